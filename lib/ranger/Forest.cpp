@@ -177,6 +177,35 @@ void Forest::initR(std::string dependent_variable_name, std::unique_ptr<Data> in
   this->keep_inbag = keep_inbag;
 }
 
+// Init for prediction with a saved forest and in-memory data, without any file output
+void Forest::initPredict(std::string load_forest_filename, std::unique_ptr<Data> input_data, uint seed,
+    uint num_threads) {
+
+  this->verbose_out = nullptr;
+
+  std::vector<double> sample_fraction_vector = { 1 };
+  std::vector<std::string> unordered_variable_names;
+
+  init("", MEM_DOUBLE, std::move(input_data), 0, "", DEFAULT_NUM_TREE, seed, num_threads, DEFAULT_IMPORTANCE_MODE, 0, "",
+      true, true, unordered_variable_names, false, DEFAULT_SPLITRULE, false, sample_fraction_vector, DEFAULT_ALPHA,
+      DEFAULT_MINPROP, false, DEFAULT_PREDICTIONTYPE, DEFAULT_NUM_RANDOM_SPLITS, false);
+
+  loadFromFile(load_forest_filename);
+}
+
+// Replace the data of a forest initialised with initPredict, so the loaded forest can predict new samples
+void Forest::setPredictionData(std::unique_ptr<Data> input_data) {
+
+  // Keep the variable properties set when the forest was loaded
+  input_data->getIsOrderedVariable() = data->getIsOrderedVariable();
+  for (auto varID : data->getNoSplitVariables()) {
+    input_data->addNoSplitVariable(varID);
+  }
+
+  data = std::move(input_data);
+  num_samples = data->getNumRows();
+}
+
 void Forest::init(std::string dependent_variable_name, MemoryMode memory_mode, std::unique_ptr<Data> input_data,
     uint mtry, std::string output_prefix, uint num_trees, uint seed, uint num_threads, ImportanceMode importance_mode,
     uint min_node_size, std::string status_variable_name, bool prediction_mode, bool sample_with_replacement,
@@ -62,6 +62,8 @@ public:
       const std::vector<std::string>& unordered_variable_names, bool memory_saving_splitting, SplitRule splitrule,
       bool predict_all, std::vector<double>& sample_fraction, double alpha, double minprop, bool holdout,
       PredictionType prediction_type, uint num_random_splits, bool order_snps);
+  void initPredict(std::string load_forest_filename, std::unique_ptr<Data> input_data, uint seed, uint num_threads);
+  void setPredictionData(std::unique_ptr<Data> input_data);
   virtual void initInternal(std::string status_variable_name) = 0;
 
   // Grow or predict
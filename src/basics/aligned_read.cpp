@@ -15,7 +15,7 @@ namespace octopus {
 
 const GenomicRegion::ContigName& AlignedRead::Segment::contig_name() const
 {
-    return contig_name_;
+    return contig_name_.str();
 }
 
 GenomicRegion::Position AlignedRead::Segment::begin() const noexcept
@@ -47,7 +47,7 @@ const std::string& AlignedRead::name() const noexcept
 
 const std::string& AlignedRead::read_group() const noexcept
 {
-    return read_group_;
+    return read_group_.str();
 }
 
 const GenomicRegion& AlignedRead::mapped_region() const noexcept
@@ -22,6 +22,7 @@
 #include "basics/genomic_region.hpp"
 #include "concepts/mappable.hpp"
 #include "cigar_string.hpp"
+#include "utils/interned_string.hpp"
 
 namespace octopus {
 
@@ -69,7 +70,7 @@ public:
     private:
         using FlagBits = std::bitset<2>;
         
-        GenomicRegion::ContigName contig_name_;
+        InternedString contig_name_;
         GenomicRegion::Position begin_;
         GenomicRegion::Size inferred_template_length_;
         FlagBits flags_;
@@ -136,8 +137,8 @@ private:
     NucleotideSequence sequence_;
     BaseQualityVector base_qualities_;
     CigarString cigar_;
-    std::string read_group_;
     boost::optional<Segment> next_segment_;
+    InternedString read_group_;
     FlagBits flags_;
     MappingQuality mapping_quality_;
     
@@ -174,8 +175,8 @@ AlignedRead::AlignedRead(String_&& name, GenomicRegion_&& reference_region, Seq&
 , sequence_ {std::forward<Seq>(sequence)}
 , base_qualities_ {std::forward<Qualities_>(qualities)}
 , cigar_ {std::forward<CigarString_>(cigar)}
-, read_group_ {std::forward<String2_>(read_group)}
 , next_segment_ {}
+, read_group_ {std::forward<String2_>(read_group)}
 , flags_ {compress(flags)}
 , mapping_quality_ {mapping_quality}
 {}
@@ -191,11 +192,11 @@ AlignedRead::AlignedRead(String1_&& name, GenomicRegion_&& reference_region, Seq
 , sequence_ {std::forward<Seq>(sequence)}
 , base_qualities_ {std::forward<Qualities_>(qualities)}
 , cigar_ {std::forward<CigarString_>(cigar)}
-, read_group_ {std::forward<String2_>(read_group)}
 , next_segment_ {
     Segment {std::forward<String3_>(next_segment_contig_name), next_segment_begin,
     inferred_template_length, next_segment_flags}
   }
+, read_group_ {std::forward<String2_>(read_group)}
 , flags_ {compress(flags)}
 , mapping_quality_ {mapping_quality}
 {}
@@ -68,7 +68,12 @@ unsigned as_unsigned(const std::string& option, const OptionMap& options)
 
 bool is_run_command(const OptionMap& options)
 {
-    return !is_set("help", options) && !is_set("version", options);
+    return !is_set("help", options) && !is_set("version", options) && !is_pack_reference_command(options);
+}
+
+bool is_pack_reference_command(const OptionMap& options)
+{
+    return is_set("pack-reference", options);
 }
 
 bool is_debug_mode(const OptionMap& options)
@@ -274,6 +279,29 @@ boost::optional<fs::path> get_trace_log_file_name(const OptionMap& options)
     }
 }
 
+boost::optional<fs::path> get_profile_file_name(const OptionMap& options)
+{
+    if (is_set("profile", options)) {
+        return resolve_path(options.at("profile").as<fs::path>(), options);
+    } else {
+        return boost::none;
+    }
+}
+
+boost::optional<fs::path> get_profile_trace_file_name(const OptionMap& options)
+{
+    if (is_set("profile-trace", options)) {
+        return resolve_path(options.at("profile-trace").as<fs::path>(), options);
+    } else {
+        return boost::none;
+    }
+}
+
+fs::path get_reference_to_pack(const OptionMap& options)
+{
+    return resolve_path(options.at("pack-reference").as<fs::path>(), options);
+}
+
 bool is_fast_mode(const OptionMap& options)
 {
     return options.at("fast").as<bool>() || options.at("very-fast").as<bool>();
@@ -683,7 +711,9 @@ ReadManager make_read_manager(const OptionMap& options)
 {
     auto read_paths = get_read_paths(options);
     const auto max_open_files = as_unsigned("max-open-read-files", options);
-    return ReadManager {std::move(read_paths), max_open_files};
+    auto max_fetch_threads = get_num_threads(options);
+    if (!max_fetch_threads) max_fetch_threads = std::thread::hardware_concurrency();
+    return ReadManager {std::move(read_paths), max_open_files, *max_fetch_threads};
 }
 
 bool allow_assembler_generation(const OptionMap& options)
@@ -1631,6 +1661,7 @@ HaplotypeLikelihoodModel make_likelihood_model(const OptionMap& options, const b
     HaplotypeLikelihoodModel::Config config {};
     config.use_mapping_quality = options.at("model-mapping-quality").as<bool>();
     config.use_flank_state = allow_flank_scoring(options);
+    config.max_cache_memory = options.at("max-likelihood-cache-footprint").as<MemoryFootprint>().num_bytes();
     if (config.use_mapping_quality) {
         config.mapping_quality_cap = calculate_mapping_quality_cap(options, read_profile);
         config.mapping_quality_cap_trigger = calculate_mapping_quality_cap_trigger(options, read_profile);
@@ -1756,6 +1787,7 @@ CallerFactory make_caller_factory(const ReferenceGenome& reference, ReadPipe& re
         vc_builder.set_sites_only();
     }
     vc_builder.set_likelihood_model(make_likelihood_model(options, read_profile));
+    vc_builder.set_execution_policy(get_thread_execution_policy(options));
     const auto target_working_memory = get_target_working_memory(options);
     if (target_working_memory) vc_builder.set_target_memory_footprint(*target_working_memory);
     return CallerFactory {std::move(vc_builder)};
@@ -1766,6 +1798,11 @@ bool is_call_filtering_requested(const OptionMap& options) noexcept
     return options.at("call-filtering").as<bool>();
 }
 
+bool is_random_forest_filtering_requested(const OptionMap& options) noexcept
+{
+    return is_call_filtering_requested(options) && (is_set("forest-file", options) || is_set("somatic-forest-file", options));
+}
+
 std::string get_germline_filter_expression(const OptionMap& options)
 {
     return options.at("filter-expression").as<std::string>();
@@ -1823,12 +1860,12 @@ make_call_filter_factory(const ReferenceGenome& reference, ReadPipe& read_pipe,
 {
     if (is_call_filtering_requested(options)) {
         const auto caller = get_caller_type(options, read_pipe.samples());
+        if (!temp_directory) temp_directory = "/tmp";
         if (is_set("forest-file", options)) {
             auto forest_file = resolve_path(options.at("forest-file").as<fs::path>(), options);
             if (!fs::exists(forest_file)) {
                 throw MissingForestFile {forest_file, "forest-file"};
             }
-            if (!temp_directory) temp_directory = "/tmp";
             if (caller == "cancer") {
                 if (is_set("somatic-forest-file", options)) {
                     auto somatic_forest_file = resolve_path(options.at("somatic-forest-file").as<fs::path>(), options);
@@ -1912,6 +1949,16 @@ bool keep_unfiltered_calls(const OptionMap& options) noexcept
     return options.at("keep-unfiltered-calls").as<bool>();
 }
 
+bool reuse_calling_likelihoods(const OptionMap& options) noexcept
+{
+    return options.at("reuse-calling-likelihoods").as<bool>();
+}
+
+bool filter_during_calling(const OptionMap& options) noexcept
+{
+    return options.at("filter-during-calling").as<bool>();
+}
+
 ReadPipe make_default_filter_read_pipe(ReadManager& read_manager, std::vector<SampleName> samples)
 {
     using std::make_unique;
@@ -28,12 +28,17 @@ namespace fs = boost::filesystem;
 namespace octopus { namespace options {
 
 bool is_run_command(const OptionMap& options);
+bool is_pack_reference_command(const OptionMap& options);
 
 bool is_debug_mode(const OptionMap& options);
 bool is_trace_mode(const OptionMap& options);
 
 boost::optional<fs::path> get_debug_log_file_name(const OptionMap& options);
 boost::optional<fs::path> get_trace_log_file_name(const OptionMap& options);
+boost::optional<fs::path> get_profile_file_name(const OptionMap& options);
+boost::optional<fs::path> get_profile_trace_file_name(const OptionMap& options);
+
+fs::path get_reference_to_pack(const OptionMap& options);
 
 boost::optional<unsigned> get_num_threads(const OptionMap& options);
 
@@ -65,6 +70,8 @@ CallerFactory make_caller_factory(const ReferenceGenome& reference, ReadPipe& re
 
 bool is_call_filtering_requested(const OptionMap& options) noexcept;
 
+bool is_random_forest_filtering_requested(const OptionMap& options) noexcept;
+
 std::unique_ptr<VariantCallFilterFactory>
 make_call_filter_factory(const ReferenceGenome& reference, ReadPipe& read_pipe, const OptionMap& options,
                          boost::optional<fs::path> temp_directory = boost::none);
@@ -73,6 +80,10 @@ bool use_calling_read_pipe_for_call_filtering(const OptionMap& options) noexcept
 
 bool keep_unfiltered_calls(const OptionMap& options) noexcept;
 
+bool reuse_calling_likelihoods(const OptionMap& options) noexcept;
+
+bool filter_during_calling(const OptionMap& options) noexcept;
+
 ReadPipe make_call_filter_read_pipe(ReadManager& read_manager, std::vector<SampleName> samples, const OptionMap& options);
 
 boost::optional<fs::path> get_output_path(const OptionMap& options);
@@ -62,6 +62,14 @@ OptionMap parse_options(const int argc, const char** argv)
      po::value<fs::path>()->implicit_value("octopus_trace.log"),
      "Writes very verbose debug information to trace.log in the working directory")
     
+    ("profile",
+     po::value<fs::path>()->implicit_value("octopus_profile.json"),
+     "Writes a JSON profile of the time spent in each calling stage, summed over all threads")
+    
+    ("profile-trace",
+     po::value<fs::path>()->implicit_value("octopus_profile_trace.json"),
+     "Writes a Chrome trace of the calling stages of each task region (viewable in chrome://tracing)")
+    
     ("fast",
      po::bool_switch()->default_value(false),
      "Turns off some features to improve runtime, at the cost of decreased calling accuracy."
@@ -70,6 +78,11 @@ OptionMap parse_options(const int argc, const char** argv)
     ("very-fast",
      po::bool_switch()->default_value(false),
      "The same as fast but also disables inactive flank scoring")
+    
+    ("pack-reference",
+     po::value<fs::path>(),
+     "Writes a packed copy of the given indexed FASTA reference to <reference>.packed and exits."
+     " The packed reference can be given to --reference for faster reference access")
     ;
     
     po::options_description backend("Backend");
@@ -91,6 +104,11 @@ OptionMap parse_options(const int argc, const char** argv)
      po::value<MemoryFootprint>()->default_value(*parse_footprint("6GB"), "6GB"),
      "None binding request to limit the memory footprint of buffered read data")
     
+    ("max-likelihood-cache-footprint",
+     po::value<MemoryFootprint>()->default_value(MemoryFootprint {0}, "0"),
+     "Maximum memory footprint of the read likelihood cache kept by each calling task's likelihood model."
+     " Off (0) by default as building cache keys costs more than the pair HMM evaluations saved on short reads")
+    
     ("max-open-read-files",
      po::value<int>()->default_value(250),
      "Limits the number of read files that can be open simultaneously")
@@ -638,6 +656,18 @@ OptionMap parse_options(const int argc, const char** argv)
      po::value<bool>()->default_value(false),
      "Use the original reads used for variant calling for filtering")
     
+    ("reuse-calling-likelihoods",
+     po::bool_switch()->default_value(false),
+     "Store the read likelihoods computed during calling and reuse them for read assignment when"
+     " filtering calls and making realigned BAMs, rather than recomputing them. The stored likelihoods"
+     " come from the calling model and active region haplotypes, and are kept in single precision, so"
+     " read assignments, and the measures derived from them, can differ from a run without this option")
+    
+    ("filter-during-calling",
+     po::bool_switch()->default_value(false),
+     "Filter calls in each calling task as soon as they are called, rather than in a separate pass after"
+     " calling. Only possible for filters that do not need the whole call set (i.e. threshold filters)")
+    
     ("keep-unfiltered-calls",
      po::bool_switch()->default_value(false),
      "Keep a copy of unfiltered calls")
@@ -716,6 +746,10 @@ OptionMap parse_options(const int argc, const char** argv)
         return vm_init;
     }
     
+    if (vm_init.count("pack-reference") == 1) {
+        return vm_init;
+    }
+    
     OptionMap vm;
     
     if (vm_init.count("config") == 1) {
@@ -20,10 +20,12 @@
 #include "core/tools/haplotype_filter.hpp"
 #include "core/tools/read_assigner.hpp"
 #include "core/tools/read_realigner.hpp"
+#include "core/tools/likelihood_sidecar.hpp"
 #include "utils/mappable_algorithms.hpp"
 #include "utils/read_stats.hpp"
 #include "utils/maths.hpp"
 #include "utils/append.hpp"
+#include "utils/profiler.hpp"
 
 namespace octopus {
 
@@ -39,6 +41,7 @@ Caller::Caller(Components&& components, Parameters parameters)
 , haplotype_generator_builder_ {std::move(components.haplotype_generator_builder)}
 , likelihood_model_ {std::move(components.likelihood_model)}
 , phaser_ {std::move(components.phaser)}
+, likelihood_sidecar_ {std::move(components.likelihood_sidecar)}
 , parameters_ {std::move(parameters)}
 {
     if (parameters_.max_haplotypes == 0) {
@@ -145,7 +148,11 @@ std::deque<VcfRecord> Caller::call(const GenomicRegion& call_region, ProgressMet
     ReadPipe::Report reads_report {};
     ReadMap reads;
     if (candidate_generator_.requires_reads()) {
-        reads = read_pipe_.get().fetch_reads(expand(call_region, 100), reads_report);
+        {
+            profiling::Scope scope {"fetch_reads"};
+            reads = read_pipe_.get().fetch_reads(expand(call_region, 100), reads_report);
+            profiling::count("reads", count_reads(reads));
+        }
         add_reads(reads, candidate_generator_);
         if (!refcalls_requested() && all_empty(reads)) {
             if (debug_log_) stream(*debug_log_) << "Stopping early as no reads found in call region " << call_region;
@@ -154,7 +161,12 @@ std::deque<VcfRecord> Caller::call(const GenomicRegion& call_region, ProgressMet
         if (debug_log_) stream(*debug_log_) << "Using " << count_reads(reads) << " reads in call region " << call_region;
     }
     const auto candidate_region = calculate_candidate_region(call_region, reads, reference_, candidate_generator_);
-    auto candidates = generate_candidate_variants(candidate_region);
+    auto candidates = [&] () {
+        profiling::Scope scope {"candidate_generation"};
+        auto result = generate_candidate_variants(candidate_region);
+        profiling::count("candidates", result.size());
+        return result;
+    }();
     if (debug_log_) debug::print_final_candidates(stream(*debug_log_), candidates, candidate_region);
     if (!refcalls_requested() && candidates.empty()) {
         progress_meter.log_completed(call_region);
@@ -162,12 +174,15 @@ std::deque<VcfRecord> Caller::call(const GenomicRegion& call_region, ProgressMet
     }
     if (!candidate_generator_.requires_reads()) {
         // as we didn't fetch them earlier
+        profiling::Scope scope {"fetch_reads"};
         reads = read_pipe_.get().fetch_reads(call_region, reads_report);
+        profiling::count("reads", count_reads(reads));
     }
     auto calls = call_variants(call_region, candidates, reads, reads_report, progress_meter);
     candidates.clear();
     candidates.shrink_to_fit();
     progress_meter.log_completed(call_region);
+    profiling::Scope scope {"vcf_conversion"};
     const auto record_factory = make_record_factory(reads);
     if (debug_log_) stream(*debug_log_) << "Converting " << calls.size() << " calls made in " << call_region << " to VCF";
     return convert_to_vcf(std::move(calls), record_factory, call_region);
@@ -298,6 +313,7 @@ Caller::call_variants(const GenomicRegion& call_region, const MappableFlatSet<Va
                       const ReadMap& reads, const ReadPipe::Report& read_report,
                       ProgressMeter& progress_meter) const
 {
+    profiling::Scope call_scope {"call_variants"};
     std::deque<CallWrapper> result {};
     auto haplotype_likelihoods = make_haplotype_likelihood_cache();
     if (candidates.empty()) {
@@ -315,8 +331,11 @@ Caller::call_variants(const GenomicRegion& call_region, const MappableFlatSet<Va
     auto completed_region = head_region(call_region);
     std::deque<Haplotype> protected_haplotypes {};
     while (true) {
-        status = generate_active_haplotypes(call_region, haplotype_generator, active_region,
-                                            next_active_region, haplotypes, next_haplotypes);
+        {
+            profiling::Scope scope {"haplotype_generation"};
+            status = generate_active_haplotypes(call_region, haplotype_generator, active_region,
+                                                next_active_region, haplotypes, next_haplotypes);
+        }
         if (status == GeneratorStatus::done) {
             if (refcalls_requested()) {
                 if (!prev_called_region) {
@@ -340,7 +359,15 @@ Caller::call_variants(const GenomicRegion& call_region, const MappableFlatSet<Va
             continue;
         }
         if (debug_log_) stream(*debug_log_) << "There are " << count_reads(active_reads) << " active reads in " << active_region;
-        if (!populate(haplotype_likelihoods, active_region, haplotypes, candidates, active_reads)) {
+        profiling::count("active_regions");
+        bool is_populated;
+        {
+            profiling::Scope scope {"likelihoods"};
+            profiling::count("reads", count_reads(active_reads));
+            profiling::count("haplotypes", haplotypes.size());
+            is_populated = populate(haplotype_likelihoods, active_region, haplotypes, candidates, active_reads);
+        }
+        if (!is_populated) {
             haplotype_generator.clear_progress();
             haplotype_likelihoods.clear();
             continue;
@@ -357,9 +384,16 @@ Caller::call_variants(const GenomicRegion& call_region, const MappableFlatSet<Va
                 insert_sorted(*reference_haplotype_itr, protected_haplotypes);
             }
         }
-        auto has_removal_impact = filter_haplotypes(haplotypes, haplotype_generator, haplotype_likelihoods, protected_haplotypes);
+        bool has_removal_impact;
+        {
+            profiling::Scope scope {"haplotype_filtering"};
+            has_removal_impact = filter_haplotypes(haplotypes, haplotype_generator, haplotype_likelihoods, protected_haplotypes);
+        }
         if (haplotypes.empty()) continue;
-        const auto caller_latents = infer_latents(haplotypes, haplotype_likelihoods);
+        const auto caller_latents = [&] () {
+            profiling::Scope scope {"latents"};
+            return infer_latents(haplotypes, haplotype_likelihoods);
+        }();
         if (trace_log_) {
             debug::print_haplotype_posteriors(stream(*trace_log_), *caller_latents->haplotype_posteriors(), -1);
         } else if (debug_log_) {
@@ -383,6 +417,7 @@ Caller::call_variants(const GenomicRegion& call_region, const MappableFlatSet<Va
             protected_haplotypes.clear();
         }
         if (status != GeneratorStatus::skipped) {
+            profiling::Scope scope {"calling"};
             call_variants(active_region, call_region, next_active_region, backtrack_region,
                           candidates, haplotypes, haplotype_likelihoods, active_reads, *caller_latents,
                           result, prev_called_region, completed_region);
@@ -390,6 +425,14 @@ Caller::call_variants(const GenomicRegion& call_region, const MappableFlatSet<Va
         haplotype_likelihoods.clear();
         progress_meter.log_completed(completed_region);
     }
+    if (debug_log_) {
+        const auto cache_statistics = haplotype_likelihoods.cache_statistics();
+        if (cache_statistics.lookups > 0) {
+            stream(*debug_log_) << "Read likelihood cache hit rate in " << call_region << " was "
+                                << 100.0 * cache_statistics.hits / cache_statistics.lookups << "% ("
+                                << cache_statistics.hits << " of " << cache_statistics.lookups << " lookups)";
+        }
+    }
     return result;
 }
 
@@ -691,6 +734,9 @@ void Caller::call_variants(const GenomicRegion& active_region,
             if (!calls.empty()) {
                 set_model_posteriors(calls, latents, haplotypes, haplotype_likelihoods);
                 set_phasing(calls, latents, haplotypes, call_region);
+                if (likelihood_sidecar_) {
+                    write_likelihood_sidecar(haplotypes, haplotype_likelihoods, reads, latents);
+                }
             }
         }
         if (refcalls_requested()) {
@@ -707,6 +753,23 @@ void Caller::call_variants(const GenomicRegion& active_region,
     }
 }
 
+void Caller::write_likelihood_sidecar(const std::vector<Haplotype>& haplotypes,
+                                      const HaplotypeLikelihoodArray& haplotype_likelihoods,
+                                      const ReadMap& reads, const Latents& latents) const
+{
+    // Store the called haplotypes and the reference, as read assignment needs both for homozygous calls
+    const auto called_haplotypes = get_called_haplotypes(latents);
+    std::vector<Haplotype> sidecar_haplotypes {std::cbegin(called_haplotypes), std::cend(called_haplotypes)};
+    const auto reference_itr = find_reference(haplotypes);
+    if (reference_itr != std::cend(haplotypes) && !has_reference(sidecar_haplotypes)) {
+        sidecar_haplotypes.push_back(*reference_itr);
+    }
+    sidecar_haplotypes.erase(std::remove_if(std::begin(sidecar_haplotypes), std::end(sidecar_haplotypes),
+                                            [&] (const auto& haplotype) { return !haplotype_likelihoods.contains(haplotype); }),
+                             std::end(sidecar_haplotypes));
+    likelihood_sidecar_->write(sidecar_haplotypes, reads, haplotype_likelihoods, reference_);
+}
+
 Genotype<Haplotype> Caller::call_genotype(const Latents& latents, const SampleName& sample) const
 {
     const auto genotype_posteriors_ptr = latents.genotype_posteriors();
@@ -844,7 +907,7 @@ HaplotypeGenerator Caller::make_haplotype_generator(const MappableFlatSet<Varian
 
 HaplotypeLikelihoodArray Caller::make_haplotype_likelihood_cache() const
 {
-    return HaplotypeLikelihoodArray {likelihood_model_, parameters_.max_haplotypes, samples_};
+    return HaplotypeLikelihoodArray {likelihood_model_, parameters_.max_haplotypes, samples_, parameters_.execution_policy};
 }
 
 VcfRecordFactory Caller::make_record_factory(const ReadMap& reads) const
@@ -37,6 +37,7 @@ class Call;
 struct CallWrapper;
 class VariantCall;
 class ReferenceCall;
+class LikelihoodSidecarWriter;
 
 class Caller
 {
@@ -105,6 +106,7 @@ public:
         HaplotypeGenerator::Builder haplotype_generator_builder;
         HaplotypeLikelihoodModel likelihood_model;
         Phaser phaser;
+        std::shared_ptr<LikelihoodSidecarWriter> likelihood_sidecar;
     };
     
     struct Parameters
@@ -116,6 +118,7 @@ public:
         bool allow_model_filtering;
         bool protect_reference_haplotype;
         boost::optional<MemoryFootprint> target_max_memory;
+        ExecutionPolicy execution_policy;
     };
     
 private:
@@ -128,6 +131,7 @@ private:
     HaplotypeGenerator::Builder haplotype_generator_builder_;
     HaplotypeLikelihoodModel likelihood_model_;
     Phaser phaser_;
+    std::shared_ptr<LikelihoodSidecarWriter> likelihood_sidecar_;
     Parameters parameters_;
     
     // virtual methods
@@ -216,6 +220,8 @@ private:
                               const HaplotypeLikelihoodArray& haplotype_likelihoods) const;
     void set_phasing(std::vector<CallWrapper>& calls, const Latents& latents,
                      const std::vector<Haplotype>& haplotypes, const GenomicRegion& call_region) const;
+    void write_likelihood_sidecar(const std::vector<Haplotype>& haplotypes, const HaplotypeLikelihoodArray& haplotype_likelihoods,
+                                  const ReadMap& reads, const Latents& latents) const;
     bool done_calling(const GenomicRegion& region) const noexcept;
     std::vector<CallWrapper> call_reference(const GenomicRegion& region, const ReadMap& reads) const;
     std::vector<Allele>
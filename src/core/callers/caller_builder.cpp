@@ -15,7 +15,7 @@ namespace octopus {
 
 CallerBuilder::CallerBuilder(const ReferenceGenome& reference, const ReadPipe& read_pipe,
                              VariantGeneratorBuilder vgb, HaplotypeGenerator::Builder hgb)
-: components_ {reference, read_pipe, std::move(vgb), std::move(hgb), HaplotypeLikelihoodModel {}, Phaser {}}
+: components_ {reference, read_pipe, std::move(vgb), std::move(hgb), HaplotypeLikelihoodModel {}, Phaser {}, nullptr}
 , params_ {}
 , factory_ {}
 {
@@ -25,6 +25,7 @@ CallerBuilder::CallerBuilder(const ReferenceGenome& reference, const ReadPipe& r
     params_.general.haplotype_extension_threshold = Phred<> {150.0};
     params_.general.saturation_limit = Phred<> {10.0};
     params_.general.max_haplotypes = 200;
+    params_.general.execution_policy = ExecutionPolicy::seq;
     factory_ = generate_factory();
 }
 
@@ -115,6 +116,18 @@ CallerBuilder& CallerBuilder::set_target_memory_footprint(MemoryFootprint memory
     return *this;
 }
 
+CallerBuilder& CallerBuilder::set_execution_policy(const ExecutionPolicy policy) noexcept
+{
+    params_.general.execution_policy = policy;
+    return *this;
+}
+
+CallerBuilder& CallerBuilder::set_likelihood_sidecar(std::shared_ptr<LikelihoodSidecarWriter> sidecar) noexcept
+{
+    components_.likelihood_sidecar = std::move(sidecar);
+    return *this;
+}
+
 CallerBuilder& CallerBuilder::set_min_variant_posterior(Phred<double> posterior) noexcept
 {
     params_.min_variant_posterior = posterior;
@@ -310,7 +323,8 @@ Caller::Components CallerBuilder::make_components() const
         components_.variant_generator_builder.build(components_.reference),
         components_.haplotype_generator_builder,
         components_.likelihood_model,
-        Phaser {params_.min_phase_score}
+        Phaser {params_.min_phase_score},
+        components_.likelihood_sidecar
     };
 }
 
@@ -52,6 +52,8 @@ public:
     CallerBuilder& set_sites_only() noexcept;
     CallerBuilder& set_reference_haplotype_protection(bool b) noexcept;
     CallerBuilder& set_target_memory_footprint(MemoryFootprint memory) noexcept;
+    CallerBuilder& set_execution_policy(ExecutionPolicy policy) noexcept;
+    CallerBuilder& set_likelihood_sidecar(std::shared_ptr<LikelihoodSidecarWriter> sidecar) noexcept;
     
     CallerBuilder& set_min_variant_posterior(Phred<double> posterior) noexcept;
     CallerBuilder& set_min_refcall_posterior(Phred<double> posterior) noexcept;
@@ -103,6 +105,7 @@ private:
         HaplotypeGenerator::Builder haplotype_generator_builder;
         HaplotypeLikelihoodModel likelihood_model;
         Phaser phaser;
+        std::shared_ptr<LikelihoodSidecarWriter> likelihood_sidecar;
     };
     
     struct Parameters
@@ -34,6 +34,7 @@ public:
     
     CallerFactory& set_reference(const ReferenceGenome& reference) noexcept;
     CallerFactory& set_read_pipe(ReadPipe& read_pipe) noexcept;
+    CallerFactory& set_likelihood_sidecar(std::shared_ptr<LikelihoodSidecarWriter> sidecar) noexcept;
     
     std::unique_ptr<Caller> make(const ContigName& contig) const;
     
@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <functional>
 #include <exception>
+#include <thread>
 
 #include "config/config.hpp"
 #include "config/option_collation.hpp"
@@ -133,6 +134,25 @@ const VariantCallFilterFactory& GenomeCallingComponents::call_filter_factory() c
     return *components_.call_filter_factory;
 }
 
+bool GenomeCallingComponents::is_call_filtering_fused() const noexcept
+{
+    return components_.fuse_call_filtering;
+}
+
+boost::optional<const VariantCallFilter&> GenomeCallingComponents::fused_call_filter() const noexcept
+{
+    if (components_.fused_call_filter) {
+        return *components_.fused_call_filter; // convert to reference
+    } else {
+        return boost::none;
+    }
+}
+
+void GenomeCallingComponents::set_fused_call_filter(std::unique_ptr<VariantCallFilter> filter) noexcept
+{
+    components_.fused_call_filter = std::move(filter);
+}
+
 ReadPipe& GenomeCallingComponents::filter_read_pipe() noexcept
 {
     return components_.filter_read_pipe ? *components_.filter_read_pipe : read_pipe();
@@ -173,6 +193,11 @@ boost::optional<GenomeCallingComponents::Path> GenomeCallingComponents::data_pro
     return components_.data_profile;
 }
 
+std::shared_ptr<LikelihoodSidecarWriter> GenomeCallingComponents::likelihood_sidecar() const noexcept
+{
+    return components_.likelihood_sidecar;
+}
+
 bool GenomeCallingComponents::sites_only() const noexcept
 {
     return components_.sites_only;
@@ -362,13 +387,21 @@ bool is_stdout_output(const options::OptionMap& options)
 
 bool require_temp_dir_for_filtering(const options::OptionMap& options)
 {
-    return options::is_call_filtering_requested(options)
-           && (!options::keep_unfiltered_calls(options) || is_stdout_output(options));
+    return (options::is_call_filtering_requested(options)
+            && (!options::keep_unfiltered_calls(options) || is_stdout_output(options)))
+           || options::is_random_forest_filtering_requested(options); // measure replay buffer may spill
+}
+
+bool is_likelihood_sidecar_needed(const options::OptionMap& options)
+{
+    return options::reuse_calling_likelihoods(options)
+           && (options::is_call_filtering_requested(options) || options::bamout_request(options)
+               || options::split_bamout_request(options));
 }
 
 bool is_temp_directory_needed(const options::OptionMap& options)
 {
-    return is_multithreaded_run(options) || require_temp_dir_for_filtering(options);
+    return is_multithreaded_run(options) || require_temp_dir_for_filtering(options) || is_likelihood_sidecar_needed(options);
 }
 
 boost::optional<fs::path> get_temp_directory(const options::OptionMap& options)
@@ -515,6 +548,7 @@ GenomeCallingComponents::Components::Components(ReferenceGenome&& reference, Rea
     try {
         call_filter_factory = options::make_call_filter_factory(this->reference, this->read_pipe, options, this->temp_directory);
         setup_writers(options);
+        setup_likelihood_sidecar(options);
     } catch (...) {
         if (temp_directory) fs::remove_all(*temp_directory);
         throw;
@@ -542,7 +576,16 @@ void GenomeCallingComponents::Components::set_read_buffer_size(const options::Op
 
 void GenomeCallingComponents::Components::setup_writers(const options::OptionMap& options)
 {
-    if (call_filter_factory) {
+    fuse_call_filtering = false;
+    if (call_filter_factory && options::filter_during_calling(options)) {
+        if (call_filter_factory->is_block_local() && !filter_request && !options::keep_unfiltered_calls(options)) {
+            fuse_call_filtering = true;
+        } else {
+            logging::WarningLogger warn_log {};
+            warn_log << "Calls cannot be filtered during calling with the requested options, so will be filtered after calling";
+        }
+    }
+    if (call_filter_factory && !fuse_call_filtering) {
         const auto final_output_path = output.path();
         filtered_output = std::move(output);
         fs::path prefilter_path;
@@ -573,6 +616,15 @@ void GenomeCallingComponents::Components::setup_filter_read_pipe(const options::
     }
 }
 
+void GenomeCallingComponents::Components::setup_likelihood_sidecar(const options::OptionMap& options)
+{
+    if (is_likelihood_sidecar_needed(options) && (!fuse_call_filtering || bamout || split_bamout)) {
+        assert(temp_directory);
+        likelihood_sidecar = std::make_shared<LikelihoodSidecarWriter>(*temp_directory / "octopus_likelihoods.bin");
+        caller_factory.set_likelihood_sidecar(likelihood_sidecar);
+    }
+}
+
 void GenomeCallingComponents::update_dependents() noexcept
 {
     components_.read_pipe.set_read_manager(components_.read_manager);
@@ -631,7 +683,11 @@ private:
 
 VcfWriter make_output_vcf_writer(const options::OptionMap& options)
 {
-    return make_vcf_writer(options::get_output_path(options));
+    auto result = make_vcf_writer(options::get_output_path(options));
+    auto num_threads = options::get_num_threads(options);
+    if (!num_threads) num_threads = std::thread::hardware_concurrency();
+    if (*num_threads > 1) result.set_compression_threads(*num_threads);
+    return result;
 }
 
 } // namespace
@@ -691,6 +747,8 @@ ContigCallingComponents::ContigCallingComponents(const GenomicRegion::ContigName
 , read_buffer_size {genome_components.read_buffer_size()}
 , output {genome_components.output()}
 , progress_meter {genome_components.progress_meter()}
+, call_filter {genome_components.fused_call_filter()}
+, filter_read_pipe {genome_components.filter_read_pipe()}
 {}
 
 ContigCallingComponents::ContigCallingComponents(const GenomicRegion::ContigName& contig, VcfWriter& output,
@@ -703,6 +761,8 @@ ContigCallingComponents::ContigCallingComponents(const GenomicRegion::ContigName
 , read_buffer_size {genome_components.read_buffer_size()}
 , output {output}
 , progress_meter {genome_components.progress_meter()}
+, call_filter {genome_components.fused_call_filter()}
+, filter_read_pipe {genome_components.filter_read_pipe()}
 {}
 
 } // namespace octopus
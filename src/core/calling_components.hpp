@@ -23,6 +23,7 @@
 #include "readpipe/read_pipe_fwd.hpp"
 #include "core/callers/caller_factory.hpp"
 #include "core/csr/filters/variant_call_filter_factory.hpp"
+#include "core/tools/likelihood_sidecar.hpp"
 #include "utils/input_reads_profiler.hpp"
 #include "logging/progress_meter.hpp"
 
@@ -62,6 +63,9 @@ public:
     boost::optional<VcfWriter&> filtered_output() noexcept;
     boost::optional<const VcfWriter&> filtered_output() const noexcept;
     const VariantCallFilterFactory& call_filter_factory() const;
+    bool is_call_filtering_fused() const noexcept;
+    boost::optional<const VariantCallFilter&> fused_call_filter() const noexcept;
+    void set_fused_call_filter(std::unique_ptr<VariantCallFilter> filter) noexcept;
     ReadPipe& filter_read_pipe() noexcept;
     const ReadPipe& filter_read_pipe() const noexcept;
     ProgressMeter& progress_meter() noexcept;
@@ -73,6 +77,7 @@ public:
     boost::optional<Path> bamout() const;
     boost::optional<Path> split_bamout() const;
     boost::optional<Path> data_profile() const;
+    std::shared_ptr<LikelihoodSidecarWriter> likelihood_sidecar() const noexcept;
     
 private:
     struct Components
@@ -113,11 +118,15 @@ private:
         // exception handling easier.
         boost::optional<Path> temp_directory;
         std::unique_ptr<VariantCallFilterFactory> call_filter_factory;
+        bool fuse_call_filtering;
+        std::unique_ptr<VariantCallFilter> fused_call_filter;
+        std::shared_ptr<LikelihoodSidecarWriter> likelihood_sidecar;
         
         void setup_progress_meter(const options::OptionMap& options);
         void set_read_buffer_size(const options::OptionMap& options);
         void setup_writers(const options::OptionMap& options);
         void setup_filter_read_pipe(const options::OptionMap& options);
+        void setup_likelihood_sidecar(const options::OptionMap& options);
     };
     
     Components components_;
@@ -141,6 +150,8 @@ struct ContigCallingComponents
     std::size_t read_buffer_size;
     std::reference_wrapper<VcfWriter> output;
     std::reference_wrapper<ProgressMeter> progress_meter;
+    boost::optional<const VariantCallFilter&> call_filter;
+    std::reference_wrapper<const ReadPipe> filter_read_pipe;
     
     ContigCallingComponents() = delete;
     
@@ -9,6 +9,8 @@
 #include <iterator>
 #include <array>
 #include <future>
+#include <mutex>
+#include <condition_variable>
 #include <cassert>
 
 #include "exceptions/program_error.hpp"
@@ -29,6 +31,7 @@ FacetFactory::FacetFactory(VcfHeader input_header)
 , read_pipe_ {}
 , ploidies_ {}
 , pedigree_ {}
+, calling_likelihoods_ {}
 , facet_makers_ {}
 {
     setup_facet_makers();
@@ -41,6 +44,7 @@ FacetFactory::FacetFactory(VcfHeader input_header, const ReferenceGenome& refere
 , read_pipe_ {std::move(read_pipe)}
 , ploidies_ {std::move(ploidies)}
 , pedigree_ {}
+, calling_likelihoods_ {}
 , facet_makers_ {}
 {
     setup_facet_makers();
@@ -54,6 +58,7 @@ FacetFactory::FacetFactory(VcfHeader input_header, const ReferenceGenome& refere
 , read_pipe_ {std::move(read_pipe)}
 , ploidies_ {std::move(ploidies)}
 , pedigree_ {std::move(pedigree)}
+, calling_likelihoods_ {}
 , facet_makers_ {}
 {
     setup_facet_makers();
@@ -66,6 +71,7 @@ FacetFactory::FacetFactory(FacetFactory&& other)
 , read_pipe_ {std::move(other.read_pipe_)}
 , ploidies_ {std::move(other.ploidies_)}
 , pedigree_ {std::move(other.pedigree_)}
+, calling_likelihoods_ {std::move(other.calling_likelihoods_)}
 , facet_makers_ {}
 {
     setup_facet_makers();
@@ -80,10 +86,16 @@ FacetFactory& FacetFactory::operator=(FacetFactory&& other)
     swap(read_pipe_, other.read_pipe_);
     swap(ploidies_, other.ploidies_);
     swap(pedigree_, other.pedigree_);
+    swap(calling_likelihoods_, other.calling_likelihoods_);
     setup_facet_makers();
     return *this;
 }
 
+void FacetFactory::set_calling_likelihoods(std::shared_ptr<const LikelihoodSidecarReader> likelihoods) noexcept
+{
+    calling_likelihoods_ = std::move(likelihoods);
+}
+
 class UnknownFacet : public ProgramError
 {
     std::string do_where() const override { return "FacetFactory::make"; }
@@ -193,46 +205,143 @@ public:
     BadFacetFactoryRequest(std::string facet) : facet_ {std::move(facet)} {}
 };
 
+FacetFactory::FacetBlock FacetFactory::make(const std::vector<std::string>& names, const CallBlock& block, const ReadMap& reads) const
+{
+    if (names.empty()) return {};
+    check_requirements(names, true);
+    BlockData block_data {};
+    if (!block.empty()) {
+        block_data.region = encompassing_region(block);
+        if (requires_reads(names)) {
+            block_data.reads = copy_overlapped(reads, *block_data.region);
+        }
+        if (requires_genotypes(names)) {
+            block_data.genotypes = extract_genotypes(block, samples_, *reference_);
+        }
+    }
+    return make(names, block_data);
+}
+
 std::vector<FacetFactory::FacetBlock>
 FacetFactory::make(const std::vector<std::string>& names,
                    const std::vector<CallBlock>& blocks,
                    ThreadPool& workers) const
 {
-    if (blocks.empty()) return {};
+    std::vector<FacetBlock> result(blocks.size());
+    make(names, blocks, workers, [&result] (const std::size_t idx, FacetBlock facets) { result[idx] = std::move(facets); },
+         blocks.size());
+    return result;
+}
+
+namespace {
+
+class BlockWindow
+{
+public:
+    BlockWindow(std::size_t capacity) : capacity_ {std::max(capacity, std::size_t {1})}, size_ {0} {}
+    
+    void acquire()
+    {
+        std::unique_lock<std::mutex> lock {mutex_};
+        cv_.wait(lock, [this] () { return size_ < capacity_; });
+        ++size_;
+    }
+    void release()
+    {
+        {
+            std::lock_guard<std::mutex> lock {mutex_};
+            --size_;
+        }
+        cv_.notify_one();
+    }
+    
+private:
+    std::size_t capacity_, size_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+struct BlockWindowSlot
+{
+    BlockWindowSlot(BlockWindow& window) : window_ {window} {}
+    ~BlockWindowSlot() { window_.release(); }
+private:
+    BlockWindow& window_;
+};
+
+template <typename T>
+void wait_all(std::vector<std::future<T>>& futures) noexcept
+{
+    for (auto& fut : futures) {
+        if (fut.valid()) fut.wait();
+    }
+}
+
+} // namespace
+
+void FacetFactory::make(const std::vector<std::string>& names,
+                        const std::vector<CallBlock>& blocks,
+                        ThreadPool& workers,
+                        const FacetBlockHandler& handler,
+                        const std::size_t max_buffered_blocks) const
+{
+    if (blocks.empty()) return;
     check_requirements(names);
-    std::vector<FacetBlock> result {};
-    result.reserve(blocks.size());
     if (blocks.size() > 1 && !workers.empty()) {
-        std::vector<std::future<FacetBlock>> futures {};
-        futures.reserve(blocks.size());
         const auto fetch_reads = requires_reads(names);
         const auto fetch_genotypes = requires_genotypes(names);
-        for (const auto& block : blocks) {
-            // It's faster to fetch reads serially from left to right, so do this outside the thread pool
-            BlockData data {};
-            if (!block.empty()) {
-                data.region = encompassing_region(block);
-                if (fetch_reads) {
-                    data.reads = read_pipe_->fetch_reads(*data.region);
+        BlockWindow window {max_buffered_blocks};
+        std::vector<std::future<void>> futures {};
+        futures.reserve(blocks.size());
+        try {
+            for (std::size_t block_idx {0}; block_idx < blocks.size(); ++block_idx) {
+                const auto& block = blocks[block_idx];
+                window.acquire();
+                // It's faster to fetch reads serially from left to right, so do this outside the thread pool
+                BlockData data {};
+                try {
+                    if (!block.empty()) {
+                        data.region = encompassing_region(block);
+                        if (fetch_reads) {
+                            data.reads = read_pipe_->fetch_reads(*data.region);
+                        }
+                    }
+                } catch (...) {
+                    window.release();
+                    throw;
                 }
+                futures.push_back(workers.push([this, &names, &handler, &window, &block, block_idx, fetch_genotypes,
+                                                data {std::move(data)}] () mutable {
+                    BlockWindowSlot slot {window};
+                    if (fetch_genotypes) {
+                        data.genotypes = extract_genotypes(block, samples_, *reference_);
+                    }
+                    handler(block_idx, this->make(names, data));
+                }));
             }
-            futures.push_back(workers.push([this, &names, data {std::move(data)}, &block, fetch_genotypes] () mutable {
-                if (fetch_genotypes) {
-                    data.genotypes = extract_genotypes(block, samples_, *reference_);
-                }
-                return this->make(names, data);
-            }));
+        } catch (...) {
+            wait_all(futures); // tasks reference window and handler
+            throw;
         }
         for (auto& fut : futures) {
-            result.push_back(fut.get());
+            try {
+                fut.get();
+            } catch (...) {
+                wait_all(futures);
+                throw;
+            }
         }
     } else {
-        for (const auto& block : blocks) {
-            const auto data = make_block_data(names, block);
-            result.push_back(make(names, data));
+        for (std::size_t block_idx {0}; block_idx < blocks.size(); ++block_idx) {
+            const auto data = make_block_data(names, blocks[block_idx]);
+            handler(block_idx, make(names, data));
         }
     }
-    return result;
+}
+
+bool FacetFactory::is_read_dependent(const std::vector<std::string>& names) const noexcept
+{
+    return requires_reads(names);
 }
 
 // private methods
@@ -247,7 +356,11 @@ void FacetFactory::setup_facet_makers()
     facet_makers_[name<ReadAssignments>()] = [this] (const BlockData& block) -> FacetWrapper
     {
         assert(block.reads && block.genotypes);
-        return {std::make_unique<ReadAssignments>(*reference_, *block.genotypes, *block.reads)};
+        if (calling_likelihoods_) {
+            return {std::make_unique<ReadAssignments>(*reference_, *block.genotypes, *block.reads, *calling_likelihoods_)};
+        } else {
+            return {std::make_unique<ReadAssignments>(*reference_, *block.genotypes, *block.reads)};
+        }
     };
     facet_makers_[name<ReferenceContext>()] = [this] (const BlockData& block) -> FacetWrapper
     {
@@ -277,9 +390,9 @@ void FacetFactory::setup_facet_makers()
     };
 }
 
-void FacetFactory::check_requirements(const std::string& name) const
+void FacetFactory::check_requirements(const std::string& name, const bool have_reads) const
 {
-    if (!read_pipe_ && requires_reads(name)) {
+    if (!have_reads && requires_reads(name)) {
         throw BadFacetFactoryRequest {name};
     }
     if (!reference_ && requires_reference(name)) {
@@ -293,13 +406,23 @@ void FacetFactory::check_requirements(const std::string& name) const
     }
 }
 
-void FacetFactory::check_requirements(const std::vector<std::string>& names) const
+void FacetFactory::check_requirements(const std::string& name) const
+{
+    check_requirements(name, static_cast<bool>(read_pipe_));
+}
+
+void FacetFactory::check_requirements(const std::vector<std::string>& names, const bool have_reads) const
 {
     for (const auto& name : names) {
-        check_requirements(name);
+        check_requirements(name, have_reads);
     }
 }
 
+void FacetFactory::check_requirements(const std::vector<std::string>& names) const
+{
+    check_requirements(names, static_cast<bool>(read_pipe_));
+}
+
 FacetWrapper FacetFactory::make(const std::string& name, const BlockData& block) const
 {
     if (facet_makers_.count(name) == 1) {
@@ -5,9 +5,11 @@
 #define facet_factory_hpp
 
 #include <string>
+#include <cstddef>
 #include <vector>
 #include <functional>
 #include <unordered_map>
+#include <memory>
 
 #include <boost/optional.hpp>
 
@@ -19,6 +21,7 @@
 #include "io/reference/reference_genome.hpp"
 #include "readpipe/buffered_read_pipe.hpp"
 #include "utils/genotype_reader.hpp"
+#include "core/tools/likelihood_sidecar.hpp"
 #include "utils/thread_pool.hpp"
 #include "facet.hpp"
 
@@ -29,6 +32,7 @@ class FacetFactory
 public:
     using CallBlock  = std::vector<VcfRecord>;
     using FacetBlock = std::vector<FacetWrapper>;
+    using FacetBlockHandler = std::function<void(std::size_t, FacetBlock)>;
     
     FacetFactory() = delete;
     
@@ -44,9 +48,21 @@ public:
     
     ~FacetFactory() = default;
     
+    // Read assignments will use these likelihoods, computed during calling, where possible
+    void set_calling_likelihoods(std::shared_ptr<const LikelihoodSidecarReader> likelihoods) noexcept;
+    
     FacetWrapper make(const std::string& name, const CallBlock& block) const;
     FacetBlock make(const std::vector<std::string>& names, const CallBlock& block) const;
+    // Uses the given reads, which must contain all reads overlapping the block, rather than the read pipe
+    FacetBlock make(const std::vector<std::string>& names, const CallBlock& block, const ReadMap& reads) const;
     std::vector<FacetBlock> make(const std::vector<std::string>& names, const std::vector<CallBlock>& blocks, ThreadPool& workers) const;
+    // Reads are fetched for each block, left to right, on the calling thread while workers make facets for earlier
+    // blocks. handler is called on a worker thread with the index of each block and its facets. At most
+    // max_buffered_blocks blocks are prefetched or being handled at any one time.
+    void make(const std::vector<std::string>& names, const std::vector<CallBlock>& blocks, ThreadPool& workers,
+              const FacetBlockHandler& handler, std::size_t max_buffered_blocks) const;
+    
+    bool is_read_dependent(const std::vector<std::string>& names) const noexcept;
 
 private:
     struct BlockData
@@ -62,11 +78,14 @@ private:
     boost::optional<BufferedReadPipe> read_pipe_;
     boost::optional<PloidyMap> ploidies_;
     boost::optional<octopus::Pedigree> pedigree_;
+    std::shared_ptr<const LikelihoodSidecarReader> calling_likelihoods_;
     
     std::unordered_map<std::string, std::function<FacetWrapper(const BlockData& data)>> facet_makers_;
     
     void setup_facet_makers();
+    void check_requirements(const std::string& name, bool have_reads) const;
     void check_requirements(const std::string& name) const;
+    void check_requirements(const std::vector<std::string>& names, bool have_reads) const;
     void check_requirements(const std::vector<std::string>& names) const;
     FacetWrapper make(const std::string& name, const BlockData& block) const;
     FacetBlock make(const std::vector<std::string>& names, const BlockData& block) const;
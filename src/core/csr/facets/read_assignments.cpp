@@ -20,9 +20,17 @@ auto copy_overlapped_to_vector(const ReadContainer& reads, const Mappable& mappa
 
 } // namespace
 
-ReadAssignments::ReadAssignments(const ReferenceGenome& reference, const GenotypeMap& genotypes, const ReadMap& reads)
+ReadAssignments::ReadAssignments(const ReferenceGenome& reference, const GenotypeMap& genotypes, const ReadMap& reads,
+                                 boost::optional<const LikelihoodSidecarReader&> calling_likelihoods)
 : result_ {}
 {
+    const auto assign = [&] (const auto& genotype, const auto& local_reads, const auto& sample) {
+        if (calling_likelihoods) {
+            return compute_haplotype_support(genotype, local_reads, result_.ambiguous[sample], sample, *calling_likelihoods);
+        } else {
+            return compute_haplotype_support(genotype, local_reads, result_.ambiguous[sample]);
+        }
+    };
     const auto num_samples = genotypes.size();
     result_.support.reserve(num_samples);
     result_.ambiguous.reserve(num_samples);
@@ -39,7 +47,7 @@ ReadAssignments::ReadAssignments(const ReferenceGenome& reference, const Genotyp
             if (!local_reads.empty()) {
                 HaplotypeSupportMap genotype_support {};
                 if (!genotype.is_homozygous()) {
-                    genotype_support = compute_haplotype_support(genotype, local_reads, result_.ambiguous[sample]);
+                    genotype_support = assign(genotype, local_reads, sample);
                 } else {
                     if (is_reference(genotype[0])) {
                         genotype_support[genotype[0]] = std::move(local_reads);
@@ -48,7 +56,7 @@ ReadAssignments::ReadAssignments(const ReferenceGenome& reference, const Genotyp
                         Haplotype ref {mapped_region(genotype), reference};
                         result_.support[sample][ref] = {};
                         augmented_genotype.emplace(std::move(ref));
-                        genotype_support = compute_haplotype_support(augmented_genotype, local_reads, result_.ambiguous[sample]);
+                        genotype_support = assign(augmented_genotype, local_reads, sample);
                     }
                 }
                 for (auto& s : genotype_support) {
@@ -15,6 +15,7 @@
 #include "core/types/haplotype.hpp"
 #include "core/types/genotype.hpp"
 #include "core/tools/read_assigner.hpp"
+#include "core/tools/likelihood_sidecar.hpp"
 #include "io/reference/reference_genome.hpp"
 
 namespace octopus { namespace csr {
@@ -26,7 +27,8 @@ public:
     
     ReadAssignments() = default;
     
-    ReadAssignments(const ReferenceGenome& reference, const GenotypeMap& genotypes, const ReadMap& reads);
+    ReadAssignments(const ReferenceGenome& reference, const GenotypeMap& genotypes, const ReadMap& reads,
+                    boost::optional<const LikelihoodSidecarReader&> calling_likelihoods = boost::none);
     
 private:
     static const std::string name_;
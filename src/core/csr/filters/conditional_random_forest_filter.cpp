@@ -7,16 +7,13 @@
 #include <iterator>
 #include <algorithm>
 #include <numeric>
-#include <iostream>
 #include <cassert>
 #include <cmath>
-#include <limits>
 
 #include <boost/variant.hpp>
-#include <boost/lexical_cast.hpp>
 #include <boost/filesystem/operations.hpp>
 
-#include "ranger/ForestProbability.h"
+#include "ranger/DataDouble.h"
 
 #include "basics/phred.hpp"
 #include "utils/concat.hpp"
@@ -57,13 +54,13 @@ ConditionalRandomForestFilter::ConditionalRandomForestFilter(FacetFactory facet_
                                                              Path temp_directory,
                                                              boost::optional<ProgressMeter&> progress)
 : DoublePassVariantCallFilter {std::move(facet_factory), concat(std::move(measures), chooser_measures),
-                               std::move(output_config), threading, progress}
+                               std::move(output_config), threading, std::move(temp_directory), progress}
 , forest_paths_ {std::move(ranger_forests)}
-, temp_dir_ {std::move(temp_directory)}
 , chooser_ {std::move(chooser)}
 , num_chooser_measures_ {chooser_measures.size()}
+, data_ {}
 , num_records_ {0}
-, data_buffer_ {}
+, predictions_ {}
 {
     check_all_exists(forest_paths_);
     forests_.reserve(forest_paths_.size());
@@ -90,34 +87,10 @@ std::int8_t ConditionalRandomForestFilter::choose_forest(const MeasureVector& me
     return chooser_(chooser_measures);
 }
 
-template <typename T>
-static void write_line(const std::vector<T>& data, std::ostream& out)
-{
-    std::copy(std::cbegin(data), std::prev(std::cend(data)), std::ostream_iterator<T> {out, " "});
-    out << data.back() << '\n';
-}
-
 void ConditionalRandomForestFilter::prepare_for_registration(const SampleList& samples) const
 {
-    std::vector<std::string> data_header {};
-    data_header.reserve(measures_.size() - num_chooser_measures_);
-    std::transform(std::cbegin(measures_), std::prev(std::cend(measures_), num_chooser_measures_), std::back_inserter(data_header),
-                   [] (const auto& measure) { return measure.name(); });
-    data_header.push_back("TP");
-    const auto num_forests = forest_paths_.size();
-    data_.resize(num_forests);
-    for (std::size_t forest_idx {0}; forest_idx < num_forests; ++forest_idx) {
-        data_[forest_idx].reserve(samples.size());
-        for (const auto& sample : samples) {
-            auto data_path = temp_dir_;
-            Path fname {"octopus_ranger_temp_forest_data_" + std::to_string(forest_idx) + "_" + sample + ".dat"};
-            data_path /= fname;
-            data_[forest_idx].emplace_back(data_path.string(), data_path);
-            write_line(data_header, data_[forest_idx].back().handle);
-        }
-    }
-    data_buffer_.resize(num_forests);
-    for (auto& buffer : data_buffer_) buffer.resize(samples.size());
+    data_.resize(forest_paths_.size());
+    for (auto& forest_data : data_) forest_data.resize(samples.size());
     choices_.resize(samples.size());
 }
 
@@ -130,9 +103,9 @@ bool is_subnormal(const T x) noexcept
 }
 
 template <typename T>
-double lexical_cast_to_double(const T& value)
+double to_double(const T& value)
 {
-    auto result = boost::lexical_cast<double>(value);
+    auto result = static_cast<double>(value);
     if (is_subnormal(result)) {
         result = 0;
     }
@@ -144,7 +117,7 @@ struct MeasureDoubleVisitor : boost::static_visitor<>
     double result;
     template <typename T> void operator()(const T& value)
     {
-        result = lexical_cast_to_double(value);
+        result = to_double(value);
     }
     template <typename T> void operator()(const boost::optional<T>& value)
     {
@@ -178,33 +151,28 @@ class NanMeasure : public ProgramError
     std::string do_help() const override { return "submit an error report"; }
 };
 
-void check_nan(const std::vector<double>& values)
+template <typename ForwardIt>
+void check_nan(ForwardIt first, ForwardIt last)
 {
-    if (std::any_of(std::cbegin(values), std::cend(values), [] (auto v) { return std::isnan(v); })) {
+    if (std::any_of(first, last, [] (auto v) { return std::isnan(v); })) {
         throw NanMeasure {};
     }
 }
 
-void skip_lines(std::istream& in, int n = 1)
-{
-    for (; n > 0; --n) in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-}
-
 } // namespace
 
 void ConditionalRandomForestFilter::record(const std::size_t call_idx, std::size_t sample_idx, MeasureVector measures) const
 {
     assert(!measures.empty());
     const auto forest_idx = choose_forest(measures);
-    const auto num_forests = static_cast<std::remove_const_t<decltype(forest_idx)>>(data_buffer_.size());
+    const auto num_forests = static_cast<std::remove_const_t<decltype(forest_idx)>>(data_.size());
     if (forest_idx >= 0 && forest_idx < num_forests) {
-        auto& buffer = data_buffer_[forest_idx][sample_idx];
+        auto& rows = data_[forest_idx][sample_idx];
+        const auto row_begin = rows.size();
         std::transform(std::cbegin(measures), std::prev(std::cend(measures), num_chooser_measures_),
-                       std::back_inserter(buffer), cast_to_double);
-        buffer.push_back(0); // dummy TP value
-        check_nan(buffer);
-        write_line(buffer, data_[forest_idx][sample_idx].handle);
-        buffer.clear();
+                       std::back_inserter(rows), cast_to_double);
+        rows.push_back(0); // dummy TP value
+        check_nan(std::next(std::cbegin(rows), row_begin), std::cend(rows));
     } else {
         hard_filtered_record_indices_.push_back(call_idx);
     }
@@ -212,36 +180,31 @@ void ConditionalRandomForestFilter::record(const std::size_t call_idx, std::size
     choices_[sample_idx].push_back(forest_idx);
 }
 
-void ConditionalRandomForestFilter::close_data_files() const
-{
-    for (auto& forest : data_) {
-        for (auto& sample : forest) {
-            sample.handle.close();
-        }
-    }
-}
-
 namespace {
 
-bool read_header(std::ifstream& prediction_file)
+// Ranger stores data column major, one row per sample record
+auto make_ranger_data(const std::vector<std::vector<double>>& sample_rows, std::vector<std::string> variable_names)
 {
-    skip_lines(prediction_file);
-    std::string order;
-    std::getline(prediction_file, order);
-    skip_lines(prediction_file);
-    return order.front() == '1';
+    const auto num_cols = variable_names.size();
+    const auto num_rows = std::accumulate(std::cbegin(sample_rows), std::cend(sample_rows), std::size_t {0},
+                                          [=] (auto curr, const auto& rows) { return curr + rows.size() / num_cols; });
+    std::vector<double> values(num_rows * num_cols);
+    std::size_t row_offset {0};
+    for (const auto& rows : sample_rows) {
+        const auto num_sample_rows = rows.size() / num_cols;
+        for (std::size_t row {0}; row < num_sample_rows; ++row) {
+            for (std::size_t col {0}; col < num_cols; ++col) {
+                values[col * num_rows + row_offset + row] = rows[row * num_cols + col];
+            }
+        }
+        row_offset += num_sample_rows;
+    }
+    return std::make_unique<ranger::DataDouble>(std::move(values), std::move(variable_names), num_rows, num_cols);
 }
 
-static double get_prob_false(std::string& prediction_line, const bool tp_first)
+std::size_t get_false_class_index(const ranger::ForestProbability& forest)
 {
-    using std::cbegin; using std::cend;
-    if (tp_first) {
-        prediction_line.erase(cbegin(prediction_line), std::next(std::find(cbegin(prediction_line), cend(prediction_line), ' ')));
-        prediction_line.erase(std::find(cbegin(prediction_line), cend(prediction_line), ' '), cend(prediction_line));
-    } else {
-        prediction_line.erase(std::find(cbegin(prediction_line), cend(prediction_line), ' '), cend(prediction_line));
-    }
-    return boost::lexical_cast<double>(prediction_line);
+    return forest.getClassValues().front() == 1 ? 1 : 0;
 }
 
 } // namespace
@@ -259,47 +222,40 @@ public:
 
 void ConditionalRandomForestFilter::prepare_for_classification(boost::optional<Log>& log) const
 {
-    close_data_files();
-    const Path ranger_prefix {temp_dir_ / "octopus_ranger_temp"};
-    const Path ranger_prediction_fname {ranger_prefix.string() + ".prediction"};
-    data_buffer_.resize(1);
-    auto& predictions = data_buffer_[0];
-    predictions.resize(num_records_);
+    std::vector<std::string> variable_names {};
+    variable_names.reserve(measures_.size() - num_chooser_measures_ + 1);
+    std::transform(std::cbegin(measures_), std::prev(std::cend(measures_), num_chooser_measures_), std::back_inserter(variable_names),
+                   [] (const auto& measure) { return measure.name(); });
+    variable_names.push_back("TP");
     const auto num_samples = choices_.size();
+    predictions_.assign(num_records_, std::vector<double>(num_samples));
     for (std::size_t forest_idx {0}; forest_idx < forest_paths_.size(); ++forest_idx) {
+        auto& forest_data = data_[forest_idx];
+        if (std::all_of(std::cbegin(forest_data), std::cend(forest_data), [] (const auto& rows) { return rows.empty(); })) {
+            continue;
+        }
+        auto& forest = forests_[forest_idx];
+        try {
+            forest->initPredict(forest_paths_[forest_idx].string(), make_ranger_data(forest_data, variable_names), 12, num_threads());
+        } catch (const std::runtime_error& e) {
+            throw MalformedForestFile {forest_paths_[forest_idx]};
+        }
+        forest_data.clear();
+        forest_data.shrink_to_fit();
+        forest->run(false);
+        const auto& forest_predictions = forest->getPredictions().front();
+        const auto false_class_idx = get_false_class_index(*forest);
+        std::size_t row_idx {0};
         for (std::size_t sample_idx {0}; sample_idx < num_samples; ++sample_idx) {
-            auto forest_choice_itr = std::find(std::cbegin(choices_[sample_idx]), std::cend(choices_[sample_idx]), forest_idx);
-            if (forest_choice_itr != std::cend(choices_[sample_idx])) {
-                const auto& file = data_[forest_idx][sample_idx];
-                std::vector<std::string> tmp {}, cat_vars {};
-                auto& forest = forests_[forest_idx];
-                try {
-                    forest->initCpp("TP", ranger::MemoryMode::MEM_DOUBLE, file.path.string(), 0, ranger_prefix.string(),
-                                    1000, nullptr, 12, 1, forest_paths_[forest_idx].string(), ranger::ImportanceMode::IMP_GINI, 1, "",
-                                    tmp, "", true, cat_vars, false, ranger::SplitRule::LOGRANK, "", false, 1.0,
-                                    ranger::DEFAULT_ALPHA, ranger::DEFAULT_MINPROP, false,
-                                    ranger::PredictionType::RESPONSE, ranger::DEFAULT_NUM_RANDOM_SPLITS);
-                } catch (const std::runtime_error& e) {
-                    throw MalformedForestFile {forest_paths_[forest_idx]};
-                }
-                forest->run(false);
-                forest->writePredictionFile();
-                std::ifstream prediction_file {ranger_prediction_fname.string()};
-                const auto tp_first = read_header(prediction_file);
-                std::string line;
-                while (std::getline(prediction_file, line)) {
-                    if (!line.empty()) {
-                        const auto record_idx = std::distance(std::cbegin(choices_[sample_idx]), forest_choice_itr);
-                        predictions[record_idx].push_back(get_prob_false(line, tp_first));
-                        assert(forest_choice_itr != std::cend(choices_[sample_idx]));
-                        forest_choice_itr = std::find(std::next(forest_choice_itr), std::cend(choices_[sample_idx]), forest_idx);
-                    }
+            for (std::size_t record_idx {0}; record_idx < choices_[sample_idx].size(); ++record_idx) {
+                const auto choice = choices_[sample_idx][record_idx];
+                if (choice >= 0 && static_cast<std::size_t>(choice) == forest_idx) {
+                    assert(row_idx < forest_predictions.size());
+                    predictions_[record_idx][sample_idx] = forest_predictions[row_idx++][false_class_idx];
                 }
-                boost::filesystem::remove(file.path);
             }
         }
     }
-    boost::filesystem::remove(ranger_prediction_fname);
     data_.clear();
     data_.shrink_to_fit();
     choices_.clear();
@@ -323,9 +279,8 @@ VariantCallFilter::Classification ConditionalRandomForestFilter::classify(const
 {
     Classification result {};
     if (hard_filtered_.empty() || !hard_filtered_[call_idx]) {
-        const auto& predictions = data_buffer_[0];
-        assert(call_idx < predictions.size() && sample_idx < predictions[call_idx].size());
-        const auto prob_false = predictions[call_idx][sample_idx];
+        assert(call_idx < predictions_.size() && sample_idx < predictions_[call_idx].size());
+        const auto prob_false = predictions_[call_idx][sample_idx];
         if (prob_false < 0.5) {
             result.category = Classification::Category::unfiltered;
         } else {
@@ -20,11 +20,14 @@ DoublePassVariantCallFilter::DoublePassVariantCallFilter(FacetFactory facet_fact
                                                          std::vector<MeasureWrapper> measures,
                                                          OutputOptions output_config,
                                                          ConcurrencyPolicy threading,
+                                                         boost::filesystem::path temp_directory,
                                                          boost::optional<ProgressMeter&> progress)
 : VariantCallFilter {std::move(facet_factory), std::move(measures), std::move(output_config), threading}
 , info_log_ {logging::InfoLogger {}}
 , progress_ {progress}
 , current_contig_ {}
+, annotate_measures_ {output_config.annotate_measures}
+, measure_buffer_ {std::move(temp_directory)}
 {}
 
 void DoublePassVariantCallFilter::filter(const VcfReader& source, VcfWriter& dest, const SampleList& samples) const
@@ -92,6 +95,7 @@ void DoublePassVariantCallFilter::record(const VcfRecord& call, const MeasureVec
     for (std::size_t sample_idx {0}; sample_idx < samples.size(); ++sample_idx) {
         this->record(record_idx, sample_idx, get_sample_values(measures, measures_, sample_idx));
     }
+    if (annotate_measures_) measure_buffer_.push_back(measures);
     log_progress(mapped_region(call));
 }
 
@@ -137,11 +141,35 @@ void DoublePassVariantCallFilter::filter(const VcfRecord& call, const std::size_
                                          VcfWriter& dest) const
 {
     const auto sample_classifications = classify(call_idx, samples);
-    const auto call_classification = merge(sample_classifications);
-    write(call, call_classification, samples, sample_classifications, dest);
+    if (annotate_measures_) {
+        const auto measures = measure_buffer_.pop_front();
+        const auto call_classification = merge(sample_classifications, measures);
+        auto annotation_builder = VcfRecord::Builder {call};
+        annotate(annotation_builder, measures);
+        const auto annotated_call = annotation_builder.build_once();
+        write(annotated_call, call_classification, samples, sample_classifications, dest);
+    } else {
+        const auto call_classification = merge(sample_classifications);
+        write(call, call_classification, samples, sample_classifications, dest);
+    }
     log_progress(mapped_region(call));
 }
 
+boost::optional<VcfRecord>
+DoublePassVariantCallFilter::make_filtered_call(const VcfRecord& call, const MeasureVector& measures,
+                                                const SampleList& samples, const ClassificationList& sample_classifications) const
+{
+    if (annotate_measures_) {
+        const auto call_classification = merge(sample_classifications, measures);
+        auto annotation_builder = VcfRecord::Builder {call};
+        annotate(annotation_builder, measures);
+        const auto annotated_call = annotation_builder.build_once();
+        return make_filtered_call(annotated_call, call_classification, samples, sample_classifications);
+    } else {
+        return make_filtered_call(call, merge(sample_classifications), samples, sample_classifications);
+    }
+}
+
 static auto expand_lhs_to_zero(const GenomicRegion& region)
 {
     return GenomicRegion {region.contig_name(), 0, region.end()};
@@ -8,11 +8,13 @@
 #include <cstddef>
 
 #include <boost/optional.hpp>
+#include <boost/filesystem/path.hpp>
 
 #include "logging/progress_meter.hpp"
 #include "basics/genomic_region.hpp"
 #include "logging/logging.hpp"
 #include "variant_call_filter.hpp"
+#include "measure_replay_buffer.hpp"
 
 namespace octopus { namespace csr {
 
@@ -25,6 +27,7 @@ public:
                                 std::vector<MeasureWrapper> measures,
                                 OutputOptions output_config,
                                 ConcurrencyPolicy threading,
+                                boost::filesystem::path temp_directory,
                                 boost::optional<ProgressMeter&> progress);
     
     DoublePassVariantCallFilter(const DoublePassVariantCallFilter&)            = delete;
@@ -37,10 +40,17 @@ public:
 protected:
     using Log = logging::InfoLogger;
     
+    using VariantCallFilter::make_filtered_call;
+    boost::optional<VcfRecord>
+    make_filtered_call(const VcfRecord& call, const MeasureVector& measures,
+                       const SampleList& samples, const ClassificationList& sample_classifications) const;
+    
 private:
     mutable boost::optional<Log> info_log_;
     mutable boost::optional<ProgressMeter&> progress_;
     mutable boost::optional<GenomicRegion::ContigName> current_contig_;
+    bool annotate_measures_;
+    mutable MeasureReplayBuffer measure_buffer_;
     
     virtual void log_registration_pass(Log& log) const;
     virtual void prepare_for_registration(const SampleList& samples) const {};
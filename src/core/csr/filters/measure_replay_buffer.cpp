@@ -0,0 +1,271 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "measure_replay_buffer.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <stdexcept>
+#include <cassert>
+
+#include <boost/variant.hpp>
+#include <boost/mpl/at.hpp>
+#include <boost/mpl/size.hpp>
+#include <boost/filesystem/operations.hpp>
+
+namespace octopus { namespace csr {
+
+namespace {
+
+// Encoding
+
+template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+void write(const T value, std::string& out)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T> void write(const boost::optional<T>& value, std::string& out);
+template <typename T> void write(const std::vector<T>& values, std::string& out);
+
+void write(const std::vector<bool>& values, std::string& out)
+{
+    write(static_cast<std::uint64_t>(values.size()), out);
+    for (const bool value : values) write(value, out);
+}
+
+void write(const boost::any&, std::string&)
+{
+    throw std::runtime_error {"MeasureReplayBuffer: any type not supported"};
+}
+
+template <typename T>
+void write(const boost::optional<T>& value, std::string& out)
+{
+    write(static_cast<bool>(value), out);
+    if (value) write(*value, out);
+}
+
+template <typename T>
+void write(const std::vector<T>& values, std::string& out)
+{
+    write(static_cast<std::uint64_t>(values.size()), out);
+    for (const auto& value : values) write(value, out);
+}
+
+struct MeasureWriteVisitor : public boost::static_visitor<>
+{
+    MeasureWriteVisitor(std::string& out) : out_ {out} {}
+    template <typename T> void operator()(const T& value) const { write(value, out_); }
+private:
+    std::string& out_;
+};
+
+void write(const Measure::ResultType& value, std::string& out)
+{
+    write(static_cast<std::int8_t>(value.which()), out);
+    boost::apply_visitor(MeasureWriteVisitor {out}, value);
+}
+
+// Decoding
+
+template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+void read(const char*& in, T& value)
+{
+    std::memcpy(&value, in, sizeof(T));
+    in += sizeof(T);
+}
+
+template <typename T> void read(const char*& in, boost::optional<T>& value);
+template <typename T> void read(const char*& in, std::vector<T>& values);
+
+void read(const char*& in, std::vector<bool>& values)
+{
+    std::uint64_t size;
+    read(in, size);
+    values.resize(size);
+    for (std::size_t i {0}; i < size; ++i) {
+        bool value;
+        read(in, value);
+        values[i] = value;
+    }
+}
+
+void read(const char*&, boost::any&)
+{
+    throw std::runtime_error {"MeasureReplayBuffer: any type not supported"};
+}
+
+template <typename T>
+void read(const char*& in, boost::optional<T>& value)
+{
+    bool is_set;
+    read(in, is_set);
+    if (is_set) {
+        T tmp {};
+        read(in, tmp);
+        value = std::move(tmp);
+    } else {
+        value = boost::none;
+    }
+}
+
+template <typename T>
+void read(const char*& in, std::vector<T>& values)
+{
+    std::uint64_t size;
+    read(in, size);
+    values.resize(size);
+    for (auto& value : values) read(in, value);
+}
+
+using MeasureTypes = Measure::ResultType::types;
+static constexpr int numMeasureTypes {boost::mpl::size<MeasureTypes>::value};
+
+template <int I, int N = numMeasureTypes>
+struct MeasureValueReader
+{
+    static Measure::ResultType apply(const int which, const char*& in)
+    {
+        if (which == I) {
+            typename boost::mpl::at_c<MeasureTypes, I>::type result {};
+            read(in, result);
+            return result;
+        }
+        return MeasureValueReader<I + 1, N>::apply(which, in);
+    }
+};
+
+template <int N>
+struct MeasureValueReader<N, N>
+{
+    static Measure::ResultType apply(const int, const char*&)
+    {
+        throw std::runtime_error {"MeasureReplayBuffer: bad measure type"};
+    }
+};
+
+void read(const char*& in, Measure::ResultType& value)
+{
+    std::int8_t which;
+    read(in, which);
+    value = MeasureValueReader<0>::apply(which, in);
+}
+
+void encode(const MeasureReplayBuffer::MeasureVector& measures, std::string& out)
+{
+    const auto size_pos = out.size();
+    write(std::uint64_t {0}, out);
+    write(static_cast<std::uint64_t>(measures.size()), out);
+    for (const auto& measure : measures) write(measure, out);
+    const std::uint64_t num_bytes {out.size() - size_pos - sizeof(std::uint64_t)};
+    std::memcpy(&out[size_pos], &num_bytes, sizeof(std::uint64_t));
+}
+
+MeasureReplayBuffer::MeasureVector decode(const char*& in)
+{
+    std::uint64_t num_measures;
+    read(in, num_measures);
+    MeasureReplayBuffer::MeasureVector result(num_measures);
+    for (auto& measure : result) read(in, measure);
+    return result;
+}
+
+} // namespace
+
+MeasureReplayBuffer::MeasureReplayBuffer(Path spill_directory, std::size_t max_memory_footprint)
+: spill_directory_ {std::move(spill_directory)}
+, max_memory_footprint_ {max_memory_footprint}
+, buffer_ {}
+, record_buffer_ {}
+, buffer_pos_ {0}
+, spill_path_ {}
+, spill_out_ {}
+, spill_in_ {}
+, size_ {0}
+, replaying_ {false}
+{}
+
+MeasureReplayBuffer::~MeasureReplayBuffer()
+{
+    if (spill_path_) {
+        spill_out_.close();
+        spill_in_.close();
+        boost::system::error_code ec {};
+        boost::filesystem::remove(*spill_path_, ec);
+    }
+}
+
+bool MeasureReplayBuffer::empty() const noexcept
+{
+    return size_ == 0;
+}
+
+std::size_t MeasureReplayBuffer::size() const noexcept
+{
+    return size_;
+}
+
+void MeasureReplayBuffer::push_back(const MeasureVector& measures)
+{
+    assert(!replaying_);
+    encode(measures, buffer_);
+    ++size_;
+    if (buffer_.size() > max_memory_footprint_) spill();
+}
+
+MeasureReplayBuffer::MeasureVector MeasureReplayBuffer::pop_front()
+{
+    assert(!empty());
+    if (!replaying_) start_replay();
+    --size_;
+    if (spill_path_) {
+        std::uint64_t num_bytes;
+        spill_in_.read(reinterpret_cast<char*>(&num_bytes), sizeof(std::uint64_t));
+        record_buffer_.resize(num_bytes);
+        spill_in_.read(&record_buffer_[0], num_bytes);
+        if (!spill_in_) throw std::runtime_error {"MeasureReplayBuffer: failed to read spill file"};
+        const char* in {record_buffer_.data()};
+        return decode(in);
+    } else {
+        const char* in {buffer_.data() + buffer_pos_ + sizeof(std::uint64_t)};
+        auto result = decode(in);
+        buffer_pos_ = in - buffer_.data();
+        if (empty()) {
+            buffer_.clear();
+            buffer_.shrink_to_fit();
+            buffer_pos_ = 0;
+            replaying_ = false;
+        }
+        return result;
+    }
+}
+
+// private methods
+
+void MeasureReplayBuffer::spill()
+{
+    if (!spill_path_) {
+        spill_path_ = spill_directory_ / boost::filesystem::unique_path("octopus-measures-%%%%-%%%%-%%%%.bin");
+        spill_out_.open(spill_path_->string(), std::ios::binary);
+        if (!spill_out_) throw std::runtime_error {"MeasureReplayBuffer: failed to open spill file " + spill_path_->string()};
+    }
+    spill_out_.write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+}
+
+void MeasureReplayBuffer::start_replay()
+{
+    if (spill_path_) {
+        spill();
+        buffer_.shrink_to_fit();
+        spill_out_.close();
+        spill_in_.open(spill_path_->string(), std::ios::binary);
+        if (!spill_in_) throw std::runtime_error {"MeasureReplayBuffer: failed to open spill file " + spill_path_->string()};
+    }
+    replaying_ = true;
+}
+
+} // namespace csr
+} // namespace octopus
@@ -0,0 +1,65 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef measure_replay_buffer_hpp
+#define measure_replay_buffer_hpp
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <fstream>
+
+#include <boost/optional.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "../measures/measure.hpp"
+
+namespace octopus { namespace csr {
+
+/*
+ MeasureReplayBuffer stores measure vectors in a compact binary encoding so they can be
+ replayed, in the order they were pushed, on a later pass. Encoded vectors are kept in memory
+ until max_memory_footprint bytes are used, after which they are spilled to a temporary file in spill_directory.
+
+ All push_back calls must precede the first pop_front.
+ */
+class MeasureReplayBuffer
+{
+public:
+    using MeasureVector = std::vector<Measure::ResultType>;
+    using Path          = boost::filesystem::path;
+
+    MeasureReplayBuffer(Path spill_directory = "/tmp", std::size_t max_memory_footprint = 500'000'000);
+
+    MeasureReplayBuffer(const MeasureReplayBuffer&)            = delete;
+    MeasureReplayBuffer& operator=(const MeasureReplayBuffer&) = delete;
+    MeasureReplayBuffer(MeasureReplayBuffer&&)                 = default;
+    MeasureReplayBuffer& operator=(MeasureReplayBuffer&&)      = default;
+
+    ~MeasureReplayBuffer();
+
+    bool empty() const noexcept;
+    std::size_t size() const noexcept;
+
+    void push_back(const MeasureVector& measures);
+    MeasureVector pop_front();
+
+private:
+    Path spill_directory_;
+    std::size_t max_memory_footprint_;
+    std::string buffer_, record_buffer_;
+    std::size_t buffer_pos_;
+    boost::optional<Path> spill_path_;
+    std::ofstream spill_out_;
+    std::ifstream spill_in_;
+    std::size_t size_;
+    bool replaying_;
+
+    void spill();
+    void start_replay();
+};
+
+} // namespace csr
+} // namespace octopus
+
+#endif
@@ -7,15 +7,13 @@
 #include <iterator>
 #include <algorithm>
 #include <numeric>
-#include <iostream>
 #include <cassert>
 #include <cmath>
-#include <limits>
 
 #include <boost/variant.hpp>
-#include <boost/lexical_cast.hpp>
+#include <boost/range/combine.hpp>
 
-#include "ranger/ForestProbability.h"
+#include "ranger/DataDouble.h"
 
 #include "basics/phred.hpp"
 
@@ -25,14 +23,18 @@ RandomForestFilter::RandomForestFilter(FacetFactory facet_factory,
                                        std::vector<MeasureWrapper> measures,
                                        OutputOptions output_config,
                                        ConcurrencyPolicy threading,
-                                       Path ranger_forest, Path temp_directory,
+                                       Path ranger_forest,
+                                       Path temp_directory,
                                        boost::optional<ProgressMeter&> progress)
-: DoublePassVariantCallFilter {std::move(facet_factory), std::move(measures), std::move(output_config), threading, progress}
+: DoublePassVariantCallFilter {std::move(facet_factory), std::move(measures), std::move(output_config), threading,
+                               std::move(temp_directory), progress}
 , forest_ {std::make_unique<ranger::ForestProbability>()}
 , ranger_forest_ {std::move(ranger_forest)}
-, temp_dir_ {std::move(temp_directory)}
+, data_ {}
 , num_records_ {0}
-, data_buffer_ {}
+, predictions_ {}
+, idle_forests_ {}
+, idle_forests_mutex_ {}
 {}
 
 const std::string RandomForestFilter::call_qual_name_ = "RFQUAL";
@@ -48,34 +50,9 @@ void RandomForestFilter::annotate(VcfHeader::Builder& header) const
     header.add_filter("RF", "Random Forest filtered");
 }
 
-namespace {
-
-template <typename T>
-static void write_line(const std::vector<T>& data, std::ostream& out)
-{
-    std::copy(std::cbegin(data), std::prev(std::cend(data)), std::ostream_iterator<T> {out, " "});
-    out << data.back() << '\n';
-}
-
-} // namespace
-
 void RandomForestFilter::prepare_for_registration(const SampleList& samples) const
 {
-    std::vector<std::string> data_header {};
-    data_header.reserve(measures_.size());
-    for (const auto& measure : measures_) {
-        data_header.push_back(measure.name());
-    }
-    data_header.push_back("TP");
-    data_.reserve(samples.size());
-    for (const auto& sample : samples) {
-        auto data_path = temp_dir_;
-        Path fname {"octopus_ranger_temp_forest_data_" + sample + ".dat"};
-        data_path /= fname;
-        data_.emplace_back(data_path.string(), data_path);
-        write_line(data_header, data_.back().handle);
-    }
-    data_buffer_.resize(samples.size());
+    data_.resize(samples.size());
 }
 
 namespace {
@@ -87,9 +64,9 @@ bool is_subnormal(const T x) noexcept
 }
 
 template <typename T>
-double lexical_cast_to_double(const T& value)
+double to_double(const T& value)
 {
-    auto result = boost::lexical_cast<double>(value);
+    auto result = static_cast<double>(value);
     if (is_subnormal(result)) {
         result = 0;
     }
@@ -101,7 +78,7 @@ struct MeasureDoubleVisitor : boost::static_visitor<>
     double result;
     template <typename T> void operator()(const T& value)
     {
-        result = lexical_cast_to_double(value);
+        result = to_double(value);
     }
     template <typename T> void operator()(const boost::optional<T>& value)
     {
@@ -128,83 +105,125 @@ auto cast_to_double(const Measure::ResultType& value)
     return vis.result;
 }
 
-void skip_lines(std::istream& in, int n = 1)
+template <typename MeasureVector>
+void append_row(const MeasureVector& measures, std::vector<double>& rows)
 {
-    for (; n > 0; --n) in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    assert(!measures.empty());
+    std::transform(std::cbegin(measures), std::cend(measures), std::back_inserter(rows), cast_to_double);
+    rows.push_back(0); // dummy TP value
 }
 
 } // namespace
 
 void RandomForestFilter::record(const std::size_t call_idx, std::size_t sample_idx, MeasureVector measures) const
 {
-    assert(!measures.empty());
-    std::transform(std::cbegin(measures), std::cend(measures), std::back_inserter(data_buffer_[sample_idx]), cast_to_double);
-    data_buffer_[sample_idx].push_back(0); // dummy TP value
-    write_line(data_buffer_[sample_idx], data_[sample_idx].handle);
-    data_buffer_[sample_idx].clear();
+    append_row(measures, data_[sample_idx]);
     if (call_idx >= num_records_) ++num_records_;
 }
 
 namespace {
 
-bool read_header(std::ifstream& prediction_file)
+// Ranger stores data column major, one row per sample record
+auto make_ranger_data(const std::vector<std::vector<double>>& sample_rows, std::vector<std::string> variable_names)
 {
-    skip_lines(prediction_file);
-    std::string order;
-    std::getline(prediction_file, order);
-    skip_lines(prediction_file);
-    return order.front() == '1';
+    const auto num_cols = variable_names.size();
+    const auto num_rows = std::accumulate(std::cbegin(sample_rows), std::cend(sample_rows), std::size_t {0},
+                                          [=] (auto curr, const auto& rows) { return curr + rows.size() / num_cols; });
+    std::vector<double> values(num_rows * num_cols);
+    std::size_t row_offset {0};
+    for (const auto& rows : sample_rows) {
+        const auto num_sample_rows = rows.size() / num_cols;
+        for (std::size_t row {0}; row < num_sample_rows; ++row) {
+            for (std::size_t col {0}; col < num_cols; ++col) {
+                values[col * num_rows + row_offset + row] = rows[row * num_cols + col];
+            }
+        }
+        row_offset += num_sample_rows;
+    }
+    return std::make_unique<ranger::DataDouble>(std::move(values), std::move(variable_names), num_rows, num_cols);
 }
 
-static double get_prob_false(std::string& prediction_line, const bool tp_first)
+std::size_t get_false_class_index(const ranger::ForestProbability& forest)
 {
-    using std::cbegin; using std::cend;
-    if (tp_first) {
-        prediction_line.erase(cbegin(prediction_line), std::next(std::find(cbegin(prediction_line), cend(prediction_line), ' ')));
-        prediction_line.erase(std::find(cbegin(prediction_line), cend(prediction_line), ' '), cend(prediction_line));
-    } else {
-        prediction_line.erase(std::find(cbegin(prediction_line), cend(prediction_line), ' '), cend(prediction_line));
+    return forest.getClassValues().front() == 1 ? 1 : 0;
+}
+
+// Ranger predicts one row per sample record, this returns the false class probability of each sample for each record
+auto get_false_probabilities(const ranger::ForestProbability& forest, const std::size_t num_samples, const std::size_t num_records)
+{
+    const auto& forest_predictions = forest.getPredictions().front();
+    assert(forest_predictions.size() == num_samples * num_records);
+    const auto false_class_idx = get_false_class_index(forest);
+    std::vector<std::vector<double>> result(num_records, std::vector<double>(num_samples));
+    for (std::size_t sample_idx {0}; sample_idx < num_samples; ++sample_idx) {
+        for (std::size_t record_idx {0}; record_idx < num_records; ++record_idx) {
+            result[record_idx][sample_idx] = forest_predictions[sample_idx * num_records + record_idx][false_class_idx];
+        }
     }
-    return boost::lexical_cast<double>(prediction_line);
+    return result;
 }
 
 } // namespace
 
+std::vector<std::string> RandomForestFilter::get_variable_names() const
+{
+    std::vector<std::string> result {};
+    result.reserve(measures_.size() + 1);
+    for (const auto& measure : measures_) {
+        result.push_back(measure.name());
+    }
+    result.push_back("TP");
+    return result;
+}
+
 void RandomForestFilter::prepare_for_classification(boost::optional<Log>& log) const
 {
-    const Path ranger_prefix {temp_dir_ / "octopus_ranger_temp"};
-    const Path ranger_prediction_fname {ranger_prefix.string() + ".prediction"};
-    data_buffer_.resize(num_records_);
-    for (auto& file : data_) {
-        file.handle.close();
-        std::vector<std::string> tmp {}, cat_vars {};
-        forest_->initCpp("TP", ranger::MemoryMode::MEM_DOUBLE, file.path.string(), 0, ranger_prefix.string(),
-                         1000, nullptr, 12, 1, ranger_forest_.string(), ranger::ImportanceMode::IMP_GINI, 1, "",
-                         tmp, "", true, cat_vars, false, ranger::SplitRule::LOGRANK, "", false, 1.0,
-                         ranger::DEFAULT_ALPHA, ranger::DEFAULT_MINPROP, false,
-                         ranger::PredictionType::RESPONSE, ranger::DEFAULT_NUM_RANDOM_SPLITS);
+    const auto num_samples = data_.size();
+    predictions_.assign(num_records_, std::vector<double>(num_samples));
+    if (num_records_ > 0) {
+        forest_->initPredict(ranger_forest_.string(), make_ranger_data(data_, get_variable_names()), 12, num_threads());
+        data_.clear();
+        data_.shrink_to_fit();
         forest_->run(false);
-        forest_->writePredictionFile();
-        std::ifstream prediction_file {ranger_prediction_fname.string()};
-        const auto tp_first = read_header(prediction_file);
-        std::string line;
-        std::size_t record_idx {0};
-        while (std::getline(prediction_file, line)) {
-            if (!line.empty()) {
-                data_buffer_[record_idx++].push_back(get_prob_false(line, tp_first));
-            }
+        predictions_ = get_false_probabilities(*forest_, num_samples, num_records_);
+    }
+}
+
+std::vector<std::vector<double>>
+RandomForestFilter::predict(const std::vector<std::vector<double>>& data, const std::size_t num_records) const
+{
+    assert(num_records > 0);
+    std::unique_ptr<ranger::ForestProbability> forest {};
+    {
+        std::lock_guard<std::mutex> lock {idle_forests_mutex_};
+        if (!idle_forests_.empty()) {
+            forest = std::move(idle_forests_.back());
+            idle_forests_.pop_back();
         }
-        boost::filesystem::remove(file.path);
     }
-    boost::filesystem::remove(ranger_prediction_fname);
-    data_.clear();
-    data_.shrink_to_fit();
+    auto ranger_data = make_ranger_data(data, get_variable_names());
+    if (forest) {
+        forest->setPredictionData(std::move(ranger_data));
+    } else {
+        // Blocks are small and already run concurrently, so each forest predicts with a single thread
+        forest = std::make_unique<ranger::ForestProbability>();
+        forest->initPredict(ranger_forest_.string(), std::move(ranger_data), 12, 1);
+    }
+    forest->run(false);
+    auto result = get_false_probabilities(*forest, data.size(), num_records);
+    std::lock_guard<std::mutex> lock {idle_forests_mutex_};
+    idle_forests_.push_back(std::move(forest));
+    return result;
 }
 
 VariantCallFilter::Classification RandomForestFilter::classify(const std::size_t call_idx, std::size_t sample_idx) const
 {
-    assert(call_idx < data_buffer_.size() && sample_idx < data_buffer_[call_idx].size());
-    const auto prob_false = data_buffer_[call_idx][sample_idx];
+    assert(call_idx < predictions_.size() && sample_idx < predictions_[call_idx].size());
+    return make_classification(predictions_[call_idx][sample_idx]);
+}
+
+VariantCallFilter::Classification RandomForestFilter::make_classification(const double prob_false) const
+{
     Classification result {};
     if (prob_false < 0.5) {
         result.category = Classification::Category::unfiltered;
@@ -216,5 +235,37 @@ VariantCallFilter::Classification RandomForestFilter::classify(const std::size_t
     return result;
 }
 
+void RandomForestFilter::filter_blocks(const std::vector<CallBlock>& blocks, const std::vector<MeasureBlock>& measures,
+                                       const SampleList& samples, std::deque<VcfRecord>& dest) const
+{
+    assert(measures.size() == blocks.size());
+    // The rows and predictions belong to this call, not the filter, so several workers can filter blocks at once
+    std::vector<std::vector<double>> data(samples.size());
+    std::size_t num_records {0};
+    for (const auto& block_measures : measures) {
+        for (const auto& call_measures : block_measures) {
+            for (std::size_t sample_idx {0}; sample_idx < samples.size(); ++sample_idx) {
+                append_row(get_sample_values(call_measures, measures_, sample_idx), data[sample_idx]);
+            }
+            ++num_records;
+        }
+    }
+    if (num_records == 0) return;
+    const auto predictions = predict(data, num_records);
+    std::size_t record_idx {0};
+    for (auto block_tup : boost::combine(blocks, measures)) {
+        assert(block_tup.get<1>().size() == block_tup.get<0>().size());
+        for (auto call_tup : boost::combine(block_tup.get<0>(), block_tup.get<1>())) {
+            ClassificationList sample_classifications(samples.size());
+            for (std::size_t sample_idx {0}; sample_idx < samples.size(); ++sample_idx) {
+                sample_classifications[sample_idx] = make_classification(predictions[record_idx][sample_idx]);
+            }
+            auto filtered_call = make_filtered_call(call_tup.get<0>(), call_tup.get<1>(), samples, sample_classifications);
+            if (filtered_call) dest.push_back(std::move(*filtered_call));
+            ++record_idx;
+        }
+    }
+}
+
 } // namespace csr
 } // namespace octopus
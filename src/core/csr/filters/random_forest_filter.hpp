@@ -5,14 +5,15 @@
 #define random_forest_filter_hpp
 
 #include <vector>
+#include <string>
 #include <cstddef>
 #include <memory>
-#include <fstream>
+#include <mutex>
 
 #include <boost/optional.hpp>
 #include <boost/filesystem.hpp>
 
-#include "ranger/Forest.h"
+#include "ranger/ForestProbability.h"
 
 #include "double_pass_variant_call_filter.hpp"
 
@@ -35,35 +36,41 @@ public:
     
     RandomForestFilter(const RandomForestFilter&)            = delete;
     RandomForestFilter& operator=(const RandomForestFilter&) = delete;
-    RandomForestFilter(RandomForestFilter&&)                 = default;
-    RandomForestFilter& operator=(RandomForestFilter&&)      = default;
+    RandomForestFilter(RandomForestFilter&&)                 = delete;
+    RandomForestFilter& operator=(RandomForestFilter&&)      = delete;
     
     virtual ~RandomForestFilter() override = default;
+    
+    // Each record is predicted independently, so the calls of a block can be classified on their own
+    bool is_block_local() const noexcept override { return true; }
 
 private:
-    struct File
-    {
-        std::ofstream handle;
-        Path path;
-        template <typename F, typename P>
-        File(F&& handle, P&& path) : handle {std::forward<F>(handle)}, path {std::forward<P>(path)} {};
-    };
+    using ForestPool = std::vector<std::unique_ptr<ranger::ForestProbability>>;
     
-    std::unique_ptr<ranger::Forest> forest_;
-    Path ranger_forest_, temp_dir_;
+    std::unique_ptr<ranger::ForestProbability> forest_;
+    Path ranger_forest_;
     
-    mutable std::vector<File> data_;
+    mutable std::vector<std::vector<double>> data_;
     mutable std::size_t num_records_;
-    mutable std::vector<std::vector<double>> data_buffer_;
+    mutable std::vector<std::vector<double>> predictions_;
+    
+    // Loaded forests not currently predicting a block
+    mutable ForestPool idle_forests_;
+    mutable std::mutex idle_forests_mutex_;
     
     const static std::string call_qual_name_;
     
+    std::vector<std::string> get_variable_names() const;
+    std::vector<std::vector<double>> predict(const std::vector<std::vector<double>>& data, std::size_t num_records) const;
+    Classification make_classification(double prob_false) const;
     boost::optional<std::string> genotype_quality_name() const override;
     void annotate(VcfHeader::Builder& header) const override;
     void prepare_for_registration(const SampleList& samples) const override;
     void record(std::size_t call_idx, std::size_t sample_idx, MeasureVector measures) const override;
     void prepare_for_classification(boost::optional<Log>& log) const override;
     Classification classify(std::size_t call_idx, std::size_t sample_idx) const override;
+    void filter_blocks(const std::vector<CallBlock>& blocks, const std::vector<MeasureBlock>& measures,
+                       const SampleList& samples, std::deque<VcfRecord>& dest) const override;
 };
 
 } // namespace csr
@@ -27,7 +27,7 @@ static const auto default_measure_names = utils::split("AC AD AF ARF BQ CC CRF D
 RandomForestFilterFactory::RandomForestFilterFactory()
 : ranger_forests_ {}
 , forest_types_ {}
-, temp_directory_ {}
+, temp_directory_ {"/tmp"}
 {
     measures_ = parse_measures(default_measure_names);
 }
@@ -53,6 +53,12 @@ std::unique_ptr<VariantCallFilterFactory> RandomForestFilterFactory::do_clone()
     return std::make_unique<RandomForestFilterFactory>(*this);
 }
 
+// Only the germline forest filter has a block path, the conditional forest filters still filter the whole call set
+bool RandomForestFilterFactory::do_is_block_local() const noexcept
+{
+    return forest_types_.size() == 1 && forest_types_.front() == ForestType::germline;
+}
+
 std::vector<MeasureWrapper> RandomForestFilterFactory::measures() const
 {
     return measures_;
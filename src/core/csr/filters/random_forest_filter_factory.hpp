@@ -47,6 +47,7 @@ private:
     Path temp_directory_;
     
     std::unique_ptr<VariantCallFilterFactory> do_clone() const override;
+    bool do_is_block_local() const noexcept override;
     std::unique_ptr<VariantCallFilter> do_make(FacetFactory facet_factory,
                                                VariantCallFilter::OutputOptions output_config,
                                                boost::optional<ProgressMeter&> progress,
@@ -73,6 +73,28 @@ void SinglePassVariantCallFilter::filter(const CallBlock& block, const MeasureBl
 }
 
 void SinglePassVariantCallFilter::filter(const VcfRecord& call, const MeasureVector& measures, VcfWriter& dest, const SampleList& samples) const
+{
+    auto filtered_call = filter(call, measures, samples);
+    if (filtered_call) {
+        dest << *filtered_call;
+    }
+    log_progress(mapped_region(call));
+}
+
+void SinglePassVariantCallFilter::filter_block(const CallBlock& block, const MeasureBlock& measures, const SampleList& samples,
+                                               std::deque<VcfRecord>& dest) const
+{
+    assert(measures.size() == block.size());
+    for (auto tup : boost::combine(block, measures)) {
+        auto filtered_call = filter(tup.get<0>(), tup.get<1>(), samples);
+        if (filtered_call) {
+            dest.push_back(std::move(*filtered_call));
+        }
+    }
+}
+
+boost::optional<VcfRecord>
+SinglePassVariantCallFilter::filter(const VcfRecord& call, const MeasureVector& measures, const SampleList& samples) const
 {
     const auto sample_classifications = classify(measures, samples);
     const auto call_classification = merge(sample_classifications, measures);
@@ -80,11 +102,10 @@ void SinglePassVariantCallFilter::filter(const VcfRecord& call, const MeasureVec
         auto annotation_builder = VcfRecord::Builder {call};
         annotate(annotation_builder, measures);
         const auto annotated_call = annotation_builder.build_once();
-        write(annotated_call, call_classification, samples, sample_classifications, dest);
+        return make_filtered_call(annotated_call, call_classification, samples, sample_classifications);
     } else {
-        write(call, call_classification, samples, sample_classifications, dest);
+        return make_filtered_call(call, call_classification, samples, sample_classifications);
     }
-    log_progress(mapped_region(call));
 }
 
 VariantCallFilter::ClassificationList
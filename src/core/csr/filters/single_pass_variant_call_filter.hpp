@@ -5,6 +5,7 @@
 #define single_pass_variant_call_filter_hpp
 
 #include <vector>
+#include <deque>
 
 #include <boost/optional.hpp>
 
@@ -32,6 +33,8 @@ public:
     
     virtual ~SinglePassVariantCallFilter() override = default;
     
+    bool is_block_local() const noexcept override { return true; }
+    
 protected:
     std::vector<std::string> measure_names_;
     
@@ -48,6 +51,9 @@ private:
     void filter(const std::vector<CallBlock>& blocks, VcfWriter& dest, const SampleList& samples) const;
     void filter(const CallBlock& block, const MeasureBlock & measures, VcfWriter& dest, const SampleList& samples) const;
     void filter(const VcfRecord& call, const MeasureVector& measures, VcfWriter& dest, const SampleList& samples) const;
+    void filter_block(const CallBlock& block, const MeasureBlock& measures, const SampleList& samples,
+                      std::deque<VcfRecord>& dest) const override;
+    boost::optional<VcfRecord> filter(const VcfRecord& call, const MeasureVector& measures, const SampleList& samples) const;
     ClassificationList classify(const MeasureVector& call_measures, const SampleList& samples) const;
     void log_progress(const GenomicRegion& region) const;
 };
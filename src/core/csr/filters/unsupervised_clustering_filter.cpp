@@ -14,8 +14,10 @@ UnsupervisedClusteringFilter::UnsupervisedClusteringFilter(FacetFactory facet_fa
                                                            std::vector<MeasureWrapper> measures,
                                                            OutputOptions output_config,
                                                            ConcurrencyPolicy threading,
+                                                           boost::filesystem::path temp_directory,
                                                            boost::optional<ProgressMeter&> progress)
-: DoublePassVariantCallFilter {std::move(facet_factory), std::move(measures), std::move(output_config), threading, progress}
+: DoublePassVariantCallFilter {std::move(facet_factory), std::move(measures), std::move(output_config), threading,
+                               std::move(temp_directory), progress}
 {}
 
 void UnsupervisedClusteringFilter::annotate(VcfHeader::Builder& header) const
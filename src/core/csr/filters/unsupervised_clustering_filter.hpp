@@ -9,6 +9,7 @@
 #include <cstddef>
 
 #include <boost/optional.hpp>
+#include <boost/filesystem/path.hpp>
 
 #include "double_pass_variant_call_filter.hpp"
 
@@ -23,6 +24,7 @@ public:
                                  std::vector<MeasureWrapper> measures,
                                  OutputOptions output_config,
                                  ConcurrencyPolicy threading,
+                                 boost::filesystem::path temp_directory = "/tmp",
                                  boost::optional<ProgressMeter&> progress = boost::none);
     
     UnsupervisedClusteringFilter(const UnsupervisedClusteringFilter&)            = delete;
@@ -36,7 +36,7 @@ std::unique_ptr<VariantCallFilter> UnsupervisedClusteringFilterFactory::do_make(
                                                                                 boost::optional<ProgressMeter&> progress,
                                                                                 VariantCallFilter::ConcurrencyPolicy threading) const
 {
-    return std::make_unique<UnsupervisedClusteringFilter>(std::move(facet_factory), measures_, output_config, threading, progress);
+    return std::make_unique<UnsupervisedClusteringFilter>(std::move(facet_factory), measures_, output_config, threading, "/tmp", progress);
 }
 
 } // namespace csr
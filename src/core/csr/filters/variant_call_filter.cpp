@@ -12,6 +12,8 @@
 #include <limits>
 #include <cmath>
 #include <thread>
+#include <stdexcept>
+#include <cassert>
 
 #include <boost/range/combine.hpp>
 
@@ -26,7 +28,6 @@
 #include "utils/string_utils.hpp"
 #include "utils/genotype_reader.hpp"
 #include "utils/append.hpp"
-#include "utils/parallel_transform.hpp"
 #include "io/variant/vcf_writer.hpp"
 #include "io/variant/vcf_spec.hpp"
 
@@ -84,6 +85,29 @@ void VariantCallFilter::filter(const VcfReader& source, VcfWriter& dest) const
     filter(source, dest, samples);
 }
 
+bool VariantCallFilter::requires_reads() const noexcept
+{
+    return facet_factory_.is_read_dependent(facet_names_);
+}
+
+VcfHeader VariantCallFilter::make_header(const VcfHeader& input_header) const
+{
+    VcfHeader::Builder builder {input_header};
+    if (output_config_.emit_sites_only) {
+        builder.clear_format();
+    }
+    if (output_config_.clear_info) {
+        builder.clear_info();
+    }
+    if (output_config_.annotate_measures) {
+        for (const auto& measure : measures_) {
+            measure.annotate(builder);
+        }
+    }
+    annotate(builder);
+    return builder.build_once();
+}
+
 // protected methods
 
 namespace {
@@ -147,6 +171,11 @@ bool VariantCallFilter::can_measure_multiple_blocks() const noexcept
     return is_multithreaded();
 }
 
+unsigned VariantCallFilter::num_threads() const noexcept
+{
+    return is_multithreaded() ? workers_.size() : 1;
+}
+
 namespace {
 
 GenomicRegion get_phase_set(const VcfRecord& record, const SampleName& sample)
@@ -179,10 +208,20 @@ std::vector<T> copy_each_first(const std::vector<std::pair<T, _>>& items)
     return result;
 }
 
-} // namespace
+auto make_map(const std::vector<std::string>& names, std::vector<FacetWrapper>&& facets)
+{
+    assert(names.size() == facets.size());
+    Measure::FacetMap result {};
+    result.reserve(names.size());
+    for (auto tup : boost::combine(names, std::move(facets))) {
+        result.emplace(tup.get<0>(), std::move(tup.get<1>()));
+    }
+    return result;
+}
 
-VariantCallFilter::CallBlock
-VariantCallFilter::read_next_block(VcfIterator& first, const VcfIterator& last, const SampleList& samples) const
+template <typename ForwardIterator>
+std::vector<VcfRecord>
+read_next_block(ForwardIterator& first, const ForwardIterator& last, const std::vector<SampleName>& samples)
 {
     std::vector<std::pair<VcfRecord, GenomicRegion>> block {};
     for (; first != last; ++first) {
@@ -196,6 +235,31 @@ VariantCallFilter::read_next_block(VcfIterator& first, const VcfIterator& last,
     return copy_each_first(block);
 }
 
+} // namespace
+
+VariantCallFilter::CallBlock
+VariantCallFilter::read_next_block(VcfIterator& first, const VcfIterator& last, const SampleList& samples) const
+{
+    return csr::read_next_block(first, last, samples);
+}
+
+std::deque<VcfRecord>
+VariantCallFilter::filter(const std::deque<VcfRecord>& calls, const SampleList& samples, const ReadMap& reads) const
+{
+    assert(is_block_local());
+    std::vector<CallBlock> blocks {};
+    std::vector<MeasureBlock> measures {};
+    for (auto first = std::cbegin(calls), last = std::cend(calls); first != last;) {
+        auto block = csr::read_next_block(first, last, samples);
+        const auto facets = make_map(facet_names_, facet_factory_.make(facet_names_, block, reads));
+        measures.push_back(measure(block, facets));
+        blocks.push_back(std::move(block));
+    }
+    std::deque<VcfRecord> result {};
+    filter_blocks(blocks, measures, samples, result);
+    return result;
+}
+
 std::vector<VariantCallFilter::CallBlock>
 VariantCallFilter::read_next_blocks(VcfIterator& first, const VcfIterator& last, const SampleList& samples) const
 {
@@ -249,14 +313,15 @@ std::vector<VariantCallFilter::MeasureBlock> VariantCallFilter::measure(const st
     std::vector<MeasureBlock> result {};
     result.reserve(blocks.size());
     if (is_multithreaded()) {
-        const auto facets = compute_facets(blocks);
         if (debug_log_) {
             stream(*debug_log_) << "Measuring " << blocks.size() << " blocks with " << workers_.size() << " threads";
         }
-        transform(std::cbegin(blocks), std::cend(blocks), std::cbegin(facets), std::back_inserter(result),
-                  [this] (const auto& block, const auto& block_facets) {
-                      return this->measure(block, block_facets);
-                  }, workers_);
+        // Each block is measured as soon as its facets are ready so that workers are not left idle waiting for reads
+        result.resize(blocks.size());
+        facet_factory_.make(facet_names_, blocks, workers_,
+                            [&] (const std::size_t block_idx, FacetFactory::FacetBlock facets) {
+                                result[block_idx] = this->measure(blocks[block_idx], make_map(facet_names_, std::move(facets)));
+                            }, max_buffered_blocks());
     } else {
         for (const CallBlock& block : blocks) {
             result.push_back(measure(block));
@@ -277,12 +342,24 @@ void VariantCallFilter::write(const VcfRecord& call, const Classification& class
 void VariantCallFilter::write(const VcfRecord& call, const Classification& classification,
                               const SampleList& samples, const ClassificationList& sample_classifications,
                               VcfWriter& dest) const
+{
+    auto filtered_call = make_filtered_call(call, classification, samples, sample_classifications);
+    if (filtered_call) {
+        dest << *filtered_call;
+    }
+}
+
+boost::optional<VcfRecord>
+VariantCallFilter::make_filtered_call(const VcfRecord& call, const Classification& classification,
+                                      const SampleList& samples, const ClassificationList& sample_classifications) const
 {
     if (!is_hard_filtered(classification)) {
         auto filtered_call = construct_template(call);
         annotate(filtered_call, classification);
         annotate(filtered_call, samples, sample_classifications);
-        dest << filtered_call.build_once();
+        return filtered_call.build_once();
+    } else {
+        return boost::none;
     }
 }
 
@@ -306,22 +383,23 @@ bool VariantCallFilter::is_soft_filtered(const ClassificationList& sample_classi
                        [] (const auto& c) { return c.category != Classification::Category::unfiltered; });
 }
 
-VcfHeader VariantCallFilter::make_header(const VcfReader& source) const
+void VariantCallFilter::filter_block(const CallBlock&, const MeasureBlock&, const SampleList&, std::deque<VcfRecord>&) const
 {
-    VcfHeader::Builder builder {source.fetch_header()};
-    if (output_config_.emit_sites_only) {
-        builder.clear_format();
-    }
-    if (output_config_.clear_info) {
-        builder.clear_info();
-    }
-    if (output_config_.annotate_measures) {
-        for (const auto& measure : measures_) {
-            measure.annotate(builder);
-        }
+    throw std::runtime_error {"VariantCallFilter: filter is not block local"};
+}
+
+void VariantCallFilter::filter_blocks(const std::vector<CallBlock>& blocks, const std::vector<MeasureBlock>& measures,
+                                      const SampleList& samples, std::deque<VcfRecord>& dest) const
+{
+    assert(measures.size() == blocks.size());
+    for (auto tup : boost::combine(blocks, measures)) {
+        filter_block(tup.get<0>(), tup.get<1>(), samples, dest);
     }
-    annotate(builder);
-    return builder.build_once();
+}
+
+VcfHeader VariantCallFilter::make_header(const VcfReader& source) const
+{
+    return make_header(source.fetch_header());
 }
 
 VcfRecord::Builder VariantCallFilter::construct_template(const VcfRecord& call) const
@@ -376,7 +454,7 @@ void VariantCallFilter::annotate(VcfRecord::Builder& call, const SampleName& sam
     const auto quality_name = this->genotype_quality_name();
     if (quality_name) {
         if (status.quality) {
-            call.set_format(sample, *quality_name, utils::to_string(status.quality->score(), 2));
+            call.set_format(sample, *quality_name, VcfRecord::ValueType {status.quality->score(), 2});
         } else {
             call.set_format_missing(sample, *quality_name);
         }
@@ -394,40 +472,18 @@ void VariantCallFilter::annotate(VcfRecord::Builder& call, const Classification
     if (quality_name) {
         call.add_info(*quality_name);
         if (status.quality) {
-            call.set_info(*quality_name, utils::to_string(status.quality->score(), 2));
+            call.set_info(*quality_name, VcfRecord::ValueType {status.quality->score(), 2});
         } else {
             call.set_info_missing(*quality_name);
         }
     }
 }
 
-auto make_map(const std::vector<std::string>& names, std::vector<FacetWrapper>&& facets)
-{
-    assert(names.size() == facets.size());
-    Measure::FacetMap result {};
-    result.reserve(names.size());
-    for (auto tup : boost::combine(names, std::move(facets))) {
-        result.emplace(tup.get<0>(), std::move(tup.get<1>()));
-    }
-    return result;
-}
-
 Measure::FacetMap VariantCallFilter::compute_facets(const CallBlock& block) const
 {
     return make_map(facet_names_, facet_factory_.make(facet_names_, block));
 }
 
-std::vector<Measure::FacetMap> VariantCallFilter::compute_facets(const std::vector<CallBlock>& blocks) const
-{
-    auto facets = facet_factory_.make(facet_names_, blocks, workers_);
-    std::vector<Measure::FacetMap> result {};
-    result.reserve(blocks.size());
-    for (auto& block : facets) {
-        result.push_back(make_map(facet_names_, std::move(block)));
-    }
-    return result;
-}
-
 VariantCallFilter::MeasureBlock VariantCallFilter::measure(const CallBlock& block, const Measure::FacetMap& facets) const
 {
     if (debug_log_ && !block.empty()) {
@@ -502,5 +558,10 @@ unsigned VariantCallFilter::max_concurrent_blocks() const noexcept
     }
 }
 
+unsigned VariantCallFilter::max_buffered_blocks() const noexcept
+{
+    return 4 * workers_.size();
+}
+
 } // namespace csr
 } // namespace octopus
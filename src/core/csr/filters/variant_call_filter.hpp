@@ -5,6 +5,7 @@
 #define variant_call_filter_hpp
 
 #include <vector>
+#include <deque>
 #include <string>
 #include <cstddef>
 #include <type_traits>
@@ -49,6 +50,8 @@ public:
         boost::optional<unsigned> max_threads = boost::none;
     };
     
+    using SampleList = std::vector<SampleName>;
+    
     VariantCallFilter() = delete;
     
     VariantCallFilter(FacetFactory facet_factory,
@@ -65,8 +68,15 @@ public:
     
     void filter(const VcfReader& source, VcfWriter& dest) const;
     
+    // Block local filters classify each call block using only data local to the block, so can filter
+    // calls in memory, e.g. the calls of a single calling task, without a genome-wide pass.
+    virtual bool is_block_local() const noexcept { return false; }
+    bool requires_reads() const noexcept;
+    VcfHeader make_header(const VcfHeader& input_header) const;
+    // reads must contain all reads overlapping calls. Requires is_block_local().
+    std::deque<VcfRecord> filter(const std::deque<VcfRecord>& calls, const SampleList& samples, const ReadMap& reads) const;
+    
 protected:
-    using SampleList    = std::vector<SampleName>;
     using MeasureVector = std::vector<Measure::ResultType>;
     using VcfIterator   = VcfReader::RecordIterator;
     using CallBlock     = std::vector<VcfRecord>;
@@ -88,6 +98,7 @@ protected:
     
     bool can_measure_single_call() const noexcept;
     bool can_measure_multiple_blocks() const noexcept;
+    unsigned num_threads() const noexcept;
     CallBlock read_next_block(VcfIterator& first, const VcfIterator& last, const SampleList& samples) const;
     std::vector<CallBlock> read_next_blocks(VcfIterator& first, const VcfIterator& last, const SampleList& samples) const;
     MeasureVector measure(const VcfRecord& call) const;
@@ -97,6 +108,9 @@ protected:
     void write(const VcfRecord& call, const Classification& classification,
                const SampleList& samples, const ClassificationList& sample_classifications,
                VcfWriter& dest) const;
+    boost::optional<VcfRecord>
+    make_filtered_call(const VcfRecord& call, const Classification& classification,
+                       const SampleList& samples, const ClassificationList& sample_classifications) const;
     void annotate(VcfRecord::Builder& call, const MeasureVector& measures) const;
     
 private:
@@ -111,13 +125,16 @@ private:
     
     virtual void annotate(VcfHeader::Builder& header) const = 0;
     virtual void filter(const VcfReader& source, VcfWriter& dest, const SampleList& samples) const = 0;
+    virtual void filter_block(const CallBlock& block, const MeasureBlock& measures, const SampleList& samples,
+                              std::deque<VcfRecord>& dest) const;
+    virtual void filter_blocks(const std::vector<CallBlock>& blocks, const std::vector<MeasureBlock>& measures,
+                               const SampleList& samples, std::deque<VcfRecord>& dest) const;
     virtual boost::optional<std::string> call_quality_name() const { return boost::none; }
     virtual boost::optional<std::string> genotype_quality_name() const { return boost::none; }
     virtual bool is_soft_filtered(const ClassificationList& sample_classifications, const MeasureVector& measures) const;
     
     VcfHeader make_header(const VcfReader& source) const;
     Measure::FacetMap compute_facets(const CallBlock& block) const;
-    std::vector<Measure::FacetMap> compute_facets(const std::vector<CallBlock>& blocks) const;
     MeasureBlock measure(const CallBlock& block, const Measure::FacetMap& facets) const;
     MeasureVector measure(const VcfRecord& call, const Measure::FacetMap& facets) const;
     VcfRecord::Builder construct_template(const VcfRecord& call) const;
@@ -131,6 +148,7 @@ private:
     void fail(VcfRecord::Builder& call, std::vector<std::string> reasons) const;
     bool is_multithreaded() const noexcept;
     unsigned max_concurrent_blocks() const noexcept;
+    unsigned max_buffered_blocks() const noexcept;
 };
 
 } // namespace csr
@@ -14,6 +14,11 @@ std::unique_ptr<VariantCallFilterFactory> VariantCallFilterFactory::clone() cons
     return do_clone();
 }
 
+bool VariantCallFilterFactory::is_block_local() const noexcept
+{
+    return do_is_block_local();
+}
+
 std::unique_ptr<VariantCallFilter>
 VariantCallFilterFactory::make(const ReferenceGenome& reference,
                                BufferedReadPipe read_pipe,
@@ -22,13 +27,16 @@ VariantCallFilterFactory::make(const ReferenceGenome& reference,
                                boost::optional<Pedigree> pedigree,
                                VariantCallFilter::OutputOptions output_config,
                                boost::optional<ProgressMeter&> progress,
-                               boost::optional<unsigned> max_threads) const
+                               boost::optional<unsigned> max_threads,
+                               std::shared_ptr<const LikelihoodSidecarReader> calling_likelihoods) const
 {
     if (pedigree) {
         FacetFactory facet_factory {std::move(input_header), reference, std::move(read_pipe), std::move(ploidies), std::move(*pedigree)};
+        facet_factory.set_calling_likelihoods(std::move(calling_likelihoods));
         return do_make(std::move(facet_factory), output_config, progress, {max_threads});
     } else {
         FacetFactory facet_factory {std::move(input_header), reference, std::move(read_pipe), std::move(ploidies)};
+        facet_factory.set_calling_likelihoods(std::move(calling_likelihoods));
         return do_make(std::move(facet_factory), output_config, progress, {max_threads});
     }
 }
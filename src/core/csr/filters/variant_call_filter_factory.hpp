@@ -19,6 +19,7 @@ class ReferenceGenome;
 class BufferedReadPipe;
 class PloidyMap;
 class Pedigree;
+class LikelihoodSidecarReader;
 
 namespace csr {
 
@@ -31,6 +32,9 @@ public:
     
     std::unique_ptr<VariantCallFilterFactory> clone() const;
     
+    // True if the filters made are block local, so can filter calls in memory during calling
+    bool is_block_local() const noexcept;
+    
     std::unique_ptr<VariantCallFilter>
     make(const ReferenceGenome& reference,
          BufferedReadPipe read_pipe,
@@ -39,10 +43,12 @@ public:
          boost::optional<Pedigree> pedigree,
          VariantCallFilter::OutputOptions output_config,
          boost::optional<ProgressMeter&> progress = boost::none,
-         boost::optional<unsigned> max_threads = 1) const;
+         boost::optional<unsigned> max_threads = 1,
+         std::shared_ptr<const LikelihoodSidecarReader> calling_likelihoods = nullptr) const;
     
 private:
     virtual std::unique_ptr<VariantCallFilterFactory> do_clone() const = 0;
+    virtual bool do_is_block_local() const noexcept { return false; }
     virtual
     std::unique_ptr<VariantCallFilter>
     do_make(FacetFactory facet_factory,
@@ -33,7 +33,7 @@ Measure::ResultType Depth::do_evaluate(const VcfRecord& call, const FacetMap& fa
             const auto& reads = get_value<OverlappingReads>(facets.at("OverlappingReads"));
             return static_cast<std::size_t>(count_overlapped(reads, call));
         } else {
-            return static_cast<std::size_t>(std::stoull(call.info_value(vcfspec::info::combinedReadDepth).front()));
+            return static_cast<std::size_t>(call.info_value(vcfspec::info::combinedReadDepth).front().to_integer());
         }
     } else {
         const auto& samples = get_value<Samples>(facets.at("Samples"));
@@ -46,7 +46,7 @@ Measure::ResultType Depth::do_evaluate(const VcfRecord& call, const FacetMap& fa
             }
         } else {
             for (const auto& sample : samples) {
-                result.push_back(std::stoull(call.get_sample_value(sample, vcfspec::format::combinedReadDepth).front()));
+                result.push_back(call.get_sample_value(sample, vcfspec::format::combinedReadDepth).front().to_integer());
             }
         }
         return result;
@@ -31,7 +31,7 @@ Measure::ResultType GenotypeQuality::do_evaluate(const VcfRecord& call, const Fa
         static const std::string gq_field {vcfspec::format::conditionalQuality};
         boost::optional<double> sample_gq {};
         if (call.has_format(gq_field)) {
-            sample_gq = std::stod(call.get_sample_value(sample, gq_field).front());
+            sample_gq = call.get_sample_value(sample, gq_field).front().to_real();
         }
         result.push_back(sample_gq);
     }
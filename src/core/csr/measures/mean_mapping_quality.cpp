@@ -30,7 +30,7 @@ Measure::ResultType MeanMappingQuality::do_evaluate(const VcfRecord& call, const
         assert(!reads.empty());
         return rmq_mapping_quality(reads, mapped_region(call));
     } else {
-        return std::stod(call.info_value(vcfspec::info::rmsMappingQuality).front());
+        return call.info_value(vcfspec::info::rmsMappingQuality).front().to_real();
     }
 }
 
@@ -20,7 +20,7 @@ Measure::ResultType ModelPosterior::do_evaluate(const VcfRecord& call, const Fac
     namespace ovcf = octopus::vcf::spec;
     boost::optional<double> result {};
     if (call.has_info(ovcf::info::modelPosterior)) {
-        result = std::stod(call.info_value(ovcf::info::modelPosterior).front());
+        result = call.info_value(ovcf::info::modelPosterior).front().to_real();
     }
     return result;
 }
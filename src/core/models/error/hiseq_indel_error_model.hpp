@@ -15,6 +15,7 @@ class HiSeqIndelErrorModel : public IndelErrorModel
 public:
     using IndelErrorModel::PenaltyType;
     using IndelErrorModel::PenaltyVector;
+    using IndelErrorModel::RepeatVector;
     
     HiSeqIndelErrorModel() = default;
     
@@ -51,7 +52,8 @@ private:
     static constexpr PenaltyType defaultGapExtension_ = 3;
     
     virtual std::unique_ptr<IndelErrorModel> do_clone() const override;
-    virtual PenaltyType do_evaluate(const Haplotype& haplotype, PenaltyVector& gap_open_penalties) const override;
+    virtual PenaltyType do_evaluate(const Haplotype& haplotype, const RepeatVector& repeats,
+                                    PenaltyVector& gap_open_penalties) const override;
 };
 
 } // namespace octopus
@@ -13,9 +13,10 @@ std::unique_ptr<IndelErrorModel> IndelErrorModel::clone() const
 }
 
 IndelErrorModel::PenaltyType
-IndelErrorModel::evaluate(const Haplotype& haplotype, PenaltyVector& gap_open_penalities) const
+IndelErrorModel::evaluate(const Haplotype& haplotype, const RepeatVector& repeats,
+                          PenaltyVector& gap_open_penalities) const
 {
-    return do_evaluate(haplotype, gap_open_penalities);
+    return do_evaluate(haplotype, repeats, gap_open_penalities);
 }
 
 } // namespace octopus
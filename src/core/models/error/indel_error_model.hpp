@@ -9,6 +9,8 @@
 #include <cstdint>
 #include <memory>
 
+namespace tandem { struct Repeat; }
+
 namespace octopus {
 
 class Haplotype;
@@ -18,15 +20,18 @@ class IndelErrorModel
 public:
     using PenaltyType = std::int8_t;
     using PenaltyVector = std::vector<PenaltyType>;
+    using RepeatVector = std::vector<tandem::Repeat>;
     
     virtual ~IndelErrorModel() = default;
     
     std::unique_ptr<IndelErrorModel> clone() const;
-    PenaltyType evaluate(const Haplotype& haplotype, PenaltyVector& gap_open_penalties) const;
+    // repeats are the exact tandem repeats in the haplotype sequence, ordered by position
+    PenaltyType evaluate(const Haplotype& haplotype, const RepeatVector& repeats, PenaltyVector& gap_open_penalties) const;
     
 private:
     virtual std::unique_ptr<IndelErrorModel> do_clone() const = 0;
-    virtual PenaltyType do_evaluate(const Haplotype& haplotype, PenaltyVector& gap_open_penalties) const = 0;
+    virtual PenaltyType do_evaluate(const Haplotype& haplotype, const RepeatVector& repeats,
+                                    PenaltyVector& gap_open_penalties) const = 0;
 };
 
 } // namespace octopus
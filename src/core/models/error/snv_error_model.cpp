@@ -10,11 +10,11 @@ std::unique_ptr<SnvErrorModel> SnvErrorModel::clone() const
     return do_clone();
 }
 
-void SnvErrorModel::evaluate(const Haplotype& haplotype,
+void SnvErrorModel::evaluate(const Haplotype& haplotype, const RepeatVector& repeats,
                              MutationVector& forward_snv_mask, PenaltyVector& forward_snv_priors,
                              MutationVector& reverse_snv_mask, PenaltyVector& reverse_snv_priors) const
 {
-    do_evaluate(haplotype, forward_snv_mask, forward_snv_priors, reverse_snv_mask, reverse_snv_priors);
+    do_evaluate(haplotype, repeats, forward_snv_mask, forward_snv_priors, reverse_snv_mask, reverse_snv_priors);
 }
 
 } // namespace octopus
@@ -8,6 +8,8 @@
 #include <cstdint>
 #include <memory>
 
+namespace tandem { struct Repeat; }
+
 namespace octopus {
 
 class Haplotype;
@@ -18,17 +20,19 @@ public:
     using MutationVector = std::vector<char>;
     using PenaltyType    = std::int8_t;
     using PenaltyVector  = std::vector<PenaltyType>;
+    using RepeatVector   = std::vector<tandem::Repeat>;
     
     virtual ~SnvErrorModel() = default;
     
     std::unique_ptr<SnvErrorModel> clone() const;
-    void evaluate(const Haplotype& haplotype,
+    // repeats are the exact tandem repeats in the haplotype sequence, ordered by position
+    void evaluate(const Haplotype& haplotype, const RepeatVector& repeats,
                   MutationVector& forward_snv_mask, PenaltyVector& forward_snv_priors,
                   MutationVector& reverse_snv_mask, PenaltyVector& reverse_snv_priors) const;
 
 private:
     virtual std::unique_ptr<SnvErrorModel> do_clone() const = 0;
-    virtual void do_evaluate(const Haplotype& haplotype,
+    virtual void do_evaluate(const Haplotype& haplotype, const RepeatVector& repeats,
                              MutationVector& forward_snv_mask, PenaltyVector& forward_snv_priors,
                              MutationVector& reverse_snv_mask, PenaltyVector& reverse_snv_priors) const = 0;
 };
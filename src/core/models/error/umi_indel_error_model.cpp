@@ -25,11 +25,6 @@ std::unique_ptr<IndelErrorModel> UmiIndelErrorModel::do_clone() const
 
 namespace {
 
-auto extract_repeats(const Haplotype& haplotype)
-{
-    return tandem::extract_exact_tandem_repeats(haplotype.sequence(), 1, 3);
-}
-
 template <typename C, typename T>
 static auto get_penalty(const C& penalties, const T length)
 {
@@ -51,10 +46,10 @@ auto fill_n_if_less(FordwardIt first, std::size_t n, const Tp& value)
 } // namespace
 
 UmiIndelErrorModel::PenaltyType
-UmiIndelErrorModel::do_evaluate(const Haplotype& haplotype, PenaltyVector& gap_open_penalities) const
+UmiIndelErrorModel::do_evaluate(const Haplotype& haplotype, const RepeatVector& repeats,
+                                PenaltyVector& gap_open_penalities) const
 {
     using std::begin; using std::end; using std::cbegin; using std::cend; using std::next;
-    const auto repeats = extract_repeats(haplotype);
     gap_open_penalities.assign(sequence_size(haplotype), homopolymerErrors_.front());
     tandem::Repeat max_repeat {};
     for (const auto& repeat : repeats) {
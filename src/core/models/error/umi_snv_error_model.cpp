@@ -22,11 +22,6 @@ std::unique_ptr<SnvErrorModel> UmiSnvErrorModel::do_clone() const
 
 namespace {
 
-auto extract_repeats(const Haplotype& haplotype, const unsigned max_period)
-{
-    return tandem::extract_exact_tandem_repeats(haplotype.sequence(), 1, max_period);
-}
-
 template <typename ForwardIt, typename OutputIt>
 OutputIt count_runs(ForwardIt first, ForwardIt last, OutputIt result,
                     const unsigned max_gap = 4)
@@ -123,18 +118,18 @@ auto make_substitution_mask(const Haplotype& haplotype)
     
 } // namespace
 
-void UmiSnvErrorModel::do_evaluate(const Haplotype& haplotype,
+void UmiSnvErrorModel::do_evaluate(const Haplotype& haplotype, const RepeatVector& repeats,
                                    MutationVector& forward_snv_mask, PenaltyVector& forward_snv_priors,
                                    MutationVector& reverse_snv_mask, PenaltyVector& reverse_snv_priors) const
 {
     using std::cbegin; using std::cend; using std::crbegin; using std::crend;
     using std::begin; using std::end; using std::rbegin; using std::next;
     constexpr auto Max_period = maxQualities_.size();
-    const auto repeats = extract_repeats(haplotype, Max_period);
     const auto num_bases = sequence_size(haplotype);
     std::array<std::vector<std::int8_t>, Max_period> repeat_masks {};
     repeat_masks.fill(std::vector<std::int8_t>(num_bases, 0));
     for (const auto& repeat : repeats) {
+        if (repeat.period > Max_period) continue;
         std::fill_n(next(begin(repeat_masks[repeat.period - 1]), repeat.pos), repeat.length, repeat_hash(haplotype, repeat));
     }
     const auto max_quality = maxQualities_.front().front();
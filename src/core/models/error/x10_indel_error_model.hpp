@@ -15,6 +15,7 @@ class X10IndelErrorModel : public IndelErrorModel
 public:
     using IndelErrorModel::PenaltyType;
     using IndelErrorModel::PenaltyVector;
+    using IndelErrorModel::RepeatVector;
     
     X10IndelErrorModel() = default;
     
@@ -52,7 +53,8 @@ private:
     static constexpr PenaltyType defaultGapExtension_ = 3;
     
     virtual std::unique_ptr<IndelErrorModel> do_clone() const override;
-    virtual PenaltyType do_evaluate(const Haplotype& haplotype, PenaltyVector& gap_open_penalties) const override;
+    virtual PenaltyType do_evaluate(const Haplotype& haplotype, const RepeatVector& repeats,
+                                    PenaltyVector& gap_open_penalties) const override;
 };
     
 } // namespace octopus
@@ -20,6 +20,7 @@ public:
     using SnvErrorModel::MutationVector;
     using SnvErrorModel::PenaltyType;
     using SnvErrorModel::PenaltyVector;
+    using SnvErrorModel::RepeatVector;
     
     X10SnvErrorModel() = default;
     
@@ -43,7 +44,7 @@ private:
      }};
     
     virtual std::unique_ptr<SnvErrorModel> do_clone() const override;
-    virtual void do_evaluate(const Haplotype& haplotype,
+    virtual void do_evaluate(const Haplotype& haplotype, const RepeatVector& repeats,
                              MutationVector& forward_snv_mask, PenaltyVector& forward_snv_priors,
                              MutationVector& reverse_snv_mask, PenaltyVector& reverse_snv_priors) const override;
 };
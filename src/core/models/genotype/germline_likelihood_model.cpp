@@ -9,6 +9,8 @@
 #include <numeric>
 #include <array>
 #include <limits>
+#include <unordered_map>
+#include <memory>
 #include <cassert>
 
 #include "utils/maths.hpp"
@@ -111,8 +113,140 @@ GermlineLikelihoodModel::LogProbability GermlineLikelihoodModel::evaluate(const
     return result;
 }
 
+void GermlineLikelihoodModel::evaluate(const std::vector<Genotype<Haplotype>>& genotypes,
+                                       std::vector<LogProbability>& result) const
+{
+    assert(likelihoods_.is_primed());
+    batch_rows_.clear();
+    batch_genotype_rows_.clear();
+    batch_genotype_offsets_.assign(1, 0);
+    batch_genotype_offsets_.reserve(genotypes.size() + 1);
+    // Genotypes usually share haplotype objects, so most haplotypes are found without hashing the sequence
+    std::unordered_map<const Haplotype*, unsigned> haplotype_rows {};
+    std::unordered_map<const LikelihoodVector*, unsigned> likelihood_rows {};
+    for (const auto& genotype : genotypes) {
+        for (unsigned i {0}; i < genotype.ploidy(); ++i) {
+            const Haplotype& haplotype {genotype[i]};
+            auto row_itr = haplotype_rows.find(std::addressof(haplotype));
+            if (row_itr == std::cend(haplotype_rows)) {
+                const auto& likelihoods = likelihoods_[haplotype];
+                const auto p = likelihood_rows.emplace(std::addressof(likelihoods), batch_rows_.size());
+                if (p.second) batch_rows_.push_back(std::addressof(likelihoods));
+                row_itr = haplotype_rows.emplace(std::addressof(haplotype), p.first->second).first;
+            }
+            batch_genotype_rows_.push_back(row_itr->second);
+        }
+        batch_genotype_offsets_.push_back(batch_genotype_rows_.size());
+    }
+    evaluate_batch(result);
+}
+
+void GermlineLikelihoodModel::evaluate(const std::vector<GenotypeIndex>& genotypes,
+                                       std::vector<LogProbability>& result) const
+{
+    assert(is_primed());
+    batch_rows_.clear();
+    batch_genotype_rows_.clear();
+    batch_genotype_offsets_.assign(1, 0);
+    batch_genotype_offsets_.reserve(genotypes.size() + 1);
+    constexpr auto noRow = std::numeric_limits<unsigned>::max();
+    std::vector<unsigned> haplotype_rows(indexed_likelihoods_.size(), noRow);
+    for (const auto& genotype : genotypes) {
+        for (const auto haplotype_idx : genotype) {
+            if (haplotype_rows[haplotype_idx] == noRow) {
+                haplotype_rows[haplotype_idx] = batch_rows_.size();
+                batch_rows_.push_back(std::addressof(indexed_likelihoods_[haplotype_idx].get()));
+            }
+            batch_genotype_rows_.push_back(haplotype_rows[haplotype_idx]);
+        }
+        batch_genotype_offsets_.push_back(batch_genotype_rows_.size());
+    }
+    evaluate_batch(result);
+}
+
 // private methods
 
+// ln p(read | genotype) = ln sum {haplotype in genotype} exp(ln p(read | haplotype) - m) + m - ln ploidy
+// where m is the maximum ln p(read | haplotype) over all haplotypes in the batch. Exponentiating relative
+// to m means each haplotype is exponentiated once for the batch rather than once for every genotype
+// containing it, and leaves a single logarithm per read for each genotype. Reads where all of a genotype's
+// scaled likelihoods underflow fall back to the exact per-read evaluation.
+void GermlineLikelihoodModel::evaluate_batch(std::vector<LogProbability>& result) const
+{
+    const auto num_genotypes = batch_genotype_offsets_.size() - 1;
+    result.assign(num_genotypes, 0.0);
+    if (batch_rows_.empty()) return;
+    const auto num_reads = batch_rows_.front()->size();
+    if (num_reads == 0) return;
+    LogProbability max_likelihood_sum {0};
+    bool is_scaled {false};
+    const auto scale_likelihoods = [&] () {
+        read_max_likelihoods_.assign(num_reads, std::numeric_limits<LogProbability>::lowest());
+        for (const auto row : batch_rows_) {
+            const auto likelihoods = row->data();
+            for (std::size_t read_idx {0}; read_idx < num_reads; ++read_idx) {
+                read_max_likelihoods_[read_idx] = std::max(read_max_likelihoods_[read_idx], likelihoods[read_idx]);
+            }
+        }
+        scaled_likelihoods_.resize(batch_rows_.size() * num_reads);
+        for (std::size_t row_idx {0}; row_idx < batch_rows_.size(); ++row_idx) {
+            const auto likelihoods = batch_rows_[row_idx]->data();
+            const auto scaled_likelihoods = scaled_likelihoods_.data() + row_idx * num_reads;
+            for (std::size_t read_idx {0}; read_idx < num_reads; ++read_idx) {
+                scaled_likelihoods[read_idx] = std::exp(likelihoods[read_idx] - read_max_likelihoods_[read_idx]);
+            }
+        }
+        max_likelihood_sum = std::accumulate(std::cbegin(read_max_likelihoods_), std::cend(read_max_likelihoods_), 0.0);
+        read_sums_.resize(num_reads);
+        is_scaled = true;
+    };
+    for (std::size_t genotype_idx {0}; genotype_idx < num_genotypes; ++genotype_idx) {
+        const auto first_row = batch_genotype_rows_.data() + batch_genotype_offsets_[genotype_idx];
+        const auto last_row  = batch_genotype_rows_.data() + batch_genotype_offsets_[genotype_idx + 1];
+        if (first_row == last_row) continue;
+        if (std::all_of(std::next(first_row), last_row, [=] (auto row) { return row == *first_row; })) {
+            const auto& likelihoods = *batch_rows_[*first_row];
+            result[genotype_idx] = std::accumulate(std::cbegin(likelihoods), std::cend(likelihoods), 0.0);
+            continue;
+        }
+        if (!is_scaled) scale_likelihoods();
+        std::copy_n(scaled_likelihoods_.data() + *first_row * num_reads, num_reads, read_sums_.data());
+        for (auto row_itr = std::next(first_row); row_itr != last_row; ++row_itr) {
+            const auto scaled_likelihoods = scaled_likelihoods_.data() + *row_itr * num_reads;
+            for (std::size_t read_idx {0}; read_idx < num_reads; ++read_idx) {
+                read_sums_[read_idx] += scaled_likelihoods[read_idx];
+            }
+        }
+        if (*std::min_element(std::cbegin(read_sums_), std::cend(read_sums_)) < std::numeric_limits<LogProbability>::min()) {
+            result[genotype_idx] = evaluate_exact(first_row, last_row);
+            continue;
+        }
+        LogProbability log_sum {0};
+        for (std::size_t read_idx {0}; read_idx < num_reads; ++read_idx) {
+            log_sum += std::log(read_sums_[read_idx]);
+        }
+        const auto ploidy = static_cast<unsigned>(last_row - first_row);
+        result[genotype_idx] = log_sum + max_likelihood_sum - num_reads * std::log(ploidy);
+    }
+}
+
+GermlineLikelihoodModel::LogProbability
+GermlineLikelihoodModel::evaluate_exact(const unsigned* first_row, const unsigned* last_row) const
+{
+    const auto ploidy = static_cast<unsigned>(last_row - first_row);
+    const auto ln_ploidy = std::log(ploidy);
+    buffer_.resize(ploidy);
+    LogProbability result {0};
+    const auto num_likelihoods = batch_rows_[*first_row]->size();
+    for (std::size_t read_idx {0}; read_idx < num_likelihoods; ++read_idx) {
+        std::transform(first_row, last_row, std::begin(buffer_),
+                       [=] (auto row) noexcept { return (*batch_rows_[row])[read_idx]; });
+        result += maths::log_sum_exp(buffer_) - ln_ploidy;
+    }
+    return result;
+}
+
+
 GermlineLikelihoodModel::LogProbability GermlineLikelihoodModel::evaluate_haploid(const Genotype<Haplotype>& genotype) const
 {
     const auto& log_likelihoods = likelihoods_[genotype[0]];
@@ -199,21 +333,14 @@ GermlineLikelihoodModel::LogProbability GermlineLikelihoodModel::evaluate_polypl
         return std::accumulate(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1), 0.0);
     }
     if (z == 2) {
-        const double lnpm1 {std::log(ploidy - 1)};
         const auto unique_haplotypes = genotype.copy_unique_ref();
         const auto& log_likelihoods2 = likelihoods_[unique_haplotypes.back()];
-        
-        if (genotype.count(unique_haplotypes.front()) == 1) {
-            return std::inner_product(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1),
-                                      std::cbegin(log_likelihoods2), 0.0, std::plus<> {},
-                                      [ploidy, lnpm1] (const auto a, const auto b) -> double {
-                                          return maths::log_sum_exp(a, lnpm1 + b) - ln<>(ploidy);
-                                      });
-        }
+        const auto count1 = genotype.count(unique_haplotypes.front());
+        const double ln_count1 {std::log(count1)}, ln_count2 {std::log(ploidy - count1)}, ln_ploidy {std::log(ploidy)};
         return std::inner_product(std::cbegin(log_likelihoods1), std::cend(log_likelihoods1),
                                   std::cbegin(log_likelihoods2), 0.0, std::plus<> {},
-                                  [ploidy, lnpm1] (const auto a, const auto b) -> double {
-                                      return maths::log_sum_exp(lnpm1 + a, b) - ln<>(ploidy);
+                                  [=] (const auto a, const auto b) -> double {
+                                      return maths::log_sum_exp(ln_count1 + a, ln_count2 + b) - ln_ploidy;
                                   });
     }
     likelihood_refs_.reserve(ploidy);
@@ -38,12 +38,26 @@ public:
     LogProbability evaluate(const Genotype<Haplotype>& genotype) const;
     LogProbability evaluate(const GenotypeIndex& genotype) const;
     
+    // Evaluating many genotypes together shares the work for haplotypes common to several genotypes
+    void evaluate(const std::vector<Genotype<Haplotype>>& genotypes, std::vector<LogProbability>& result) const;
+    void evaluate(const std::vector<GenotypeIndex>& genotypes, std::vector<LogProbability>& result) const;
+    
 private:
+    using LikelihoodVector = HaplotypeLikelihoodArray::LikelihoodVector;
+    
     const HaplotypeLikelihoodArray& likelihoods_;
     std::vector<HaplotypeLikelihoodArray::LikelihoodVectorRef> indexed_likelihoods_;
     mutable std::vector<HaplotypeLikelihoodArray::LikelihoodVectorRef> likelihood_refs_;
     mutable std::vector<LogProbability> buffer_;
     
+    // Batch evaluation buffers
+    mutable std::vector<const LikelihoodVector*> batch_rows_;
+    mutable std::vector<unsigned> batch_genotype_rows_;
+    mutable std::vector<std::size_t> batch_genotype_offsets_;
+    mutable std::vector<LogProbability> read_max_likelihoods_, scaled_likelihoods_, read_sums_;
+    
+    void evaluate_batch(std::vector<LogProbability>& result) const;
+    LogProbability evaluate_exact(const unsigned* first_row, const unsigned* last_row) const;
     // These are just for optimisation
     LogProbability evaluate_haploid(const Genotype<Haplotype>& genotype) const;
     LogProbability evaluate_diploid(const Genotype<Haplotype>& genotype) const;
@@ -52,6 +66,22 @@ private:
     LogProbability evaluate_polyploid(const Genotype<Haplotype>& genotype) const;
 };
 
+inline std::vector<GermlineLikelihoodModel::LogProbability>&
+evaluate(const std::vector<Genotype<Haplotype>>& genotypes, const GermlineLikelihoodModel& model,
+         std::vector<GermlineLikelihoodModel::LogProbability>& result)
+{
+    model.evaluate(genotypes, result);
+    return result;
+}
+
+inline std::vector<GermlineLikelihoodModel::LogProbability>&
+evaluate(const std::vector<GenotypeIndex>& genotypes, const GermlineLikelihoodModel& model,
+         std::vector<GermlineLikelihoodModel::LogProbability>& result)
+{
+    model.evaluate(genotypes, result);
+    return result;
+}
+
 template <typename Container1, typename Container2>
 Container2&
 evaluate(const Container1& genotypes, const GermlineLikelihoodModel& model, Container2& result)
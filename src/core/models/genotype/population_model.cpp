@@ -156,12 +156,9 @@ compute_genotype_log_likelihoods(const std::vector<SampleName>& samples,
     result.reserve(samples.size());
     std::transform(std::cbegin(samples), std::cend(samples), std::back_inserter(result),
                    [&genotypes, &haplotype_likelihoods, &likelihood_model] (const auto& sample) {
-                       GenotypeLogLikelihoodVector likelihoods(genotypes.size());
+                       GenotypeLogLikelihoodVector likelihoods {};
                        haplotype_likelihoods.prime(sample);
-                       std::transform(std::cbegin(genotypes), std::cend(genotypes), std::begin(likelihoods),
-                                      [&likelihood_model] (const auto& genotype) {
-                                          return likelihood_model.evaluate(genotype);
-                                      });
+                       octopus::model::evaluate(genotypes, likelihood_model, likelihoods);
                        return likelihoods;
                    });
     return result;
@@ -15,8 +15,6 @@
 #include "utils/maths.hpp"
 #include "germline_likelihood_model.hpp"
 
-#include "timers.hpp"
-
 namespace octopus { namespace model {
 
 unsigned TrioModel::max_ploidy() noexcept
@@ -131,11 +129,13 @@ bool operator>(const ParentsProbabilityPair& lhs, const ParentsProbabilityPair&
 auto compute_likelihoods(const std::vector<Genotype<Haplotype>>& genotypes,
                          const GermlineLikelihoodModel& model)
 {
+    std::vector<GermlineLikelihoodModel::LogProbability> likelihoods {};
+    model.evaluate(genotypes, likelihoods);
     std::vector<GenotypeRefProbabilityPair> result {};
     result.reserve(genotypes.size());
-    std::transform(std::cbegin(genotypes), std::cend(genotypes), std::back_inserter(result),
-                   [&model] (const auto& genotype) {
-                       return GenotypeRefProbabilityPair {genotype, model.evaluate(genotype)};
+    std::transform(std::cbegin(genotypes), std::cend(genotypes), std::cbegin(likelihoods), std::back_inserter(result),
+                   [] (const auto& genotype, const auto likelihood) {
+                       return GenotypeRefProbabilityPair {genotype, likelihood};
                    });
     return result;
 }
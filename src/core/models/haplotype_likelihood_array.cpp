@@ -4,29 +4,99 @@
 #include "haplotype_likelihood_array.hpp"
 
 #include <utility>
+#include <iterator>
+#include <numeric>
 #include <cassert>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+
+#include "utils/thread_pool.hpp"
 
 #include <iostream> // DEBUG
 #include <iomanip>  // DEBUG
 
 namespace octopus {
 
+namespace {
+
+struct ShardProgress
+{
+    ShardProgress(std::size_t num_shards) : num_shards {num_shards}, next_shard {0}, num_completed {0}, failed {false} {}
+    const std::size_t num_shards;
+    std::atomic<std::size_t> next_shard, num_completed;
+    std::atomic<bool> failed;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable all_completed;
+};
+
+// Claims and evaluates shards until none are left. evaluate is only called for claimed shards, so
+// anything it references need only outlive the shards, not the pool task running this.
+template <typename F>
+void run_shards(ShardProgress& progress, F&& evaluate)
+{
+    for (auto shard = progress.next_shard++; shard < progress.num_shards; shard = progress.next_shard++) {
+        if (!progress.failed) {
+            try {
+                evaluate(shard);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock {progress.mutex};
+                if (!progress.error) progress.error = std::current_exception();
+                progress.failed = true;
+            }
+        }
+        if (++progress.num_completed == progress.num_shards) {
+            std::lock_guard<std::mutex> lock {progress.mutex};
+            progress.all_completed.notify_all();
+        }
+    }
+}
+
+struct PopulateShard
+{
+    const Haplotype* haplotype;
+    std::size_t sample, first_read, num_reads;
+    HaplotypeLikelihoodArray::Likelihood* result;
+};
+
+struct PopulateWorker
+{
+    PopulateWorker(unsigned char kmer_size) : haplotype_index {kmer_size} {}
+    HaplotypeLikelihoodModel* likelihood_model = nullptr;
+    const Haplotype* haplotype = nullptr;
+    KmerIndex haplotype_index;
+    std::vector<std::size_t> mapping_positions = {};
+    std::vector<HaplotypeLikelihoodModel::MappingPositionVector> read_mapping_positions = {};
+    HaplotypeLikelihoodModel::ReadReferenceVector reads = {};
+    std::vector<double> likelihoods = {};
+};
+
+} // namespace
+
 // public methods
 
 HaplotypeLikelihoodArray::HaplotypeLikelihoodArray(const unsigned max_haplotypes,
                                                    const std::vector<SampleName>& samples)
-: cache_ {max_haplotypes}
+: haplotype_indices_ {max_haplotypes}
 , sample_indices_ {samples.size()}
+, likelihoods_ {}
 {
     mapping_positions_.resize(maxMappingPositions);
 }
 
 HaplotypeLikelihoodArray::HaplotypeLikelihoodArray(HaplotypeLikelihoodModel likelihood_model,
                                                    unsigned max_haplotypes,
-                                                   const std::vector<SampleName>& samples)
+                                                   const std::vector<SampleName>& samples,
+                                                   ExecutionPolicy execution_policy)
 : likelihood_model_ {std::move(likelihood_model)}
-, cache_ {max_haplotypes}
+, execution_policy_ {execution_policy}
+, worker_likelihood_models_ {}
+, haplotype_indices_ {max_haplotypes}
 , sample_indices_ {samples.size()}
+, likelihoods_ {}
 {
     mapping_positions_.resize(maxMappingPositions);
 }
@@ -43,13 +113,20 @@ void HaplotypeLikelihoodArray::populate(const ReadMap& reads,
 {
     // This code is not very pretty because it is a bottleneck for the entire application.
     // We want to try a minimise memory allocations for the mapping.
-    cache_.clear();
-    if (cache_.bucket_count() < haplotypes.size()) {
-        cache_.rehash(haplotypes.size());
-    }
     set_read_iterators_and_sample_indices(reads);
     assert(reads.size() == read_iterators_.size());
     const auto num_samples = reads.size();
+    const auto unique_haplotypes = index_haplotypes(haplotypes);
+    std::vector<std::size_t> sample_num_reads(num_samples);
+    std::transform(std::cbegin(read_iterators_), std::cend(read_iterators_), std::begin(sample_num_reads),
+                   [] (const ReadPacket& t) { return t.num_reads; });
+    likelihoods_.reset(unique_haplotypes.size(), sample_num_reads);
+    // The haplotypes mostly share the reference sequence, so their repeats are projected from the reference repeats
+    if (unique_haplotypes.size() >= minHaplotypesForRepeatIndex) {
+        repeat_index_.index(make_reference_haplotype(unique_haplotypes.front()));
+    } else {
+        repeat_index_.clear();
+    }
     // Precompute all read hashes so we don't have to recompute for each haplotype
     std::vector<std::vector<KmerPerfectHashes>> read_hashes {};
     read_hashes.reserve(num_samples);
@@ -60,78 +137,127 @@ void HaplotypeLikelihoodArray::populate(const ReadMap& reads,
                        [] (const AlignedRead& read) { return compute_kmer_hashes<mapperKmerSize>(read.sequence()); });
         read_hashes.emplace_back(std::move(sample_read_hashes));
     }
-    auto haplotype_hashes = init_kmer_hash_table<mapperKmerSize>();
+    if (use_parallel_populate(unique_haplotypes)) {
+        populate_parallel(unique_haplotypes, read_hashes, flank_state);
+        likelihood_model_.clear();
+        read_iterators_.clear();
+        return;
+    }
+    std::vector<HaplotypeLikelihoodModel::ReadReferenceVector> sample_reads {};
+    sample_reads.reserve(num_samples);
+    for (const auto& t : read_iterators_) {
+        if (t.num_reads >= minReadsForBatchEvaluation) {
+            sample_reads.emplace_back(t.first, t.last);
+        } else {
+            sample_reads.emplace_back();
+        }
+    }
+    KmerIndex haplotype_index {mapperKmerSize};
+    std::vector<Likelihood> batch_likelihoods {};
     const auto first_mapping_position = std::begin(mapping_positions_);
-    for (const auto& haplotype : haplotypes) {
-        populate_kmer_hash_table<mapperKmerSize>(haplotype.sequence(), haplotype_hashes);
-        auto haplotype_mapping_counts = init_mapping_counts(haplotype_hashes);
-        auto itr = std::begin(cache_.emplace(std::piecewise_construct,
-                                             std::forward_as_tuple(haplotype),
-                                             std::forward_as_tuple(num_samples)).first->second);
-        likelihood_model_.reset(haplotype, flank_state);
+    for (std::size_t h {0}; h < unique_haplotypes.size(); ++h) {
+        const Haplotype& haplotype {unique_haplotypes[h]};
+        haplotype_index.index(haplotype.sequence());
+        likelihood_model_.reset(haplotype, repeat_index_, flank_state);
         auto read_hash_itr = std::cbegin(read_hashes);
+        auto sample_reads_itr = std::cbegin(sample_reads);
+        std::size_t s {0};
         for (const auto& t : read_iterators_) { // for each sample
-            *itr = std::vector<double>(t.num_reads);
-            std::transform(t.first, t.last, std::cbegin(*read_hash_itr), std::begin(*itr),
-                           [&] (const AlignedRead& read, const auto& read_hashes) {
-                               const auto last_mapping_position = map_query_to_target(read_hashes, haplotype_hashes,
-                                                                                      haplotype_mapping_counts,
-                                                                                      first_mapping_position,
-                                                                                      maxMappingPositions);
-                               reset_mapping_counts(haplotype_mapping_counts);
-                               return likelihood_model_.evaluate(read, first_mapping_position, last_mapping_position);
-                           });
+            const auto result = likelihoods_.row(s, h);
+            if (t.num_reads >= minReadsForBatchEvaluation) {
+                // Many reads so worth mapping them all first, then aligning them together
+                read_mapping_positions_.resize(t.num_reads);
+                auto mapping_positions_itr = std::begin(read_mapping_positions_);
+                for (const auto& read_hashes : *read_hash_itr) {
+                    mapping_positions_itr->clear();
+                    haplotype_index.map(read_hashes, std::back_inserter(*mapping_positions_itr++), maxMappingPositions);
+                }
+                likelihood_model_.evaluate(*sample_reads_itr, read_mapping_positions_, batch_likelihoods);
+                std::copy(std::cbegin(batch_likelihoods), std::cend(batch_likelihoods), result);
+            } else {
+                std::transform(t.first, t.last, std::cbegin(*read_hash_itr), result,
+                               [&] (const AlignedRead& read, const auto& read_hashes) {
+                                   const auto last_mapping_position = haplotype_index.map(read_hashes, first_mapping_position,
+                                                                                          maxMappingPositions);
+                                   return likelihood_model_.evaluate(read, first_mapping_position, last_mapping_position);
+                               });
+            }
             ++read_hash_itr;
-            ++itr;
+            ++sample_reads_itr;
+            ++s;
         }
-        clear_kmer_hash_table(haplotype_hashes);
     }
     likelihood_model_.clear();
     read_iterators_.clear();
+    read_mapping_positions_.clear();
 }
 
 std::size_t HaplotypeLikelihoodArray::num_likelihoods(const SampleName& sample) const
 {
-    return std::cbegin(cache_)->second.at(sample_indices_.at(sample)).size();
+    return likelihoods_(sample_indices_.at(sample), std::cbegin(haplotype_indices_)->second).size();
 }
 
 const HaplotypeLikelihoodArray::LikelihoodVector&
 HaplotypeLikelihoodArray::operator()(const SampleName& sample, const Haplotype& haplotype) const
 {
-    return cache_.at(haplotype)[sample_indices_.at(sample)];
+    return likelihoods_(sample_indices_.at(sample), haplotype_indices_.at(haplotype));
 }
 
 const HaplotypeLikelihoodArray::LikelihoodVector&
 HaplotypeLikelihoodArray::operator[](const Haplotype& haplotype) const
 {
-    return cache_.at(haplotype)[*primed_sample_];
+    return likelihoods_(*primed_sample_, haplotype_indices_.at(haplotype));
+}
+
+std::size_t HaplotypeLikelihoodArray::index_of(const Haplotype& haplotype) const
+{
+    return haplotype_indices_.at(haplotype);
+}
+
+const HaplotypeLikelihoodArray::LikelihoodVector&
+HaplotypeLikelihoodArray::operator()(const SampleName& sample, const std::size_t haplotype_index) const
+{
+    return likelihoods_(sample_indices_.at(sample), haplotype_index);
 }
 
 HaplotypeLikelihoodArray::SampleLikelihoodMap
 HaplotypeLikelihoodArray::extract_sample(const SampleName& sample) const
 {
     const auto sample_index = sample_indices_.at(sample);
-    SampleLikelihoodMap result {cache_.size()};
-    for (const auto& p : cache_) {
-        result.emplace(p.first, p.second[sample_index]);
+    SampleLikelihoodMap result {haplotype_indices_.size()};
+    for (const auto& p : haplotype_indices_) {
+        result.emplace(p.first, likelihoods_(sample_index, p.second));
     }
     return result;
 }
 
 bool HaplotypeLikelihoodArray::contains(const Haplotype& haplotype) const noexcept
 {
-    return cache_.count(haplotype) == 1;
+    return haplotype_indices_.count(haplotype) == 1;
 }
 
 bool HaplotypeLikelihoodArray::is_empty() const noexcept
 {
-    return cache_.empty();
+    return haplotype_indices_.empty();
+}
+
+HaplotypeLikelihoodModel::CacheStatistics HaplotypeLikelihoodArray::cache_statistics() const noexcept
+{
+    auto result = likelihood_model_.cache_statistics();
+    for (const auto& model : worker_likelihood_models_) {
+        const auto worker_statistics = model.cache_statistics();
+        result.hits += worker_statistics.hits;
+        result.lookups += worker_statistics.lookups;
+    }
+    return result;
 }
 
 void HaplotypeLikelihoodArray::clear() noexcept
 {
-    cache_.clear();
+    haplotype_indices_.clear();
+    next_haplotype_index_ = 0;
     sample_indices_.clear();
+    likelihoods_.clear();
     unprime();
 }
 
@@ -170,6 +296,173 @@ void HaplotypeLikelihoodArray::set_read_iterators_and_sample_indices(const ReadM
     }
 }
 
+std::vector<std::reference_wrapper<const Haplotype>>
+HaplotypeLikelihoodArray::index_haplotypes(const std::vector<Haplotype>& haplotypes)
+{
+    haplotype_indices_.clear();
+    if (haplotype_indices_.bucket_count() < haplotypes.size()) {
+        haplotype_indices_.rehash(haplotypes.size());
+    }
+    std::vector<std::reference_wrapper<const Haplotype>> result {};
+    result.reserve(haplotypes.size());
+    for (const auto& haplotype : haplotypes) {
+        if (haplotype_indices_.emplace(haplotype, result.size()).second) {
+            result.emplace_back(haplotype);
+        }
+    }
+    next_haplotype_index_ = result.size();
+    return result;
+}
+
+bool HaplotypeLikelihoodArray::use_parallel_populate(const std::vector<std::reference_wrapper<const Haplotype>>& haplotypes) const noexcept
+{
+    if (execution_policy_ == ExecutionPolicy::seq) return false;
+    // Shards only run on the pool running this thread, so populating never starts threads of its own
+    const auto pool = ThreadPool::current();
+    if (pool == nullptr || pool->size() < 2) return false;
+    const auto num_reads = std::accumulate(std::cbegin(read_iterators_), std::cend(read_iterators_), std::size_t {0},
+                                           [] (auto curr, const ReadPacket& t) { return curr + t.num_reads; });
+    return haplotypes.size() * num_reads >= minEvaluationsForParallelPopulate;
+}
+
+void HaplotypeLikelihoodArray::populate_parallel(const std::vector<std::reference_wrapper<const Haplotype>>& haplotypes,
+                                                 const std::vector<std::vector<KmerPerfectHashes>>& read_hashes,
+                                                 const boost::optional<FlankState> flank_state)
+{
+    const auto num_samples = read_iterators_.size();
+    // Each shard writes to its own part of the preallocated matrix
+    std::vector<PopulateShard> shards {};
+    for (std::size_t h {0}; h < haplotypes.size(); ++h) {
+        for (std::size_t s {0}; s < num_samples; ++s) {
+            const auto num_reads = read_iterators_[s].num_reads;
+            for (std::size_t first_read {0}; first_read < num_reads; first_read += parallelReadBlockSize) {
+                shards.push_back({std::addressof(haplotypes[h].get()), s, first_read,
+                                  std::min(parallelReadBlockSize, num_reads - first_read), likelihoods_.row(s, h)});
+            }
+        }
+    }
+    if (shards.empty()) return;
+    auto& pool = *ThreadPool::current();
+    // The populating thread is one of the pool's workers
+    const auto num_pool_workers = std::min(pool.size() - 1, shards.size() - 1);
+    if (worker_likelihood_models_.size() < num_pool_workers) {
+        worker_likelihood_models_.resize(num_pool_workers, likelihood_model_);
+    }
+    std::vector<PopulateWorker> workers(num_pool_workers + 1, PopulateWorker {mapperKmerSize});
+    workers.front().likelihood_model = std::addressof(likelihood_model_);
+    for (std::size_t w {1}; w < workers.size(); ++w) {
+        workers[w].likelihood_model = std::addressof(worker_likelihood_models_[w - 1]);
+    }
+    const auto evaluate_shard = [&] (PopulateWorker& worker, const PopulateShard& shard) {
+        if (worker.haplotype != shard.haplotype) {
+            if (!worker.haplotype) worker.mapping_positions.resize(maxMappingPositions);
+            worker.haplotype_index.index(shard.haplotype->sequence());
+            worker.likelihood_model->reset(*shard.haplotype, repeat_index_, flank_state);
+            worker.haplotype = shard.haplotype;
+        }
+        const auto& t = read_iterators_[shard.sample];
+        const auto first_read = std::next(t.first, shard.first_read);
+        const auto last_read  = std::next(first_read, shard.num_reads);
+        const auto first_read_hashes = std::next(std::cbegin(read_hashes[shard.sample]), shard.first_read);
+        const auto first_result = std::next(shard.result, shard.first_read);
+        if (t.num_reads >= minReadsForBatchEvaluation) {
+            worker.read_mapping_positions.resize(shard.num_reads);
+            auto read_hashes_itr = first_read_hashes;
+            for (auto& mapping_positions : worker.read_mapping_positions) {
+                mapping_positions.clear();
+                worker.haplotype_index.map(*read_hashes_itr++, std::back_inserter(mapping_positions), maxMappingPositions);
+            }
+            worker.reads.assign(first_read, last_read);
+            worker.likelihood_model->evaluate(worker.reads, worker.read_mapping_positions, worker.likelihoods);
+            std::copy(std::cbegin(worker.likelihoods), std::cend(worker.likelihoods), first_result);
+        } else {
+            const auto first_mapping_position = std::begin(worker.mapping_positions);
+            std::transform(first_read, last_read, first_read_hashes, first_result,
+                           [&] (const AlignedRead& read, const auto& read_hashes) {
+                               const auto last_mapping_position = worker.haplotype_index.map(read_hashes, first_mapping_position,
+                                                                                             maxMappingPositions);
+                               return worker.likelihood_model->evaluate(read, first_mapping_position, last_mapping_position);
+                           });
+        }
+    };
+    auto progress = std::make_shared<ShardProgress>(shards.size());
+    for (std::size_t w {1}; w < workers.size(); ++w) {
+        auto& worker = workers[w];
+        pool.push([progress, &worker, &shards, &evaluate_shard] () {
+            run_shards(*progress, [&] (std::size_t shard) { evaluate_shard(worker, shards[shard]); });
+        });
+    }
+    // The populating thread works too, so progress is made even if the pool is busy with other tasks
+    run_shards(*progress, [&] (std::size_t shard) { evaluate_shard(workers.front(), shards[shard]); });
+    {
+        std::unique_lock<std::mutex> lock {progress->mutex};
+        progress->all_completed.wait(lock, [&] () { return progress->num_completed == progress->num_shards; });
+    }
+    for (auto& model : worker_likelihood_models_) model.clear();
+    if (progress->error) std::rethrow_exception(progress->error);
+}
+
+HaplotypeLikelihoodArray::LikelihoodMatrix::LikelihoodMatrix(const LikelihoodMatrix& other)
+: buffer_ {other.buffer_}
+, rows_ {other.rows_}
+{
+    rebase(other.buffer_.data());
+}
+
+HaplotypeLikelihoodArray::LikelihoodMatrix&
+HaplotypeLikelihoodArray::LikelihoodMatrix::operator=(const LikelihoodMatrix& other)
+{
+    if (this != &other) {
+        buffer_ = other.buffer_;
+        rows_ = other.rows_;
+        rebase(other.buffer_.data());
+    }
+    return *this;
+}
+
+void HaplotypeLikelihoodArray::LikelihoodMatrix::reset(const std::size_t num_haplotypes,
+                                                       const std::vector<std::size_t>& sample_num_reads)
+{
+    const auto num_reads = std::accumulate(std::cbegin(sample_num_reads), std::cend(sample_num_reads), std::size_t {0});
+    buffer_.assign(num_haplotypes * num_reads, 0);
+    rows_.resize(sample_num_reads.size());
+    auto first = buffer_.data();
+    for (std::size_t s {0}; s < sample_num_reads.size(); ++s) {
+        rows_[s].resize(num_haplotypes);
+        for (auto& row : rows_[s]) {
+            row = LikelihoodVector {first, sample_num_reads[s]};
+            first += sample_num_reads[s];
+        }
+    }
+}
+
+void HaplotypeLikelihoodArray::LikelihoodMatrix::clear() noexcept
+{
+    buffer_.clear();
+    rows_.clear();
+}
+
+const HaplotypeLikelihoodArray::LikelihoodVector&
+HaplotypeLikelihoodArray::LikelihoodMatrix::operator()(const std::size_t sample, const std::size_t haplotype) const
+{
+    return rows_.at(sample).at(haplotype);
+}
+
+HaplotypeLikelihoodArray::Likelihood*
+HaplotypeLikelihoodArray::LikelihoodMatrix::row(const std::size_t sample, const std::size_t haplotype) noexcept
+{
+    return buffer_.data() + (rows_[sample][haplotype].data() - buffer_.data());
+}
+
+void HaplotypeLikelihoodArray::LikelihoodMatrix::rebase(const Likelihood* old_buffer) noexcept
+{
+    for (auto& sample_rows : rows_) {
+        for (auto& row : sample_rows) {
+            if (row.data()) row = LikelihoodVector {buffer_.data() + (row.data() - old_buffer), row.size()};
+        }
+    }
+}
+
 // non-member methods
 
 HaplotypeLikelihoodArray merge_samples(const std::vector<SampleName>& samples,
@@ -179,7 +472,7 @@ HaplotypeLikelihoodArray merge_samples(const std::vector<SampleName>& samples,
 {
     HaplotypeLikelihoodArray result {static_cast<unsigned>(haplotypes.size()), {new_sample}};
     for (const auto& haplotype : haplotypes) {
-        HaplotypeLikelihoodArray::LikelihoodVector likelihoods {};
+        std::vector<HaplotypeLikelihoodArray::Likelihood> likelihoods {};
         for (const auto& sample : samples) {
             const auto& m = haplotype_likelihoods(sample, haplotype);
             likelihoods.insert(std::end(likelihoods), std::cbegin(m), std::cend(m));
@@ -6,8 +6,11 @@
 
 #include <unordered_map>
 #include <vector>
+#include <deque>
 #include <algorithm>
+#include <iterator>
 #include <functional>
+#include <cstddef>
 
 #include <boost/optional.hpp>
 
@@ -15,6 +18,7 @@
 #include "core/types/haplotype.hpp"
 #include "basics/aligned_read.hpp"
 #include "utils/kmer_mapper.hpp"
+#include "utils/tandem_repeat_index.hpp"
 #include "haplotype_likelihood_model.hpp"
 
 namespace octopus {
@@ -23,15 +27,54 @@ namespace octopus {
     HaplotypeLikelihoodArray is essentially a matrix of haplotype likelihoods, i.e.
     p(read | haplotype) for a given set of AlignedReads and Haplotypes.
  
+    The likelihoods are stored in one dense buffer. Each sample's likelihoods are contiguous,
+    with one row of read likelihoods for each haplotype. Haplotypes are given indices when the
+    array is populated, and these stay valid until it is repopulated or cleared, so repeated
+    lookups can avoid hashing haplotypes.
+ 
     The matrix can be efficiently populated as the read mapping and alignment are
-    done internally which allows minimal memory allocation.
+    done internally which allows minimal memory allocation. With a parallel execution
+    policy, large populations are split into (haplotype, sample, read block) shards that
+    are evaluated on the ThreadPool running the populating thread, each worker using its
+    own copy of the likelihood model.
  */
 class HaplotypeLikelihoodArray
 {
 public:
     using FlankState = HaplotypeLikelihoodModel::FlankState;
     
-    using LikelihoodVector     = std::vector<double>;
+    using Likelihood = double;
+    
+    // A read-only view of one haplotype's read likelihoods for one sample
+    class LikelihoodVector
+    {
+    public:
+        using value_type      = Likelihood;
+        using size_type       = std::size_t;
+        using const_reference = const Likelihood&;
+        using reference       = const_reference;
+        using const_iterator  = const Likelihood*;
+        using iterator        = const_iterator;
+        
+        LikelihoodVector() = default;
+        LikelihoodVector(const Likelihood* first, std::size_t size) noexcept : first_ {first}, size_ {size} {}
+        
+        std::size_t size() const noexcept { return size_; }
+        bool empty() const noexcept { return size_ == 0; }
+        const_iterator begin() const noexcept { return first_; }
+        const_iterator end() const noexcept { return first_ + size_; }
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator cend() const noexcept { return end(); }
+        const_reference operator[](std::size_t n) const noexcept { return first_[n]; }
+        const_reference front() const noexcept { return *first_; }
+        const_reference back() const noexcept { return first_[size_ - 1]; }
+        const Likelihood* data() const noexcept { return first_; }
+        
+    private:
+        const Likelihood* first_ = nullptr;
+        std::size_t size_ = 0;
+    };
+    
     using LikelihoodVectorRef  = std::reference_wrapper<const LikelihoodVector>;
     using HaplotypeRef         = std::reference_wrapper<const Haplotype>;
     using SampleLikelihoodMap  = std::unordered_map<HaplotypeRef, LikelihoodVectorRef>;
@@ -42,7 +85,8 @@ public:
     
     HaplotypeLikelihoodArray(HaplotypeLikelihoodModel likelihood_model,
                              unsigned max_haplotypes,
-                             const std::vector<SampleName>& samples);
+                             const std::vector<SampleName>& samples,
+                             ExecutionPolicy execution_policy = ExecutionPolicy::seq);
     
     HaplotypeLikelihoodArray(const HaplotypeLikelihoodArray&)            = default;
     HaplotypeLikelihoodArray& operator=(const HaplotypeLikelihoodArray&) = default;
@@ -59,6 +103,9 @@ public:
     const LikelihoodVector& operator()(const SampleName& sample, const Haplotype& haplotype) const;
     const LikelihoodVector& operator[](const Haplotype& haplotype) const; // when primed with a sample
     
+    std::size_t index_of(const Haplotype& haplotype) const;
+    const LikelihoodVector& operator()(const SampleName& sample, std::size_t haplotype_index) const;
+    
     SampleLikelihoodMap extract_sample(const SampleName& sample) const;
     
     bool contains(const Haplotype& haplotype) const noexcept;
@@ -70,6 +117,8 @@ public:
     
     bool is_empty() const noexcept;
     
+    HaplotypeLikelihoodModel::CacheStatistics cache_statistics() const noexcept;
+    
     void clear() noexcept;
     
     bool is_primed() const noexcept;
@@ -79,8 +128,17 @@ public:
 private:
     static constexpr unsigned char mapperKmerSize {6};
     static constexpr std::size_t maxMappingPositions {10};
+    static constexpr std::size_t minReadsForBatchEvaluation {16};
+    static constexpr std::size_t parallelReadBlockSize {128};
+    static constexpr std::size_t minEvaluationsForParallelPopulate {5'000};
+    static constexpr std::size_t minHaplotypesForRepeatIndex {2};
+    
+    using MappingPositionVector = HaplotypeLikelihoodModel::MappingPositionVector;
     
     HaplotypeLikelihoodModel likelihood_model_;
+    ExecutionPolicy execution_policy_ = ExecutionPolicy::seq;
+    // Copies of likelihood_model_ for the pool workers; the populating thread uses likelihood_model_
+    std::vector<HaplotypeLikelihoodModel> worker_likelihood_models_;
     
     struct ReadPacket
     {
@@ -90,34 +148,90 @@ private:
         std::size_t num_reads;
     };
     
-    std::unordered_map<Haplotype, std::vector<LikelihoodVector>, HaplotypeHash> cache_;
+    // Owns the dense likelihood buffer and the row views into it. The views are rebased when the buffer
+    // is copied or grows, and are held in deques so assign never moves them
+    class LikelihoodMatrix
+    {
+    public:
+        LikelihoodMatrix() = default;
+        
+        LikelihoodMatrix(const LikelihoodMatrix&);
+        LikelihoodMatrix& operator=(const LikelihoodMatrix&);
+        LikelihoodMatrix(LikelihoodMatrix&&)            = default;
+        LikelihoodMatrix& operator=(LikelihoodMatrix&&) = default;
+        
+        ~LikelihoodMatrix() = default;
+        
+        void reset(std::size_t num_haplotypes, const std::vector<std::size_t>& sample_num_reads);
+        void clear() noexcept;
+        
+        const LikelihoodVector& operator()(std::size_t sample, std::size_t haplotype) const;
+        Likelihood* row(std::size_t sample, std::size_t haplotype) noexcept;
+        
+        template <typename InputIt>
+        void assign(std::size_t sample, std::size_t haplotype, InputIt first, InputIt last);
+        
+    private:
+        std::vector<Likelihood> buffer_;
+        std::deque<std::deque<LikelihoodVector>> rows_; // sample x haplotype
+        
+        void rebase(const Likelihood* old_buffer) noexcept;
+    };
+    
+    std::unordered_map<Haplotype, std::size_t, HaplotypeHash> haplotype_indices_;
+    std::size_t next_haplotype_index_ = 0; // erased indices are never reused
     std::unordered_map<SampleName, std::size_t> sample_indices_;
+    LikelihoodMatrix likelihoods_;
     
     mutable boost::optional<std::size_t> primed_sample_;
     
     // Just to optimise population
     std::vector<ReadPacket> read_iterators_;
     std::vector<std::size_t> mapping_positions_;
+    std::vector<MappingPositionVector> read_mapping_positions_;
+    TandemRepeatIndex repeat_index_ {HaplotypeLikelihoodModel::max_repeat_period()};
     
     void set_read_iterators_and_sample_indices(const ReadMap& reads);
+    std::vector<std::reference_wrapper<const Haplotype>> index_haplotypes(const std::vector<Haplotype>& haplotypes);
+    bool use_parallel_populate(const std::vector<std::reference_wrapper<const Haplotype>>& haplotypes) const noexcept;
+    void populate_parallel(const std::vector<std::reference_wrapper<const Haplotype>>& haplotypes,
+                           const std::vector<std::vector<KmerPerfectHashes>>& read_hashes,
+                           boost::optional<FlankState> flank_state);
 };
 
 template <typename S, typename Container>
 void HaplotypeLikelihoodArray::insert(S&& sample, const Haplotype& haplotype,
                                       Container&& likelihoods)
 {
-    sample_indices_.emplace(std::forward<S>(sample), sample_indices_.size());
-    cache_[haplotype].emplace_back(std::forward<Container>(likelihoods));
+    const auto sample_index = sample_indices_.emplace(std::forward<S>(sample), sample_indices_.size()).first->second;
+    const auto p = haplotype_indices_.emplace(haplotype, next_haplotype_index_);
+    if (p.second) ++next_haplotype_index_;
+    const auto haplotype_index = p.first->second;
+    likelihoods_.assign(sample_index, haplotype_index, std::cbegin(likelihoods), std::cend(likelihoods));
 }
 
 template <typename Container>
 void HaplotypeLikelihoodArray::erase(const Container& haplotypes)
 {
+    // The rows of erased haplotypes are left in the buffer so other haplotype indices stay valid
     for (const auto& haplotype : haplotypes) {
-        cache_.erase(haplotype);
+        haplotype_indices_.erase(haplotype);
     }
 }
 
+template <typename InputIt>
+void HaplotypeLikelihoodArray::LikelihoodMatrix::assign(const std::size_t sample, const std::size_t haplotype,
+                                                        InputIt first, InputIt last)
+{
+    if (rows_.size() <= sample) rows_.resize(sample + 1);
+    if (rows_[sample].size() <= haplotype) rows_[sample].resize(haplotype + 1);
+    const auto old_buffer = buffer_.data();
+    const auto offset = buffer_.size();
+    buffer_.insert(std::end(buffer_), first, last);
+    if (buffer_.data() != old_buffer) rebase(old_buffer);
+    rows_[sample][haplotype] = LikelihoodVector {buffer_.data() + offset, buffer_.size() - offset};
+}
+
 // non-member methods
 
 HaplotypeLikelihoodArray merge_samples(const std::vector<SampleName>& samples,
@@ -4,6 +4,7 @@
 #include "haplotype_likelihood_model.hpp"
 
 #include <utility>
+#include <string>
 #include <cmath>
 #include <limits>
 #include <cassert>
@@ -39,12 +40,28 @@ unsigned HaplotypeLikelihoodModel::pad_requirement() noexcept
     return hmm::min_flank_pad();
 }
 
+unsigned HaplotypeLikelihoodModel::max_repeat_period() noexcept
+{
+    return 3; // The error models only distinguish homopolymers, dinucleotide, and trinucleotide repeats
+}
+
 void HaplotypeLikelihoodModel::reset(const Haplotype& haplotype, boost::optional<FlankState> flank_state)
 {
+    // An empty index just finds the repeats of the whole haplotype
+    reset(haplotype, TandemRepeatIndex {max_repeat_period()}, std::move(flank_state));
+}
+
+void HaplotypeLikelihoodModel::reset(const Haplotype& haplotype, const TandemRepeatIndex& repeat_index,
+                                     boost::optional<FlankState> flank_state)
+{
+    assert(repeat_index.max_period() == max_repeat_period());
     haplotype_ = std::addressof(haplotype);
     haplotype_flank_state_ = std::move(flank_state);
+    if (snv_error_model_ || indel_error_model_) {
+        repeat_index.find(haplotype, haplotype_repeats_);
+    }
     if (snv_error_model_) {
-        snv_error_model_->evaluate(haplotype,
+        snv_error_model_->evaluate(haplotype, haplotype_repeats_,
                                    haplotype_snv_forward_mask_, haplotype_snv_forward_priors_,
                                    haplotype_snv_reverse_mask_, haplotype_snv_reverse_priors_);
     } else {
@@ -55,7 +72,7 @@ void HaplotypeLikelihoodModel::reset(const Haplotype& haplotype, boost::optional
         haplotype_snv_reverse_mask_.assign(std::cbegin(haplotype.sequence()), std::cend(haplotype.sequence()));
     }
     if (indel_error_model_) {
-        haplotype_gap_extension_penalty_ = indel_error_model_->evaluate(haplotype, haplotype_gap_open_penalities_);
+        haplotype_gap_extension_penalty_ = indel_error_model_->evaluate(haplotype, haplotype_repeats_, haplotype_gap_open_penalities_);
     }
 }
 
@@ -82,13 +99,19 @@ HaplotypeLikelihoodModel::HaplotypeLikelihoodModel(std::unique_ptr<SnvErrorModel
 , indel_error_model_ {std::move(indel_model)}
 , haplotype_ {nullptr}
 , haplotype_flank_state_ {}
+, haplotype_repeats_ {}
 , haplotype_gap_open_penalities_ {}
 , haplotype_gap_extension_penalty_ {}
 , config_ {config}
+, cache_ {}
+, cache_key_ {}
 {
     if (config_.mapping_quality_cap_trigger && *config_.mapping_quality_cap_trigger >= config_.mapping_quality_cap) {
         config_.mapping_quality_cap_trigger = boost::none;
     }
+    if (config_.max_cache_memory > 0) {
+        cache_ = std::make_unique<ReadLikelihoodCache>(config_.max_cache_memory);
+    }
 }
 
 HaplotypeLikelihoodModel::HaplotypeLikelihoodModel(const HaplotypeLikelihoodModel& other)
@@ -105,6 +128,7 @@ HaplotypeLikelihoodModel::HaplotypeLikelihoodModel(const HaplotypeLikelihoodMode
     }
     haplotype_ = other.haplotype_;
     haplotype_flank_state_ = other.haplotype_flank_state_;
+    haplotype_repeats_ = other.haplotype_repeats_;
     haplotype_snv_forward_mask_ = other.haplotype_snv_forward_mask_;
     haplotype_snv_reverse_mask_ = other.haplotype_snv_reverse_mask_;
     haplotype_snv_forward_priors_ = other.haplotype_snv_forward_priors_;
@@ -112,6 +136,9 @@ HaplotypeLikelihoodModel::HaplotypeLikelihoodModel(const HaplotypeLikelihoodMode
     haplotype_gap_open_penalities_ = other.haplotype_gap_open_penalities_;
     haplotype_gap_extension_penalty_ = other.haplotype_gap_extension_penalty_;
     config_ = other.config_;
+    if (config_.max_cache_memory > 0) {
+        cache_ = std::make_unique<ReadLikelihoodCache>(config_.max_cache_memory); // cached likelihoods are not copied
+    }
 }
 
 HaplotypeLikelihoodModel& HaplotypeLikelihoodModel::operator=(const HaplotypeLikelihoodModel& other)
@@ -130,6 +157,7 @@ void swap(HaplotypeLikelihoodModel& lhs, HaplotypeLikelihoodModel& rhs) noexcept
     swap(lhs.snv_error_model_, rhs.snv_error_model_);
     swap(lhs.haplotype_, rhs.haplotype_);
     swap(lhs.haplotype_flank_state_, rhs.haplotype_flank_state_);
+    swap(lhs.haplotype_repeats_, rhs.haplotype_repeats_);
     swap(lhs.haplotype_snv_forward_mask_, rhs.haplotype_snv_forward_mask_);
     swap(lhs.haplotype_snv_reverse_mask_, rhs.haplotype_snv_reverse_mask_);
     swap(lhs.haplotype_snv_forward_priors_, rhs.haplotype_snv_forward_priors_);
@@ -137,6 +165,7 @@ void swap(HaplotypeLikelihoodModel& lhs, HaplotypeLikelihoodModel& rhs) noexcept
     swap(lhs.haplotype_gap_open_penalities_, rhs.haplotype_gap_open_penalities_);
     swap(lhs.haplotype_gap_extension_penalty_, rhs.haplotype_gap_extension_penalty_);
     swap(lhs.config_, rhs.config_);
+    swap(lhs.cache_, rhs.cache_);
 }
 
 bool HaplotypeLikelihoodModel::can_use_flank_state() const noexcept
@@ -144,6 +173,15 @@ bool HaplotypeLikelihoodModel::can_use_flank_state() const noexcept
     return config_.use_flank_state;
 }
 
+HaplotypeLikelihoodModel::CacheStatistics HaplotypeLikelihoodModel::cache_statistics() const noexcept
+{
+    if (cache_) {
+        return cache_->statistics();
+    } else {
+        return {0, 0};
+    }
+}
+
 double HaplotypeLikelihoodModel::evaluate(const AlignedRead& read) const
 {
     const static MappingPositionVector empty {};
@@ -178,15 +216,15 @@ bool is_in_range(const std::size_t mapping_position, const AlignedRead& read, co
 
 } // namespace
 
-template <typename InputIt>
-double max_score(const AlignedRead& read, const Haplotype& haplotype,
-                 InputIt first_mapping_position, InputIt last_mapping_position,
-                 const hmm::MutationModel& model)
+// Calls f with each position the read should be evaluated at, throwing ShortHaplotypeError if there are none
+template <typename InputIt, typename UnaryFunction>
+void visit_mapping_positions(const AlignedRead& read, const Haplotype& haplotype,
+                             InputIt first_mapping_position, InputIt last_mapping_position,
+                             UnaryFunction f)
 {
     assert(contains(haplotype, read));
     using PositionType = typename std::iterator_traits<InputIt>::value_type;
     const auto original_mapping_position = static_cast<PositionType>(begin_distance(haplotype, read));
-    auto max_log_probability = std::numeric_limits<double>::lowest();
     bool is_original_position_mapped {false}, has_in_range_mapping_position {false};
     std::for_each(first_mapping_position, last_mapping_position, [&] (const auto position) {
         if (position == original_mapping_position) {
@@ -194,15 +232,12 @@ double max_score(const AlignedRead& read, const Haplotype& haplotype,
         }
         if (is_in_range(position, read, haplotype)) {
             has_in_range_mapping_position = true;
-            auto p = hmm::evaluate(read.sequence(), haplotype.sequence(), read.base_qualities(), position, model);
-            max_log_probability = std::max(p, max_log_probability);
+            f(position);
         }
     });
     if (!is_original_position_mapped && is_in_range(original_mapping_position, read, haplotype)) {
         has_in_range_mapping_position = true;
-        auto p = hmm::evaluate(read.sequence(), haplotype.sequence(), read.base_qualities(),
-                               original_mapping_position, model);
-        max_log_probability = std::max(p, max_log_probability);
+        f(original_mapping_position);
     }
     if (!has_in_range_mapping_position) {
         const auto min_shift = num_out_of_range_bases(original_mapping_position, read, haplotype);
@@ -221,13 +256,91 @@ double max_score(const AlignedRead& read, const Haplotype& haplotype,
                 throw HaplotypeLikelihoodModel::ShortHaplotypeError {haplotype, required_extension};
             }
         }
-        max_log_probability = hmm::evaluate(read.sequence(), haplotype.sequence(), read.base_qualities(),
-                                            final_mapping_position, model);
+        f(final_mapping_position);
     }
+}
+
+template <typename InputIt>
+double max_score(const AlignedRead& read, const Haplotype& haplotype,
+                 InputIt first_mapping_position, InputIt last_mapping_position,
+                 const hmm::MutationModel& model)
+{
+    auto max_log_probability = std::numeric_limits<double>::lowest();
+    visit_mapping_positions(read, haplotype, first_mapping_position, last_mapping_position, [&] (const auto position) {
+        auto p = hmm::evaluate(read.sequence(), haplotype.sequence(), read.base_qualities(), position, model);
+        max_log_probability = std::max(p, max_log_probability);
+    });
     assert(max_log_probability > std::numeric_limits<double>::lowest() && max_log_probability <= 0);
     return max_log_probability;
 }
 
+namespace {
+
+template <typename T>
+void append_bytes(const T& value, ReadLikelihoodCache::Key& result)
+{
+    result.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename Container>
+void append_bytes(const Container& values, const long first, const long last, ReadLikelihoodCache::Key& result)
+{
+    append_bytes(last - first, result);
+    result.append(reinterpret_cast<const char*>(values.data() + first), (last - first) * sizeof(values[0]));
+}
+
+} // namespace
+
+// The key encodes everything the pair HMM reads when evaluating the read at the given
+// mapping positions: the read itself, and the haplotype bases, error model penalties and
+// flank boundaries in the smallest window containing every truth span the HMM aligns to.
+// Every variable length field is prefixed with its length so distinct inputs can never
+// have the same encoding.
+template <typename InputIt>
+void make_cache_key(const AlignedRead& read, const Haplotype& haplotype,
+                    InputIt first_mapping_position, InputIt last_mapping_position,
+                    const hmm::MutationModel& model, ReadLikelihoodCache::Key& result)
+{
+    const auto pad = static_cast<long>(hmm::min_flank_pad());
+    const auto read_size = static_cast<long>(sequence_size(read));
+    const auto haplotype_size = static_cast<long>(sequence_size(haplotype));
+    result.clear();
+    append_bytes(read.sequence(), 0, read_size, result);
+    append_bytes(read.base_qualities(), 0, read_size, result);
+    append_bytes(read.is_marked_reverse_mapped(), result);
+    // The truth span the pair HMM aligns against at each position, clamped as the HMM clamps it
+    const auto truth_span_begin = [pad] (const long position) { return std::max(position - pad, 0l); };
+    const auto truth_span_end = [&] (const long position) {
+        return std::min(truth_span_begin(position) + read_size + 2 * pad - 1, haplotype_size);
+    };
+    auto window_begin = std::numeric_limits<long>::max(), window_end = std::numeric_limits<long>::min();
+    long num_positions {0};
+    visit_mapping_positions(read, haplotype, first_mapping_position, last_mapping_position, [&] (const auto position) {
+        window_begin = std::min(window_begin, truth_span_begin(static_cast<long>(position)));
+        window_end = std::max(window_end, truth_span_end(static_cast<long>(position)));
+        ++num_positions;
+    });
+    const auto window_size = window_end - window_begin;
+    append_bytes(haplotype.sequence(), window_begin, window_end, result);
+    append_bytes(model.snv_mask, window_begin, window_end, result);
+    append_bytes(model.snv_priors, window_begin, window_end, result);
+    append_bytes(model.gap_open, window_begin, window_end, result);
+    append_bytes(model.gap_extend, result);
+    append_bytes(model.nuc_prior, result);
+    append_bytes(num_positions, result);
+    visit_mapping_positions(read, haplotype, first_mapping_position, last_mapping_position, [&] (const auto position) {
+        append_bytes(static_cast<long>(position) - window_begin, result);
+    });
+    // Boundaries only matter up to a little beyond the window
+    const auto clamp_to_window = [&] (const long position) {
+        return std::min(std::max(position - window_begin, -2 * pad), window_size + 2 * pad);
+    };
+    append_bytes(clamp_to_window(0), result);
+    append_bytes(clamp_to_window(static_cast<long>(model.lhs_flank_size)), result);
+    append_bytes(clamp_to_window(haplotype_size - static_cast<long>(model.rhs_flank_size)), result);
+    append_bytes(clamp_to_window(haplotype_size), result);
+}
+
 double HaplotypeLikelihoodModel::evaluate(const AlignedRead& read,
                                           MappingPositionItr first_mapping_position,
                                           MappingPositionItr last_mapping_position) const
@@ -235,39 +348,69 @@ double HaplotypeLikelihoodModel::evaluate(const AlignedRead& read,
     if (haplotype_ == nullptr) {
         throw std::runtime_error {"HaplotypeLikelihoodModel: no buffered Haplotype"};
     }
-    const auto is_forward = !read.is_marked_reverse_mapped();
-    hmm::MutationModel model {
-        is_forward ? haplotype_snv_forward_mask_ : haplotype_snv_reverse_mask_,
-        is_forward ? haplotype_snv_forward_priors_ : haplotype_snv_reverse_priors_,
-        haplotype_gap_open_penalities_,
-        haplotype_gap_extension_penalty_
-    };
-    if (haplotype_flank_state_) {
-        model.lhs_flank_size = haplotype_flank_state_->lhs_flank;
-        model.rhs_flank_size = haplotype_flank_state_->rhs_flank;
-    } else {
-        model.lhs_flank_size = 0;
-        model.rhs_flank_size = 0;
+    const auto model = make_mutation_model(read);
+    if (cache_) {
+        make_cache_key(read, *haplotype_, first_mapping_position, last_mapping_position, model, cache_key_);
+        const auto cached_likelihood = cache_->find(cache_key_);
+        if (cached_likelihood) return adjust_for_mapping_quality(read, *cached_likelihood);
     }
     const auto ln_prob_given_mapped = max_score(read, *haplotype_, first_mapping_position, last_mapping_position, model);
-    if (config_.use_mapping_quality) {
-        // This calculation is approximately
-        // p(read | hap) = p(read missmapped) p(read | hap, missmapped)
-        //                  + p(read correctly mapped) p(read | hap, correctly mapped)
-        // = p(read correctly mapped) p(read | hap, correctly mapped)
-        //      + p(read missmapped)
-        // assuming p(read | hap, missmapped) = 1
-        auto mapping_quality = read.mapping_quality();
-        if (config_.mapping_quality_cap_trigger && mapping_quality >= *config_.mapping_quality_cap_trigger) {
-            mapping_quality = config_.mapping_quality_cap;
+    if (cache_) cache_->insert(cache_key_, ln_prob_given_mapped);
+    return adjust_for_mapping_quality(read, ln_prob_given_mapped);
+}
+
+void HaplotypeLikelihoodModel::evaluate(const ReadReferenceVector& reads,
+                                        const std::vector<MappingPositionVector>& mapping_positions,
+                                        std::vector<double>& result) const
+{
+    if (haplotype_ == nullptr) {
+        throw std::runtime_error {"HaplotypeLikelihoodModel: no buffered Haplotype"};
+    }
+    assert(reads.size() == mapping_positions.size());
+    // Forward and reverse reads use different SNV models so must be batched separately
+    std::vector<hmm::Target> forward_targets {}, reverse_targets {};
+    std::vector<std::size_t> forward_read_indices {}, reverse_read_indices {};
+    forward_targets.reserve(reads.size());
+    forward_read_indices.reserve(reads.size());
+    result.assign(reads.size(), std::numeric_limits<double>::lowest());
+    // Only the keys of reads that miss the cache are kept, to be inserted once evaluated
+    std::vector<std::pair<std::size_t, ReadLikelihoodCache::Key>> missed_keys {};
+    for (std::size_t i {0}; i < reads.size(); ++i) {
+        const AlignedRead& read = reads[i];
+        if (cache_) {
+            make_cache_key(read, *haplotype_, std::cbegin(mapping_positions[i]), std::cend(mapping_positions[i]),
+                           make_mutation_model(read), cache_key_);
+            const auto cached_likelihood = cache_->find(cache_key_);
+            if (cached_likelihood) {
+                result[i] = *cached_likelihood;
+                continue;
+            }
+            missed_keys.emplace_back(i, cache_key_);
         }
-        using octopus::maths::constants::ln10Div10;
-        const auto ln_prob_missmapped = -ln10Div10<> * mapping_quality;
-        const auto ln_prob_mapped = std::log(1.0 - std::exp(ln_prob_missmapped));
-        const auto result = maths::log_sum_exp(ln_prob_mapped + ln_prob_given_mapped, ln_prob_missmapped);
-        return result > -1e-15 ? 0.0 : result;
-    } else {
-        return ln_prob_given_mapped  > -1e-15 ? 0.0 : ln_prob_given_mapped;
+        auto& targets = read.is_marked_reverse_mapped() ? reverse_targets : forward_targets;
+        auto& read_indices = read.is_marked_reverse_mapped() ? reverse_read_indices : forward_read_indices;
+        visit_mapping_positions(read, *haplotype_, std::cbegin(mapping_positions[i]), std::cend(mapping_positions[i]),
+                                [&] (const auto position) {
+            targets.push_back({read.sequence(), read.base_qualities(), position});
+            read_indices.push_back(i);
+        });
+    }
+    std::vector<double> likelihoods {};
+    const auto update_max_scores = [&] (const auto& targets, const auto& read_indices, const hmm::MutationModel& model) {
+        if (targets.empty()) return;
+        hmm::evaluate(targets, haplotype_->sequence(), model, likelihoods);
+        for (std::size_t i {0}; i < likelihoods.size(); ++i) {
+            result[read_indices[i]] = std::max(likelihoods[i], result[read_indices[i]]);
+        }
+    };
+    update_max_scores(forward_targets, forward_read_indices, make_mutation_model(true));
+    update_max_scores(reverse_targets, reverse_read_indices, make_mutation_model(false));
+    for (const auto& key : missed_keys) {
+        cache_->insert(key.second, result[key.first]);
+    }
+    for (std::size_t i {0}; i < reads.size(); ++i) {
+        assert(result[i] > std::numeric_limits<double>::lowest() && result[i] <= 0);
+        result[i] = adjust_for_mapping_quality(reads[i], result[i]);
     }
 }
 
@@ -353,19 +496,43 @@ HaplotypeLikelihoodModel::align(const AlignedRead& read, MappingPositionItr firs
     if (haplotype_ == nullptr) {
         throw std::runtime_error {"HaplotypeLikelihoodModel: no buffered Haplotype"};
     }
-    const auto is_forward = !read.is_marked_reverse_mapped();
-    hmm::MutationModel model {is_forward ? haplotype_snv_forward_mask_ : haplotype_snv_reverse_mask_,
-                              is_forward ? haplotype_snv_forward_priors_ : haplotype_snv_reverse_priors_,
-                              haplotype_gap_open_penalities_, haplotype_gap_extension_penalty_};
+    const auto model = make_mutation_model(read);
+    auto result = compute_optimal_alignment(read, *haplotype_, first_mapping_position, last_mapping_position, model);
+    result.likelihood = adjust_for_mapping_quality(read, result.likelihood);
+    return result;
+}
+
+// private methods
+
+hmm::MutationModel HaplotypeLikelihoodModel::make_mutation_model(const bool is_forward) const noexcept
+{
+    hmm::MutationModel result {
+        is_forward ? haplotype_snv_forward_mask_ : haplotype_snv_reverse_mask_,
+        is_forward ? haplotype_snv_forward_priors_ : haplotype_snv_reverse_priors_,
+        haplotype_gap_open_penalities_,
+        haplotype_gap_extension_penalty_
+    };
     if (haplotype_flank_state_) {
-        model.lhs_flank_size = haplotype_flank_state_->lhs_flank;
-        model.rhs_flank_size = haplotype_flank_state_->rhs_flank;
-    } else {
-        model.lhs_flank_size = 0;
-        model.rhs_flank_size = 0;
+        result.lhs_flank_size = haplotype_flank_state_->lhs_flank;
+        result.rhs_flank_size = haplotype_flank_state_->rhs_flank;
     }
-    auto result = compute_optimal_alignment(read, *haplotype_, first_mapping_position, last_mapping_position, model);
+    return result;
+}
+
+hmm::MutationModel HaplotypeLikelihoodModel::make_mutation_model(const AlignedRead& read) const noexcept
+{
+    return make_mutation_model(!read.is_marked_reverse_mapped());
+}
+
+double HaplotypeLikelihoodModel::adjust_for_mapping_quality(const AlignedRead& read, const double ln_prob_given_mapped) const
+{
     if (config_.use_mapping_quality) {
+        // This calculation is approximately
+        // p(read | hap) = p(read missmapped) p(read | hap, missmapped)
+        //                  + p(read correctly mapped) p(read | hap, correctly mapped)
+        // = p(read correctly mapped) p(read | hap, correctly mapped)
+        //      + p(read missmapped)
+        // assuming p(read | hap, missmapped) = 1
         auto mapping_quality = read.mapping_quality();
         if (config_.mapping_quality_cap_trigger && mapping_quality >= *config_.mapping_quality_cap_trigger) {
             mapping_quality = config_.mapping_quality_cap;
@@ -373,12 +540,11 @@ HaplotypeLikelihoodModel::align(const AlignedRead& read, MappingPositionItr firs
         using octopus::maths::constants::ln10Div10;
         const auto ln_prob_missmapped = -ln10Div10<> * mapping_quality;
         const auto ln_prob_mapped = std::log(1.0 - std::exp(ln_prob_missmapped));
-        result.likelihood = maths::log_sum_exp(ln_prob_mapped + result.likelihood, ln_prob_missmapped);
-        result.likelihood = result.likelihood > -1e-15 ? 0.0 : result.likelihood;
+        const auto result = maths::log_sum_exp(ln_prob_mapped + ln_prob_given_mapped, ln_prob_missmapped);
+        return result > -1e-15 ? 0.0 : result;
     } else {
-        result.likelihood = result.likelihood > -1e-15 ? 0.0 : result.likelihood;
+        return ln_prob_given_mapped  > -1e-15 ? 0.0 : ln_prob_given_mapped;
     }
-    return result;
 }
 
 HaplotypeLikelihoodModel make_haplotype_likelihood_model(const std::string sequencer, bool use_mapping_quality)
@@ -12,6 +12,7 @@
 #include <type_traits>
 #include <limits>
 #include <array>
+#include <tuple>
 #include <cassert>
 #include <iostream>
 
@@ -117,6 +118,47 @@ CigarString make_cigar(const std::vector<char>& align1, const std::vector<char>&
     return result;
 }
 
+int calculate_flank_score(const std::string& truth, const std::string& target,
+                          const std::int8_t* qualities,
+                          const int alignment_offset, const int truth_alignment_size,
+                          const MutationModel& model,
+                          const int first_pos, const char* align1, const char* align2) noexcept
+{
+    const auto truth_size  = static_cast<int>(truth.size());
+    const auto target_size = static_cast<int>(target.size());
+    auto lhs_flank_size = static_cast<int>(model.lhs_flank_size);
+    if (lhs_flank_size < alignment_offset) {
+        lhs_flank_size = 0;
+    } else {
+        lhs_flank_size -= alignment_offset;
+        if (lhs_flank_size < 0) lhs_flank_size = 0;
+    }
+    auto rhs_flank_size = static_cast<int>(model.rhs_flank_size);
+    if (alignment_offset + truth_alignment_size < truth_size - rhs_flank_size) {
+        rhs_flank_size = 0;
+    } else {
+        rhs_flank_size += alignment_offset + truth_alignment_size;
+        rhs_flank_size -= truth_size;
+        if (rhs_flank_size < 0) rhs_flank_size = 0;
+    }
+    assert(lhs_flank_size >= 0 && rhs_flank_size >= 0);
+    int target_mask_size;
+    auto flank_score = simd::calculate_flank_score(truth_alignment_size,
+                                                   lhs_flank_size, rhs_flank_size,
+                                                   target.data(), qualities,
+                                                   model.snv_mask.data() + alignment_offset,
+                                                   model.snv_priors.data() + alignment_offset,
+                                                   model.gap_open.data() + alignment_offset,
+                                                   model.gap_extend, model.nuc_prior,
+                                                   first_pos,
+                                                   align1, align2,
+                                                   target_mask_size);
+    const auto num_explained_bases = target_size - target_mask_size;
+    constexpr int min_explained_bases {2};
+    if (num_explained_bases < min_explained_bases) flank_score = 0;
+    return flank_score;
+}
+
 auto simd_align(const std::string& truth, const std::string& target,
                 const std::vector<std::uint8_t>& target_qualities,
                 const std::size_t target_offset,
@@ -161,37 +203,9 @@ auto simd_align(const std::string& truth, const std::string& target,
         if (first_pos == -1) {
             return std::numeric_limits<double>::lowest(); // overflow
         }
-        auto lhs_flank_size = static_cast<int>(model.lhs_flank_size);
-        if (lhs_flank_size < alignment_offset) {
-            lhs_flank_size = 0;
-        } else {
-            lhs_flank_size -= alignment_offset;
-            if (lhs_flank_size < 0) lhs_flank_size = 0;
-        }
-        auto rhs_flank_size = static_cast<int>(model.rhs_flank_size);
-        if (alignment_offset + truth_alignment_size < truth_size - rhs_flank_size) {
-            rhs_flank_size = 0;
-        } else {
-            rhs_flank_size += alignment_offset + truth_alignment_size;
-            rhs_flank_size -= truth_size;
-            if (rhs_flank_size < 0) rhs_flank_size = 0;
-        }
-        assert(lhs_flank_size >= 0 && rhs_flank_size >= 0);
         assert(align1.back() == 0); // required by calculate_flank_score
-        int target_mask_size;
-        auto flank_score = simd::calculate_flank_score(truth_alignment_size,
-                                                       lhs_flank_size, rhs_flank_size,
-                                                       target.data(), qualities,
-                                                       model.snv_mask.data() + alignment_offset,
-                                                       model.snv_priors.data() + alignment_offset,
-                                                       model.gap_open.data() + alignment_offset,
-                                                       model.gap_extend, model.nuc_prior,
-                                                       first_pos,
-                                                       align1.data(), align2.data(),
-                                                       target_mask_size);
-        const auto num_explained_bases = target_size - target_mask_size;
-        constexpr int min_explained_bases {2};
-        if (num_explained_bases < min_explained_bases) flank_score = 0;
+        const auto flank_score = calculate_flank_score(truth, target, qualities, alignment_offset, truth_alignment_size,
+                                                       model, first_pos, align1.data(), align2.data());
         //assert(flank_score <= score);
         if (flank_score <= score) {
             return -ln10Div10<> * static_cast<double>(score - flank_score);
@@ -240,37 +254,9 @@ simd_align(const std::string& truth, const std::string& target,
         throw HMMOverflow {target, truth};
     }
     if (use_adjusted_alignment_score(truth, target, target_offset, model)) {
-        auto lhs_flank_size = static_cast<int>(model.lhs_flank_size);
-        if (lhs_flank_size < alignment_offset) {
-            lhs_flank_size = 0;
-        } else {
-            lhs_flank_size -= alignment_offset;
-            if (lhs_flank_size < 0) lhs_flank_size = 0;
-        }
-        auto rhs_flank_size = static_cast<int>(model.rhs_flank_size);
-        if (alignment_offset + truth_alignment_size < truth_size - rhs_flank_size) {
-            rhs_flank_size = 0;
-        } else {
-            rhs_flank_size += alignment_offset + truth_alignment_size;
-            rhs_flank_size -= truth_size;
-            if (rhs_flank_size < 0) rhs_flank_size = 0;
-        }
-        assert(lhs_flank_size >= 0 && rhs_flank_size >= 0);
         assert(align1.back() == 0); // required by calculate_flank_score
-        int target_mask_size;
-        auto flank_score = simd::calculate_flank_score(truth_alignment_size,
-                                                       lhs_flank_size, rhs_flank_size,
-                                                       target.data(), qualities,
-                                                       model.snv_mask.data() + alignment_offset,
-                                                       model.snv_priors.data() + alignment_offset,
-                                                       model.gap_open.data() + alignment_offset,
-                                                       model.gap_extend, model.nuc_prior,
-                                                       first_pos,
-                                                       align1.data(), align2.data(),
-                                                       target_mask_size);
-        const auto num_explained_bases = target_size - target_mask_size;
-        constexpr int min_explained_bases {2};
-        if (num_explained_bases < min_explained_bases) flank_score = 0;
+        const auto flank_score = calculate_flank_score(truth, target, qualities, alignment_offset, truth_alignment_size,
+                                                       model, first_pos, align1.data(), align2.data());
         if (flank_score <= score) {
             score -= flank_score;
         } else {
@@ -309,18 +295,22 @@ void validate(const std::string& truth, const std::string& target,
     }
 }
 
-double evaluate(const std::string& target, const std::string& truth,
-                const std::vector<std::uint8_t>& target_qualities,
-                const std::size_t target_offset,
-                const MutationModel& model)
+namespace {
+
+// Returns false if a full alignment is needed to evaluate the target
+bool evaluate_without_alignment(const std::string& target, const std::string& truth,
+                                const std::vector<std::uint8_t>& target_qualities,
+                                const std::size_t target_offset,
+                                const MutationModel& model,
+                                double& result) noexcept
 {
     using std::cbegin; using std::cend; using std::next; using std::distance;
     static constexpr auto lnProbability = make_phred_to_ln_prob_lookup<std::uint8_t>();
-    validate(truth, target, target_qualities, target_offset, model);
     const auto offsetted_truth_begin_itr = next(cbegin(truth), target_offset);
     const auto m1 = std::mismatch(cbegin(target), cend(target), offsetted_truth_begin_itr);
     if (m1.first == cend(target)) {
-        return 0; // sequences are equal, can't do better than this
+        result = 0;
+        return true; // sequences are equal, can't do better than this
     }
     const auto m2 = std::mismatch(next(m1.first), cend(target), next(m1.second));
     if (m2.first == cend(target)) {
@@ -329,7 +319,8 @@ double evaluate(const std::string& target, const std::string& truth,
         // truth:  ACGTTCGT
         const auto truth_mismatch_idx = distance(offsetted_truth_begin_itr, m1.second) + target_offset;
         if (truth_mismatch_idx < model.lhs_flank_size || truth_mismatch_idx >= (truth.size() - model.rhs_flank_size)) {
-            return 0;
+            result = 0;
+            return true;
         }
         const auto target_index = distance(cbegin(target), m1.first);
         auto mispatch_penalty = target_qualities[target_index];
@@ -338,25 +329,168 @@ double evaluate(const std::string& target, const std::string& truth,
                                         static_cast<std::uint8_t>(model.snv_priors[truth_mismatch_idx]));
         }
         if (mispatch_penalty <= model.gap_open[truth_mismatch_idx]) {
-            return lnProbability[mispatch_penalty];
+            result = lnProbability[mispatch_penalty];
+            return true;
         } else {
             if (std::equal(next(m1.first), cend(target), m1.second)) {
                 // target: AAAAGGGG
                 // truth:  AAA GGGGG
-                return lnProbability[model.gap_open[truth_mismatch_idx]];
+                result = lnProbability[model.gap_open[truth_mismatch_idx]];
+                return true;
             } else if (std::equal(m1.first, cend(target), next(m1.second))) {
                 // target: AAA GGGGG
                 // truth:  AAAAGGGGG
-                return lnProbability[model.gap_open[truth_mismatch_idx]];
+                result = lnProbability[model.gap_open[truth_mismatch_idx]];
+                return true;
             } else if (mispatch_penalty <= (model.gap_open[truth_mismatch_idx] + model.gap_extend)) {
-                return lnProbability[mispatch_penalty];
+                result = lnProbability[mispatch_penalty];
+                return true;
             }
         }
     }
+    return false;
+}
+
+} // namespace
+
+double evaluate(const std::string& target, const std::string& truth,
+                const std::vector<std::uint8_t>& target_qualities,
+                const std::size_t target_offset,
+                const MutationModel& model)
+{
+    validate(truth, target, target_qualities, target_offset, model);
+    double result;
+    if (evaluate_without_alignment(target, truth, target_qualities, target_offset, model, result)) {
+        return result;
+    }
     // TODO: we should be able to optimise the alignment based of the first mismatch postition
     return simd_align(truth, target, target_qualities, target_offset, model);
 }
 
+namespace {
+
+struct PendingAlignment
+{
+    std::size_t index;
+    int target_size, alignment_offset;
+    bool use_adjusted_score;
+};
+
+using PendingAlignmentIterator = std::vector<PendingAlignment>::const_iterator;
+
+// All pending alignments in the range must have the same target size and adjustment requirement
+void simd_align(const std::vector<Target>& targets, const std::string& truth,
+                const MutationModel& model,
+                const PendingAlignmentIterator first, const PendingAlignmentIterator last,
+                std::vector<double>& result)
+{
+    constexpr auto pad = simd::min_flank_pad();
+    const auto num_alignments = static_cast<int>(std::distance(first, last));
+    const auto target_size = first->target_size;
+    const auto truth_alignment_size = static_cast<int>(target_size + 2 * pad - 1);
+    thread_local std::vector<const char*> truths {}, sequences {}, snv_masks {};
+    thread_local std::vector<const std::int8_t*> qualities {}, snv_priors {}, gap_opens {};
+    thread_local std::vector<int> scores {};
+    truths.clear(); sequences.clear(); snv_masks.clear();
+    qualities.clear(); snv_priors.clear(); gap_opens.clear();
+    std::for_each(first, last, [&] (const PendingAlignment& alignment) {
+        const auto& target = targets[alignment.index];
+        truths.push_back(truth.data() + alignment.alignment_offset);
+        sequences.push_back(target.sequence.data());
+        qualities.push_back(reinterpret_cast<const std::int8_t*>(target.qualities.data()));
+        snv_masks.push_back(model.snv_mask.data() + alignment.alignment_offset);
+        snv_priors.push_back(model.snv_priors.data() + alignment.alignment_offset);
+        gap_opens.push_back(model.gap_open.data() + alignment.alignment_offset);
+    });
+    scores.resize(num_alignments);
+    if (!first->use_adjusted_score) {
+        simd::align(truths.data(), sequences.data(), qualities.data(),
+                    truth_alignment_size, target_size, num_alignments,
+                    snv_masks.data(), snv_priors.data(), gap_opens.data(),
+                    model.gap_extend, model.nuc_prior,
+                    scores.data());
+        for (int i {0}; i < num_alignments; ++i) {
+            result[std::next(first, i)->index] = -ln10Div10<> * static_cast<double>(scores[i]);
+        }
+    } else {
+        const auto max_alignment_size = static_cast<std::size_t>(2 * (target_size + pad));
+        thread_local std::vector<char> align1 {}, align2 {};
+        thread_local std::vector<char*> align1_ptrs {}, align2_ptrs {};
+        thread_local std::vector<int> first_positions {};
+        align1.assign(num_alignments * (max_alignment_size + 1), 0);
+        align2.assign(num_alignments * (max_alignment_size + 1), 0);
+        align1_ptrs.resize(num_alignments);
+        align2_ptrs.resize(num_alignments);
+        first_positions.resize(num_alignments);
+        for (int i {0}; i < num_alignments; ++i) {
+            align1_ptrs[i] = align1.data() + i * (max_alignment_size + 1);
+            align2_ptrs[i] = align2.data() + i * (max_alignment_size + 1);
+        }
+        simd::align(truths.data(), sequences.data(), qualities.data(),
+                    truth_alignment_size, target_size, num_alignments,
+                    snv_masks.data(), snv_priors.data(), gap_opens.data(),
+                    model.gap_extend, model.nuc_prior,
+                    scores.data(), first_positions.data(), align1_ptrs.data(), align2_ptrs.data());
+        for (int i {0}; i < num_alignments; ++i) {
+            const auto& alignment = *std::next(first, i);
+            if (first_positions[i] == -1) {
+                result[alignment.index] = std::numeric_limits<double>::lowest(); // overflow
+                continue;
+            }
+            const auto& target = targets[alignment.index];
+            const auto flank_score = calculate_flank_score(truth, target.sequence, qualities[i],
+                                                           alignment.alignment_offset, truth_alignment_size,
+                                                           model, first_positions[i], align1_ptrs[i], align2_ptrs[i]);
+            if (flank_score <= scores[i]) {
+                result[alignment.index] = -ln10Div10<> * static_cast<double>(scores[i] - flank_score);
+            } else {
+                // Overflow has occurred when calculating score;
+                result[alignment.index] = -ln10Div10<> * (flank_score + scores[i]);
+            }
+        }
+    }
+}
+
+} // namespace
+
+void evaluate(const std::vector<Target>& targets, const std::string& truth,
+              const MutationModel& model,
+              std::vector<double>& result)
+{
+    constexpr auto pad = simd::min_flank_pad();
+    const auto truth_size = static_cast<int>(truth.size());
+    result.resize(targets.size());
+    thread_local std::vector<PendingAlignment> pending {};
+    pending.clear();
+    for (std::size_t i {0}; i < targets.size(); ++i) {
+        const auto& target = targets[i];
+        validate(truth, target.sequence, target.qualities, target.offset, model);
+        if (!evaluate_without_alignment(target.sequence, truth, target.qualities, target.offset, model, result[i])) {
+            const auto target_size = static_cast<int>(target.sequence.size());
+            const auto truth_alignment_size = static_cast<int>(target_size + 2 * pad - 1);
+            const auto alignment_offset = std::max(0, static_cast<int>(target.offset) - pad);
+            if (alignment_offset + truth_alignment_size > truth_size) {
+                result[i] = std::numeric_limits<double>::lowest();
+            } else {
+                const auto use_adjusted_score = use_adjusted_alignment_score(truth, target.sequence, target.offset, model);
+                pending.push_back({i, target_size, alignment_offset, use_adjusted_score});
+            }
+        }
+    }
+    const auto requires_same_alignment = [] (const PendingAlignment& lhs, const PendingAlignment& rhs) noexcept {
+        return lhs.target_size == rhs.target_size && lhs.use_adjusted_score == rhs.use_adjusted_score;
+    };
+    std::sort(std::begin(pending), std::end(pending), [] (const PendingAlignment& lhs, const PendingAlignment& rhs) noexcept {
+        return std::tie(lhs.target_size, lhs.use_adjusted_score) < std::tie(rhs.target_size, rhs.use_adjusted_score);
+    });
+    for (auto first = std::cbegin(pending), last = std::cend(pending); first != last;) {
+        const auto batch_last = std::find_if_not(std::next(first), last,
+                                                 [&] (const auto& alignment) { return requires_same_alignment(*first, alignment); });
+        simd_align(targets, truth, model, first, batch_last, result);
+        first = batch_last;
+    }
+}
+
 Alignment&
 align(const std::string& target, const std::string& truth,
       const std::vector<std::uint8_t>& target_qualities,
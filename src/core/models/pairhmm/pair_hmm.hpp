@@ -92,6 +92,20 @@ double evaluate(const std::string& target, const std::string& truth,
                 std::size_t target_offset,
                 const MutationModel& model);
 
+struct Target
+{
+    const std::string& sequence;
+    const std::vector<std::uint8_t>& qualities;
+    std::size_t offset;
+};
+
+// Batched version of the above. Each likelihood is identical to evaluating the
+// target individually, but targets of equal length are aligned together so the
+// SIMD registers are fully used.
+void evaluate(const std::vector<Target>& targets, const std::string& truth,
+              const MutationModel& model,
+              std::vector<double>& result);
+
 Alignment&
 align(const std::string& target, const std::string& truth,
       const std::vector<std::uint8_t>& target_qualities,
@@ -45,6 +45,53 @@ int align(const char* truth, const char* target, const std::int8_t* qualities,
           const std::int8_t* gap_open, short gap_extend, short nuc_prior,
           char* aln1, char* aln2, int& first_pos) noexcept;
 
+// Batched versions of the above align overloads. Each aligns the num_alignments targets
+// against the corresponding truths, writing the scores to scores. All targets must be
+// target_len long and all truths truth_len long. Alignments are packed into the widest
+// SIMD registers supported by the host CPU, one band per 128-bit lane, so the results
+// are identical to aligning each target individually.
+
+int max_batch_size() noexcept;
+
+void align(const char* const* truths, const char* const* targets, const std::int8_t* const* qualities,
+           int truth_len, int target_len, int num_alignments,
+           short gap_open, short gap_extend, short nuc_prior,
+           int* scores) noexcept;
+
+void align(const char* const* truths, const char* const* targets, const std::int8_t* const* qualities,
+           int truth_len, int target_len, int num_alignments,
+           const std::int8_t* const* gap_open, short gap_extend, short nuc_prior,
+           int* scores) noexcept;
+
+void align(const char* const* truths, const char* const* targets, const std::int8_t* const* qualities,
+           int truth_len, int target_len, int num_alignments,
+           const std::int8_t* const* gap_open, const std::int8_t* const* gap_extend,
+           short nuc_prior,
+           int* scores) noexcept;
+
+void align(const char* const* truths, const char* const* targets, const std::int8_t* const* qualities,
+           int truth_len, int target_len, int num_alignments,
+           const std::int8_t* const* gap_open, const std::int8_t* const* gap_extend,
+           short nuc_prior,
+           int* scores, int* first_pos, char* const* aln1, char* const* aln2) noexcept;
+
+void align(const char* const* truths, const char* const* targets, const std::int8_t* const* qualities,
+           int truth_len, int target_len, int num_alignments,
+           const char* const* snv_mask, const std::int8_t* const* snv_prior,
+           const std::int8_t* const* gap_open, short gap_extend, short nuc_prior,
+           int* scores) noexcept;
+
+void align(const char* const* truths, const char* const* targets, const std::int8_t* const* qualities,
+           int truth_len, int target_len, int num_alignments,
+           const std::int8_t* const* gap_open, short gap_extend, short nuc_prior,
+           int* scores, int* first_pos, char* const* aln1, char* const* aln2) noexcept;
+
+void align(const char* const* truths, const char* const* targets, const std::int8_t* const* qualities,
+           int truth_len, int target_len, int num_alignments,
+           const char* const* snv_mask, const std::int8_t* const* snv_prior,
+           const std::int8_t* const* gap_open, short gap_extend, short nuc_prior,
+           int* scores, int* first_pos, char* const* aln1, char* const* aln2) noexcept;
+
 int calculate_flank_score(int truth_len, int lhs_flank_len, int rhs_flank_len,
                           const char* target, const std::int8_t* quals,
                           const char* snv_mask, const std::int8_t* snv_prior,
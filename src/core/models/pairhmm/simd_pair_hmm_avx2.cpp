@@ -0,0 +1,84 @@
+// Copyright (c) 2015-2018 Daniel Cooke and Gerton Lunter
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#if __GNUC__ >= 6
+    #pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
+
+#include <immintrin.h>
+
+#define OCTOPUS_PAIR_HMM_TARGET __attribute__((target("avx2")))
+
+#include "simd_pair_hmm_impl.hpp"
+
+namespace octopus { namespace hmm { namespace simd { namespace avx2 {
+
+namespace {
+
+// Holds two band 8 alignments, one in each 128-bit lane. The AVX2 byte shifts operate on
+// each 128-bit lane independently, which is exactly what the band shifts require.
+struct InstructionSet
+{
+    using Vector = __m256i;
+    
+    static constexpr int batch_size {avx2::batch_size()};
+    
+    OCTOPUS_PAIR_HMM_TARGET static Vector set1(const short a) noexcept { return _mm256_set1_epi16(a); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector set2(const short a, const short b) noexcept
+    {
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_set1_epi16(a)), _mm_set1_epi16(b), 1);
+    }
+    OCTOPUS_PAIR_HMM_TARGET static Vector load(const short* values) noexcept
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const Vector*>(values));
+    }
+    OCTOPUS_PAIR_HMM_TARGET static void store(short* result, const Vector a) noexcept
+    {
+        _mm256_storeu_si256(reinterpret_cast<Vector*>(result), a);
+    }
+    OCTOPUS_PAIR_HMM_TARGET static Vector add(const Vector a, const Vector b) noexcept { return _mm256_add_epi16(a, b); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector min(const Vector a, const Vector b) noexcept { return _mm256_min_epi16(a, b); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector cmpeq(const Vector a, const Vector b) noexcept { return _mm256_cmpeq_epi16(a, b); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector bit_and(const Vector a, const Vector b) noexcept { return _mm256_and_si256(a, b); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector bit_andnot(const Vector a, const Vector b) noexcept { return _mm256_andnot_si256(a, b); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector bit_or(const Vector a, const Vector b) noexcept { return _mm256_or_si256(a, b); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector shift_bits_left(const Vector a, const int n) noexcept { return _mm256_slli_epi16(a, n); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector shift_bits_right(const Vector a, const int n) noexcept { return _mm256_srli_epi16(a, n); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector shift_left(const Vector a) noexcept { return _mm256_slli_si256(a, 2); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector shift_right(const Vector a) noexcept { return _mm256_srli_si256(a, 2); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector insert_front(const Vector a, const short value) noexcept
+    {
+        return _mm256_blend_epi16(a, _mm256_set1_epi16(value), 0x01);
+    }
+    OCTOPUS_PAIR_HMM_TARGET static Vector insert_front(const Vector a, const short* values) noexcept
+    {
+        return _mm256_blend_epi16(a, set2(values[0], values[1]), 0x01);
+    }
+    OCTOPUS_PAIR_HMM_TARGET static Vector insert_back(const Vector a, const short value) noexcept
+    {
+        return _mm256_blend_epi16(a, _mm256_set1_epi16(value), 0x80);
+    }
+    OCTOPUS_PAIR_HMM_TARGET static Vector insert_back(const Vector a, const short* values) noexcept
+    {
+        return _mm256_blend_epi16(a, set2(values[0], values[1]), 0x80);
+    }
+    OCTOPUS_PAIR_HMM_TARGET static void extract(const Vector a, const int index, short* result) noexcept
+    {
+        short values[16];
+        store(values, a);
+        result[0] = values[index];
+        result[1] = values[8 + index];
+    }
+};
+
+} // namespace
+
+void align(const AlignmentBatch& batch, int* scores, const AlignmentTraceback* traceback) noexcept
+{
+    simd::align<InstructionSet>(batch, scores, traceback);
+}
+
+} // namespace avx2
+} // namespace simd
+} // namespace hmm
+} // namespace octopus
@@ -0,0 +1,88 @@
+// Copyright (c) 2015-2018 Daniel Cooke and Gerton Lunter
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#if __GNUC__ >= 6
+    #pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
+#if defined(__GNUC__) && !defined(__clang__)
+    // GCC's own AVX-512 intrinsics use deliberately uninitialised operands
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include <immintrin.h>
+
+#define OCTOPUS_PAIR_HMM_TARGET __attribute__((target("avx512bw")))
+
+#include "simd_pair_hmm_impl.hpp"
+
+namespace octopus { namespace hmm { namespace simd { namespace avx512 {
+
+namespace {
+
+// Holds four band 8 alignments, one in each 128-bit lane. As with AVX2, the AVX-512 byte
+// shifts operate on each 128-bit lane independently.
+struct InstructionSet
+{
+    using Vector = __m512i;
+    
+    static constexpr int batch_size {avx512::batch_size()};
+    static constexpr __mmask32 front_mask {0x01010101}, back_mask {0x80808080};
+    
+    OCTOPUS_PAIR_HMM_TARGET static Vector set1(const short a) noexcept { return _mm512_set1_epi16(a); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector load(const short* values) noexcept { return _mm512_loadu_si512(values); }
+    OCTOPUS_PAIR_HMM_TARGET static void store(short* result, const Vector a) noexcept { _mm512_storeu_si512(result, a); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector add(const Vector a, const Vector b) noexcept { return _mm512_add_epi16(a, b); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector min(const Vector a, const Vector b) noexcept { return _mm512_min_epi16(a, b); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector cmpeq(const Vector a, const Vector b) noexcept
+    {
+        return _mm512_movm_epi16(_mm512_cmpeq_epi16_mask(a, b));
+    }
+    OCTOPUS_PAIR_HMM_TARGET static Vector bit_and(const Vector a, const Vector b) noexcept { return _mm512_and_si512(a, b); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector bit_andnot(const Vector a, const Vector b) noexcept { return _mm512_andnot_si512(a, b); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector bit_or(const Vector a, const Vector b) noexcept { return _mm512_or_si512(a, b); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector shift_bits_left(const Vector a, const int n) noexcept { return _mm512_slli_epi16(a, n); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector shift_bits_right(const Vector a, const int n) noexcept { return _mm512_srli_epi16(a, n); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector shift_left(const Vector a) noexcept { return _mm512_bslli_epi128(a, 2); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector shift_right(const Vector a) noexcept { return _mm512_bsrli_epi128(a, 2); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector insert(Vector a, const short* values, const __mmask32 mask) noexcept
+    {
+        a = _mm512_mask_set1_epi16(a, mask & 0x000000FF, values[0]);
+        a = _mm512_mask_set1_epi16(a, mask & 0x0000FF00, values[1]);
+        a = _mm512_mask_set1_epi16(a, mask & 0x00FF0000, values[2]);
+        return _mm512_mask_set1_epi16(a, mask & 0xFF000000, values[3]);
+    }
+    OCTOPUS_PAIR_HMM_TARGET static Vector insert_front(const Vector a, const short value) noexcept
+    {
+        return _mm512_mask_set1_epi16(a, front_mask, value);
+    }
+    OCTOPUS_PAIR_HMM_TARGET static Vector insert_front(const Vector a, const short* values) noexcept
+    {
+        return insert(a, values, front_mask);
+    }
+    OCTOPUS_PAIR_HMM_TARGET static Vector insert_back(const Vector a, const short value) noexcept
+    {
+        return _mm512_mask_set1_epi16(a, back_mask, value);
+    }
+    OCTOPUS_PAIR_HMM_TARGET static Vector insert_back(const Vector a, const short* values) noexcept
+    {
+        return insert(a, values, back_mask);
+    }
+    OCTOPUS_PAIR_HMM_TARGET static void extract(const Vector a, const int index, short* result) noexcept
+    {
+        short values[32];
+        store(values, a);
+        for (int k {0}; k < batch_size; ++k) result[k] = values[8 * k + index];
+    }
+};
+
+} // namespace
+
+void align(const AlignmentBatch& batch, int* scores, const AlignmentTraceback* traceback) noexcept
+{
+    simd::align<InstructionSet>(batch, scores, traceback);
+}
+
+} // namespace avx512
+} // namespace simd
+} // namespace hmm
+} // namespace octopus
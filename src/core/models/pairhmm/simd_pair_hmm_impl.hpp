@@ -0,0 +1,390 @@
+// Copyright (c) 2015-2018 Daniel Cooke and Gerton Lunter
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+// Instruction set independent implementation of the banded pair HMM.
+//
+// This header is only meant to be included by the instruction set specific translation
+// units (simd_pair_hmm_sse2.cpp etc). Each must first define OCTOPUS_PAIR_HMM_TARGET (the
+// function target attribute for the instruction set) and a wrapper type providing the
+// vector operations used here, and then instantiate the kernels with align<Wrapper>.
+// Everything is given internal linkage so that instantiations compiled for different
+// targets can never be merged by the linker.
+
+#ifndef simd_pair_hmm_impl_hpp
+#define simd_pair_hmm_impl_hpp
+
+#include <cstdint>
+#include <array>
+#include <algorithm>
+#include <cassert>
+
+#include <boost/container/small_vector.hpp>
+
+#include "simd_pair_hmm_kernels.hpp"
+
+#ifndef OCTOPUS_PAIR_HMM_TARGET
+    #error "OCTOPUS_PAIR_HMM_TARGET must be defined before including simd_pair_hmm_impl.hpp"
+#endif
+
+namespace octopus { namespace hmm { namespace simd {
+
+namespace {
+
+constexpr std::size_t staticBackpointerCapacity {10000};
+
+template <typename T>
+using SmallVector = boost::container::small_vector<T, staticBackpointerCapacity>;
+
+constexpr short nScore {2 << 2};
+constexpr int bandSize {8};
+constexpr short inf {0x7800};
+constexpr char gap {'-'};
+
+constexpr int matchLabel  {0};
+constexpr int insertLabel {1};
+constexpr int deleteLabel {3};
+
+template <typename InstructionSet, typename F>
+OCTOPUS_PAIR_HMM_TARGET
+typename InstructionSet::Vector make_window(F f) noexcept
+{
+    constexpr int numLanes {InstructionSet::batch_size * bandSize};
+    short values[numLanes];
+    for (int k {0}; k < InstructionSet::batch_size; ++k) {
+        for (int j {0}; j < bandSize; ++j) {
+            values[k * bandSize + j] = f(k, j);
+        }
+    }
+    return InstructionSet::load(values);
+}
+
+int traceback(const short* backpointers, const int stride, const int offset,
+              const char* truth, const char* target, const int target_len,
+              const short minscore, const int minscoreidx,
+              int& first_pos, char* aln1, char* aln2) noexcept
+{
+    if (minscoreidx < 0) {
+        // minscore was never updated so we must have overflowed badly
+        first_pos = -1;
+        return -1;
+    }
+    const auto backpointer = [=] (const int s, const int i) noexcept { return backpointers[s * stride + offset + i]; };
+    auto s      = minscoreidx; // point to the dummy match transition
+    auto i      = s / 2 - target_len;
+    auto y      = target_len;
+    auto x      = s - y;
+    auto alnidx = 0;
+    auto state  = (backpointer(s, i) >> (2 * matchLabel)) & 3;
+    s -= 2;
+    // this is 2*y (s even) or 2*y+1 (s odd)
+    while (y > 0) {
+        if (s < 0 || i < 0) {
+            // This should never happen so must have overflowed
+            first_pos = -1;
+            return -1;
+        }
+        const auto new_state = (backpointer(s, i) >> (2 * state)) & 3;
+        if (state == matchLabel) {
+            s -= 2;
+            aln1[alnidx] = truth[--x];
+            aln2[alnidx] = target[--y];
+        } else if (state == insertLabel) {
+            i += s & 1;
+            s -= 1;
+            aln1[alnidx] = gap;
+            aln2[alnidx] = target[--y];
+        } else {
+            s -= 1;
+            i -= s & 1;
+            aln1[alnidx] = truth[--x];
+            aln2[alnidx] = gap;
+        }
+        state = new_state;
+        alnidx++;
+    }
+    aln1[alnidx] = 0;
+    aln2[alnidx] = 0;
+    first_pos = x;
+    std::reverse(aln1, aln1 + alnidx);
+    std::reverse(aln2, aln2 + alnidx);
+    return (minscore + 0x8000) >> 2;
+}
+
+template <typename InstructionSet, bool SnvMask>
+OCTOPUS_PAIR_HMM_TARGET
+typename InstructionSet::Vector
+match_penalty(const typename InstructionSet::Vector& _targetwin, const typename InstructionSet::Vector& _truthwin,
+              const typename InstructionSet::Vector& _qualitieswin, const typename InstructionSet::Vector& _truthnqual,
+              const typename InstructionSet::Vector& _snvmaskwin, const typename InstructionSet::Vector& _snv_priorwin) noexcept
+{
+    using ISA = InstructionSet;
+    if (SnvMask) {
+        const auto _snvmask = ISA::cmpeq(_targetwin, _snvmaskwin);
+        return ISA::min(ISA::bit_andnot(ISA::cmpeq(_targetwin, _truthwin),
+                                        ISA::min(_qualitieswin,
+                                                 ISA::bit_or(ISA::bit_and(_snvmask, _snv_priorwin),
+                                                             ISA::bit_andnot(_snvmask, _qualitieswin)))),
+                        _truthnqual);
+    } else {
+        return ISA::min(ISA::bit_andnot(ISA::cmpeq(_targetwin, _truthwin), _qualitieswin), _truthnqual);
+    }
+}
+
+template <typename InstructionSet>
+OCTOPUS_PAIR_HMM_TARGET
+void store_backpointers(const typename InstructionSet::Vector& _m, const typename InstructionSet::Vector& _i,
+                        const typename InstructionSet::Vector& _d, const typename InstructionSet::Vector& _three,
+                        short* result) noexcept
+{
+    using ISA = InstructionSet;
+    ISA::store(result, ISA::bit_or(ISA::bit_or(ISA::bit_and(_three, _m),
+                                               ISA::shift_bits_left(ISA::bit_and(_three, _i), 2 * insertLabel)),
+                                   ISA::shift_bits_left(ISA::bit_and(_three, _d), 2 * deleteLabel)));
+}
+
+template <typename InstructionSet>
+OCTOPUS_PAIR_HMM_TARGET
+void update_minscores(const typename InstructionSet::Vector& _m, const int i, const int s, const int num_alignments,
+                      short* minscore, int* minscoreidx) noexcept
+{
+    short values[InstructionSet::batch_size];
+    // The final iteration refers one past the end of the band, which is clamped to the last element
+    InstructionSet::extract(_m, std::min(i, bandSize - 1), values);
+    for (int k {0}; k < num_alignments; ++k) {
+        if (values[k] < minscore[k]) {
+            minscore[k] = values[k];
+            minscoreidx[k] = s;
+        }
+    }
+}
+
+// Aligns up to InstructionSet::batch_size alignments of the batch, starting at first.
+//
+// target is the read; the shorter of the sequences
+// no checks for overflow are done
+//
+// the bottom-left and top-right corners of the DP table are just
+// included at the extreme ends of the diagonal, which measures
+// n=8 entries diagonally across.  This fixes the length of the
+// longer (horizontal) sequence to 15 (2*8-1) more than the shorter
+//
+// the << 2's are because the lower two bits are reserved for back tracing
+template <typename InstructionSet, bool VariableGapOpen, bool VariableGapExtend, bool SnvMask, bool Traceback>
+OCTOPUS_PAIR_HMM_TARGET
+void align(const AlignmentBatch& batch, const int first, int* scores, const AlignmentTraceback* tb) noexcept
+{
+    using ISA    = InstructionSet;
+    using Vector = typename ISA::Vector;
+    constexpr int batchSize {ISA::batch_size};
+    constexpr int numLanes  {batchSize * bandSize};
+
+    const int truth_len {batch.truth_len}, target_len {batch.target_len};
+    assert(truth_len > bandSize && (truth_len == target_len + 2 * bandSize - 1));
+    assert(first < batch.size);
+
+    // Any spare band groups just repeat the last alignment; their results are discarded
+    const int num_alignments {std::min(batchSize, batch.size - first)};
+    const char* truths[batchSize];
+    const char* targets[batchSize];
+    const std::int8_t* qualities[batchSize];
+    const char* snv_masks[batchSize] {};
+    const std::int8_t* snv_priors[batchSize] {};
+    const std::int8_t* gap_opens[batchSize] {};
+    const std::int8_t* gap_extends[batchSize] {};
+    for (int k {0}; k < batchSize; ++k) {
+        const auto idx = first + std::min(k, num_alignments - 1);
+        truths[k]    = batch.truths[idx];
+        targets[k]   = batch.targets[idx];
+        qualities[k] = batch.qualities[idx];
+        if (SnvMask) {
+            snv_masks[k]  = batch.snv_masks[idx];
+            snv_priors[k] = batch.snv_priors[idx];
+        }
+        if (VariableGapOpen) gap_opens[k] = batch.gap_opens[idx];
+        if (VariableGapExtend) gap_extends[k] = batch.gap_extends[idx];
+    }
+    const auto gap_open_penalty = [&] (const int k, const int pos) noexcept -> short {
+        return (VariableGapOpen ? gap_opens[k][pos] : batch.gap_open) << 2;
+    };
+    const auto gap_extend_penalty = [&] (const int k, const int pos) noexcept -> short {
+        return (VariableGapExtend ? gap_extends[k][pos] : batch.gap_extend) << 2;
+    };
+
+    Vector _m1 {ISA::set1(inf)};
+    auto _i1 = _m1;
+    auto _d1 = _m1;
+    auto _m2 = _m1;
+    auto _i2 = _m1;
+    auto _d2 = _m1;
+
+    const Vector _nuc_prior {ISA::set1(batch.nuc_prior << 2)};
+    const Vector _three {ISA::set1(3)};
+
+    Vector _initmask  {make_window<ISA>([] (int, int j) noexcept -> short { return j == 0 ? -1 : 0; })};
+    Vector _initmask2 {make_window<ISA>([] (int, int j) noexcept -> short { return j == 0 ? -0x8000 : 0; })};
+
+    // truth is initialized with the n-long prefix, in forward direction
+    // target is initialized as empty; reverse direction
+    Vector _truthwin     {make_window<ISA>([&] (int k, int j) noexcept -> short { return truths[k][j]; })};
+    Vector _targetwin    {_m1};
+    Vector _qualitieswin {ISA::set1(64 << 2)};
+
+    // if N, make nScore; if != N, make inf
+    Vector _truthnqual {ISA::add(ISA::bit_and(ISA::cmpeq(_truthwin, ISA::set1('N')), ISA::set1(nScore - inf)),
+                                 ISA::set1(inf))};
+
+    Vector _gap_open   {make_window<ISA>(gap_open_penalty)};
+    Vector _gap_extend {make_window<ISA>(gap_extend_penalty)};
+
+    Vector _snvmaskwin {_m1}, _snv_priorwin {_m1};
+    if (SnvMask) {
+        _snvmaskwin   = make_window<ISA>([&] (int k, int j) noexcept -> short { return snv_masks[k][j]; });
+        _snv_priorwin = make_window<ISA>([&] (int k, int j) noexcept -> short { return snv_priors[k][j] << 2; });
+    }
+
+    SmallVector<short> _backpointers(Traceback ? 2 * (truth_len + bandSize) * numLanes : 0);
+
+    std::array<short, batchSize> minscore;
+    std::array<int, batchSize> minscoreidx;
+    minscore.fill(inf);
+    minscoreidx.fill(-1);
+    short values[batchSize];
+
+    // main loop.  Do one extra iteration, with nucs from sequence 2 just moved out
+    // of the targetwin/qual arrays, to simplify getting back pointers
+    for (int s {0}; s <= 2 * (target_len + bandSize); s += 2) {
+        // truth is current; target needs updating
+        _targetwin    = ISA::shift_left(_targetwin);
+        _qualitieswin = ISA::shift_left(_qualitieswin);
+
+        if (s / 2 < target_len) {
+            for (int k {0}; k < batchSize; ++k) values[k] = targets[k][s / 2];
+            _targetwin = ISA::insert_front(_targetwin, values);
+            for (int k {0}; k < batchSize; ++k) values[k] = qualities[k][s / 2] << 2;
+            _qualitieswin = ISA::insert_front(_qualitieswin, values);
+        } else {
+            _targetwin    = ISA::insert_front(_targetwin, '0');
+            _qualitieswin = ISA::insert_front(_qualitieswin, 64 << 2);
+        }
+
+        // S even
+        _m1 = ISA::bit_or(_initmask2, ISA::bit_andnot(_initmask, _m1));
+        _m2 = ISA::bit_or(_initmask2, ISA::bit_andnot(_initmask, _m2));
+        _m1 = ISA::min(_m1, ISA::min(_i1, _d1));
+
+        // at this point, extract minimum score.  Referred-to position must
+        // be y==target_len-1, so that current position has y==target_len; i==0 so d=0 and y=s/2
+        if (s / 2 >= target_len) {
+            // point back to the match state at this entry, so as not to have to store the state at s-2
+            update_minscores<ISA>(_m1, s / 2 - target_len, s, num_alignments, minscore.data(), minscoreidx.data());
+        }
+
+        _m1 = ISA::add(_m1, match_penalty<ISA, SnvMask>(_targetwin, _truthwin, _qualitieswin, _truthnqual, _snvmaskwin, _snv_priorwin));
+        _d1 = ISA::min(ISA::add(_d2, _gap_extend),
+                       ISA::add(ISA::min(_m2, _i2), ISA::shift_right(_gap_open))); // allow I->D
+        _d1 = ISA::insert_front(ISA::shift_left(_d1), inf);
+        _i1 = ISA::add(ISA::min(ISA::add(_i2, _gap_extend), ISA::add(_m2, _gap_open)), _nuc_prior);
+
+        if (Traceback) {
+            store_backpointers<ISA>(_m1, _i1, _d1, _three, _backpointers.data() + s * numLanes);
+            // set state labels
+            _m1 = ISA::bit_andnot(_three, _m1);
+            _i1 = ISA::bit_or(ISA::bit_andnot(_three, _i1), ISA::shift_bits_right(_three, 1));
+            _d1 = ISA::bit_or(ISA::bit_andnot(_three, _d1), _three);
+        }
+
+        // S odd
+        // truth needs updating; target is current
+        const auto pos = bandSize + s / 2;
+        for (int k {0}; k < batchSize; ++k) values[k] = pos < truth_len ? truths[k][pos] : 'N';
+        _truthwin = ISA::insert_back(ISA::shift_right(_truthwin), values);
+        for (int k {0}; k < batchSize; ++k) values[k] = values[k] == 'N' ? nScore : inf;
+        _truthnqual = ISA::insert_back(ISA::shift_right(_truthnqual), values);
+        if (SnvMask) {
+            for (int k {0}; k < batchSize; ++k) values[k] = pos < truth_len ? snv_masks[k][pos] : 'N';
+            _snvmaskwin = ISA::insert_back(ISA::shift_right(_snvmaskwin), values);
+            for (int k {0}; k < batchSize; ++k) values[k] = (pos < truth_len ? snv_priors[k][pos] : inf) << 2;
+            _snv_priorwin = ISA::insert_back(ISA::shift_right(_snv_priorwin), values);
+        }
+        const auto gap_idx = pos < truth_len ? pos : truth_len - 1;
+        if (VariableGapOpen) {
+            for (int k {0}; k < batchSize; ++k) values[k] = gap_open_penalty(k, gap_idx);
+            _gap_open = ISA::insert_back(ISA::shift_right(_gap_open), values);
+        }
+        if (VariableGapExtend) {
+            for (int k {0}; k < batchSize; ++k) values[k] = gap_extend_penalty(k, gap_idx);
+            _gap_extend = ISA::insert_back(ISA::shift_right(_gap_extend), values);
+        }
+
+        _initmask  = ISA::shift_left(_initmask);
+        _initmask2 = ISA::shift_left(_initmask2);
+
+        _m2 = ISA::min(_m2, ISA::min(_i2, _d2));
+
+        if (s / 2 >= target_len) {
+            update_minscores<ISA>(_m2, s / 2 - target_len, s + 1, num_alignments, minscore.data(), minscoreidx.data());
+        }
+
+        _m2 = ISA::add(_m2, match_penalty<ISA, SnvMask>(_targetwin, _truthwin, _qualitieswin, _truthnqual, _snvmaskwin, _snv_priorwin));
+        _d2 = ISA::min(ISA::add(_d1, _gap_extend),
+                       ISA::add(ISA::min(_m1, _i1), _gap_open)); // allow I->D
+        _i2 = ISA::insert_back(ISA::add(ISA::min(ISA::add(ISA::shift_right(_i1), _gap_extend),
+                                                 ISA::add(ISA::shift_right(_m1), _gap_open)),
+                                        _nuc_prior), inf);
+
+        if (Traceback) {
+            store_backpointers<ISA>(_m2, _i2, _d2, _three, _backpointers.data() + (s + 1) * numLanes);
+            // set state labels
+            _m2 = ISA::bit_andnot(_three, _m2);
+            _i2 = ISA::bit_or(ISA::bit_andnot(_three, _i2), ISA::shift_bits_right(_three, 1));
+            _d2 = ISA::bit_or(ISA::bit_andnot(_three, _d2), _three);
+        }
+    }
+
+    for (int k {0}; k < num_alignments; ++k) {
+        if (Traceback) {
+            scores[first + k] = traceback(_backpointers.data(), numLanes, k * bandSize,
+                                          truths[k], targets[k], target_len,
+                                          minscore[k], minscoreidx[k],
+                                          tb->first_pos[first + k], tb->aln1[first + k], tb->aln2[first + k]);
+        } else {
+            scores[first + k] = (minscore[k] + 0x8000) >> 2;
+        }
+    }
+}
+
+template <typename InstructionSet, bool VariableGapOpen, bool VariableGapExtend, bool SnvMask>
+void align(const AlignmentBatch& batch, int* scores, const AlignmentTraceback* traceback) noexcept
+{
+    for (int first {0}; first < batch.size; first += InstructionSet::batch_size) {
+        if (traceback) {
+            align<InstructionSet, VariableGapOpen, VariableGapExtend, SnvMask, true>(batch, first, scores, traceback);
+        } else {
+            align<InstructionSet, VariableGapOpen, VariableGapExtend, SnvMask, false>(batch, first, scores, traceback);
+        }
+    }
+}
+
+template <typename InstructionSet>
+void align(const AlignmentBatch& batch, int* scores, const AlignmentTraceback* traceback) noexcept
+{
+    if (batch.snv_masks) {
+        assert(batch.gap_opens && !batch.gap_extends);
+        align<InstructionSet, true, false, true>(batch, scores, traceback);
+    } else if (batch.gap_extends) {
+        assert(batch.gap_opens);
+        align<InstructionSet, true, true, false>(batch, scores, traceback);
+    } else if (batch.gap_opens) {
+        align<InstructionSet, true, false, false>(batch, scores, traceback);
+    } else {
+        align<InstructionSet, false, false, false>(batch, scores, traceback);
+    }
+}
+
+} // namespace
+
+} // namespace simd
+} // namespace hmm
+} // namespace octopus
+
+#endif
@@ -0,0 +1,61 @@
+// Copyright (c) 2015-2018 Daniel Cooke and Gerton Lunter
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef simd_pair_hmm_kernels_hpp
+#define simd_pair_hmm_kernels_hpp
+
+#include <cstdint>
+
+namespace octopus { namespace hmm { namespace simd {
+
+// A set of equal length alignments to be computed together. Penalty arrays that are null
+// are replaced by the corresponding flat penalty.
+struct AlignmentBatch
+{
+    const char* const* truths;
+    const char* const* targets;
+    const std::int8_t* const* qualities;
+    int truth_len, target_len, size;
+    const char* const* snv_masks = nullptr;
+    const std::int8_t* const* snv_priors = nullptr;
+    const std::int8_t* const* gap_opens = nullptr;
+    const std::int8_t* const* gap_extends = nullptr;
+    short gap_open = 0, gap_extend = 0, nuc_prior = 0;
+};
+
+struct AlignmentTraceback
+{
+    int* first_pos;
+    char* const* aln1;
+    char* const* aln2;
+};
+
+// Instruction set specific kernels. Each packs batch_size() band 8 alignments into one
+// register (one per 128-bit lane), so all produce identical results. The traceback is
+// optional.
+namespace sse2 {
+
+constexpr int batch_size() noexcept { return 1; }
+void align(const AlignmentBatch& batch, int* scores, const AlignmentTraceback* traceback) noexcept;
+
+} // namespace sse2
+
+namespace avx2 {
+
+constexpr int batch_size() noexcept { return 2; }
+void align(const AlignmentBatch& batch, int* scores, const AlignmentTraceback* traceback) noexcept;
+
+} // namespace avx2
+
+namespace avx512 {
+
+constexpr int batch_size() noexcept { return 4; }
+void align(const AlignmentBatch& batch, int* scores, const AlignmentTraceback* traceback) noexcept;
+
+} // namespace avx512
+
+} // namespace simd
+} // namespace hmm
+} // namespace octopus
+
+#endif
@@ -0,0 +1,86 @@
+// Copyright (c) 2015-2018 Daniel Cooke and Gerton Lunter
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#if __GNUC__ >= 6
+    #pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
+
+#include <emmintrin.h>
+
+#define OCTOPUS_PAIR_HMM_TARGET __attribute__((target("sse2")))
+
+#include "simd_pair_hmm_impl.hpp"
+
+namespace octopus { namespace hmm { namespace simd { namespace sse2 {
+
+namespace {
+
+struct InstructionSet
+{
+    using Vector = __m128i;
+    
+    static constexpr int batch_size {sse2::batch_size()};
+    
+    OCTOPUS_PAIR_HMM_TARGET static Vector set1(const short a) noexcept { return _mm_set1_epi16(a); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector load(const short* values) noexcept
+    {
+        return _mm_loadu_si128(reinterpret_cast<const Vector*>(values));
+    }
+    OCTOPUS_PAIR_HMM_TARGET static void store(short* result, const Vector a) noexcept
+    {
+        _mm_storeu_si128(reinterpret_cast<Vector*>(result), a);
+    }
+    OCTOPUS_PAIR_HMM_TARGET static Vector add(const Vector a, const Vector b) noexcept { return _mm_add_epi16(a, b); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector min(const Vector a, const Vector b) noexcept { return _mm_min_epi16(a, b); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector cmpeq(const Vector a, const Vector b) noexcept { return _mm_cmpeq_epi16(a, b); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector bit_and(const Vector a, const Vector b) noexcept { return _mm_and_si128(a, b); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector bit_andnot(const Vector a, const Vector b) noexcept { return _mm_andnot_si128(a, b); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector bit_or(const Vector a, const Vector b) noexcept { return _mm_or_si128(a, b); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector shift_bits_left(const Vector a, const int n) noexcept { return _mm_slli_epi16(a, n); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector shift_bits_right(const Vector a, const int n) noexcept { return _mm_srli_epi16(a, n); }
+    // Shifts each band towards the back by one element
+    OCTOPUS_PAIR_HMM_TARGET static Vector shift_left(const Vector a) noexcept { return _mm_slli_si128(a, 2); }
+    // Shifts each band towards the front by one element
+    OCTOPUS_PAIR_HMM_TARGET static Vector shift_right(const Vector a) noexcept { return _mm_srli_si128(a, 2); }
+    OCTOPUS_PAIR_HMM_TARGET static Vector insert_front(const Vector a, const short value) noexcept
+    {
+        return _mm_insert_epi16(a, value, 0);
+    }
+    OCTOPUS_PAIR_HMM_TARGET static Vector insert_front(const Vector a, const short* values) noexcept
+    {
+        return _mm_insert_epi16(a, values[0], 0);
+    }
+    OCTOPUS_PAIR_HMM_TARGET static Vector insert_back(const Vector a, const short value) noexcept
+    {
+        return _mm_insert_epi16(a, value, 7);
+    }
+    OCTOPUS_PAIR_HMM_TARGET static Vector insert_back(const Vector a, const short* values) noexcept
+    {
+        return _mm_insert_epi16(a, values[0], 7);
+    }
+    OCTOPUS_PAIR_HMM_TARGET static void extract(const Vector a, const int index, short* result) noexcept
+    {
+        switch (index) {
+            case 0:  result[0] = _mm_extract_epi16(a, 0); break;
+            case 1:  result[0] = _mm_extract_epi16(a, 1); break;
+            case 2:  result[0] = _mm_extract_epi16(a, 2); break;
+            case 3:  result[0] = _mm_extract_epi16(a, 3); break;
+            case 4:  result[0] = _mm_extract_epi16(a, 4); break;
+            case 5:  result[0] = _mm_extract_epi16(a, 5); break;
+            case 6:  result[0] = _mm_extract_epi16(a, 6); break;
+            default: result[0] = _mm_extract_epi16(a, 7); break;
+        }
+    }
+};
+
+} // namespace
+
+void align(const AlignmentBatch& batch, int* scores, const AlignmentTraceback* traceback) noexcept
+{
+    simd::align<InstructionSet>(batch, scores, traceback);
+}
+
+} // namespace sse2
+} // namespace simd
+} // namespace hmm
+} // namespace octopus
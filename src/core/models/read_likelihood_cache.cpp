@@ -0,0 +1,93 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "read_likelihood_cache.hpp"
+
+#include <iterator>
+
+namespace octopus {
+
+namespace {
+
+// Approximate heap usage of an entry: a hash map node and bucket, a list node, and the key bytes
+std::size_t entry_footprint(const ReadLikelihoodCache::Key& key) noexcept
+{
+    return sizeof(ReadLikelihoodCache::Key) + sizeof(double) + 4 * sizeof(void*) + sizeof(std::size_t)
+           + 3 * sizeof(void*) + key.capacity();
+}
+
+} // namespace
+
+ReadLikelihoodCache::ReadLikelihoodCache(const std::size_t max_memory_bytes)
+: max_memory_ {max_memory_bytes}
+, memory_ {0}
+, entries_ {}
+, recently_used_ {}
+{}
+
+std::size_t ReadLikelihoodCache::max_memory() const noexcept
+{
+    return max_memory_;
+}
+
+std::size_t ReadLikelihoodCache::memory() const noexcept
+{
+    return memory_;
+}
+
+std::size_t ReadLikelihoodCache::size() const noexcept
+{
+    return entries_.size();
+}
+
+boost::optional<double> ReadLikelihoodCache::find(const Key& key)
+{
+    ++lookups_;
+    const auto itr = entries_.find(key);
+    if (itr == std::cend(entries_)) return boost::none;
+    ++hits_;
+    recently_used_.splice(std::begin(recently_used_), recently_used_, itr->second.recency);
+    return itr->second.likelihood;
+}
+
+void ReadLikelihoodCache::insert(const Key& key, const double likelihood)
+{
+    auto itr = entries_.find(key);
+    if (itr != std::end(entries_)) {
+        itr->second.likelihood = likelihood;
+        recently_used_.splice(std::begin(recently_used_), recently_used_, itr->second.recency);
+        return;
+    }
+    Key stored_key {key}; // shrinks capacity to the key size
+    const auto footprint = entry_footprint(stored_key);
+    if (footprint > max_memory_) return;
+    while (memory_ + footprint > max_memory_) evict_least_recently_used();
+    itr = entries_.emplace(std::move(stored_key), Entry {likelihood, {}}).first;
+    recently_used_.push_front(&itr->first);
+    itr->second.recency = std::begin(recently_used_);
+    memory_ += footprint;
+}
+
+ReadLikelihoodCache::Statistics ReadLikelihoodCache::statistics() const noexcept
+{
+    return {hits_, lookups_};
+}
+
+void ReadLikelihoodCache::clear() noexcept
+{
+    entries_.clear();
+    recently_used_.clear();
+    memory_ = 0;
+}
+
+// private methods
+
+void ReadLikelihoodCache::evict_least_recently_used()
+{
+    const auto itr = entries_.find(*recently_used_.back());
+    memory_ -= entry_footprint(itr->first);
+    recently_used_.pop_back();
+    entries_.erase(itr);
+}
+
+} // namespace octopus
@@ -0,0 +1,79 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef read_likelihood_cache_hpp
+#define read_likelihood_cache_hpp
+
+#include <cstddef>
+#include <string>
+#include <list>
+#include <unordered_map>
+
+#include <boost/optional.hpp>
+
+namespace octopus {
+
+/*
+    ReadLikelihoodCache is a bounded least-recently-used store of p(read | haplotype)
+    for reads evaluated against local haplotype sequence. A key is a byte string encoding
+    the read and everything the pair HMM sees around the read's mapping window. Keys are
+    stored and compared in full, so a hit means the alignment computation would be repeated
+    exactly; hash collisions only cost a comparison.
+ */
+class ReadLikelihoodCache
+{
+public:
+    using Key = std::string;
+
+    struct Statistics
+    {
+        std::size_t hits, lookups;
+    };
+
+    ReadLikelihoodCache() = default;
+
+    ReadLikelihoodCache(std::size_t max_memory_bytes);
+
+    ReadLikelihoodCache(const ReadLikelihoodCache&)            = delete;
+    ReadLikelihoodCache& operator=(const ReadLikelihoodCache&) = delete;
+    ReadLikelihoodCache(ReadLikelihoodCache&&)                 = default;
+    ReadLikelihoodCache& operator=(ReadLikelihoodCache&&)      = default;
+
+    ~ReadLikelihoodCache() = default;
+
+    std::size_t max_memory() const noexcept;
+    std::size_t memory() const noexcept;
+    std::size_t size() const noexcept;
+
+    boost::optional<double> find(const Key& key);
+
+    void insert(const Key& key, double likelihood);
+
+    Statistics statistics() const noexcept;
+
+    void clear() noexcept;
+
+private:
+    struct Entry;
+
+    using EntryMap = std::unordered_map<Key, Entry>;
+    // Pointers to map keys stay valid when the map rehashes, unlike iterators
+    using RecencyList = std::list<const Key*>;
+
+    struct Entry
+    {
+        double likelihood;
+        RecencyList::iterator recency;
+    };
+
+    std::size_t max_memory_ = 0, memory_ = 0;
+    EntryMap entries_;
+    RecencyList recently_used_;
+    std::size_t hits_ = 0, lookups_ = 0;
+
+    void evict_least_recently_used();
+};
+
+} // namespace octopus
+
+#endif
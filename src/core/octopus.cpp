@@ -19,6 +19,7 @@
 #include <condition_variable>
 #include <mutex>
 #include <atomic>
+#include <exception>
 #include <chrono>
 #include <sstream>
 #include <iostream>
@@ -39,6 +40,7 @@
 #include "utils/mappable_algorithms.hpp"
 #include "utils/read_stats.hpp"
 #include "utils/append.hpp"
+#include "utils/repeat_finder.hpp"
 #include "config/octopus_vcf.hpp"
 #include "core/callers/caller_factory.hpp"
 #include "core/callers/caller.hpp"
@@ -49,15 +51,16 @@
 #include "core/tools/vcf_header_factory.hpp"
 #include "io/variant/vcf.hpp"
 #include "utils/timing.hpp"
+#include "utils/thread_pool.hpp"
+#include "utils/profiler.hpp"
 #include "exceptions/program_error.hpp"
 #include "csr/filters/variant_call_filter.hpp"
 #include "csr/filters/variant_call_filter_factory.hpp"
 #include "readpipe/buffered_read_pipe.hpp"
 #include "core/tools/bam_realigner.hpp"
+#include "core/tools/likelihood_sidecar.hpp"
 #include "core/tools/indel_profiler.hpp"
 
-#include "timers.hpp" // BENCHMARK
-
 namespace octopus {
 
 using logging::get_debug_log;
@@ -145,10 +148,28 @@ auto get_call_types(const GenomeCallingComponents& components, const std::vector
     return result;
 }
 
+// The fused filter only needs the reads of each calling task, so it doesn't need a big read buffer
+auto make_fused_call_filter(const GenomeCallingComponents& components, VcfHeader calling_header)
+{
+    BufferedReadPipe buffered_rp {components.filter_read_pipe(), BufferedReadPipe::Config {0}};
+    VariantCallFilter::OutputOptions output_config {};
+    if (components.sites_only()) {
+        output_config.emit_sites_only = true;
+    }
+    return components.call_filter_factory().make(components.reference(), std::move(buffered_rp), std::move(calling_header),
+                                                 components.ploidies(), components.pedigree(), output_config);
+}
+
 void write_caller_output_header(GenomeCallingComponents& components, const std::string& command)
 {
     const auto call_types = get_call_types(components, components.contigs());
-    if (components.sites_only() && !apply_csr(components)) {
+    if (components.is_call_filtering_fused()) {
+        auto calling_header = make_vcf_header(components.samples(), components.contigs(),
+                                              components.reference(), call_types, command);
+        auto filter = make_fused_call_filter(components, calling_header);
+        components.output() << filter->make_header(calling_header);
+        components.set_fused_call_filter(std::move(filter));
+    } else if (components.sites_only() && !apply_csr(components)) {
         components.output() << make_vcf_header({}, components.contigs(), components.reference(),
                                                call_types, command);
     } else {
@@ -242,10 +263,40 @@ void log_finish_info(const GenomeCallingComponents& components, const utils::Tim
     if (output_path) stream(info_log) << "Calls have been written to " << *output_path;
 }
 
+std::deque<VcfRecord> filter(const std::deque<VcfRecord>& calls, const VariantCallFilter& filter,
+                             const ReadPipe& read_pipe, const std::vector<SampleName>& samples)
+{
+    profiling::Scope scope {"filter"};
+    ReadMap reads {};
+    if (filter.requires_reads()) {
+        reads = read_pipe.fetch_reads(encompassing_region(calls));
+    }
+    return filter.filter(calls, samples, reads);
+}
+
+std::deque<VcfRecord> call(const GenomicRegion& region, const ContigCallingComponents& components)
+{
+    profiling::Scope scope {"task", region};
+    return components.caller->call(region, components.progress_meter);
+}
+
+// If call filtering is fused then calls are filtered as soon as connecting calls are resolved, while
+// the region's reads are still likely to be cached, rather than in a separate pass over the whole
+// call set after calling. Filtering before resolution would filter calls spanning a task boundary in
+// pieces, and could remove a piece before it is merged.
+void filter_resolved(std::deque<VcfRecord>& calls, const ContigCallingComponents& components)
+{
+    if (components.call_filter && !calls.empty()) {
+        calls = filter(calls, *components.call_filter, components.filter_read_pipe, components.samples);
+    }
+}
+
 void write_calls(std::deque<VcfRecord>&& calls, VcfWriter& out)
 {
     static auto debug_log = get_debug_log();
     if (debug_log) stream(*debug_log) << "Writing " << calls.size() << " calls to output";
+    profiling::Scope scope {"write"};
+    profiling::count("calls", calls.size());
     write(calls, out);
     calls.clear();
     calls.shrink_to_fit();
@@ -298,6 +349,81 @@ auto propose_call_subregion(const ContigCallingComponents& components,
     return propose_call_subregion(components, right_overhang_region(input_region, current_subregion), min_size);
 }
 
+// Task cost model
+//
+// Calling time is dominated by the number of reads in a region, but some reads generate many more
+// candidates and haplotypes than others. Tasks are therefore cut so each has roughly the same
+// predicted cost, where the cost of a read is inflated if it starts in or near a tandem repeat, or if
+// its alignment has an insertion, deletion or soft clip, a cheap proxy for candidate density. The
+// reference repeat scan is only done on the head of very large windows, so reads beyond that are
+// costed as if in unique sequence, although gapped reads are still costed everywhere.
+//
+// The factors are rough estimates of the relative work per read, not fitted to calling times.
+
+struct TaskCostModel
+{
+    double repeat_read_cost_factor = 3.0;
+    GenomicRegion::Size repeat_read_flank = 150;
+    double gapped_read_cost_factor = 2.0;
+    GenomicRegion::Size max_repeat_scan_size = 1'000'000;
+};
+
+auto find_costed_repeat_regions(const ContigCallingComponents& components, const GenomicRegion& region,
+                                const TaskCostModel& model)
+{
+    if (size(region) > model.max_repeat_scan_size) {
+        return find_repeat_regions(components.reference, expand_rhs(head_region(region), model.max_repeat_scan_size));
+    } else {
+        return find_repeat_regions(components.reference, region);
+    }
+}
+
+auto propose_task_subregion(const ContigCallingComponents& components,
+                            const GenomicRegion& remaining_call_region,
+                            const GenomicRegion::Size min_size,
+                            const TaskCostModel model = TaskCostModel {})
+{
+    const auto max_window = propose_call_subregion(components, remaining_call_region, min_size);
+    if (size(max_window) <= min_size) return max_window;
+    const auto& rm = components.read_manager.get();
+    ReadManager::PositionList gapped_read_positions {};
+    const auto read_positions = rm.extract_read_positions(components.samples, max_window, components.read_buffer_size,
+                                                          gapped_read_positions);
+    if (read_positions.empty()) return max_window;
+    const auto repeats = find_costed_repeat_regions(components, max_window, model);
+    if (repeats.empty() && gapped_read_positions.empty()) return max_window;
+    const auto max_cost = static_cast<double>(components.read_buffer_size);
+    const auto min_end = max_window.begin() + min_size;
+    double cost {0};
+    auto repeat_itr = std::cbegin(repeats);
+    auto gapped_itr = std::cbegin(gapped_read_positions);
+    for (const auto position : read_positions) {
+        while (repeat_itr != std::cend(repeats) && repeat_itr->end() <= position) ++repeat_itr;
+        cost += 1;
+        if (repeat_itr != std::cend(repeats) && position + model.repeat_read_flank >= repeat_itr->begin()) {
+            cost += model.repeat_read_cost_factor;
+        }
+        // Both lists are sorted, and each gapped read is also in read_positions
+        if (gapped_itr != std::cend(gapped_read_positions) && *gapped_itr == position) {
+            cost += model.gapped_read_cost_factor;
+            ++gapped_itr;
+        }
+        if (cost > max_cost && position > min_end) {
+            return GenomicRegion {max_window.contig_name(), max_window.begin(), position};
+        }
+    }
+    return max_window;
+}
+
+auto propose_task_subregion(const ContigCallingComponents& components,
+                            const GenomicRegion& current_subregion,
+                            const GenomicRegion& input_region,
+                            const GenomicRegion::Size min_size)
+{
+    assert(contains(input_region, current_subregion));
+    return propose_task_subregion(components, right_overhang_region(input_region, current_subregion), min_size);
+}
+
 void buffer_connecting_calls(std::deque<VcfRecord>& calls,
                              const GenomicRegion& next_calling_region,
                              std::vector<VcfRecord>& buffer)
@@ -357,7 +483,7 @@ void resolve_connecting_calls(std::vector<VcfRecord>& old_connecting_calls,
             const auto unresolved_region = encompassing_region(merged_calls);
             merged_calls.clear();
             merged_calls.shrink_to_fit();
-            auto new_calls = components.caller->call(unresolved_region, components.progress_meter);
+            auto new_calls = call(unresolved_region, components);
             // TODO: we need to make sure the new calls don't contain any calls
             // outside the unresolved_region, and also possibly adjust phase regions
             // in calls past unresolved_region.
@@ -386,7 +512,7 @@ void run_octopus_on_contig(ContigCallingComponents&& components)
         if (debug_log) stream(*debug_log) << "Processing subregion " << subregion;
         
         try {
-            calls = components.caller->call(subregion, components.progress_meter);
+            calls = call(subregion, components);
         } catch(...) {
             // TODO: which exceptions can we recover from?
             throw;
@@ -405,6 +531,7 @@ void run_octopus_on_contig(ContigCallingComponents&& components)
         assert(connecting_calls.empty());
         
         buffer_connecting_calls(calls, next_subregion, connecting_calls);
+        filter_resolved(calls, components);
         try {
             write_calls(std::move(calls), components.output);
         } catch(...) {
@@ -417,54 +544,11 @@ void run_octopus_on_contig(ContigCallingComponents&& components)
 
 void run_octopus_single_threaded(GenomeCallingComponents& components)
 {
-    #ifdef BENCHMARK
-    init_timers();
-    #endif
     components.progress_meter().start();
     for (const auto& contig : components.contigs()) {
         run_octopus_on_contig(ContigCallingComponents {contig, components});
     }
     components.progress_meter().stop();
-    #ifdef BENCHMARK
-        print_all_timers();
-    #endif
-}
-
-VcfWriter create_unique_temp_output_file(const GenomicRegion& region,
-                                         const GenomeCallingComponents& components)
-{
-    auto path = *components.temp_directory();
-    const auto& contig = region.contig_name();
-    const auto begin   = std::to_string(region.begin());
-    const auto end     = std::to_string(region.end());
-    boost::filesystem::path file_name {contig + "_" + begin + "-" + end + "_temp.bcf"};
-    path /= file_name;
-    const auto call_types = get_call_types(components, {region.contig_name()});
-    auto header = make_vcf_header(components.samples(), contig, components.reference(), call_types,
-                                  "octopus-internal");
-    return VcfWriter {std::move(path), std::move(header)};
-}
-
-VcfWriter create_unique_temp_output_file(const GenomicRegion::ContigName& contig,
-                                         const GenomeCallingComponents& components)
-{
-    return create_unique_temp_output_file(components.reference().contig_region(contig),
-                                          components);
-}
-
-using TempVcfWriterMap = std::unordered_map<ContigName, VcfWriter>;
-
-TempVcfWriterMap make_temp_vcf_writers(const GenomeCallingComponents& components)
-{
-    if (!components.temp_directory()) {
-        throw std::runtime_error {"Could not make temp writers"};
-    }
-    TempVcfWriterMap result {};
-    result.reserve(components.contigs().size());
-    for (const auto& contig : components.contigs()) {
-        result.emplace(contig, create_unique_temp_output_file(contig, components));
-    }
-    return result;
 }
 
 struct Task : public Mappable<Task>
@@ -529,6 +613,7 @@ struct TaskMakerSyncPacket
     std::atomic_uint num_tasks;
     std::unordered_map<ContigName, bool> finished;
     std::atomic_bool all_done;
+    std::atomic_bool cancelled {false}; // Set if the scheduler exits before all tasks are made
 };
 
 void make_region_tasks(const GenomicRegion& region, const ContigCallingComponents& components, const ExecutionPolicy policy,
@@ -536,7 +621,7 @@ void make_region_tasks(const GenomicRegion& region, const ContigCallingComponent
 {
     static constexpr GenomicRegion::Size minTaskSize {5'000};
     std::unique_lock<std::mutex> lock {sync.mutex, std::defer_lock};
-    auto subregion = propose_call_subregion(components, region, minTaskSize);
+    auto subregion = propose_task_subregion(components, region, minTaskSize);
     if (ends_equal(subregion, region)) {
         lock.lock();
         sync.cv.wait(lock, [&] () { return sync.ready; });
@@ -547,14 +632,15 @@ void make_region_tasks(const GenomicRegion& region, const ContigCallingComponent
             if (last_contig) sync.all_done = true;
         }
         lock.unlock();
-        sync.cv.notify_one();
+        sync.cv.notify_all();
     } else {
         std::deque<GenomicRegion> batch {};
         batch.push_back(subregion);
         bool done {false};
         while (true) {
+            if (sync.cancelled) return;
             while (batch.size() < std::max(sync.batch_size_hint.load(), 1u) || !sync.waiting) {
-                subregion = propose_call_subregion(components, subregion, region, minTaskSize);
+                subregion = propose_task_subregion(components, subregion, region, minTaskSize);
                 batch.push_back(subregion);
                 assert(!ends_before(region, subregion));
                 if (ends_equal(subregion, region)) {
@@ -576,12 +662,12 @@ void make_region_tasks(const GenomicRegion& region, const ContigCallingComponent
                     assert(!last_contig);
                 }
                 lock.unlock();
-                sync.cv.notify_one();
+                sync.cv.notify_all();
                 break;
             } else {
                 batch.clear();
                 lock.unlock();
-                sync.cv.notify_one();
+                sync.cv.notify_all();
             }
         }
     }
@@ -592,9 +678,9 @@ void make_contig_tasks(const ContigCallingComponents& components, const Executio
 {
     if (components.regions.empty()) return;
     std::for_each(std::cbegin(components.regions), std::prev(std::cend(components.regions)), [&] (const auto& region) {
-        make_region_tasks(region, components, policy, result, sync, false, last_contig);
+        if (!sync.cancelled) make_region_tasks(region, components, policy, result, sync, false, last_contig);
     });
-    make_region_tasks(components.regions.back(), components, policy, result, sync, true, last_contig);
+    if (!sync.cancelled) make_region_tasks(components.regions.back(), components, policy, result, sync, true, last_contig);
 }
 
 ExecutionPolicy make_execution_policy(const GenomeCallingComponents& components)
@@ -618,7 +704,7 @@ void make_tasks_helper(TaskMap& tasks, std::vector<ContigName> contigs, GenomeCa
     try {
         static auto debug_log = get_debug_log();
         if (debug_log) stream(*debug_log) << "Making tasks for " << contigs.size() << " contigs";
-        for (std::size_t i {0}; i < contigs.size(); ++i) {
+        for (std::size_t i {0}; i < contigs.size() && !sync.cancelled; ++i) {
             const auto& contig = contigs[i];
             if (debug_log) stream(*debug_log) << "Making tasks for contig " << contig;
             auto contig_components = make_contig_components(contig, components, num_threads);
@@ -688,15 +774,14 @@ unsigned calculate_num_task_threads(const GenomeCallingComponents& components)
     }
 }
 
+// Requires sync.mutex to be held
 Task pop(TaskMap& tasks, TaskMakerSyncPacket& sync)
 {
     assert(!tasks.empty());
-    std::unique_lock<std::mutex> lock {sync.mutex};
-    sync.ready = false;
     assert(sync.num_tasks > 0);
     const auto contig_task_itr = std::begin(tasks);
     assert(!contig_task_itr->second.empty());
-    const auto result = std::move(contig_task_itr->second.front());
+    auto result = std::move(contig_task_itr->second.front());
     contig_task_itr->second.pop();
     if (sync.finished.at(contig_task_itr->first) && contig_task_itr->second.empty()) {
         static auto debug_log = get_debug_log();
@@ -704,16 +789,15 @@ Task pop(TaskMap& tasks, TaskMakerSyncPacket& sync)
         tasks.erase(contig_task_itr);
     }
     --sync.num_tasks;
-    sync.ready = true;
-    lock.unlock();
-    sync.cv.notify_one();
     return result;
 }
 
 struct CompletedTask : public Task
 {
-    CompletedTask(Task task) : Task {std::move(task)}, calls {}, runtime {} {}
+    CompletedTask(Task task) : Task {std::move(task)}, calls {}, filtered_calls {}, runtime {} {}
     std::deque<VcfRecord> calls;
+    // Set if the calls have been moved to a worker for fused filtering
+    std::future<std::deque<VcfRecord>> filtered_calls;
     utils::TimeInterval runtime;
 };
 
@@ -730,56 +814,82 @@ std::ostream& operator<<(std::ostream& os, const CompletedTask& task)
     return os;
 }
 
+// Shares the task maker's mutex and condition variable, so the scheduler can wait for either
+// a new task or a finished task
 struct CallerSyncPacket
 {
-    CallerSyncPacket() : num_finished {0} {}
-    std::condition_variable cv;
-    std::mutex mutex;
-    std::atomic_uint num_finished;
+    CallerSyncPacket(TaskMakerSyncPacket& task_maker_sync)
+    : cv {task_maker_sync.cv}
+    , mutex {task_maker_sync.mutex}
+    , finished {}
+    , error {}
+    , num_running {0}
+    {}
+    std::condition_variable& cv;
+    std::mutex& mutex;
+    std::deque<CompletedTask> finished;
+    std::exception_ptr error;
+    unsigned num_running;
 };
 
-template<typename R>
-bool is_ready(const std::future<R>& f)
-{
-    return f.valid() && f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
-}
-
-auto run(Task task, ContigCallingComponents components, CallerSyncPacket& sync)
+void run(Task task, ContigCallingComponents components, CallerSyncPacket& sync, ThreadPool& workers)
 {
     static auto debug_log = get_debug_log();
     if (debug_log) stream(*debug_log) << "Spawning task " << task;
-    return std::async(std::launch::async, [task = std::move(task), components = std::move(components), &sync] () {
+    workers.push([task = std::move(task), components = std::move(components), &sync] () {
         try {
             CompletedTask result {task};
             result.runtime.start = std::chrono::system_clock::now();
-            result.calls = components.caller->call(task.region, components.progress_meter);
+            result.calls = call(task.region, components);
             result.runtime.end = std::chrono::system_clock::now();
             std::unique_lock<std::mutex> lock {sync.mutex};
-            ++sync.num_finished;
+            sync.finished.push_back(std::move(result));
+            --sync.num_running;
             lock.unlock();
             sync.cv.notify_all();
-            return result;
         } catch (...) {
             logging::ErrorLogger error_log {};
             stream(error_log) << "Encountered a problem whilst calling " << task;
             using namespace std::chrono_literals;
             std::this_thread::sleep_for(2s); // Try to make sure the error is logged before raising
             std::unique_lock<std::mutex> lock {sync.mutex};
-            ++sync.num_finished;
+            if (!sync.error) sync.error = std::current_exception();
+            --sync.num_running;
             lock.unlock();
             sync.cv.notify_all();
-            throw;
         }
     });
 }
 
+// Splits task into at most max_tasks tasks that are each at least min_task_size
+auto split(Task task, const unsigned max_tasks, const GenomicRegion::Size min_task_size)
+{
+    std::vector<Task> result {};
+    const auto num_tasks = std::max(std::min(static_cast<GenomicRegion::Size>(max_tasks), region_size(task) / min_task_size),
+                                    GenomicRegion::Size {1});
+    if (num_tasks == 1) {
+        result.push_back(std::move(task));
+        return result;
+    }
+    result.reserve(num_tasks);
+    const auto task_size = region_size(task) / num_tasks;
+    auto task_begin = mapped_begin(task);
+    for (GenomicRegion::Size i {0}; i < num_tasks - 1; ++i) {
+        result.emplace_back(GenomicRegion {contig_name(task), task_begin, task_begin + task_size}, task.policy);
+        task_begin += task_size;
+    }
+    result.emplace_back(GenomicRegion {contig_name(task), task_begin, mapped_end(task)}, task.policy);
+    return result;
+}
+
 using CompletedTaskMap = std::map<ContigName, std::map<ContigRegion, CompletedTask>>;
 using HoldbackTask = boost::optional<std::reference_wrapper<const CompletedTask>>;
 
 auto get_writable_completed_tasks(CompletedTask&& task, CompletedTaskMap::mapped_type& buffered_tasks,
                                   TaskQueue& running_tasks, HoldbackTask& holdback)
 {
-    std::deque<CompletedTask> result {std::move(task)};
+    std::deque<CompletedTask> result {};
+    result.push_back(std::move(task));
     while (!running_tasks.empty()) {
         const auto itr = buffered_tasks.find(contig_region(running_tasks.front()));
         if (itr != std::end(buffered_tasks)) {
@@ -866,7 +976,7 @@ void resolve_connecting_calls(CompletedTask& lhs, CompletedTask& rhs,
             logging::WarningLogger warn_log {};
             stream(warn_log) << "Recalling " << unresolved_region
                              << " due to call inconsistency between thread tasks. This may increase expected runtime";
-            auto resolved_calls = components.caller->call(unresolved_region, components.progress_meter);
+            auto resolved_calls = call(unresolved_region, components);
             if (!resolved_calls.empty()) {
                 if (!contains(unresolved_region, encompassing_region(resolved_calls))) {
                     // TODO
@@ -895,41 +1005,142 @@ void resolve_connecting_calls(std::deque<CompletedTask>& adjacent_tasks,
                   [&] (auto& rhs) { resolve_connecting_calls(*lhs++, rhs, calling_components); });
 }
 
+// Shares the task maker's mutex and condition variable, so the scheduler can be woken when the
+// reorder buffer drains
 struct TaskWriterSyncPacket
 {
+    TaskWriterSyncPacket(TaskMakerSyncPacket& task_maker_sync)
+    : scheduler_cv {task_maker_sync.cv}
+    , scheduler_mutex {task_maker_sync.mutex}
+    , num_buffered_calls {0}
+    {}
     std::condition_variable cv;
     std::mutex mutex;
     std::deque<CompletedTask> tasks = {};
+    std::deque<ContigName> completed_contigs = {};
     bool done = false;
+    std::condition_variable& scheduler_cv;
+    std::mutex& scheduler_mutex;
+    std::atomic_size_t num_buffered_calls; // Only written by task writer
 };
 
-void write(std::deque<CompletedTask>& tasks, TempVcfWriterMap& writers)
+// Writes completed tasks straight to the final output in contig order. The tasks of each contig
+// arrive in order, but may arrive before a preceding contig is complete, in which case they are
+// held in a reorder buffer until all preceding contigs have been written.
+class OrderedTaskWriter
 {
-    static auto debug_log = get_debug_log();
-    for (auto&& task : tasks) {
-        if (debug_log) {
-            stream(*debug_log) << "Writing completed task " << task << " that finished in " << duration(task);
+public:
+    OrderedTaskWriter() = delete;
+    
+    OrderedTaskWriter(VcfWriter& output, std::vector<ContigName> contigs)
+    : output_ {output}
+    , contigs_ {std::move(contigs)}
+    , head_ {0}
+    , reorder_buffer_ {}
+    , completed_ {}
+    , num_buffered_calls_ {0}
+    {}
+    
+    void write(std::deque<CompletedTask>& tasks)
+    {
+        static auto debug_log = get_debug_log();
+        for (auto&& task : tasks) {
+            if (task.filtered_calls.valid()) task.calls = task.filtered_calls.get();
+            if (is_head(contig_name(task))) {
+                write(std::move(task));
+            } else {
+                if (debug_log) stream(*debug_log) << "Buffering completed task " << task << " until preceding contigs are written";
+                num_buffered_calls_ += task.calls.size();
+                reorder_buffer_[contig_name(task)].push_back(std::move(task));
+            }
+        }
+        tasks.clear();
+    }
+    
+    // All tasks for the contig must have been written
+    void complete(const ContigName& contig)
+    {
+        static auto debug_log = get_debug_log();
+        if (debug_log) stream(*debug_log) << "Finished writing contig " << contig;
+        completed_.insert(contig);
+        while (head_ < contigs_.size() && completed_.count(contigs_[head_]) == 1) {
+            ++head_;
+            if (head_ < contigs_.size()) flush(contigs_[head_]);
+        }
+    }
+    
+    std::size_t num_buffered_calls() const noexcept
+    {
+        return num_buffered_calls_;
+    }
+    
+private:
+    std::reference_wrapper<VcfWriter> output_;
+    std::vector<ContigName> contigs_;
+    std::size_t head_;
+    std::map<ContigName, std::deque<CompletedTask>> reorder_buffer_;
+    std::set<ContigName> completed_;
+    std::size_t num_buffered_calls_;
+    
+    bool is_head(const ContigName& contig) const noexcept
+    {
+        return head_ < contigs_.size() && contigs_[head_] == contig;
+    }
+    
+    void write(CompletedTask&& task)
+    {
+        static auto debug_log = get_debug_log();
+        if (debug_log) stream(*debug_log) << "Writing completed task " << task << " that finished in " << duration(task);
+        write_calls(std::move(task.calls), output_);
+    }
+    
+    void flush(const ContigName& contig)
+    {
+        const auto itr = reorder_buffer_.find(contig);
+        if (itr != std::end(reorder_buffer_)) {
+            for (auto&& task : itr->second) {
+                num_buffered_calls_ -= task.calls.size();
+                write(std::move(task));
+            }
+            reorder_buffer_.erase(itr);
         }
-        auto& writer = writers.at(contig_name(task));
-        write_calls(std::move(task.calls), writer);
     }
-    tasks.clear();
+};
+
+void notify_scheduler(TaskWriterSyncPacket& sync)
+{
+    // Take the scheduler lock so the notification cannot be missed between predicate check and wait
+    std::unique_lock<std::mutex> lock {sync.scheduler_mutex};
+    lock.unlock();
+    sync.scheduler_cv.notify_all();
 }
 
-void write_temp_vcf_helper(TempVcfWriterMap& writers, TaskWriterSyncPacket& sync)
+void write_tasks_helper(OrderedTaskWriter& writer, TaskWriterSyncPacket& sync)
 {
     try {
         std::unique_lock<std::mutex> lock {sync.mutex, std::defer_lock};
-        std::deque<CompletedTask> buffer {};
-        while (!sync.done) {
+        std::deque<CompletedTask> task_buffer {};
+        std::deque<ContigName> contig_buffer {};
+        while (true) {
             lock.lock();
-            sync.cv.wait(lock, [&] () { return !sync.tasks.empty() || sync.done; });
-            assert(buffer.empty());
-            std::swap(sync.tasks, buffer);
+            sync.cv.wait(lock, [&] () { return !sync.tasks.empty() || !sync.completed_contigs.empty() || sync.done; });
+            if (sync.tasks.empty() && sync.completed_contigs.empty()) break;
+            assert(task_buffer.empty() && contig_buffer.empty());
+            std::swap(sync.tasks, task_buffer);
+            std::swap(sync.completed_contigs, contig_buffer);
             lock.unlock();
-            sync.cv.notify_one();
-            write(buffer, writers);
+            // The tasks of a contig are always sent before the contig is completed
+            writer.write(task_buffer);
+            if (!contig_buffer.empty()) {
+                for (const auto& contig : contig_buffer) writer.complete(contig);
+                contig_buffer.clear();
+                sync.num_buffered_calls = writer.num_buffered_calls();
+                notify_scheduler(sync);
+            } else {
+                sync.num_buffered_calls = writer.num_buffered_calls();
+            }
         }
+        lock.unlock();
         logging::DebugLogger debug_log {};
         debug_log << "Task writer finished";
     } catch (const Error& e) {
@@ -949,17 +1160,22 @@ void write_temp_vcf_helper(TempVcfWriterMap& writers, TaskWriterSyncPacket& sync
     }
 }
 
-std::thread make_task_writer_thread(TempVcfWriterMap& temp_writers, TaskWriterSyncPacket& writer_sync)
+std::thread make_task_writer_thread(OrderedTaskWriter& writer, TaskWriterSyncPacket& writer_sync)
 {
-    return std::thread {write_temp_vcf_helper, std::ref(temp_writers), std::ref(writer_sync)};
+    return std::thread {write_tasks_helper, std::ref(writer), std::ref(writer_sync)};
 }
 
-void write(std::deque<CompletedTask>&& tasks, VcfWriter& temp_vcf)
+// Fused filtering of tasks whose connecting calls are resolved runs on the calling workers. The task
+// writer collects the filtered calls in task order.
+void filter_resolved(std::deque<CompletedTask>& tasks, const GenomeCallingComponents& components, ThreadPool& workers)
 {
-    static auto debug_log = get_debug_log();
-    for (auto&& task : tasks) {
-        if (debug_log) stream(*debug_log) << "Writing completed task " << task << " that finished in " << duration(task);
-        write_calls(std::move(task.calls), temp_vcf);
+    if (!components.fused_call_filter()) return;
+    for (auto& task : tasks) {
+        if (task.calls.empty()) continue;
+        task.filtered_calls = workers.push([&components, calls = std::move(task.calls)] () {
+            return filter(calls, *components.fused_call_filter(), components.filter_read_pipe(), components.samples());
+        });
+        task.calls.clear();
     }
 }
 
@@ -968,13 +1184,14 @@ void write(std::deque<CompletedTask>&& tasks, TaskWriterSyncPacket& sync)
     std::unique_lock<std::mutex> lock {sync.mutex};
     utils::append(std::move(tasks), sync.tasks);
     lock.unlock();
-    sync.cv.notify_one();
+    sync.cv.notify_all();
 }
 
 // A CompletedTask can only be written if all proceeding tasks have completed (either written or buffered)
 void write_or_buffer(CompletedTask&& task, CompletedTaskMap::mapped_type& buffered_tasks,
                      TaskQueue& running_tasks, HoldbackTask& holdback,
-                     TaskWriterSyncPacket& sync, const ContigCallingComponentFactory& calling_components)
+                     TaskWriterSyncPacket& sync, const ContigCallingComponentFactory& calling_components,
+                     const GenomeCallingComponents& components, ThreadPool& workers)
 {
     static auto debug_log = get_debug_log();
     if (is_same_region(task, running_tasks.front())) {
@@ -988,6 +1205,7 @@ void write_or_buffer(CompletedTask&& task, CompletedTaskMap::mapped_type& buffer
         holdback = p.first->second;
         if (debug_log) stream(*debug_log) << "Holding back completed task " << *holdback;
         writable_tasks.pop_back();
+        filter_resolved(writable_tasks, components, workers);
         write(std::move(writable_tasks), sync);
     } else {
         if (debug_log) stream(*debug_log) << "Buffering completed task " << task;
@@ -995,112 +1213,52 @@ void write_or_buffer(CompletedTask&& task, CompletedTaskMap::mapped_type& buffer
     }
 }
 
-void wait_until_finished(TaskWriterSyncPacket& sync)
-{
-    std::unique_lock<std::mutex> lock {sync.mutex};
-    sync.cv.wait(lock, [&] () { return sync.tasks.empty(); });
-    sync.done = true;
-    lock.unlock();
-    sync.cv.notify_one();
-}
-
-using FutureCompletedTasks = std::vector<std::future<CompletedTask>>;
-using RemainingTaskMap = std::map<ContigName, std::deque<CompletedTask>>;
-
-void extract_remaining_future_tasks(FutureCompletedTasks& futures, std::deque<CompletedTask>& result)
+// Requires sync.mutex to be held
+bool is_exhausted(const ContigName& contig, const TaskMap& pending_tasks, const TaskMakerSyncPacket& sync)
 {
-    const auto itr = std::remove_if(std::begin(futures), std::end(futures), [] (const auto& f) { return !f.valid(); });
-    std::transform(std::begin(futures), itr, std::back_inserter(result), [] (auto& fut) { return fut.get(); });
-    futures.clear();
-    futures.shrink_to_fit();
+    return sync.finished.at(contig) && pending_tasks.count(contig) == 0;
 }
 
-void extract_buffered_tasks(CompletedTaskMap& buffered_tasks, std::deque<CompletedTask>& result)
-{
-    for (auto& p : buffered_tasks) {
-        std::transform(std::make_move_iterator(std::begin(p.second)), std::make_move_iterator(std::end(p.second)),
-                       std::back_inserter(result), [] (auto&& p) { return std::move(p.second); });
-        p.second.clear();
-    }
-    buffered_tasks.clear();
-}
-
-void sort_ignoring_contig_name(std::deque<CompletedTask>& tasks)
-{
-    std::sort(std::begin(tasks), std::end(tasks),
-              [] (const auto& lhs, const auto& rhs) { return contig_region(lhs) < contig_region(rhs); });
-}
-
-RemainingTaskMap make_map(std::deque<CompletedTask>& tasks)
-{
-    sort_ignoring_contig_name(tasks);
-    RemainingTaskMap result {};
-    for (auto&& task : tasks) {
-        result[contig_name(task.region)].push_back(std::move(task));
-    }
-    return result;
-}
-
-RemainingTaskMap extract_remaining_tasks(FutureCompletedTasks& futures, CompletedTaskMap& buffered_tasks)
+// Once every task of a contig has finished, only the holdback task remains buffered
+void complete(const ContigName& contig, CompletedTaskMap::mapped_type& buffered_tasks, HoldbackTask& holdback,
+              TaskWriterSyncPacket& sync, const ContigCallingComponentFactory& calling_components,
+              const GenomeCallingComponents& components, ThreadPool& workers)
 {
+    holdback = boost::none;
     std::deque<CompletedTask> tasks {};
-    extract_remaining_future_tasks(futures, tasks);
-    extract_buffered_tasks(buffered_tasks, tasks);
-    return make_map(tasks);
-}
-
-void resolve_connecting_calls(RemainingTaskMap& remaining_tasks,
-                              const ContigCallingComponentFactoryMap& calling_components)
-{
-    for (auto& p : remaining_tasks) {
-        resolve_connecting_calls(p.second, calling_components.at(p.first));
-    }
-}
-
-void write(RemainingTaskMap&& remaining_tasks, TempVcfWriterMap& temp_vcfs)
-{
-    for (auto& p : remaining_tasks) {
-        write(std::move(p.second), temp_vcfs.at(p.first));
-    }
-}
-
-void write_remaining_tasks(FutureCompletedTasks& futures, CompletedTaskMap& buffered_tasks, TempVcfWriterMap& temp_vcfs,
-                           const ContigCallingComponentFactoryMap& calling_components)
-{
-    static auto debug_log = get_debug_log();
-    if (debug_log) stream(*debug_log) << "Waiting for " << futures.size() << " running tasks to finish";
-    auto remaining_tasks = extract_remaining_tasks(futures, buffered_tasks);
-    resolve_connecting_calls(remaining_tasks, calling_components);
-    write(std::move(remaining_tasks), temp_vcfs);
-}
-
-auto extract_writers(TempVcfWriterMap&& vcfs)
-{
-    std::vector<VcfWriter> result {};
-    result.reserve(vcfs.size());
-    for (auto&& p : vcfs) {
-        result.push_back(std::move(p.second));
-    }
-    vcfs.clear();
-    return result;
+    std::transform(std::make_move_iterator(std::begin(buffered_tasks)), std::make_move_iterator(std::end(buffered_tasks)),
+                   std::back_inserter(tasks), [] (auto&& p) { return std::move(p.second); });
+    buffered_tasks.clear();
+    resolve_connecting_calls(tasks, calling_components);
+    filter_resolved(tasks, components, workers);
+    std::unique_lock<std::mutex> lock {sync.mutex};
+    utils::append(std::move(tasks), sync.tasks);
+    sync.completed_contigs.push_back(contig);
+    lock.unlock();
+    sync.cv.notify_all();
 }
 
-auto extract_as_readers(TempVcfWriterMap&& vcfs)
+// The task writer writes all the tasks it has been sent before finishing
+void wait_until_finished(std::thread& task_writer, TaskWriterSyncPacket& sync)
 {
-    return writers_to_readers(extract_writers(std::move(vcfs)));
+    std::unique_lock<std::mutex> lock {sync.mutex};
+    sync.done = true;
+    lock.unlock();
+    sync.cv.notify_all();
+    task_writer.join();
 }
 
-void merge(TempVcfWriterMap&& temp_vcf_writers, GenomeCallingComponents& components)
+// Requires sync.mutex not to be held
+void stop(std::thread& task_maker, TaskMakerSyncPacket& sync)
 {
-    static auto debug_log = get_debug_log();
-    if (debug_log) stream(*debug_log) << "Merging " << temp_vcf_writers.size() << " temporary VCF files";
-    auto temp_readers = extract_as_readers(std::move(temp_vcf_writers));
-    merge(temp_readers, components.output(), components.contigs());
+    sync.cancelled = true;
+    if (task_maker.joinable()) task_maker.join();
 }
 
 void run_octopus_multi_threaded(GenomeCallingComponents& components)
 {
-    using namespace std::chrono_literals;
+    static constexpr GenomicRegion::Size minSplitTaskSize {10'000};
+    static constexpr std::size_t maxReorderBufferedCalls {100'000};
     static auto debug_log = get_debug_log();
     
     const auto num_task_threads = calculate_num_task_threads(components);
@@ -1108,16 +1266,14 @@ void run_octopus_multi_threaded(GenomeCallingComponents& components)
     TaskMap pending_tasks {components.contigs()};
     TaskMakerSyncPacket task_maker_sync {};
     task_maker_sync.batch_size_hint = 2 * num_task_threads;
-    std::unique_lock<std::mutex> pending_task_lock {task_maker_sync.mutex, std::defer_lock};
+    std::unique_lock<std::mutex> lock {task_maker_sync.mutex, std::defer_lock};
     auto task_maker_thread = make_task_maker_thread(pending_tasks, components, num_task_threads, task_maker_sync);
     if (!task_maker_thread.joinable()) {
         logging::FatalLogger fatal_log {};
         fatal_log << "Unable to make task maker thread";
         return;
     }
-    task_maker_thread.detach();
     
-    FutureCompletedTasks futures(num_task_threads);
     TaskMap running_tasks {ContigOrder {components.contigs()}};
     CompletedTaskMap buffered_tasks {};
     std::map<ContigName, HoldbackTask> holdbacks {};
@@ -1128,91 +1284,123 @@ void run_octopus_multi_threaded(GenomeCallingComponents& components)
         holdbacks.emplace(contig, boost::none);
     }
     
-    CallerSyncPacket caller_sync {};
+    CallerSyncPacket caller_sync {task_maker_sync};
     const auto calling_components = make_contig_calling_component_factory_map(components);
-    unsigned num_idle_futures {0};
     
-    auto temp_writers = make_temp_vcf_writers(components);
-    TaskWriterSyncPacket task_writer_sync {};
-    auto task_writer_thread = make_task_writer_thread(temp_writers, task_writer_sync);
+    const auto& contigs = components.contigs();
+    OrderedTaskWriter task_writer {components.output(), contigs};
+    TaskWriterSyncPacket task_writer_sync {task_maker_sync};
+    auto task_writer_thread = make_task_writer_thread(task_writer, task_writer_sync);
     if (!task_writer_thread.joinable()) {
         logging::FatalLogger fatal_log {};
         fatal_log << "Unable to make task writer thread";
+        stop(task_maker_thread, task_maker_sync);
         return;
     }
-    task_writer_thread.detach();
-    
-    // Wait for the first task to be made
-    const auto tasks_available = [&] () noexcept { return task_maker_sync.num_tasks > 0; };
-    while(task_maker_sync.num_tasks == 0) {
-        pending_task_lock.lock();
-        task_maker_sync.cv.wait(pending_task_lock, tasks_available);
-        pending_task_lock.unlock();
-    }
-    task_maker_sync.batch_size_hint = num_task_threads / 2;
     
-    components.progress_meter().start();
+    ThreadPool workers {num_task_threads};
     
-    while (!task_maker_sync.all_done || task_maker_sync.num_tasks > 0) {
-        pending_task_lock.lock();
-        assert(count_tasks(pending_tasks) == task_maker_sync.num_tasks);
-        if (!task_maker_sync.all_done && task_maker_sync.num_tasks == 0) {
-            task_maker_sync.batch_size_hint = std::max(num_idle_futures, num_task_threads / 2);
-            if (num_idle_futures < futures.size()) {
-                // If there are running futures then it's good periodically check to see if
-                // any have finished and process them while we wait for the task maker.
-                while (task_maker_sync.num_tasks == 0 && caller_sync.num_finished == 0) {
-                    auto now = std::chrono::system_clock::now();
-                    task_maker_sync.cv.wait_until(pending_task_lock, now + 5s, tasks_available);
+    try {
+        // Wait for the first task to be made
+        lock.lock();
+        task_maker_sync.cv.wait(lock, [&] () noexcept { return task_maker_sync.num_tasks > 0 || task_maker_sync.all_done; });
+        task_maker_sync.batch_size_hint = num_task_threads / 2;
+        lock.unlock();
+        
+        components.progress_meter().start();
+        
+        // Stop starting tasks if too many calls are waiting for a preceding contig to be written. The
+        // preceding contig's tasks are all running by then, so the reorder buffer will eventually drain.
+        const auto can_run_task = [&] () noexcept {
+            return caller_sync.num_running < num_task_threads && task_maker_sync.num_tasks > 0
+                   && task_writer_sync.num_buffered_calls < maxReorderBufferedCalls;
+        };
+        const auto all_tasks_finished = [&] () noexcept {
+            return task_maker_sync.all_done && task_maker_sync.num_tasks == 0 && caller_sync.num_running == 0;
+        };
+        std::deque<CompletedTask> finished_tasks {};
+        // All the tasks of a contig are made and started before those of the next contig
+        std::size_t num_exhausted_contigs {0}, num_completed_contigs {0};
+        std::vector<bool> completed_contigs(contigs.size(), false);
+        while (true) {
+            lock.lock();
+            // If all workers are busy then the task maker may as well make tasks in bigger batches
+            task_maker_sync.waiting = caller_sync.num_running < num_task_threads;
+            caller_sync.cv.wait(lock, [&] () noexcept {
+                return !caller_sync.finished.empty() || caller_sync.error || can_run_task() || all_tasks_finished();
+            });
+            task_maker_sync.waiting = true;
+            if (caller_sync.error) {
+                std::rethrow_exception(caller_sync.error);
+            }
+            std::swap(caller_sync.finished, finished_tasks);
+            while (can_run_task()) {
+                auto task = pop(pending_tasks, task_maker_sync);
+                const auto num_idle_workers = num_task_threads - caller_sync.num_running;
+                // No more tasks are coming, so split tasks to keep idle workers busy rather than leave a long tail
+                if (task_maker_sync.all_done && task_maker_sync.num_tasks < num_idle_workers - 1) {
+                    auto subtasks = split(std::move(task), num_idle_workers - task_maker_sync.num_tasks, minSplitTaskSize);
+                    if (debug_log && subtasks.size() > 1) {
+                        stream(*debug_log) << "Splitting task " << encompassing_region(subtasks) << " into " << subtasks.size() << " tasks";
+                    }
+                    for (auto& subtask : subtasks) {
+                        run(subtask, calling_components.at(contig_name(subtask))(), caller_sync, workers);
+                        running_tasks.at(contig_name(subtask)).push(std::move(subtask));
+                        ++caller_sync.num_running;
+                    }
+                } else {
+                    run(task, calling_components.at(contig_name(task))(), caller_sync, workers);
+                    running_tasks.at(contig_name(task)).push(std::move(task));
+                    ++caller_sync.num_running;
                 }
-            } else {
-                task_maker_sync.cv.wait(pending_task_lock, tasks_available);
             }
-        }
-        pending_task_lock.unlock();
-        num_idle_futures = 0;
-        for (auto& future : futures) {
-            if (is_ready(future)) {
-                auto completed_task = future.get();
-                const auto& contig = contig_name(completed_task.region);
-                write_or_buffer(std::move(completed_task), buffered_tasks.at(contig),
-                                running_tasks.at(contig), holdbacks.at(contig),
-                                task_writer_sync, calling_components.at(contig));
-                --caller_sync.num_finished;
+            if (!task_maker_sync.all_done && task_maker_sync.num_tasks == 0) {
+                const auto num_idle_workers = num_task_threads - caller_sync.num_running;
+                task_maker_sync.batch_size_hint = std::max(num_idle_workers, num_task_threads / 2);
+                if (debug_log && num_idle_workers > 0) stream(*debug_log) << "There are " << num_idle_workers << " idle workers";
             }
-            if (!future.valid()) {
-                pending_task_lock.lock();
-                if (task_maker_sync.num_tasks > 0) {
-                    pending_task_lock.unlock(); // As pop will need to lock the mutex too == deadlock
-                    auto task = pop(pending_tasks, task_maker_sync);
-                    future = run(task, calling_components.at(contig_name(task))(), caller_sync);
-                    running_tasks.at(contig_name(task)).push(std::move(task));
-                } else {
-                    pending_task_lock.unlock();
-                    ++num_idle_futures;
+            while (num_exhausted_contigs < contigs.size()
+                   && is_exhausted(contigs[num_exhausted_contigs], pending_tasks, task_maker_sync)) {
+                ++num_exhausted_contigs;
+            }
+            const auto done = all_tasks_finished() && caller_sync.finished.empty();
+            lock.unlock();
+            task_maker_sync.cv.notify_all();
+            for (auto&& task : finished_tasks) {
+                const auto& contig = contig_name(task.region);
+                write_or_buffer(std::move(task), buffered_tasks.at(contig), running_tasks.at(contig), holdbacks.at(contig),
+                                task_writer_sync, calling_components.at(contig), components, workers);
+            }
+            finished_tasks.clear();
+            for (auto i = num_completed_contigs; i < num_exhausted_contigs; ++i) {
+                const auto& contig = contigs[i];
+                if (!completed_contigs[i] && running_tasks.at(contig).empty()) {
+                    complete(contig, buffered_tasks.at(contig), holdbacks.at(contig), task_writer_sync,
+                             calling_components.at(contig), components, workers);
+                    completed_contigs[i] = true;
                 }
             }
+            while (num_completed_contigs < num_exhausted_contigs && completed_contigs[num_completed_contigs]) {
+                ++num_completed_contigs;
+            }
+            if (done) break;
         }
-        // If there are no idle futures then all threads are busy and we must wait for one to finish,
-        // otherwise we must have run out of tasks, so we should wait for new ones.
-        if (num_idle_futures == 0 && caller_sync.num_finished == 0) {
-            task_maker_sync.waiting = false;
-            std::unique_lock<std::mutex> lock {caller_sync.mutex};
-            caller_sync.cv.wait(lock, [&] () { return caller_sync.num_finished > 0; });
-            task_maker_sync.waiting = true;
-        } else {
-            if (debug_log) stream(*debug_log) << "There are " << num_idle_futures << " idle futures";
-        }
+        assert(pending_tasks.empty());
+        assert(num_completed_contigs == contigs.size());
+    } catch (...) {
+        // Neither thread may outlive the state it shares with this frame. Running tasks need the lock to finish.
+        if (lock.owns_lock()) lock.unlock();
+        stop(task_maker_thread, task_maker_sync);
+        wait_until_finished(task_writer_thread, task_writer_sync);
+        throw;
     }
-    assert(task_maker_sync.num_tasks == 0);
-    assert(pending_tasks.empty());
+    task_maker_thread.join();
     running_tasks.clear();
-    holdbacks.clear(); // holdbacks are just references to buffered tasks
+    holdbacks.clear();
+    buffered_tasks.clear();
     if (debug_log) *debug_log << "Finished making new tasks. Waiting for task writer to complete existing jobs";
-    wait_until_finished(task_writer_sync);
-    write_remaining_tasks(futures, buffered_tasks, temp_writers, calling_components);
+    wait_until_finished(task_writer_thread, task_writer_sync);
     components.progress_meter().stop();
-    merge(std::move(temp_writers), components);
 }
 
 } // namespace
@@ -1286,6 +1474,17 @@ bool use_unfiltered_call_region_hints_for_filtering(const GenomeCallingComponent
     return true;
 }
 
+std::shared_ptr<const LikelihoodSidecarReader> load_calling_likelihoods(GenomeCallingComponents& components)
+{
+    const auto sidecar = components.likelihood_sidecar();
+    if (sidecar) {
+        sidecar->close();
+        return std::make_shared<LikelihoodSidecarReader>(sidecar->path(), components.reference());
+    } else {
+        return nullptr;
+    }
+}
+
 void run_csr(GenomeCallingComponents& components)
 {
     if (apply_csr(components)) {
@@ -1316,7 +1515,8 @@ void run_csr(GenomeCallingComponents& components)
         const VcfReader in {std::move(*input_path)};
         const auto filter = filter_factory.make(components.reference(), std::move(buffered_rp), in.fetch_header(),
                                                 components.ploidies(), components.pedigree(),
-                                                output_config, progress, components.num_threads());
+                                                output_config, progress, components.num_threads(),
+                                                load_calling_likelihoods(components));
         assert(filter);
         VcfWriter& out {*components.filtered_output()};
         filter->filter(in, out);
@@ -1533,12 +1733,16 @@ auto get_haplotype_bam_paths(const boost::filesystem::path& prefix, const unsign
 
 void run_bam_realign(GenomeCallingComponents& components)
 {
+    BAMRealigner::Config realign_config {};
+    if (is_bam_realignment_requested(components) || is_split_bam_realignment_requested(components)) {
+        realign_config.calling_likelihoods = load_calling_likelihoods(components);
+    }
     if (is_bam_realignment_requested(components)) {
         if (check_bam_realign(components)) {
             components.read_manager().close();
             if (components.read_manager().paths().size() == 1) {
                 realign(components.read_manager().paths().front(), get_bam_realignment_vcf(components),
-                        *components.bamout(), components.reference());
+                        *components.bamout(), components.reference(), realign_config);
             } else {
                 namespace fs = boost::filesystem;
                 const auto bamout_directory = *components.bamout();
@@ -1559,7 +1763,7 @@ void run_bam_realign(GenomeCallingComponents& components)
                     auto bamout_path = bamout_directory;
                     bamout_path /= bamin_path.filename();
                     if (bamin_path != bamout_path) {
-                        realign(bamin_path, get_bam_realignment_vcf(components), bamout_path, components.reference());
+                        realign(bamin_path, get_bam_realignment_vcf(components), bamout_path, components.reference(), realign_config);
                     } else {
                         logging::WarningLogger warn_log {};
                         stream(warn_log) << "Cannot make evidence bam " << bamout_path << " as it is an input bam";
@@ -1574,7 +1778,7 @@ void run_bam_realign(GenomeCallingComponents& components)
             if (components.read_manager().paths().size() == 1) {
                 auto out_paths = get_haplotype_bam_paths(*components.split_bamout(), get_max_ploidy(components));
                 realign(components.read_manager().paths().front(), get_bam_realignment_vcf(components),
-                        std::move(out_paths), components.reference());
+                        std::move(out_paths), components.reference(), realign_config);
             } else {
                 namespace fs = boost::filesystem;
                 const auto bamout_directory = *components.split_bamout();
@@ -1597,7 +1801,7 @@ void run_bam_realign(GenomeCallingComponents& components)
                     bamout_prefix /= bamin_path.filename().stem();
                     const auto max_ploidy = get_max_called_ploidy(realignment_vcf, bamin_path);
                     auto bamout_paths = get_haplotype_bam_paths(bamout_prefix, max_ploidy);
-                    realign(bamin_path, realignment_vcf, std::move(bamout_paths), components.reference());
+                    realign(bamin_path, realignment_vcf, std::move(bamout_paths), components.reference(), realign_config);
                 }
             }
         }
@@ -1614,7 +1818,7 @@ void run_data_profiler(GenomeCallingComponents& components)
         if (final_output_path) {
             info_log << "Starting indel profiler";
             final_output.close();
-            if (is_indexable(*final_output_path)) index_vcf(*final_output_path);
+            final_output.write_index();
             const auto profile = profile_indels(components.read_pipe(), *final_output_path, components.reference(), components.search_regions());
             std::ofstream profile_file {data_profile_csv_path->string()};
             profile_file << profile;
@@ -75,7 +75,19 @@ auto copy_reads(AmbiguousReadList&& reads)
     return result;
 }
 
+auto assign_reads(const Genotype<Haplotype>& genotype, const std::vector<AlignedRead>& reads,
+                  AmbiguousReadList& unassigned_reads, const SampleName& sample,
+                  const BAMRealigner::Config& config)
+{
+    if (config.calling_likelihoods) {
+        return compute_haplotype_support(genotype, reads, unassigned_reads, sample, *config.calling_likelihoods);
+    } else {
+        return compute_haplotype_support(genotype, reads, unassigned_reads);
+    }
+}
+
 auto assign_and_realign(const std::vector<AlignedRead>& reads, const Genotype<Haplotype>& genotype,
+                        const SampleName& sample, const BAMRealigner::Config& config,
                         BAMRealigner::Report& report)
 {
     std::vector<AlignedRead> result {};
@@ -85,7 +97,7 @@ auto assign_and_realign(const std::vector<AlignedRead>& reads, const Genotype<Ha
             utils::append(safe_realign_to_reference(reads, genotype[0]), result);
         } else {
             AmbiguousReadList unassigned_reads {};
-            auto support = compute_haplotype_support(genotype, reads, unassigned_reads);
+            auto support = assign_reads(genotype, reads, unassigned_reads, sample, config);
             for (auto& p : support) {
                 if (!p.second.empty()) {
                     report.n_reads_assigned += p.second.size();
@@ -122,7 +134,8 @@ BAMRealigner::Report BAMRealigner::realign(ReadReader& src, VcfReader& variants,
     std::vector<AlignedRead> buffer {};
     for (auto p = variants.iterate(); p.first != p.second; ) {
         auto batch = read_next_batch(p.first, p.second, src, reference, samples, batch_region);
-        for (auto& sample : batch) {
+        for (std::size_t sample_idx {0}; sample_idx < batch.size(); ++sample_idx) {
+            auto& sample = batch[sample_idx];
             std::vector<AlignedRead> genotype_reads {}, realigned_reads {};
             auto sample_reads_itr = std::begin(sample.reads);
             for (const auto& genotype : sample.genotypes) {
@@ -132,7 +145,7 @@ BAMRealigner::Report BAMRealigner::realign(ReadReader& src, VcfReader& variants,
                                       std::make_move_iterator(overlapped_reads.end()));
                 sample_reads_itr = sample.reads.erase(overlapped_reads.begin(), overlapped_reads.end());
                 auto bad_reads = remove_unalignable_reads(genotype_reads);
-                auto realignments = assign_and_realign(genotype_reads, genotype, report);
+                auto realignments = assign_and_realign(genotype_reads, genotype, samples[sample_idx], config_, report);
                 report.n_reads_unassigned += bad_reads.size();
                 move_merge(bad_reads, realignments);
                 move_merge(realignments, realigned_reads);
@@ -154,6 +167,7 @@ BAMRealigner::Report BAMRealigner::realign(ReadReader& src, VcfReader& variants,
 namespace {
 
 auto split_and_realign(const std::vector<AlignedRead>& reads, const Genotype<Haplotype>& genotype,
+                       const SampleName& sample, const BAMRealigner::Config& config,
                        BAMRealigner::Report& report)
 {
     std::vector<std::vector<AlignedRead>> result(genotype.zygosity() + 1);
@@ -163,7 +177,7 @@ auto split_and_realign(const std::vector<AlignedRead>& reads, const Genotype<Hap
             result.back() = safe_realign_to_reference(reads, genotype[0]);
         } else {
             AmbiguousReadList unassigned_reads {};
-            auto support = compute_haplotype_support(genotype, reads, unassigned_reads);
+            auto support = assign_reads(genotype, reads, unassigned_reads, sample, config);
             std::size_t result_idx {0};
             for (const auto& haplotype : genotype) {
                 auto support_itr = support.find(haplotype);
@@ -198,7 +212,8 @@ BAMRealigner::Report BAMRealigner::realign(ReadReader& src, VcfReader& variants,
     boost::optional<GenomicRegion> batch_region {};
     for (auto p = variants.iterate(); p.first != p.second; ) {
         auto batch = read_next_batch(p.first, p.second, src, reference, samples, batch_region);
-        for (auto& sample : batch) {
+        for (std::size_t sample_idx {0}; sample_idx < batch.size(); ++sample_idx) {
+            auto& sample = batch[sample_idx];
             std::vector<AlignedRead> genotype_reads {}, unassigned_realigned_reads {};
             auto sample_reads_itr = std::begin(sample.reads);
             for (const auto& genotype : sample.genotypes) {
@@ -207,7 +222,7 @@ BAMRealigner::Report BAMRealigner::realign(ReadReader& src, VcfReader& variants,
                                       std::make_move_iterator(overlapped_reads.end()));
                 sample_reads_itr = sample.reads.erase(overlapped_reads.begin(), overlapped_reads.end());
                 auto bad_reads = remove_unalignable_reads(genotype_reads);
-                auto realignments = split_and_realign(genotype_reads, genotype, report);
+                auto realignments = split_and_realign(genotype_reads, genotype, samples[sample_idx], config_, report);
                 report.n_reads_unassigned += bad_reads.size();
                 move_merge(bad_reads, realignments.back());
                 assert(realignments.size() <= dsts.size());
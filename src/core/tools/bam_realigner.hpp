@@ -6,6 +6,7 @@
 
 #include <vector>
 #include <cstddef>
+#include <memory>
 
 #include <boost/optional.hpp>
 
@@ -18,6 +19,7 @@
 #include "io/read/read_writer.hpp"
 #include "io/variant/vcf_reader.hpp"
 #include "utils/thread_pool.hpp"
+#include "likelihood_sidecar.hpp"
 
 namespace octopus {
 
@@ -34,6 +36,7 @@ public:
         bool copy_hom_ref_reads = false;
         bool simplify_cigars = false;
         boost::optional<unsigned> max_threads = 1;
+        std::shared_ptr<const LikelihoodSidecarReader> calling_likelihoods = nullptr;
     };
     
     struct Report
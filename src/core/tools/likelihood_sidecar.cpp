@@ -0,0 +1,333 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "likelihood_sidecar.hpp"
+
+#include <array>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <stdexcept>
+#include <cassert>
+
+#include "core/types/allele.hpp"
+#include "core/types/variant.hpp"
+#include "exceptions/malformed_file_error.hpp"
+
+namespace octopus {
+
+/*
+ Side-car file layout (native byte order):
+
+ header  : magic (8 bytes)
+ records : for each active region
+              number of haplotypes (u32), then for each haplotype the number of non-reference
+              alleles (u32) and each allele as begin (u32), end (u32), sequence length (u32), sequence
+              number of samples (u32), then for each sample the name length (u32), name, number of
+              reads (u32), read ids (u64) and likelihoods (float) indexed [haplotype][read]
+ index   : for each record, contig name length (u32), contig name, begin (u32), end (u32),
+           offset (u64), size (u64)
+ footer  : number of records (u64), index offset (u64)
+ */
+
+namespace {
+
+constexpr std::array<char, 8> sidecarMagic {{'O', 'C', 'T', 'L', 'I', 'K', 'S', '1'}};
+
+template <typename T>
+void write(const T value, std::string& out)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void write(const std::string& value, std::string& out)
+{
+    write(static_cast<std::uint32_t>(value.size()), out);
+    out.append(value);
+}
+
+template <typename T>
+T read(const char*& in)
+{
+    T result;
+    std::memcpy(&result, in, sizeof(T));
+    in += sizeof(T);
+    return result;
+}
+
+std::string read_string(const char*& in)
+{
+    const auto size = read<std::uint32_t>(in);
+    std::string result {in, size};
+    in += size;
+    return result;
+}
+
+// The id covers everything the likelihood depends on, not just the read's identity, as the
+// filter read pipe may transform reads (e.g. trimming or masking) differently to the calling
+// read pipe. A read transformed differently then gets a new id and is not looked up.
+std::uint64_t make_read_id(const AlignedRead& read) noexcept
+{
+    // FNV-1a, which unlike std::hash is stable between builds
+    std::uint64_t result {14695981039346656037ull};
+    const auto add = [&result] (const char c) noexcept {
+        result ^= static_cast<unsigned char>(c);
+        result *= 1099511628211ull;
+    };
+    const auto add_bytes = [&add] (const auto value) noexcept {
+        char bytes[sizeof(value)];
+        std::memcpy(bytes, &value, sizeof(value));
+        for (const char c : bytes) add(c);
+    };
+    for (const char c : read.name()) add(c);
+    add_bytes(static_cast<std::uint32_t>(mapped_begin(read)));
+    const auto flags = read.flags();
+    add(flags.first_template_segment ? 'F' : 'f');
+    add(flags.reverse_mapped ? 'R' : 'r');
+    add(flags.supplementary_alignment ? 'S' : 's');
+    add_bytes(static_cast<std::uint32_t>(read.mapping_quality()));
+    add_bytes(static_cast<std::uint32_t>(sequence_size(read)));
+    for (const char c : read.sequence()) add(c);
+    for (const auto q : read.base_qualities()) add(static_cast<char>(q));
+    return result;
+}
+
+void write_haplotype(const Haplotype& haplotype, const Haplotype& reference, std::string& out)
+{
+    const auto variants = haplotype.difference(reference);
+    write(static_cast<std::uint32_t>(variants.size()), out);
+    for (const auto& variant : variants) {
+        const auto& allele = variant.alt_allele();
+        write(static_cast<std::uint32_t>(mapped_begin(allele)), out);
+        write(static_cast<std::uint32_t>(mapped_end(allele)), out);
+        write(allele.sequence(), out);
+    }
+}
+
+Haplotype read_haplotype(const char*& in, const GenomicRegion& region, const ReferenceGenome& reference)
+{
+    const auto num_alleles = read<std::uint32_t>(in);
+    std::vector<ContigAllele> alleles {};
+    alleles.reserve(num_alleles);
+    for (std::uint32_t i {0}; i < num_alleles; ++i) {
+        const auto begin = read<std::uint32_t>(in);
+        const auto end = read<std::uint32_t>(in);
+        alleles.emplace_back(ContigRegion {begin, end}, read_string(in));
+    }
+    return Haplotype {region, std::cbegin(alleles), std::cend(alleles), reference};
+}
+
+class MalformedLikelihoodSidecar : public MalformedFileError
+{
+    std::string do_where() const override
+    {
+        return "LikelihoodSidecarReader";
+    }
+public:
+    MalformedLikelihoodSidecar(LikelihoodSidecarReader::Path file) : MalformedFileError {std::move(file), "likelihood side-car"} {}
+};
+
+} // namespace
+
+LikelihoodSidecarWriter::LikelihoodSidecarWriter(Path path)
+: path_ {std::move(path)}
+, file_ {path_.string(), std::ios::binary}
+, index_ {}
+, offset_ {sidecarMagic.size()}
+, closed_ {false}
+, mutex_ {}
+{
+    if (!file_) {
+        throw std::runtime_error {"LikelihoodSidecarWriter: could not open " + path_.string()};
+    }
+    file_.write(sidecarMagic.data(), sidecarMagic.size());
+}
+
+LikelihoodSidecarWriter::~LikelihoodSidecarWriter()
+{
+    try {
+        close();
+    } catch (...) {}
+}
+
+const LikelihoodSidecarWriter::Path& LikelihoodSidecarWriter::path() const noexcept
+{
+    return path_;
+}
+
+void LikelihoodSidecarWriter::write(const std::vector<Haplotype>& haplotypes, const ReadMap& reads,
+                                    const HaplotypeLikelihoodArray& likelihoods, const ReferenceGenome& reference)
+{
+    if (haplotypes.empty()) return;
+    const auto& region = mapped_region(haplotypes.front());
+    assert(std::all_of(std::cbegin(haplotypes), std::cend(haplotypes),
+                       [&] (const auto& haplotype) { return mapped_region(haplotype) == region; }));
+    const Haplotype reference_haplotype {region, reference};
+    std::string record {};
+    ::octopus::write(static_cast<std::uint32_t>(haplotypes.size()), record);
+    for (const auto& haplotype : haplotypes) {
+        write_haplotype(haplotype, reference_haplotype, record);
+    }
+    ::octopus::write(static_cast<std::uint32_t>(reads.size()), record);
+    for (const auto& p : reads) {
+        ::octopus::write(p.first, record);
+        ::octopus::write(static_cast<std::uint32_t>(p.second.size()), record);
+        for (const auto& read : p.second) {
+            ::octopus::write(make_read_id(read), record);
+        }
+        for (const auto& haplotype : haplotypes) {
+            const auto& haplotype_likelihoods = likelihoods(p.first, haplotype);
+            assert(haplotype_likelihoods.size() == p.second.size());
+            for (const auto likelihood : haplotype_likelihoods) {
+                ::octopus::write(static_cast<float>(likelihood), record);
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock {mutex_};
+    if (closed_) {
+        throw std::runtime_error {"LikelihoodSidecarWriter: writing to closed side-car"};
+    }
+    file_.write(record.data(), record.size());
+    index_.push_back({region, offset_, record.size()});
+    offset_ += record.size();
+}
+
+void LikelihoodSidecarWriter::close()
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    if (closed_) return;
+    std::string index {};
+    for (const auto& entry : index_) {
+        ::octopus::write(entry.region.contig_name(), index);
+        ::octopus::write(static_cast<std::uint32_t>(entry.region.begin()), index);
+        ::octopus::write(static_cast<std::uint32_t>(entry.region.end()), index);
+        ::octopus::write(entry.offset, index);
+        ::octopus::write(entry.size, index);
+    }
+    ::octopus::write(static_cast<std::uint64_t>(index_.size()), index);
+    ::octopus::write(offset_, index);
+    file_.write(index.data(), index.size());
+    file_.close();
+    index_.clear();
+    index_.shrink_to_fit();
+    closed_ = true;
+    if (!file_) {
+        throw std::runtime_error {"LikelihoodSidecarWriter: failed writing " + path_.string()};
+    }
+}
+
+// LikelihoodSidecarReader
+
+LikelihoodSidecarReader::LikelihoodSidecarReader(Path path, const ReferenceGenome& reference)
+: path_ {std::move(path)}
+, reference_ {reference}
+, file_ {std::make_unique<boost::iostreams::mapped_file_source>(path_.string())}
+, index_ {}
+{
+    constexpr auto footer_size = 2 * sizeof(std::uint64_t);
+    const auto file_size = file_->size();
+    if (file_size < sidecarMagic.size() + footer_size
+        || !std::equal(std::cbegin(sidecarMagic), std::cend(sidecarMagic), file_->data())) {
+        throw MalformedLikelihoodSidecar {path_};
+    }
+    const char* footer {file_->data() + file_size - footer_size};
+    const auto num_records = read<std::uint64_t>(footer);
+    const auto index_offset = read<std::uint64_t>(footer);
+    if (index_offset > file_size - footer_size) {
+        throw MalformedLikelihoodSidecar {path_};
+    }
+    const char* in {file_->data() + index_offset};
+    for (std::uint64_t i {0}; i < num_records; ++i) {
+        auto contig = read_string(in);
+        const auto begin = read<std::uint32_t>(in);
+        const auto end = read<std::uint32_t>(in);
+        const auto offset = read<std::uint64_t>(in);
+        const auto size = read<std::uint64_t>(in);
+        auto& contig_index = index_[std::move(contig)];
+        contig_index.entries.push_back({ContigRegion {begin, end}, offset, size});
+        contig_index.max_region_size = std::max(contig_index.max_region_size, ContigRegion::Size {end - begin});
+    }
+    for (auto& p : index_) {
+        std::sort(std::begin(p.second.entries), std::end(p.second.entries),
+                  [] (const auto& lhs, const auto& rhs) { return lhs.region < rhs.region; });
+    }
+}
+
+boost::optional<LikelihoodSidecarReader::LikelihoodMatrix>
+LikelihoodSidecarReader::fetch(const SampleName& sample, const std::vector<Haplotype>& haplotypes,
+                               const std::vector<AlignedRead>& reads) const
+{
+    if (haplotypes.empty()) return boost::none;
+    const auto& region = mapped_region(haplotypes.front());
+    const auto contig_itr = index_.find(region.contig_name());
+    if (contig_itr == std::cend(index_)) return boost::none;
+    const auto& contig_index = contig_itr->second;
+    const auto& query = region.contig_region();
+    const auto first_begin = query.end() > contig_index.max_region_size ? query.end() - contig_index.max_region_size : 0;
+    auto itr = std::lower_bound(std::cbegin(contig_index.entries), std::cend(contig_index.entries), first_begin,
+                                [] (const auto& entry, const auto position) { return entry.region.begin() < position; });
+    for (; itr != std::cend(contig_index.entries) && itr->region.begin() <= query.begin(); ++itr) {
+        if (contains(itr->region, query)) {
+            auto result = fetch(*itr, region.contig_name(), sample, haplotypes, reads);
+            if (result) return result;
+        }
+    }
+    return boost::none;
+}
+
+// private methods
+
+boost::optional<LikelihoodSidecarReader::LikelihoodMatrix>
+LikelihoodSidecarReader::fetch(const IndexEntry& entry, const GenomicRegion::ContigName& contig,
+                               const SampleName& sample, const std::vector<Haplotype>& haplotypes,
+                               const std::vector<AlignedRead>& reads) const
+{
+    const GenomicRegion record_region {contig, entry.region};
+    const char* in {file_->data() + entry.offset};
+    const auto num_stored_haplotypes = read<std::uint32_t>(in);
+    std::vector<Haplotype> stored_haplotypes {};
+    stored_haplotypes.reserve(num_stored_haplotypes);
+    for (std::uint32_t i {0}; i < num_stored_haplotypes; ++i) {
+        stored_haplotypes.push_back(read_haplotype(in, record_region, reference_));
+    }
+    std::vector<std::size_t> haplotype_indices(haplotypes.size());
+    for (std::size_t i {0}; i < haplotypes.size(); ++i) {
+        const auto& haplotype_region = mapped_region(haplotypes[i]);
+        const auto match_itr = std::find_if(std::cbegin(stored_haplotypes), std::cend(stored_haplotypes),
+                                            [&] (const auto& stored) {
+                                                return copy<Haplotype>(stored, haplotype_region) == haplotypes[i];
+                                            });
+        if (match_itr == std::cend(stored_haplotypes)) return boost::none;
+        haplotype_indices[i] = std::distance(std::cbegin(stored_haplotypes), match_itr);
+    }
+    const auto num_samples = read<std::uint32_t>(in);
+    for (std::uint32_t s {0}; s < num_samples; ++s) {
+        const auto stored_sample = read_string(in);
+        const auto num_reads = read<std::uint32_t>(in);
+        const char* read_ids {in};
+        in += num_reads * sizeof(std::uint64_t);
+        const char* likelihoods {in};
+        in += std::size_t {num_stored_haplotypes} * num_reads * sizeof(float);
+        if (stored_sample != sample) continue;
+        std::unordered_map<std::uint64_t, std::uint32_t> read_indices {};
+        read_indices.reserve(num_reads);
+        for (std::uint32_t r {0}; r < num_reads; ++r) {
+            read_indices.emplace(read<std::uint64_t>(read_ids), r);
+        }
+        LikelihoodMatrix result(haplotypes.size(), std::vector<double>(reads.size(), std::numeric_limits<double>::quiet_NaN()));
+        for (std::size_t r {0}; r < reads.size(); ++r) {
+            const auto read_itr = read_indices.find(make_read_id(reads[r]));
+            if (read_itr == std::cend(read_indices)) continue;
+            for (std::size_t i {0}; i < haplotypes.size(); ++i) {
+                const char* likelihood {likelihoods + (haplotype_indices[i] * num_reads + read_itr->second) * sizeof(float)};
+                result[i][r] = read<float>(likelihood);
+            }
+        }
+        return result;
+    }
+    return boost::none;
+}
+
+} // namespace octopus
@@ -0,0 +1,125 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef likelihood_sidecar_hpp
+#define likelihood_sidecar_hpp
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+#include <functional>
+
+#include <boost/optional.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "config/common.hpp"
+#include "basics/genomic_region.hpp"
+#include "basics/aligned_read.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/models/haplotype_likelihood_array.hpp"
+#include "io/reference/reference_genome.hpp"
+
+namespace octopus {
+
+/*
+ A likelihood side-car stores the read-haplotype likelihoods computed during calling for the
+ called (and reference) haplotypes of each active region, so read assignment after calling -
+ call filtering and realigned BAM output - can look them up rather than evaluating the
+ likelihood model again.
+
+ LikelihoodSidecarWriter::write may be called concurrently. The side-car can only be read once
+ the writer is closed.
+ */
+class LikelihoodSidecarWriter
+{
+public:
+    using Path = boost::filesystem::path;
+
+    LikelihoodSidecarWriter() = delete;
+
+    LikelihoodSidecarWriter(Path path);
+
+    LikelihoodSidecarWriter(const LikelihoodSidecarWriter&)            = delete;
+    LikelihoodSidecarWriter& operator=(const LikelihoodSidecarWriter&) = delete;
+    LikelihoodSidecarWriter(LikelihoodSidecarWriter&&)                 = delete;
+    LikelihoodSidecarWriter& operator=(LikelihoodSidecarWriter&&)      = delete;
+
+    ~LikelihoodSidecarWriter();
+
+    const Path& path() const noexcept;
+
+    // All haplotypes must have the same region and be present in likelihoods
+    void write(const std::vector<Haplotype>& haplotypes, const ReadMap& reads,
+               const HaplotypeLikelihoodArray& likelihoods, const ReferenceGenome& reference);
+
+    void close();
+
+private:
+    struct IndexEntry
+    {
+        GenomicRegion region;
+        std::uint64_t offset, size;
+    };
+
+    Path path_;
+    std::ofstream file_;
+    std::vector<IndexEntry> index_;
+    std::uint64_t offset_;
+    bool closed_;
+    std::mutex mutex_;
+};
+
+class LikelihoodSidecarReader
+{
+public:
+    using Path = boost::filesystem::path;
+    using LikelihoodMatrix = std::vector<std::vector<double>>;
+
+    LikelihoodSidecarReader() = delete;
+
+    LikelihoodSidecarReader(Path path, const ReferenceGenome& reference);
+
+    LikelihoodSidecarReader(const LikelihoodSidecarReader&)            = delete;
+    LikelihoodSidecarReader& operator=(const LikelihoodSidecarReader&) = delete;
+    LikelihoodSidecarReader(LikelihoodSidecarReader&&)                 = default;
+    LikelihoodSidecarReader& operator=(LikelihoodSidecarReader&&)      = default;
+
+    ~LikelihoodSidecarReader() = default;
+
+    // Returns the stored log likelihoods of each read given each haplotype, indexed [haplotype][read], if
+    // every haplotype is stored for the sample in a single active region. Reads that were not evaluated
+    // during calling have NaN likelihoods.
+    boost::optional<LikelihoodMatrix>
+    fetch(const SampleName& sample, const std::vector<Haplotype>& haplotypes, const std::vector<AlignedRead>& reads) const;
+
+private:
+    struct IndexEntry
+    {
+        ContigRegion region;
+        std::uint64_t offset, size;
+    };
+
+    struct ContigIndex
+    {
+        std::vector<IndexEntry> entries;
+        ContigRegion::Size max_region_size = 0;
+    };
+
+    Path path_;
+    std::reference_wrapper<const ReferenceGenome> reference_;
+    std::unique_ptr<boost::iostreams::mapped_file_source> file_;
+    std::unordered_map<GenomicRegion::ContigName, ContigIndex> index_;
+
+    boost::optional<LikelihoodMatrix>
+    fetch(const IndexEntry& entry, const GenomicRegion::ContigName& contig, const SampleName& sample,
+          const std::vector<Haplotype>& haplotypes, const std::vector<AlignedRead>& reads) const;
+};
+
+} // namespace octopus
+
+#endif
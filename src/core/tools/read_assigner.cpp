@@ -9,6 +9,7 @@
 #include <limits>
 #include <random>
 #include <stdexcept>
+#include <cmath>
 #include <cassert>
 
 #include <boost/optional.hpp>
@@ -17,6 +18,7 @@
 #include "utils/kmer_mapper.hpp"
 #include "core/models/haplotype_likelihood_model.hpp"
 #include "core/models/error/error_model_factory.hpp"
+#include "likelihood_sidecar.hpp"
 
 namespace octopus {
 
@@ -184,28 +186,44 @@ auto calculate_likelihoods(const std::vector<Haplotype>& haplotypes, const Conta
     const auto reads_region = encompassing_region(reads);
     const auto read_hashes = compute_read_hashes(reads);
     static constexpr unsigned char mapperKmerSize {6};
-    auto haplotype_hashes = init_kmer_hash_table<mapperKmerSize>();
+    KmerIndex haplotype_index {mapperKmerSize};
     HaplotypeLikelihoods result {};
     result.reserve(haplotypes.size());
     const auto max_indel_size = estimate_max_indel_size(haplotypes);
     for (const auto& haplotype : haplotypes) {
         const auto expanded_haplotype = expand_for_alignment(haplotype, reads_region, max_indel_size);
-        populate_kmer_hash_table<mapperKmerSize>(expanded_haplotype.sequence(), haplotype_hashes);
-        auto haplotype_mapping_counts = init_mapping_counts(haplotype_hashes);
+        haplotype_index.index(expanded_haplotype.sequence());
         model.reset(expanded_haplotype);
         std::vector<double> likelihoods(reads.size());
         std::transform(std::cbegin(reads), std::cend(reads), std::cbegin(read_hashes), std::begin(likelihoods),
                        [&] (const auto& read, const auto& read_hash) {
-                           auto mapping_positions = map_query_to_target(read_hash, haplotype_hashes, haplotype_mapping_counts);
-                           reset_mapping_counts(haplotype_mapping_counts);
+                           auto mapping_positions = haplotype_index.map(read_hash);
                            return model.evaluate(read, mapping_positions);
                        });
-        clear_kmer_hash_table(haplotype_hashes);
         result.push_back(std::move(likelihoods));
     }
     return result;
 }
 
+void fill_missing_likelihoods(const std::vector<Haplotype>& haplotypes, const std::vector<AlignedRead>& reads,
+                              HaplotypeLikelihoodModel& model, HaplotypeLikelihoods& likelihoods)
+{
+    std::vector<std::size_t> missing_read_indices {};
+    for (std::size_t i {0}; i < reads.size(); ++i) {
+        if (std::isnan(likelihoods.front()[i])) missing_read_indices.push_back(i);
+    }
+    if (missing_read_indices.empty()) return;
+    std::vector<AlignedRead> missing_reads {};
+    missing_reads.reserve(missing_read_indices.size());
+    for (auto idx : missing_read_indices) missing_reads.push_back(reads[idx]);
+    const auto missing_likelihoods = calculate_likelihoods(haplotypes, missing_reads, model);
+    for (std::size_t k {0}; k < haplotypes.size(); ++k) {
+        for (std::size_t i {0}; i < missing_read_indices.size(); ++i) {
+            likelihoods[k][missing_read_indices[i]] = missing_likelihoods[k][i];
+        }
+    }
+}
+
 } // namespace
 
 HaplotypeSupportMap
@@ -319,6 +337,27 @@ compute_haplotype_support(const Genotype<Haplotype>& genotype,
     return compute_haplotype_support(genotype, reads, std::move(model), ambiguous, config);
 }
 
+HaplotypeSupportMap
+compute_haplotype_support(const Genotype<Haplotype>& genotype,
+                          const std::vector<AlignedRead>& reads,
+                          AmbiguousReadList& ambiguous,
+                          const SampleName& sample,
+                          const LikelihoodSidecarReader& likelihoods,
+                          AssignmentConfig config)
+{
+    if (!reads.empty() && !genotype.is_homozygous()) {
+        const auto unique_haplotypes = genotype.copy_unique();
+        auto haplotype_likelihoods = likelihoods.fetch(sample, unique_haplotypes, reads);
+        if (haplotype_likelihoods) {
+            auto model = make_default_haplotype_likelihood_model();
+            fill_missing_likelihoods(unique_haplotypes, reads, model, *haplotype_likelihoods);
+            const auto priors = get_priors(unique_haplotypes, {});
+            return calculate_support(unique_haplotypes, reads, priors, *haplotype_likelihoods, ambiguous, config);
+        }
+    }
+    return compute_haplotype_support(genotype, reads, ambiguous, config);
+}
+
 AlleleSupportMap
 compute_allele_support(const std::vector<Allele>& alleles, const HaplotypeSupportMap& haplotype_support)
 {
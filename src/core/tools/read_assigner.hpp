@@ -23,6 +23,7 @@
 namespace octopus {
 
 class HaplotypeLikelihoodModel;
+class LikelihoodSidecarReader;
 
 using HaplotypeProbabilityMap = std::unordered_map<Haplotype, double>;
 using ReadSupportSet = std::vector<AlignedRead>;
@@ -93,6 +94,15 @@ compute_haplotype_support(const Genotype<Haplotype>& genotype,
                           HaplotypeLikelihoodModel model,
                           AssignmentConfig config = AssignmentConfig {});
 
+// Uses likelihoods stored in the side-car when available, evaluating only reads or genotypes that are missing
+HaplotypeSupportMap
+compute_haplotype_support(const Genotype<Haplotype>& genotype,
+                          const std::vector<AlignedRead>& reads,
+                          AmbiguousReadList& ambiguous,
+                          const SampleName& sample,
+                          const LikelihoodSidecarReader& likelihoods,
+                          AssignmentConfig config = AssignmentConfig {});
+
 template <typename BinaryPredicate>
 AlleleSupportMap
 compute_allele_support(const std::vector<Allele>& alleles,
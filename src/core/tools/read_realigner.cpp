@@ -103,13 +103,11 @@ void realign(std::vector<AlignedRead>& reads, const Haplotype& haplotype, Haplot
     if (!reads.empty()) {
         const auto read_hashes = compute_read_hashes(reads);
         static constexpr unsigned char mapperKmerSize {6};
-        auto haplotype_hashes = init_kmer_hash_table<mapperKmerSize>();
-        populate_kmer_hash_table<mapperKmerSize>(haplotype.sequence(), haplotype_hashes);
-        auto haplotype_mapping_counts = init_mapping_counts(haplotype_hashes);
+        KmerIndex haplotype_index {mapperKmerSize};
+        haplotype_index.index(haplotype.sequence());
         model.reset(haplotype);
         for (std::size_t i {0}; i < reads.size(); ++i) {
-            auto mapping_positions = map_query_to_target(read_hashes[i], haplotype_hashes, haplotype_mapping_counts);
-            reset_mapping_counts(haplotype_mapping_counts);
+            auto mapping_positions = haplotype_index.map(read_hashes[i]);
             realign(reads[i], haplotype, model.align(reads[i], mapping_positions));
         }
     }
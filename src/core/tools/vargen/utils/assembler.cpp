@@ -12,7 +12,6 @@
 #include <cassert>
 #include <iostream>
 
-#include <boost/functional/hash.hpp>
 #include <boost/property_map/property_map.hpp>
 #include <boost/graph/depth_first_search.hpp>
 #include <boost/graph/breadth_first_search.hpp>
@@ -49,6 +48,41 @@ std::size_t count_kmers(const T& sequence, const unsigned kmer_size) noexcept
     return sequence.size() >= kmer_size ? sequence.size() - kmer_size + 1 : 0;
 }
 
+int base_code(const char base) noexcept
+{
+    switch (base) {
+        case 'A': return 0;
+        case 'C': return 1;
+        case 'G': return 2;
+        case 'T': return 3;
+        default: return -1;
+    }
+}
+
+// Kmer codes are dense in the low bits, so need mixing before use in the open addressing table
+std::size_t mix_code(std::uint64_t code) noexcept
+{
+    code ^= code >> 30;
+    code *= 0xbf58476d1ce4e5b9;
+    code ^= code >> 27;
+    code *= 0x94d049bb133111eb;
+    code ^= code >> 31;
+    return code;
+}
+
+// Polynomial rolling hash for kmers that cannot be packed
+constexpr std::uint64_t rollingHashBase {0x100000001b3};
+
+std::uint64_t rolling_hash_power(std::size_t exponent) noexcept
+{
+    std::uint64_t result {1}, base {rollingHashBase};
+    for (; exponent > 0; exponent >>= 1) {
+        if (exponent & 1) result *= base;
+        base *= base;
+    }
+    return result;
+}
+
 } // namespace
 
 // public methods
@@ -108,99 +142,78 @@ void Assembler::insert_read(const NucleotideSequence& sequence, const Direction
 {
     if (sequence.size() >= kmer_size()) {
         const bool is_forward_strand {strand == Direction::forward};
-        auto kmer_begin = std::cbegin(sequence);
-        auto kmer_end   = std::next(kmer_begin, kmer_size());
-        Kmer prev_kmer {kmer_begin, kmer_end};
-        bool prev_kmer_good {true};
-        auto vertex_itr = vertex_cache_.find(prev_kmer);
         auto ref_kmer_itr = std::cbegin(reference_kmers_);
-        if (vertex_itr == std::cend(vertex_cache_)) {
-            const auto u = add_vertex(prev_kmer);
-            if (!u) prev_kmer_good = false;
-        } else if (is_reference(vertex_itr->second)) {
-            ref_kmer_itr = std::find(std::cbegin(reference_kmers_), std::cend(reference_kmers_), prev_kmer);
-            assert(ref_kmer_itr != std::cend(reference_kmers_));
-            auto next_kmer_begin = std::next(kmer_begin);
-            auto next_kmer_end   = std::next(kmer_end);
+        // Follows the reference path for as long as the read matches it, leaving kmer at the last match
+        const auto follow_reference = [&] (Kmer& kmer) {
             const auto ref_offset = std::distance(std::cbegin(reference_kmers_), ref_kmer_itr);
             auto ref_vertex_itr = std::next(std::cbegin(reference_vertices_), ref_offset);
             auto ref_edge_itr = std::next(std::cbegin(reference_edges_), ref_offset);
             ++ref_kmer_itr;
-            for (; next_kmer_end <= std::cend(sequence) && ref_kmer_itr < std::cend(reference_kmers_);
-                   ++next_kmer_begin, ++next_kmer_end, ++ref_kmer_itr, ++ref_vertex_itr, ++ref_edge_itr) {
-                if (std::equal(next_kmer_begin, next_kmer_end, std::cbegin(*ref_kmer_itr))) {
-                    assert(ref_edge_itr != std::cend(reference_edges_));
-                    increment_weight(*ref_edge_itr, is_forward_strand);
-                } else {
-                    break;
-                }
+            for (; kmer.end() != std::cend(sequence) && ref_kmer_itr != std::cend(reference_kmers_);
+                   ++ref_kmer_itr, ++ref_vertex_itr, ++ref_edge_itr) {
+                const auto next_kmer = kmer.next();
+                if (next_kmer != *ref_kmer_itr) break;
+                assert(ref_edge_itr != std::cend(reference_edges_));
+                increment_weight(*ref_edge_itr, is_forward_strand);
+                kmer = next_kmer;
             }
-            if (next_kmer_end > std::cend(sequence)) {
+            return *ref_vertex_itr;
+        };
+        Kmer prev_kmer {std::cbegin(sequence), std::next(std::cbegin(sequence), kmer_size())};
+        bool prev_kmer_good {true};
+        auto prev_vertex = find_vertex(prev_kmer);
+        if (prev_vertex == null_vertex()) {
+            const auto u = add_vertex(prev_kmer);
+            if (u) {
+                prev_vertex = *u;
+            } else {
+                prev_kmer_good = false;
+            }
+        } else if (is_reference(prev_vertex)) {
+            ref_kmer_itr = std::find(std::cbegin(reference_kmers_), std::cend(reference_kmers_), prev_kmer);
+            assert(ref_kmer_itr != std::cend(reference_kmers_));
+            prev_vertex = follow_reference(prev_kmer);
+            if (prev_kmer.end() == std::cend(sequence)) {
                 return;
             }
-            kmer_begin = std::prev(next_kmer_begin);
-            kmer_end   = std::prev(next_kmer_end);
-            assert(kmer_end <= std::cend(sequence));
-            prev_kmer = Kmer {kmer_begin, kmer_end};
         }
-        ++kmer_begin;
-        ++kmer_end;
-        for (; kmer_end <= std::cend(sequence); ++kmer_begin, ++kmer_end) {
-            Kmer kmer {kmer_begin, kmer_end};
-            const auto kmer_itr = vertex_cache_.find(kmer);
-            if (kmer_itr == std::cend(vertex_cache_)) {
-                const auto v = add_vertex(kmer);
-                if (v) {
+        while (prev_kmer.end() != std::cend(sequence)) {
+            auto kmer = prev_kmer.next();
+            auto v = find_vertex(kmer);
+            if (v == null_vertex()) {
+                const auto new_v = add_vertex(kmer);
+                if (new_v) {
                     if (prev_kmer_good) {
-                        const auto u = vertex_cache_.at(prev_kmer);
-                        add_edge(u, *v, 1, is_forward_strand);
+                        add_edge(prev_vertex, *new_v, 1, is_forward_strand);
                     }
+                    v = *new_v;
                     prev_kmer_good = true;
                 } else {
                     prev_kmer_good = false;
                 }
             } else {
                 if (prev_kmer_good) {
-                    const auto u = vertex_cache_.at(prev_kmer);
-                    const auto v = kmer_itr->second;
                     Edge e; bool e_in_graph;
-                    std::tie(e, e_in_graph) = boost::edge(u, v, graph_);
+                    std::tie(e, e_in_graph) = boost::edge(prev_vertex, v, graph_);
                     if (e_in_graph) {
                         increment_weight(e, is_forward_strand);
                     } else {
-                        add_edge(u, v, 1, is_forward_strand);
+                        add_edge(prev_vertex, v, 1, is_forward_strand);
                     }
                 }
-                if (is_reference(kmer_itr->second)) {
+                if (is_reference(v)) {
                     ref_kmer_itr = std::find(ref_kmer_itr, std::cend(reference_kmers_), kmer);
                     if (ref_kmer_itr != std::cend(reference_kmers_)) {
-                        auto next_kmer_begin = std::next(kmer_begin);
-                        auto next_kmer_end   = std::next(kmer_end);
-                        const auto ref_offset = std::distance(std::cbegin(reference_kmers_), ref_kmer_itr);
-                        auto ref_vertex_itr = std::next(std::cbegin(reference_vertices_), ref_offset);
-                        auto ref_edge_itr = std::next(std::cbegin(reference_edges_), ref_offset);
-                        ++ref_kmer_itr;
-                        for (; next_kmer_end <= std::cend(sequence) && ref_kmer_itr < std::cend(reference_kmers_);
-                               ++next_kmer_begin, ++next_kmer_end, ++ref_kmer_itr, ++ref_vertex_itr, ++ref_edge_itr) {
-                            if (std::equal(next_kmer_begin, next_kmer_end, std::cbegin(*ref_kmer_itr))) {
-                                assert(ref_edge_itr != std::cend(reference_edges_));
-                                increment_weight(*ref_edge_itr, is_forward_strand);
-                            } else {
-                                break;
-                            }
-                        }
-                        if (next_kmer_end > std::cend(sequence)) {
+                        v = follow_reference(kmer);
+                        if (kmer.end() == std::cend(sequence)) {
                             return;
                         }
-                        kmer_begin = std::prev(next_kmer_begin);
-                        kmer_end   = std::prev(next_kmer_end);
-                        assert(kmer_end <= std::cend(sequence));
-                        kmer = Kmer {kmer_begin, kmer_end};
                     }
                 }
                 prev_kmer_good = true;
             }
             prev_kmer = kmer;
+            prev_vertex = v;
         }
     }
 }
@@ -373,7 +386,32 @@ void Assembler::write_dot(std::ostream& out) const
 Assembler::Kmer::Kmer(SequenceIterator first, SequenceIterator last) noexcept
 : first_ {first}
 , last_ {last}
-, hash_ {boost::hash_range(first_, last_)}
+, code_ {0}
+, is_packed_ {static_cast<std::size_t>(std::distance(first, last)) <= maxPackedSize}
+{
+    for (auto itr = first_; is_packed_ && itr != last_; ++itr) {
+        const auto code = base_code(*itr);
+        if (code < 0) {
+            is_packed_ = false;
+        } else {
+            code_ = (code_ << 2) | code;
+        }
+    }
+    if (!is_packed_) {
+        code_ = 0;
+        for (auto itr = first_; itr != last_; ++itr) {
+            code_ = code_ * rollingHashBase + static_cast<unsigned char>(*itr);
+        }
+    }
+    hash_ = mix_code(code_);
+}
+
+Assembler::Kmer::Kmer(SequenceIterator first, SequenceIterator last, KmerCode code, bool is_packed) noexcept
+: first_ {first}
+, last_ {last}
+, code_ {code}
+, is_packed_ {is_packed}
+, hash_ {mix_code(code)}
 {}
 
 char Assembler::Kmer::front() const noexcept
@@ -406,15 +444,143 @@ std::size_t Assembler::Kmer::hash() const noexcept
     return hash_;
 }
 
+bool Assembler::Kmer::is_packed() const noexcept
+{
+    return is_packed_;
+}
+
+Assembler::Kmer Assembler::Kmer::next() const noexcept
+{
+    const auto size = static_cast<std::size_t>(std::distance(first_, last_));
+    if (is_packed_) {
+        const auto code = base_code(*last_);
+        if (code >= 0) {
+            const auto mask = size < maxPackedSize ? (KmerCode {1} << (2 * size)) - 1 : ~KmerCode {0};
+            return Kmer {std::next(first_), std::next(last_), ((code_ << 2) | code) & mask, true};
+        }
+    } else if (size > maxPackedSize) {
+        // Short kmers must be recomputed in case the next kmer can be packed
+        const auto head = static_cast<unsigned char>(*first_) * rolling_hash_power(size - 1);
+        const auto code = (code_ - head) * rollingHashBase + static_cast<unsigned char>(*last_);
+        return Kmer {std::next(first_), std::next(last_), code, false};
+    }
+    return Kmer {std::next(first_), std::next(last_)};
+}
+
 bool operator==(const Assembler::Kmer& lhs, const Assembler::Kmer& rhs) noexcept
 {
-    return std::equal(lhs.first_, lhs.last_, rhs.first_);
+    if (lhs.is_packed_ != rhs.is_packed_ || lhs.code_ != rhs.code_) return false;
+    if (lhs.is_packed_) {
+        return std::distance(lhs.first_, lhs.last_) == std::distance(rhs.first_, rhs.last_);
+    }
+    return std::equal(lhs.first_, lhs.last_, rhs.first_, rhs.last_);
 }
 
 bool operator<(const Assembler::Kmer& lhs, const Assembler::Kmer& rhs) noexcept
 {
+    if (lhs.is_packed_ && rhs.is_packed_ && std::distance(lhs.first_, lhs.last_) == std::distance(rhs.first_, rhs.last_)) {
+        return lhs.code_ < rhs.code_;
+    }
     return std::lexicographical_compare(lhs.first_, lhs.last_, rhs.first_, rhs.last_);
 }
+
+// VertexCache
+
+std::size_t Assembler::VertexCache::size() const noexcept
+{
+    return size_;
+}
+
+bool Assembler::VertexCache::empty() const noexcept
+{
+    return size_ == 0;
+}
+
+void Assembler::VertexCache::reserve(const std::size_t n)
+{
+    std::size_t num_slots {16};
+    while (num_slots < 2 * n) num_slots *= 2;
+    if (num_slots > slots_.size()) rehash(num_slots);
+}
+
+void Assembler::VertexCache::clear() noexcept
+{
+    slots_.clear();
+    size_ = 0;
+}
+
+Assembler::Vertex Assembler::VertexCache::find(const Kmer& kmer, const KmerGraph& graph) const noexcept
+{
+    if (slots_.empty()) return boost::graph_traits<KmerGraph>::null_vertex();
+    const auto hash = kmer.hash();
+    for (auto i = hash & mask(); ; i = (i + 1) & mask()) {
+        const auto& slot = slots_[i];
+        if (slot.vertex == boost::graph_traits<KmerGraph>::null_vertex()
+            || (slot.hash == hash && graph[slot.vertex].kmer == kmer)) {
+            return slot.vertex;
+        }
+    }
+}
+
+void Assembler::VertexCache::insert(const Kmer& kmer, const Vertex v)
+{
+    // Keep the load factor at most a half so probe sequences stay short
+    if (2 * (size_ + 1) > slots_.size()) {
+        rehash(std::max(std::size_t {16}, 2 * slots_.size()));
+    }
+    const auto hash = kmer.hash();
+    auto i = hash & mask();
+    while (slots_[i].vertex != boost::graph_traits<KmerGraph>::null_vertex()) {
+        i = (i + 1) & mask();
+    }
+    slots_[i] = {hash, v};
+    ++size_;
+}
+
+bool Assembler::VertexCache::erase(const Kmer& kmer, const KmerGraph& graph) noexcept
+{
+    const auto null = boost::graph_traits<KmerGraph>::null_vertex();
+    if (slots_.empty()) return false;
+    const auto hash = kmer.hash();
+    auto i = hash & mask();
+    for (; ; i = (i + 1) & mask()) {
+        if (slots_[i].vertex == null) return false;
+        if (slots_[i].hash == hash && graph[slots_[i].vertex].kmer == kmer) break;
+    }
+    // Backward shift deletion: move later entries of the probe sequence into the hole
+    // when their home slot is not between the hole and themselves
+    for (auto j = (i + 1) & mask(); slots_[j].vertex != null; j = (j + 1) & mask()) {
+        const auto home = slots_[j].hash & mask();
+        if (((j - home) & mask()) >= ((j - i) & mask())) {
+            slots_[i] = slots_[j];
+            i = j;
+        }
+    }
+    slots_[i].vertex = null;
+    --size_;
+    return true;
+}
+
+std::size_t Assembler::VertexCache::mask() const noexcept
+{
+    return slots_.size() - 1;
+}
+
+void Assembler::VertexCache::rehash(const std::size_t num_slots)
+{
+    assert(num_slots > size_ && (num_slots & (num_slots - 1)) == 0);
+    std::vector<Slot> old_slots(num_slots, Slot {0, boost::graph_traits<KmerGraph>::null_vertex()});
+    std::swap(slots_, old_slots);
+    for (const auto& slot : old_slots) {
+        if (slot.vertex != boost::graph_traits<KmerGraph>::null_vertex()) {
+            auto i = slot.hash & mask();
+            while (slots_[i].vertex != boost::graph_traits<KmerGraph>::null_vertex()) {
+                i = (i + 1) & mask();
+            }
+            slots_[i] = slot;
+        }
+    }
+}
 //
 // Assembler private methods
 //
@@ -432,26 +598,24 @@ void Assembler::insert_reference_into_empty_graph(const NucleotideSequence& sequ
         }
         reference_vertices_.push_back(*u);
     } else {
-        reference_vertices_.push_back(vertex_cache_.at(reference_kmers_.back()));
+        reference_vertices_.push_back(find_vertex(reference_kmers_.back()));
     }
-    ++kmer_begin;
-    ++kmer_end;
-    for (; kmer_end <= std::cend(sequence); ++kmer_begin, ++kmer_end) {
-        reference_kmers_.emplace_back(kmer_begin, kmer_end);
+    for (; kmer_end != std::cend(sequence); ++kmer_end) {
+        reference_kmers_.push_back(reference_kmers_.back().next());
         const auto& kmer = reference_kmers_.back();
         if (!contains_kmer(kmer)) {
             const auto v = add_vertex(kmer, true);
             if (v) {
                 reference_vertices_.push_back(*v);
-                const auto u = vertex_cache_.at(std::crbegin(reference_kmers_)[1]);
+                const auto u = find_vertex(std::crbegin(reference_kmers_)[1]);
                 const auto e = add_reference_edge(u, *v);
                 reference_edges_.push_back(e);
             } else {
                 throw NonCanonicalReferenceSequence {sequence};
             }
         } else {
-            const auto u = vertex_cache_.at(std::crbegin(reference_kmers_)[1]);
-            const auto v = vertex_cache_.at(kmer);
+            const auto u = find_vertex(std::crbegin(reference_kmers_)[1]);
+            const auto v = find_vertex(kmer);
             reference_vertices_.push_back(v);
             const auto e = add_reference_edge(u, v);
             reference_edges_.push_back(e);
@@ -480,25 +644,23 @@ void Assembler::insert_reference_into_populated_graph(const NucleotideSequence&
         reference_vertices_.push_back(*u);
     } else {
         set_vertex_reference(reference_kmers_.back());
-        reference_vertices_.push_back(vertex_cache_.at(reference_kmers_.back()));
+        reference_vertices_.push_back(find_vertex(reference_kmers_.back()));
     }
-    ++kmer_begin;
-    ++kmer_end;
-    for (; kmer_end <= std::cend(sequence); ++kmer_begin, ++kmer_end) {
-        reference_kmers_.emplace_back(kmer_begin, kmer_end);
+    for (; kmer_end != std::cend(sequence); ++kmer_end) {
+        reference_kmers_.push_back(reference_kmers_.back().next());
         if (!contains_kmer(reference_kmers_.back())) {
             const auto v = add_vertex(reference_kmers_.back(), true);
             if (v) {
                 reference_vertices_.push_back(*v);
-                const auto u = vertex_cache_.at(std::crbegin(reference_kmers_)[1]);
+                const auto u = find_vertex(std::crbegin(reference_kmers_)[1]);
                 const auto e = add_reference_edge(u, *v);
                 reference_edges_.push_back(e);
             } else {
                 throw NonCanonicalReferenceSequence {sequence};
             }
         } else {
-            const auto u = vertex_cache_.at(std::crbegin(reference_kmers_)[1]);
-            const auto v = vertex_cache_.at(reference_kmers_.back());
+            const auto u = find_vertex(std::crbegin(reference_kmers_)[1]);
+            const auto v = find_vertex(reference_kmers_.back());
             reference_vertices_.push_back(v);
             set_vertex_reference(v);
             Edge e; bool e_in_graph;
@@ -511,7 +673,6 @@ void Assembler::insert_reference_into_populated_graph(const NucleotideSequence&
             reference_edges_.push_back(e);
         }
     }
-    vertex_cache_.rehash(vertex_cache_.size());
     reference_kmers_.shrink_to_fit();
     reference_vertices_.shrink_to_fit();
     reference_edges_.shrink_to_fit();
@@ -521,12 +682,17 @@ void Assembler::insert_reference_into_populated_graph(const NucleotideSequence&
 
 bool Assembler::contains_kmer(const Kmer& kmer) const noexcept
 {
-    return vertex_cache_.count(kmer) == 1;
+    return find_vertex(kmer) != null_vertex();
 }
 
 std::size_t Assembler::count_kmer(const Kmer& kmer) const noexcept
 {
-    return vertex_cache_.count(kmer);
+    return contains_kmer(kmer) ? 1 : 0;
+}
+
+Assembler::Vertex Assembler::find_vertex(const Kmer& kmer) const noexcept
+{
+    return vertex_cache_.find(kmer, graph_);
 }
 
 std::size_t Assembler::reference_size() const noexcept
@@ -563,40 +729,45 @@ bool Assembler::is_reference_unique_path() const
     }
 }
 
-Assembler::Vertex Assembler::null_vertex() const
+Assembler::Vertex Assembler::null_vertex() const noexcept
 {
     return boost::graph_traits<KmerGraph>::null_vertex();
 }
 
 boost::optional<Assembler::Vertex> Assembler::add_vertex(const Kmer& kmer, const bool is_reference)
 {
-    if (!utils::is_canonical_dna(kmer)) return boost::none;
+    if (!(kmer.is_packed() || utils::is_canonical_dna(kmer))) return boost::none;
     const auto u = boost::add_vertex({boost::num_vertices(graph_), kmer, is_reference}, graph_);
-    vertex_cache_.emplace(kmer, u);
+    vertex_cache_.insert(kmer, u);
     return u;
 }
 
 void Assembler::remove_vertex(const Vertex v)
 {
-    const auto c = vertex_cache_.erase(kmer_of(v));
-    assert(c == 1);
-    _unused(c); // make production build happy
+    const auto erased = vertex_cache_.erase(kmer_of(v), graph_);
+    assert(erased);
+    _unused(erased); // make production build happy
     boost::remove_vertex(v, graph_);
 }
 
 void Assembler::clear_and_remove_vertex(const Vertex v)
 {
-    const auto c = vertex_cache_.erase(kmer_of(v));
-    assert(c == 1);
-    _unused(c); // make production build happy
+    const auto erased = vertex_cache_.erase(kmer_of(v), graph_);
+    assert(erased);
+    _unused(erased); // make production build happy
     boost::clear_vertex(v, graph_);
     boost::remove_vertex(v, graph_);
 }
 
-void Assembler::clear_and_remove_all(const std::unordered_set<Vertex>& vertices)
+void Assembler::clear_and_remove_all(const VertexSet& vertices)
 {
-    for (const Vertex v : vertices) {
-        clear_and_remove_vertex(v);
+    VertexIterator vi, vi_end, vi_next;
+    std::tie(vi, vi_end) = boost::vertices(graph_);
+    for (vi_next = vi; vi != vi_end; vi = vi_next) {
+        ++vi_next;
+        if (vertices[graph_[*vi].index]) {
+            clear_and_remove_vertex(*vi);
+        }
     }
 }
 
@@ -636,7 +807,7 @@ void Assembler::set_vertex_reference(const Vertex v)
 
 void Assembler::set_vertex_reference(const Kmer& kmer)
 {
-    set_vertex_reference(vertex_cache_.at(kmer));
+    set_vertex_reference(find_vertex(kmer));
 }
 
 void Assembler::set_edge_reference(const Edge e)
@@ -745,9 +916,9 @@ boost::optional<Assembler::Vertex> Assembler::find_joining_kmer(const Vertex v)
     for (const auto base : bases) {
         adjacent_kmer.back() = base;
         const Kmer k {std::cbegin(adjacent_kmer), std::cend(adjacent_kmer)};
-        const auto itr = vertex_cache_.find(k);
-        if (itr != std::cend(vertex_cache_)) {
-            return itr->second;
+        const auto u = find_vertex(k);
+        if (u != null_vertex()) {
+            return u;
         }
     }
     return boost::none;
@@ -886,6 +1057,28 @@ protected:
     const bool allow_self_edges_;
 };
 
+template <typename IndexMap>
+struct ReachableVertexRecorder : public boost::default_bfs_visitor
+{
+    ReachableVertexRecorder(std::vector<bool>& result, IndexMap index_map)
+    : index_map_ {index_map}, result_ {result} {}
+    
+    template <typename Graph>
+    void discover_vertex(typename boost::graph_traits<Graph>::vertex_descriptor v, const Graph&)
+    {
+        result_[boost::get(index_map_, v)] = true;
+    }
+protected:
+    IndexMap index_map_;
+    std::vector<bool>& result_;
+};
+
+template <typename IndexMap>
+auto make_reachable_vertex_recorder(std::vector<bool>& result, IndexMap index_map)
+{
+    return ReachableVertexRecorder<IndexMap> {result, index_map};
+}
+
 template <typename Container>
 struct CyclicEdgeDetector : public boost::default_dfs_visitor
 {
@@ -953,34 +1146,31 @@ void Assembler::remove_all_nonreference_cycles(const bool break_chains)
     CyclicEdgeDetector<decltype(cyclic_edges)> vis {cyclic_edges};
     boost::depth_first_search(graph_, boost::visitor(vis).root_vertex(reference_head()).vertex_index_map(index_map));
     if (cyclic_edges.empty()) return;
-    std::unordered_set<Vertex> bad_kmers {}, reference_origins {}, reference_sinks {};
+    const auto num_vertices = boost::num_vertices(graph_);
+    VertexSet bad_kmers(num_vertices), reference_origins(num_vertices), reference_sinks(num_vertices);
     std::deque<std::pair<Vertex, Vertex>> cyclic_reference_segments {};
-    if (break_chains) {
-        bad_kmers.reserve(std::min(2 * cyclic_edges.size(), num_kmers()));
-        reference_origins.reserve(num_reference_kmers());
-    }
     for (const Edge& back_edge : cyclic_edges) {
         if (!is_reference(back_edge)) {
             if (break_chains) {
                 Vertex cycle_origin {boost::source(back_edge, graph_)};
-                while (!is_reference(cycle_origin) && is_bridge(cycle_origin) && bad_kmers.count(cycle_origin) == 0) {
-                    bad_kmers.insert(cycle_origin);
+                while (!is_reference(cycle_origin) && is_bridge(cycle_origin) && !bad_kmers[index_map[cycle_origin]]) {
+                    bad_kmers[index_map[cycle_origin]] = true;
                     cycle_origin = *boost::inv_adjacent_vertices(cycle_origin, graph_).first;
                 }
                 bool is_reference_origin {false};
                 if (is_reference(cycle_origin)) {
-                    reference_origins.insert(cycle_origin);
+                    reference_origins[index_map[cycle_origin]] = true;
                     is_reference_origin = true;
                 } else {
-                    bad_kmers.insert(cycle_origin);
+                    bad_kmers[index_map[cycle_origin]] = true;
                 }
                 Vertex cycle_sink {boost::target(back_edge, graph_)};
-                while (!is_reference(cycle_sink) && is_bridge(cycle_sink) && bad_kmers.count(cycle_sink) == 0) {
-                    bad_kmers.insert(cycle_origin);
+                while (!is_reference(cycle_sink) && is_bridge(cycle_sink) && !bad_kmers[index_map[cycle_sink]]) {
+                    bad_kmers[index_map[cycle_origin]] = true;
                     cycle_sink = *boost::adjacent_vertices(cycle_sink, graph_).first;
                 }
                 if (is_reference(cycle_sink)) {
-                    reference_sinks.insert(cycle_sink);
+                    reference_sinks[index_map[cycle_sink]] = true;
                     if (is_reference_origin) {
                         cyclic_reference_segments.emplace_back(cycle_sink, cycle_origin);
                     } else if (boost::out_degree(cycle_origin, graph_) > 1) {
@@ -991,8 +1181,8 @@ void Assembler::remove_all_nonreference_cycles(const bool break_chains)
                             if (tail_edge != back_edge) {
                                 auto tail = boost::target(tail_edge, graph_);
                                 while (!is_reference(tail) && boost::out_degree(tail, graph_) == 1
-                                       && bad_kmers.count(tail) == 0) {
-                                    bad_kmers.insert(tail);
+                                       && !bad_kmers[index_map[tail]]) {
+                                    bad_kmers[index_map[tail]] = true;
                                     tail = *boost::adjacent_vertices(tail, graph_).first;
                                 }
                                 if (is_reference(tail)) {
@@ -1023,22 +1213,25 @@ void Assembler::remove_all_nonreference_cycles(const bool break_chains)
                         }
                     }
                 } else {
-                    bad_kmers.insert(cycle_sink);
+                    bad_kmers[index_map[cycle_sink]] = true;
                 }
             }
             remove_edge(back_edge);
         }
     }
     bool regenerate_indices {false};
-    for (Vertex v : reference_origins) {
-        boost::remove_in_edge_if(v, [this] (Edge e) { return !is_reference(e); }, graph_);
-        regenerate_indices = true;
-    }
-    for (Vertex v : reference_sinks) {
-        boost::remove_out_edge_if(v, [this] (Edge e) { return !is_reference(e); }, graph_);
-        regenerate_indices = true;
-    }
-    if (!bad_kmers.empty()) {
+    const auto p = boost::vertices(graph_);
+    std::for_each(p.first, p.second, [&] (Vertex v) {
+        if (reference_origins[index_map[v]]) {
+            boost::remove_in_edge_if(v, [this] (Edge e) { return !is_reference(e); }, graph_);
+            regenerate_indices = true;
+        }
+        if (reference_sinks[index_map[v]]) {
+            boost::remove_out_edge_if(v, [this] (Edge e) { return !is_reference(e); }, graph_);
+            regenerate_indices = true;
+        }
+    });
+    if (std::find(std::cbegin(bad_kmers), std::cend(bad_kmers), true) != std::cend(bad_kmers)) {
         clear_and_remove_all(bad_kmers);
         regenerate_indices = true;
     }
@@ -1263,32 +1456,20 @@ void Assembler::remove_disconnected_vertices()
     }
 }
 
-std::unordered_set<Assembler::Vertex> Assembler::find_reachable_kmers(const Vertex from) const
+Assembler::VertexSet Assembler::find_reachable_kmers(const Vertex from) const
 {
-    std::unordered_set<Vertex> result {};
-    result.reserve(boost::num_vertices(graph_));
-    auto vis = boost::make_bfs_visitor(boost::write_property(boost::typed_identity_property_map<Vertex>(),
-                                                             std::inserter(result, std::begin(result)),
-                                                             boost::on_discover_vertex()));
+    const auto index_map = boost::get(&GraphNode::index, graph_);
+    VertexSet result(boost::num_vertices(graph_));
     boost::breadth_first_search(graph_, from,
-                                boost::visitor(vis).vertex_index_map(boost::get(&GraphNode::index, graph_)));
+                                boost::visitor(make_reachable_vertex_recorder(result, index_map)).vertex_index_map(index_map));
     return result;
 }
 
-std::deque<Assembler::Vertex> Assembler::remove_vertices_that_cant_be_reached_from(const Vertex v)
+void Assembler::remove_vertices_that_cant_be_reached_from(const Vertex v)
 {
-    const auto reachables = find_reachable_kmers(v);
-    VertexIterator vi, vi_end, vi_next;
-    std::tie(vi, vi_end) = boost::vertices(graph_);
-    std::deque<Vertex> result {};
-    for (vi_next = vi; vi != vi_end; vi = vi_next) {
-        ++vi_next;
-        if (reachables.count(*vi) == 0) {
-            result.push_back(*vi);
-            clear_and_remove_vertex(*vi);
-        }
-    }
-    return result;
+    auto unreachables = find_reachable_kmers(v);
+    unreachables.flip();
+    clear_and_remove_all(unreachables);
 }
 
 void Assembler::remove_vertices_that_cant_reach(const Vertex v)
@@ -1296,60 +1477,51 @@ void Assembler::remove_vertices_that_cant_reach(const Vertex v)
     if (!is_reference_empty()) {
         const auto transpose = boost::make_reverse_graph(graph_);
         const auto index_map = boost::get(&GraphNode::index, transpose);
-        std::unordered_set<Vertex> reachables {};
-        auto vis = boost::make_bfs_visitor(boost::write_property(boost::typed_identity_property_map<Vertex>(),
-                                                                 std::inserter(reachables, std::begin(reachables)),
-                                                                 boost::on_discover_vertex()));
-        boost::breadth_first_search(transpose, v, boost::visitor(vis).vertex_index_map(index_map));
-        VertexIterator vi, vi_end, vi_next;
-        std::tie(vi, vi_end) = boost::vertices(graph_);
-        for (vi_next = vi; vi != vi_end; vi = vi_next) {
-            ++vi_next;
-            if (reachables.count(*vi) == 0) {
-                clear_and_remove_vertex(*vi);
-            }
-        }
+        VertexSet unreachables(boost::num_vertices(graph_));
+        boost::breadth_first_search(transpose, v,
+                                    boost::visitor(make_reachable_vertex_recorder(unreachables, index_map)).vertex_index_map(index_map));
+        unreachables.flip();
+        clear_and_remove_all(unreachables);
     }
 }
 
 void Assembler::remove_vertices_past(const Vertex v)
 {
+    const auto index_map = boost::get(&GraphNode::index, graph_);
     auto reachables = find_reachable_kmers(v);
-    reachables.erase(v);
+    reachables[index_map[v]] = false;
     boost::clear_out_edges(v, graph_);
     std::deque<Vertex> cycle_tails {};
     // Must check for cycles that lead back to v
-    for (auto u : reachables) {
-        Edge e; bool present;
-        std::tie(e, present) = boost::edge(u, v, graph_);
-        if (present) cycle_tails.push_back(u);
-    }
+    const auto p = boost::inv_adjacent_vertices(v, graph_);
+    std::for_each(p.first, p.second, [&] (Vertex u) {
+        if (reachables[index_map[u]]) {
+            cycle_tails.push_back(u);
+            reachables[index_map[u]] = false;
+        }
+    });
     if (!cycle_tails.empty()) {
         // We can check reachable back edges as the links from v were cut previously
         const auto transpose = boost::make_reverse_graph(graph_);
-        const auto index_map = boost::get(&GraphNode::index, transpose);
-        std::unordered_set<Vertex> back_reachables {};
-        auto vis = boost::make_bfs_visitor(boost::write_property(boost::typed_identity_property_map<Vertex>(),
-                                                                 std::inserter(back_reachables, std::begin(back_reachables)),
-                                                                 boost::on_discover_vertex()));
+        const auto transpose_index_map = boost::get(&GraphNode::index, transpose);
+        VertexSet back_reachables(boost::num_vertices(graph_));
+        const auto vis = make_reachable_vertex_recorder(back_reachables, transpose_index_map);
         for (auto u : cycle_tails) {
-            boost::breadth_first_search(transpose, u, boost::visitor(vis).vertex_index_map(index_map));
-            reachables.erase(u);
+            boost::breadth_first_search(transpose, u, boost::visitor(vis).vertex_index_map(transpose_index_map));
         }
         // The intersection of reachables & back_reachables are vertices part
         // of a cycle past v. The remaining vertices in reachables are safe to
         // remove.
         bool has_intersects {false};
-        for (auto u : back_reachables) {
-            const auto iter = reachables.find(u);
-            if (iter != std::cend(reachables)) {
-                reachables.erase(iter);
+        for (std::size_t i {0}; i < reachables.size(); ++i) {
+            if (reachables[i] && back_reachables[i]) {
+                reachables[i] = false;
                 has_intersects = true;
             }
         }
         if (has_intersects) {
-            const auto removed = remove_vertices_that_cant_be_reached_from(reference_head());
-            for (auto u : removed) reachables.erase(u);
+            // Vertex indices are not regenerated, so reachables remains valid for the remaining vertices
+            remove_vertices_that_cant_be_reached_from(reference_head());
         }
     }
     clear_and_remove_all(reachables);
@@ -1409,52 +1581,41 @@ void Assembler::prune_reference_flanks()
 Assembler::DominatorMap
 Assembler::build_dominator_tree(const Vertex from) const
 {
-    DominatorMap result;
-    result.reserve(boost::num_vertices(graph_));
-    boost::lengauer_tarjan_dominator_tree(graph_, from,  boost::make_assoc_property_map(result));
-    auto it = std::cbegin(result);
-    for (; it != std::cend(result);) {
-        if (it->second == null_vertex()) {
-            it = result.erase(it);
-        } else {
-            ++it;
-        }
-    }
-    result.rehash(result.size());
+    const auto index_map = boost::get(&GraphNode::index, graph_);
+    DominatorMap result(boost::num_vertices(graph_), null_vertex());
+    boost::lengauer_tarjan_dominator_tree(graph_, from, boost::make_iterator_property_map(std::begin(result), index_map));
     return result;
 }
 
-std::unordered_set<Assembler::Vertex> Assembler::extract_nondominants(const Vertex from) const
+std::deque<Assembler::Vertex> Assembler::extract_nondominants(const Vertex from) const
 {
     const auto dom_tree = build_dominator_tree(from);
-    std::unordered_set<Vertex> dominators {};
-    dominators.reserve(dom_tree.size());
-    for (const auto& p : dom_tree) {
-        dominators.emplace(p.second);
-    }
-    std::unordered_set<Vertex> result {};
-    result.reserve(dom_tree.size());
-    for (const auto& p : dom_tree) {
-        if (dominators.count(p.first) == 0) {
-            result.emplace(p.first);
-        }
+    const auto index_map = boost::get(&GraphNode::index, graph_);
+    VertexSet dominators(dom_tree.size());
+    for (const Vertex u : dom_tree) {
+        if (u != null_vertex()) dominators[index_map[u]] = true;
     }
+    std::deque<Vertex> result {};
+    const auto p = boost::vertices(graph_);
+    std::copy_if(p.first, p.second, std::back_inserter(result), [&] (Vertex v) {
+        return dom_tree[index_map[v]] != null_vertex() && !dominators[index_map[v]];
+    });
     return result;
 }
 
 std::deque<Assembler::Vertex> Assembler::extract_nondominant_reference(const DominatorMap& dominator_tree) const
 {
-    std::unordered_set<Vertex> dominators {};
-    dominators.reserve(dominator_tree.size());
-    for (const auto& p : dominator_tree) {
-        dominators.emplace(p.second);
+    const auto index_map = boost::get(&GraphNode::index, graph_);
+    VertexSet dominators(dominator_tree.size());
+    for (const Vertex u : dominator_tree) {
+        if (u != null_vertex()) dominators[index_map[u]] = true;
     }
     std::deque<Vertex> result {};
-    for (const auto& p : dominator_tree) {
-        if (is_reference(p.first) && p.first != reference_tail() && dominators.count(p.first) == 0) {
-            result.push_back(p.first);
-        }
-    }
+    const auto p = boost::vertices(graph_);
+    std::copy_if(p.first, p.second, std::back_inserter(result), [&] (Vertex v) {
+        return dominator_tree[index_map[v]] != null_vertex() && is_reference(v) && v != reference_tail()
+               && !dominators[index_map[v]];
+    });
     return result;
 }
 
@@ -1727,7 +1888,7 @@ Assembler::extract_bubble_paths(unsigned k, const double min_bubble_score)
 {
     auto num_remaining_alt_kmers = num_kmers() - num_reference_kmers();
     std::deque<Variant> result {};
-    boost::optional<DominatorMap> dominator_tree {};
+    bool blocked_nondominant_reference {false};
     bool use_weights {false};
     while (k > 0 && num_remaining_alt_kmers > 0) {
         auto predecessors = find_shortest_scoring_paths(reference_head(), use_weights);
@@ -1736,7 +1897,7 @@ Assembler::extract_bubble_paths(unsigned k, const double min_bubble_score)
         std::tie(alt, ref, rhs_kmer_count) = backtrack_until_nonreference(predecessors, reference_tail());
         if (alt == reference_head()) {
             // complete reference path is shortest path
-            if (dominator_tree) {
+            if (blocked_nondominant_reference) {
                 if (use_weights) {
                     utils::append(extract_bubble_paths_with_ksp(k, min_bubble_score), result);
                     return result;
@@ -1745,11 +1906,11 @@ Assembler::extract_bubble_paths(unsigned k, const double min_bubble_score)
                     continue;
                 }
             } else {
-                dominator_tree = build_dominator_tree(reference_head());
-                const auto nondominant_reference = extract_nondominant_reference(*dominator_tree);
+                const auto nondominant_reference = extract_nondominant_reference(build_dominator_tree(reference_head()));
                 for (Vertex v : nondominant_reference) {
                     block_all_in_edges(v);
                 }
+                blocked_nondominant_reference = true;
                 continue;
             }
         }
@@ -1928,10 +2089,11 @@ std::deque<Assembler::SubGraph> Assembler::find_independent_subgraphs() const
         std::copy_if(std::next(candidate_subgraph_tail_itr), std::cend(reference_vertices_),
                      std::front_inserter(coalescent_points), coalesces);
         const auto dominator = build_dominator_tree(reference_head());
+        const auto index_map = boost::get(&GraphNode::index, graph_);
         std::deque<SubGraph> result {};
         while (subgraph_head_itr != std::cend(reference_vertices_)) {
             auto subbgraph_end = std::find_if(std::cbegin(coalescent_points), std::cend(coalescent_points),
-                                              [&] (const Vertex& v) { return dominator.at(v) == *subgraph_head_itr; });
+                                              [&] (const Vertex& v) { return dominator[index_map[v]] == *subgraph_head_itr; });
             assert(subbgraph_end != std::cend(coalescent_points));
             auto subgraph_offset = static_cast<std::size_t>(std::distance(std::cbegin(reference_vertices_), subgraph_head_itr));
             result.push_back({*subgraph_head_itr, *subbgraph_end, subgraph_offset});
@@ -2034,9 +2196,13 @@ void Assembler::print_weighted(const Path& path) const
 void Assembler::print_dominator_tree() const
 {
     const auto dom_tree = build_dominator_tree(reference_head());
-    for (const auto& p : dom_tree) {
-        std::cout << kmer_of(p.first) << " dominated by " << kmer_of(p.second) << std::endl;
-    }
+    const auto p = boost::vertices(graph_);
+    std::for_each(p.first, p.second, [&] (Vertex v) {
+        const auto u = dom_tree[graph_[v].index];
+        if (u != null_vertex()) {
+            std::cout << kmer_of(v) << " dominated by " << kmer_of(u) << std::endl;
+        }
+    });
 }
 
 // non-member methods
@@ -8,8 +8,8 @@
 #include <deque>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
 #include <cstddef>
+#include <cstdint>
 #include <utility>
 #include <tuple>
 #include <stdexcept>
@@ -122,21 +122,31 @@ private:
         
         std::size_t hash() const noexcept;
         
+        // Canonical kmers no longer than maxPackedSize are stored 2-bit packed
+        bool is_packed() const noexcept;
+        
+        // The kmer one base along the same sequence, which must extend past end()
+        Kmer next() const noexcept;
+        
         friend bool operator==(const Kmer& lhs, const Kmer& rhs) noexcept;
         friend bool operator<(const Kmer& lhs, const Kmer& rhs) noexcept;
     private:
+        using KmerCode = std::uint64_t;
+        
+        static constexpr std::size_t maxPackedSize {32};
+        
         SequenceIterator first_, last_;
+        // The 2-bit packed bases if is_packed_, otherwise a rolling hash of the bases
+        KmerCode code_;
+        bool is_packed_;
         std::size_t hash_;
+        
+        Kmer(SequenceIterator first, SequenceIterator last, KmerCode code, bool is_packed) noexcept;
     };
     
     friend bool operator==(const Kmer& lhs, const Kmer& rhs) noexcept;
     friend bool operator<(const Kmer& lhs, const Kmer& rhs) noexcept;
     
-    struct KmerHash
-    {
-        std::size_t operator()(const Kmer& k) const noexcept { return k.hash(); }
-    };
-    
     struct GraphEdge
     {
         using WeightType = unsigned;
@@ -160,7 +170,9 @@ private:
     using VertexIterator = boost::graph_traits<KmerGraph>::vertex_iterator;
     using EdgeIterator   = boost::graph_traits<KmerGraph>::edge_iterator;
     
-    using DominatorMap = std::unordered_map<Vertex, Vertex>;
+    // Indexed by vertex index, so only valid until the vertex indices are regenerated
+    using VertexSet    = std::vector<bool>;
+    using DominatorMap = std::vector<Vertex>;
     
     using Path = std::deque<Vertex>;
     using EdgePath = std::vector<Edge>;
@@ -172,6 +184,37 @@ private:
         std::size_t reference_offset;
     };
     
+    // Open addressing hash table from kmers to vertices. The kmers are not stored in the table
+    // but read from the graph, so it is only valid for the graph the vertices belong to.
+    class VertexCache
+    {
+    public:
+        VertexCache() = default;
+        
+        std::size_t size() const noexcept;
+        bool empty() const noexcept;
+        void reserve(std::size_t n);
+        void clear() noexcept;
+        
+        // Returns null_vertex() if the kmer is not present
+        Vertex find(const Kmer& kmer, const KmerGraph& graph) const noexcept;
+        // The kmer must not already be present
+        void insert(const Kmer& kmer, Vertex v);
+        bool erase(const Kmer& kmer, const KmerGraph& graph) noexcept;
+    private:
+        struct Slot
+        {
+            std::size_t hash;
+            Vertex vertex;
+        };
+        
+        std::vector<Slot> slots_ = {};
+        std::size_t size_ = 0;
+        
+        std::size_t mask() const noexcept;
+        void rehash(std::size_t num_slots);
+    };
+    
     Parameters params_;
     
     std::deque<Kmer> reference_kmers_;
@@ -179,7 +222,7 @@ private:
     
     KmerGraph graph_;
     
-    std::unordered_map<Kmer, Vertex, KmerHash> vertex_cache_;
+    VertexCache vertex_cache_;
     Path reference_vertices_;
     std::deque<Edge> reference_edges_;
     
@@ -189,14 +232,15 @@ private:
     void insert_reference_into_populated_graph(const NucleotideSequence& reference);
     bool contains_kmer(const Kmer& kmer) const noexcept;
     std::size_t count_kmer(const Kmer& kmer) const noexcept;
+    Vertex find_vertex(const Kmer& kmer) const noexcept;
     std::size_t reference_size() const noexcept;
     void regenerate_vertex_indices();
     bool is_reference_unique_path() const;
-    Vertex null_vertex() const;
+    Vertex null_vertex() const noexcept;
     boost::optional<Vertex> add_vertex(const Kmer& kmer, bool is_reference = false);
     void remove_vertex(Vertex v);
     void clear_and_remove_vertex(Vertex v);
-    void clear_and_remove_all(const std::unordered_set<Vertex>& vertices);
+    void clear_and_remove_all(const VertexSet& vertices);
     Edge add_edge(Vertex u, Vertex v, GraphEdge::WeightType weight, GraphEdge::WeightType forward_weight,
                   bool is_reference = false, bool is_artificial = false);
     Edge add_reference_edge(Vertex u, Vertex v);
@@ -262,8 +306,8 @@ private:
     bool is_low_weight(Vertex v, unsigned min_weight) const;
     void remove_low_weight_edges(unsigned min_weight);
     void remove_disconnected_vertices();
-    std::unordered_set<Vertex> find_reachable_kmers(Vertex from) const;
-    std::deque<Vertex> remove_vertices_that_cant_be_reached_from(Vertex v);
+    VertexSet find_reachable_kmers(Vertex from) const;
+    void remove_vertices_that_cant_be_reached_from(Vertex v);
     void remove_vertices_that_cant_reach(Vertex v);
     void remove_vertices_past(Vertex v);
     bool can_prune_reference_flanks() const;
@@ -272,7 +316,7 @@ private:
     void prune_reference_flanks();
     std::pair<Vertex, unsigned> find_bifurcation(Vertex from, Vertex to) const;
     DominatorMap build_dominator_tree(Vertex from) const;
-    std::unordered_set<Vertex> extract_nondominants(Vertex from) const;
+    std::deque<Vertex> extract_nondominants(Vertex from) const;
     std::deque<Vertex> extract_nondominant_reference(const DominatorMap&) const;
     void set_out_edge_transition_scores(Vertex v);
     void set_all_edge_transition_scores_from(Vertex src);
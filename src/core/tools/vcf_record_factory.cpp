@@ -600,7 +600,7 @@ void set_allele_counts(const Call& call, const std::vector<SampleName>& samples,
     } else {
         // It's safe to put ac before ad as there can only be one canonical alt allele, which is always listed
         // before the deleted allele.
-        result.set_info("AC", {std::to_string(std::get<0>(t)), std::to_string(std::get<1>(t))});
+        result.set_info("AC", {std::get<0>(t), std::get<1>(t)});
     }
     
     result.set_info("AN", std::get<2>(t));
@@ -646,14 +646,14 @@ VcfRecord VcfRecordFactory::make(std::unique_ptr<Call> call) const
             const auto& genotype_call = call->get_genotype_call(sample);
             auto gq = std::min(999, static_cast<int>(std::round(genotype_call.posterior.score())));
             set_vcf_genotype(sample, genotype_call, result, has_non_ref);
-            result.set_format(sample, "GQ", std::to_string(gq));
+            result.set_format(sample, "GQ", gq);
             result.set_format(sample, "DP", max_coverage(call_reads.at(sample)));
             result.set_format(sample, "MQ", static_cast<unsigned>(rmq_mapping_quality(call_reads.at(sample))));
             if (call->is_phased(sample)) {
                 const auto& phase = *genotype_call.phase;
                 auto pq = std::min(99, static_cast<int>(std::round(phase.score().score())));
                 result.set_format(sample, "PS", mapped_begin(phase.region()) + 1);
-                result.set_format(sample, "PQ", std::to_string(pq));
+                result.set_format(sample, "PQ", pq);
             }
         }
     }
@@ -703,7 +703,7 @@ void set_allele_counts(const std::vector<VcfRecord::NucleotideSequence>& alt_all
                        VcfRecord::Builder& result)
 {
     auto p = get_allele_counts(alt_alleles, genotypes);
-    result.set_info("AC", utils::to_strings(p.first));
+    result.set_info("AC", std::vector<VcfRecord::ValueType> {std::cbegin(p.first), std::cend(p.first)});
     result.set_info("AN", p.second);
 }
 
@@ -799,14 +799,14 @@ VcfRecord VcfRecordFactory::make_segment(std::vector<std::unique_ptr<Call>>&& ca
                              std::string {vcfspec::missingValue}, std::string {vcf::spec::allele::nonref});
             }
             result.set_genotype(sample, genotype_call, VcfRecord::Builder::Phasing::phased);
-            result.set_format(sample, "GQ", std::to_string(gq));
+            result.set_format(sample, "GQ", gq);
             result.set_format(sample, "DP", max_coverage(reads_.at(sample), region));
             result.set_format(sample, "MQ", static_cast<unsigned>(rmq_mapping_quality(reads_.at(sample), region)));
             if (calls.front()->is_phased(sample)) {
                 const auto phase = *calls.front()->get_genotype_call(sample).phase;
                 auto pq = std::min(99, static_cast<int>(std::round(phase.score().score())));
                 result.set_format(sample, "PS", mapped_begin(phase.region()) + 1);
-                result.set_format(sample, "PQ", std::to_string(pq));
+                result.set_format(sample, "PQ", pq);
             }
         }
     }
@@ -3,15 +3,13 @@
 
 #include "denovo_call.hpp"
 
-#include "utils/string_utils.hpp"
-
 namespace octopus {
 
 void DenovoCall::decorate(VcfRecord::Builder& record) const
 {
     record.set_denovo();
     if (posterior_) {
-        record.set_info("PP", utils::to_string(posterior_->score()));
+        record.set_info("PP", VcfRecord::ValueType {posterior_->score(), 2});
     }
 }
 
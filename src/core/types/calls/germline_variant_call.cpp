@@ -3,14 +3,12 @@
 
 #include "germline_variant_call.hpp"
 
-#include "utils/string_utils.hpp"
-
 namespace octopus {
 
 void GermlineVariantCall::decorate(VcfRecord::Builder& record) const
 {
     if (posterior_) {
-        record.set_info("PP", utils::to_string(posterior_->score()));
+        record.set_info("PP", VcfRecord::ValueType {posterior_->score(), 2});
     }
 }
 
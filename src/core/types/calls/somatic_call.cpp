@@ -16,7 +16,7 @@ void SomaticCall::decorate(VcfRecord::Builder& record) const
 {
     record.set_somatic();
     if (posterior_) {
-        record.set_info("PP", utils::to_string(posterior_->score()));
+        record.set_info("PP", VcfRecord::ValueType {posterior_->score(), 2});
     }
     if (!map_vafs_.empty()) {
         record.add_format("MAP_VAF");
@@ -589,6 +589,12 @@ bool is_reference(const Haplotype& haplotype)
     return haplotype.sequence() == haplotype.reference_.get().fetch_sequence(haplotype.mapped_region());
 }
 
+Haplotype make_reference_haplotype(const Haplotype& haplotype)
+{
+    if (haplotype.explicit_alleles_.empty()) return haplotype;
+    return Haplotype {haplotype.region_, haplotype.reference_};
+}
+
 Haplotype expand(const Haplotype& haplotype, Haplotype::MappingDomain::Size n)
 {
     if (n == 0) return haplotype;
@@ -100,6 +100,7 @@ public:
     friend bool contains(const Haplotype& lhs, const Haplotype& rhs);
     friend Haplotype detail::do_copy(const Haplotype& haplotype, const GenomicRegion& region, std::true_type);
     friend bool is_reference(const Haplotype& haplotype);
+    friend Haplotype make_reference_haplotype(const Haplotype& haplotype);
     friend Haplotype expand(const Haplotype& haplotype, MappingDomain::Position n);
     friend Haplotype remap(const Haplotype& haplotype, const GenomicRegion& region);
     
@@ -279,6 +280,9 @@ std::vector<ContigAllele> copy_unique(const Container& haplotypes, const ContigR
 
 bool is_reference(const Haplotype& haplotype);
 
+// The reference haplotype over the same region
+Haplotype make_reference_haplotype(const Haplotype& haplotype);
+
 Haplotype expand(const Haplotype& haplotype, Haplotype::MappingDomain::Size n);
 Haplotype remap(const Haplotype& haplotype, const GenomicRegion& region);
 
@@ -486,6 +486,26 @@ HtslibSamFacade::extract_read_positions(const std::vector<SampleName>& samples,
     return result;
 }
 
+HtslibSamFacade::PositionList
+HtslibSamFacade::extract_read_positions(const std::vector<SampleName>& samples, const GenomicRegion& region,
+                                        std::size_t max_coverage, PositionList& gapped_read_positions) const
+{
+    const auto is_requested = [&] (const auto& sample) { return contains(samples, sample); };
+    if (std::none_of(std::cbegin(samples_), std::cend(samples_), is_requested)) return {};
+    const auto check_samples = !is_subset(samples, samples_);
+    PositionList result {};
+    result.reserve(max_coverage);
+    HtslibIterator it {*this, region};
+    while (max_coverage > 0 && ++it) {
+        if (!check_samples || is_requested(sample_names_.at(it.read_group()))) {
+            result.push_back(it.begin());
+            if (it.has_indel_or_soft_clip()) gapped_read_positions.push_back(it.begin());
+            --max_coverage;
+        }
+    }
+    return result;
+}
+
 // fetch_reads
 
 namespace {
@@ -506,13 +526,13 @@ bool try_reserve(Container& c, const std::size_t max, const std::size_t min)
 
 } // namespace
 
-HtslibSamFacade::SampleReadMap HtslibSamFacade::fetch_reads(const GenomicRegion& region) const
+HtslibSamFacade::SampleReadMap HtslibSamFacade::fetch_reads(const GenomicRegion& region, const ReadCoreFilter& filter) const
 {
     SampleReadMap result {samples_.size()};
     if (samples_.size() == 1) {
-        return {{samples_.front(), fetch_reads(samples_.front(), region)}};
+        return {{samples_.front(), fetch_reads(samples_.front(), region, filter)}};
     }
-    HtslibIterator it {*this, region};
+    HtslibIterator it {*this, region, filter};
     for (const auto& sample : samples_) {
         auto p = result.emplace(std::piecewise_construct, std::forward_as_tuple(sample), std::forward_as_tuple());
         try_reserve(p.first->second, defaultReserve_, defaultReserve_ / 10);
@@ -530,11 +550,12 @@ HtslibSamFacade::SampleReadMap HtslibSamFacade::fetch_reads(const GenomicRegion&
     return result;
 }
 
-HtslibSamFacade::ReadContainer HtslibSamFacade::fetch_reads(const SampleName& sample, const GenomicRegion& region) const
+HtslibSamFacade::ReadContainer HtslibSamFacade::fetch_reads(const SampleName& sample, const GenomicRegion& region,
+                                                            const ReadCoreFilter& filter) const
 {
     if (!contains(samples_, sample)) return {};
-    if (samples_.size() == 1) return fetch_all_reads(region);
-    HtslibIterator it {*this, region};
+    if (samples_.size() == 1) return fetch_all_reads(region, filter);
+    HtslibIterator it {*this, region, filter};
     ReadContainer result {};
     try_reserve(result, defaultReserve_, defaultReserve_ / 10);
     while (++it) {
@@ -552,13 +573,14 @@ HtslibSamFacade::ReadContainer HtslibSamFacade::fetch_reads(const SampleName& sa
 }
 
 HtslibSamFacade::SampleReadMap HtslibSamFacade::fetch_reads(const std::vector<SampleName>& samples,
-                                                            const GenomicRegion& region) const
+                                                            const GenomicRegion& region,
+                                                            const ReadCoreFilter& filter) const
 {
     if (samples.size() == 1) {
-        return {{samples.front(), fetch_reads(samples.front(), region)}};
+        return {{samples.front(), fetch_reads(samples.front(), region, filter)}};
     }
-    if (is_subset(samples_, samples)) return fetch_reads(region);
-    HtslibIterator it {*this, region};
+    if (is_subset(samples_, samples)) return fetch_reads(region, filter);
+    HtslibIterator it {*this, region, filter};
     SampleReadMap result {samples.size()};
     for (const auto& sample : samples) {
         if (contains(samples_, sample)) {
@@ -626,9 +648,9 @@ void HtslibSamFacade::write(const AlignedRead& read)
 
 // private methods
 
-HtslibSamFacade::ReadContainer HtslibSamFacade::fetch_all_reads(const GenomicRegion& region) const
+HtslibSamFacade::ReadContainer HtslibSamFacade::fetch_all_reads(const GenomicRegion& region, const ReadCoreFilter& filter) const
 {
-    HtslibIterator it {*this, region};
+    HtslibIterator it {*this, region, filter};
     ReadContainer result {};
     try_reserve(result, defaultReserve_, defaultReserve_ / 10);
     while (++it) {
@@ -711,7 +733,7 @@ HtslibSamFacade::HtsTid HtslibSamFacade::get_htslib_target(const GenomicRegion::
 
 const std::string& HtslibSamFacade::get_contig_name(HtsTid target) const
 {
-    return contig_names_.at(target);
+    return contig_names_.at(target).str();
 }
 
 // HtslibIterator
@@ -723,11 +745,18 @@ auto make_hts_iterator(const hts_idx_t* idx, bam_hdr_t* hdr, const GenomicRegion
 }
 
 HtslibSamFacade::HtslibIterator::HtslibIterator(const HtslibSamFacade& hts_facade, const GenomicRegion& region)
+: HtslibIterator {hts_facade, region, ReadCoreFilter {}}
+{}
+
+HtslibSamFacade::HtslibIterator::HtslibIterator(const HtslibSamFacade& hts_facade, const GenomicRegion& region,
+                                                const ReadCoreFilter& filter)
 : hts_facade_ {hts_facade}
 , hts_iterator_ {hts_facade.is_open()
         ? make_hts_iterator(hts_facade_.hts_index_.get(), hts_facade_.hts_header_.get(), region)
     : nullptr, HtsIteratorDeleter {}}
 , hts_bam1_ {bam_init1(), HtsBam1Deleter {}}
+, filter_ {filter}
+, read_group_ {}
 {
     if (hts_iterator_ == nullptr) {
         throw std::runtime_error {"HtslibIterator: could not load iterator for " + hts_facade.file_path_.string()};
@@ -742,6 +771,8 @@ HtslibSamFacade::HtslibIterator::HtslibIterator(const HtslibSamFacade& hts_facad
 , hts_iterator_ {hts_facade.is_open() ? sam_itr_querys(hts_facade_.hts_index_.get(), hts_facade_.hts_header_.get(),
                                                      contig.c_str()) : nullptr, HtsIteratorDeleter {}}
 , hts_bam1_ {bam_init1(), HtsBam1Deleter {}}
+, filter_ {}
+, read_group_ {}
 {
     if (hts_iterator_ == nullptr) {
         throw std::runtime_error {"HtslibIterator: could not load iterator for " + hts_facade.file_path_.string()};
@@ -758,7 +789,13 @@ std::string extract_read_name(const bam1_t* b)
 
 bool HtslibSamFacade::HtslibIterator::operator++()
 {
-    return sam_itr_next(hts_facade_.hts_file_.get(), hts_iterator_.get(), hts_bam1_.get()) >= 0;
+    if (filter_.is_empty()) {
+        return sam_itr_next(hts_facade_.hts_file_.get(), hts_iterator_.get(), hts_bam1_.get()) >= 0;
+    }
+    while (sam_itr_next(hts_facade_.hts_file_.get(), hts_iterator_.get(), hts_bam1_.get()) >= 0) {
+        if (filter_(hts_bam1_->core)) return true;
+    }
+    return false;
 }
 
 auto extract_read_pos(const bam1_t* b) noexcept
@@ -895,7 +932,7 @@ AlignedRead HtslibSamFacade::HtslibIterator::operator*() const
             mapping_quality(info),
             extract_flags(info),
             read_group(),
-            hts_facade_.get_contig_name(info.mtid),
+            hts_facade_.contig_names_.at(info.mtid),
             next_segment_position(info),
             template_length(info),
             extract_next_segment_flags(info)
@@ -914,13 +951,17 @@ AlignedRead HtslibSamFacade::HtslibIterator::operator*() const
     }
 }
 
-HtslibSamFacade::ReadGroupIdType HtslibSamFacade::HtslibIterator::read_group() const
+const InternedString& HtslibSamFacade::HtslibIterator::read_group() const
 {
     const auto ptr = bam_aux_get(hts_bam1_.get(), readGroupTag.c_str());
     if (ptr == nullptr) {
         throw InvalidBamRecord {hts_facade_.file_path_, extract_read_name(hts_bam1_.get()), "no read group"};
     }
-    return HtslibSamFacade::ReadGroupIdType {bam_aux2Z(ptr)};
+    const auto read_group = bam_aux2Z(ptr);
+    if (!read_group_.is_same(read_group)) {
+        read_group_ = InternedString {read_group};
+    }
+    return read_group_;
 }
 
 bool HtslibSamFacade::HtslibIterator::is_good() const noexcept
@@ -943,6 +984,48 @@ std::size_t HtslibSamFacade::HtslibIterator::begin() const noexcept
     return hts_bam1_->core.pos;
 }
 
+bool HtslibSamFacade::HtslibIterator::has_indel_or_soft_clip() const noexcept
+{
+    const auto cigar_operations = bam_get_cigar(hts_bam1_.get());
+    return std::any_of(cigar_operations, cigar_operations + get_cigar_length(hts_bam1_.get()),
+                       [] (const auto op) {
+                           const auto flag = bam_cigar_op(op);
+                           return flag == BAM_CINS || flag == BAM_CDEL || flag == BAM_CSOFT_CLIP;
+                       });
+}
+
+HtslibSamFacade::HtslibIterator::CoreFilter::CoreFilter(const ReadCoreFilter& filter) noexcept
+: min_mapping_quality {filter.min_mapping_quality}
+, remove_distant_mates {filter.remove_distant_templates}
+{
+    if (filter.remove_unmapped)                 remove_flags |= BAM_FUNMAP;
+    if (filter.remove_secondary_alignments)     remove_flags |= BAM_FSECONDARY;
+    if (filter.remove_supplementary_alignments) remove_flags |= BAM_FSUPPLEMENTARY;
+    if (filter.remove_marked_duplicates)        remove_flags |= BAM_FDUP;
+    if (filter.remove_qc_fails)                 remove_flags |= BAM_FQCFAIL;
+    if (filter.remove_unmapped_next_segments)   mated_remove_flags |= BAM_FMUNMAP;
+    if (filter.remove_improper_templates)       mated_require_flags |= BAM_FPROPER_PAIR;
+}
+
+bool HtslibSamFacade::HtslibIterator::CoreFilter::is_empty() const noexcept
+{
+    return remove_flags == 0 && mated_remove_flags == 0 && mated_require_flags == 0
+           && min_mapping_quality == 0 && !remove_distant_mates;
+}
+
+// Must agree with the corresponding readpipe filters, which treat reads without a mate
+// (mtid == -1) as passing all template filters
+bool HtslibSamFacade::HtslibIterator::CoreFilter::operator()(const bam1_core_t& c) const noexcept
+{
+    if ((c.flag & remove_flags) != 0 || c.qual < min_mapping_quality) return false;
+    if (c.mtid != -1) {
+        if ((c.flag & mated_remove_flags) != 0) return false;
+        if ((c.flag & mated_require_flags) != mated_require_flags) return false;
+        if (remove_distant_mates && c.mtid != c.tid) return false;
+    }
+    return true;
+}
+
 namespace {
 
 void set_contig(const std::int32_t tid, bam1_t* result) noexcept
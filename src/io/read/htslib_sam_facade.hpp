@@ -19,6 +19,7 @@
 #include "htslib/sam.h"
 
 #include "basics/aligned_read.hpp"
+#include "utils/interned_string.hpp"
 #include "read_reader_impl.hpp"
 
 namespace octopus {
@@ -81,12 +82,19 @@ public:
     PositionList extract_read_positions(const std::vector<SampleName>& samples,
                                         const GenomicRegion& region,
                                         std::size_t max_reads) const override;
+    PositionList extract_read_positions(const std::vector<SampleName>& samples,
+                                        const GenomicRegion& region,
+                                        std::size_t max_reads,
+                                        PositionList& gapped_read_positions) const override;
     
-    SampleReadMap fetch_reads(const GenomicRegion& region) const override;
+    SampleReadMap fetch_reads(const GenomicRegion& region,
+                              const ReadCoreFilter& filter) const override;
     ReadContainer fetch_reads(const SampleName& sample,
-                              const GenomicRegion& region) const override;
+                              const GenomicRegion& region,
+                              const ReadCoreFilter& filter) const override;
     SampleReadMap fetch_reads(const std::vector<SampleName>& samples,
-                              const GenomicRegion& region) const override;
+                              const GenomicRegion& region,
+                              const ReadCoreFilter& filter) const override;
     
     GenomicRegion::Size reference_size(const GenomicRegion::ContigName& contig) const override;
     std::vector<GenomicRegion::ContigName> reference_contigs() const override;
@@ -122,6 +130,8 @@ private:
         HtslibIterator() = delete;
         
         HtslibIterator(const HtslibSamFacade& hts_facade, const GenomicRegion& region);
+        HtslibIterator(const HtslibSamFacade& hts_facade, const GenomicRegion& region,
+                       const ReadCoreFilter& filter);
         HtslibIterator(const HtslibSamFacade& hts_facade, const GenomicRegion::ContigName& contig);
         
         HtslibIterator(const HtslibIterator&) = delete;
@@ -132,10 +142,11 @@ private:
         bool operator++();
         AlignedRead operator*() const;
         
-        HtslibSamFacade::ReadGroupIdType read_group() const;
+        const InternedString& read_group() const;
         
         bool is_good() const noexcept;
         std::size_t begin() const noexcept;
+        bool has_indel_or_soft_clip() const noexcept;
     
     private:
         struct HtsIteratorDeleter
@@ -147,10 +158,30 @@ private:
             void operator()(bam1_t* b) const { bam_destroy1(b); }
         };
         
+        // ReadCoreFilter converted to bam flag masks
+        struct CoreFilter
+        {
+            CoreFilter() = default;
+            CoreFilter(const ReadCoreFilter& filter) noexcept;
+            
+            bool is_empty() const noexcept;
+            bool operator()(const bam1_core_t& c) const noexcept;
+            
+            std::uint16_t remove_flags = 0;
+            std::uint16_t mated_remove_flags = 0, mated_require_flags = 0;
+            AlignedRead::MappingQuality min_mapping_quality = 0;
+            bool remove_distant_mates = false;
+        };
+        
         const HtslibSamFacade& hts_facade_;
         
         std::unique_ptr<hts_itr_t, HtsIteratorDeleter> hts_iterator_;
         std::unique_ptr<bam1_t, HtsBam1Deleter> hts_bam1_;
+        CoreFilter filter_;
+        
+        // Reads are usually grouped, so keeping the last read group saves interning each record's
+        // read group string
+        mutable InternedString read_group_;
     };
     
     Path file_path_;
@@ -160,7 +191,7 @@ private:
     std::unique_ptr<hts_idx_t, HtsIndexDeleter> hts_index_;
     
     std::unordered_map<GenomicRegion::ContigName, HtsTid> hts_targets_;
-    std::unordered_map<HtsTid, GenomicRegion::ContigName> contig_names_;
+    std::unordered_map<HtsTid, InternedString> contig_names_;
     std::unordered_map<ReadGroupIdType, SampleName> sample_names_;
     
     std::vector<SampleName> samples_;
@@ -169,7 +200,7 @@ private:
     HtsTid get_htslib_target(const GenomicRegion::ContigName& contig) const;
     const GenomicRegion::ContigName& get_contig_name(HtsTid target) const;
     std::uint64_t get_num_mapped_reads(const GenomicRegion::ContigName& contig) const;
-    ReadContainer fetch_all_reads(const GenomicRegion& region) const;
+    ReadContainer fetch_all_reads(const GenomicRegion& region, const ReadCoreFilter& filter) const;
     void write(const AlignedRead& read, bam1_t* result) const;
 };
 
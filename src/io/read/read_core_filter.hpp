@@ -0,0 +1,37 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef read_core_filter_hpp
+#define read_core_filter_hpp
+
+#include "basics/aligned_read.hpp"
+
+namespace octopus { namespace io {
+
+/*
+ ReadCoreFilter describes read filters that can be decided from the fixed size part of an
+ alignment record (flags, mapping quality, and mate position). Readers apply it before
+ decoding the name, sequence, qualities, and tags, so failing records are never materialised.
+
+ A default constructed ReadCoreFilter passes all reads.
+ */
+struct ReadCoreFilter
+{
+    AlignedRead::MappingQuality min_mapping_quality = 0;
+    bool remove_unmapped                  = false;
+    bool remove_secondary_alignments      = false;
+    bool remove_supplementary_alignments  = false;
+    bool remove_marked_duplicates         = false;
+    bool remove_qc_fails                  = false;
+    bool remove_unmapped_next_segments    = false;
+    bool remove_improper_templates        = false;
+    bool remove_distant_templates         = false;
+};
+
+} // namespace io
+
+using io::ReadCoreFilter;
+
+} // namespace octopus
+
+#endif
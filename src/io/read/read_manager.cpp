@@ -8,6 +8,8 @@
 #include <utility>
 #include <deque>
 #include <numeric>
+#include <future>
+#include <type_traits>
 #include <cassert>
 
 #include <boost/filesystem/operations.hpp>
@@ -18,7 +20,7 @@
 
 namespace octopus { namespace io {
 
-ReadManager::ReadManager(std::vector<Path> read_file_paths, unsigned max_open_files)
+ReadManager::ReadManager(std::vector<Path> read_file_paths, unsigned max_open_files, unsigned max_fetch_threads)
 : max_open_files_ {max_open_files}
 , num_files_ {static_cast<unsigned>(read_file_paths.size())}
 , closed_readers_ {
@@ -28,9 +30,14 @@ ReadManager::ReadManager(std::vector<Path> read_file_paths, unsigned max_open_fi
 , reader_paths_containing_sample_ {}
 , possible_regions_in_readers_ {}
 , samples_ {}
+, workers_ {}
 {
     setup_reader_samples_and_regions();
     open_initial_files();
+    const auto num_fetch_threads = std::min(max_fetch_threads, std::min(num_files_, max_open_files_));
+    if (num_fetch_threads > 1) {
+        workers_ = std::make_unique<ThreadPool>(num_fetch_threads);
+    }
     samples_.reserve(reader_paths_containing_sample_.size());
     for (const auto& pair : reader_paths_containing_sample_) {
         samples_.emplace_back(pair.first);
@@ -54,6 +61,7 @@ ReadManager::ReadManager(ReadManager&& other)
     reader_paths_containing_sample_ = move(other.reader_paths_containing_sample_);
     possible_regions_in_readers_    = move(other.possible_regions_in_readers_);
     samples_                        = move(other.samples_);
+    workers_                        = move(other.workers_);
 }
 
 void swap(ReadManager& lhs, ReadManager& rhs) noexcept
@@ -69,6 +77,7 @@ void swap(ReadManager& lhs, ReadManager& rhs) noexcept
     swap(lhs.reader_paths_containing_sample_, rhs.reader_paths_containing_sample_);
     swap(lhs.possible_regions_in_readers_,    rhs.possible_regions_in_readers_);
     swap(lhs.samples_,                        rhs.samples_);
+    swap(lhs.workers_,                        rhs.workers_);
 }
 
 void ReadManager::close() const noexcept
@@ -346,33 +355,173 @@ GenomicRegion ReadManager::find_covered_subregion(const GenomicRegion& region, c
     return find_covered_subregion(samples(), region, max_reads);
 }
 
+ReadManager::PositionList
+ReadManager::extract_read_positions(const std::vector<SampleName>& samples, const GenomicRegion& region,
+                                    const std::size_t max_reads) const
+{
+    PositionList result {};
+    if (samples.empty() || is_empty(region) || max_reads == 0) return result;
+    if (all_readers_are_open()) {
+        for (const auto& p : open_readers_) {
+            utils::append(p.second.extract_read_positions(samples, region, max_reads), result);
+        }
+    } else {
+        std::lock_guard<std::mutex> lock {mutex_};
+        auto reader_paths = get_possible_reader_paths(samples, region);
+        auto reader_itr = partition_open(reader_paths);
+        while (!reader_paths.empty()) {
+            std::for_each(reader_itr, end(reader_paths), [&] (const auto& reader_path) {
+                utils::append(open_readers_.at(reader_path).extract_read_positions(samples, region, max_reads), result);
+            });
+            reader_paths.erase(reader_itr, end(reader_paths));
+            reader_itr = open_readers(begin(reader_paths), end(reader_paths));
+        }
+    }
+    std::sort(std::begin(result), std::end(result));
+    if (result.size() > max_reads) result.resize(max_reads);
+    return result;
+}
+
+ReadManager::PositionList
+ReadManager::extract_read_positions(const std::vector<SampleName>& samples, const GenomicRegion& region,
+                                    const std::size_t max_reads, PositionList& gapped_read_positions) const
+{
+    PositionList result {};
+    gapped_read_positions.clear();
+    if (samples.empty() || is_empty(region) || max_reads == 0) return result;
+    if (all_readers_are_open()) {
+        for (const auto& p : open_readers_) {
+            utils::append(p.second.extract_read_positions(samples, region, max_reads, gapped_read_positions), result);
+        }
+    } else {
+        std::lock_guard<std::mutex> lock {mutex_};
+        auto reader_paths = get_possible_reader_paths(samples, region);
+        auto reader_itr = partition_open(reader_paths);
+        while (!reader_paths.empty()) {
+            std::for_each(reader_itr, end(reader_paths), [&] (const auto& reader_path) {
+                utils::append(open_readers_.at(reader_path).extract_read_positions(samples, region, max_reads,
+                                                                                   gapped_read_positions), result);
+            });
+            reader_paths.erase(reader_itr, end(reader_paths));
+            reader_itr = open_readers(begin(reader_paths), end(reader_paths));
+        }
+    }
+    std::sort(std::begin(result), std::end(result));
+    std::sort(std::begin(gapped_read_positions), std::end(gapped_read_positions));
+    if (result.size() > max_reads) {
+        result.resize(max_reads);
+        const auto last_gapped = std::upper_bound(std::cbegin(gapped_read_positions), std::cend(gapped_read_positions),
+                                                  result.back());
+        gapped_read_positions.erase(last_gapped, std::cend(gapped_read_positions));
+    }
+    return result;
+}
+
 namespace {
 
+// Merges each sorted container in srcs into the sorted dst by appending them all and then
+// merging adjacent runs pairwise, so each read is moved O(log srcs.size()) times
 template <typename Container>
-void merge_insert(Container&& src, Container& dst)
+void merge_insert(std::vector<Container>&& srcs, Container& dst)
+{
+    std::vector<std::size_t> run_ends {};
+    run_ends.reserve(srcs.size() + 1);
+    if (!dst.empty()) run_ends.push_back(dst.size());
+    for (auto& src : srcs) {
+        if (!src.empty()) {
+            octopus::utils::append(std::move(src), dst);
+            run_ends.push_back(dst.size());
+        }
+    }
+    srcs.clear();
+    const auto first = std::begin(dst);
+    while (run_ends.size() > 1) {
+        std::size_t run_begin {0}, num_merged_runs {0};
+        for (std::size_t i {0}; i < run_ends.size(); i += 2) {
+            if (i + 1 < run_ends.size()) {
+                std::inplace_merge(std::next(first, run_begin), std::next(first, run_ends[i]), std::next(first, run_ends[i + 1]));
+                run_ends[num_merged_runs++] = run_ends[i + 1];
+                run_begin = run_ends[i + 1];
+            } else {
+                run_ends[num_merged_runs++] = run_ends[i];
+            }
+        }
+        run_ends.resize(num_merged_runs);
+    }
+}
+
+// Applies fetch to each reader, concurrently if there are workers, returning the results in reader order
+template <typename F>
+auto fetch_each(const std::vector<const ReadReader*>& readers, F fetch, ThreadPool* workers)
+{
+    using FetchResult = std::result_of_t<F(const ReadReader&)>;
+    std::vector<FetchResult> result {};
+    result.reserve(readers.size());
+    if (workers && readers.size() > 1) {
+        std::vector<std::future<FetchResult>> futures {};
+        futures.reserve(readers.size());
+        for (const auto reader : readers) {
+            futures.push_back(workers->push(fetch, std::cref(*reader)));
+        }
+        // fetch references the caller's arguments, so all tasks must finish before any error propagates
+        for (const auto& future : futures) future.wait();
+        for (auto& future : futures) result.push_back(future.get());
+    } else {
+        for (const auto reader : readers) {
+            result.push_back(fetch(*reader));
+        }
+    }
+    return result;
+}
+
+void merge_insert(std::vector<ReadManager::SampleReadMap>&& reads, ReadManager::SampleReadMap& result,
+                  ThreadPool* workers)
 {
-    auto itr = octopus::utils::append(std::move(src), dst);
-    std::inplace_merge(std::begin(dst), itr, std::end(dst));
+    std::vector<std::pair<ReadManager::ReadContainer*, std::vector<ReadManager::ReadContainer>>> sample_reads {};
+    sample_reads.reserve(result.size());
+    for (auto& p : result) {
+        std::vector<ReadManager::ReadContainer> srcs {};
+        srcs.reserve(reads.size());
+        for (auto& reader_reads : reads) {
+            const auto itr = reader_reads.find(p.first);
+            if (itr != std::end(reader_reads)) {
+                srcs.push_back(std::move(itr->second));
+            }
+        }
+        sample_reads.emplace_back(std::addressof(p.second), std::move(srcs));
+    }
+    reads.clear();
+    if (workers && sample_reads.size() > 1) {
+        std::vector<std::future<void>> merges {};
+        merges.reserve(sample_reads.size());
+        for (auto& p : sample_reads) {
+            merges.push_back(workers->push([&p] () { merge_insert(std::move(p.second), *p.first); }));
+        }
+        for (const auto& merge : merges) merge.wait();
+        for (auto& merge : merges) merge.get();
+    } else {
+        for (auto& p : sample_reads) {
+            merge_insert(std::move(p.second), *p.first);
+        }
+    }
 }
 
 } // namespace
 
-ReadManager::ReadContainer ReadManager::fetch_reads(const SampleName& sample, const GenomicRegion& region) const
+ReadManager::ReadContainer ReadManager::fetch_reads(const SampleName& sample, const GenomicRegion& region,
+                                                    const ReadCoreFilter& filter) const
 {
+    const auto fetch = [&] (const ReadReader& reader) { return reader.fetch_reads(sample, region, filter); };
     ReadContainer result {};
     if (all_readers_are_open()) {
-        for (const auto& p : open_readers_) {
-            merge_insert(p.second.fetch_reads(sample, region), result);
-        }
+        merge_insert(fetch_each(get_open_readers(), fetch, workers_.get()), result);
     } else {
         std::lock_guard<std::mutex> lock {mutex_};
         auto reader_paths = get_possible_reader_paths({sample}, region);
         auto reader_itr = partition_open(reader_paths);
         while (!reader_paths.empty()) {
-            using std::begin; using std::end; using std::make_move_iterator; using std::for_each;
-            for_each(reader_itr, end(reader_paths), [&] (const auto& reader_path) {
-                merge_insert(open_readers_.at(reader_path).fetch_reads(sample, region), result);
-            });
+            using std::begin; using std::end;
+            merge_insert(fetch_each(get_open_readers(reader_itr, end(reader_paths)), fetch, workers_.get()), result);
             reader_paths.erase(reader_itr, end(reader_paths));
             reader_itr = open_readers(begin(reader_paths), end(reader_paths));
         }
@@ -380,36 +529,24 @@ ReadManager::ReadContainer ReadManager::fetch_reads(const SampleName& sample, co
     return result;
 }
 
-ReadManager::SampleReadMap ReadManager::fetch_reads(const std::vector<SampleName>& samples, const GenomicRegion& region) const
+ReadManager::SampleReadMap ReadManager::fetch_reads(const std::vector<SampleName>& samples, const GenomicRegion& region,
+                                                    const ReadCoreFilter& filter) const
 {
+    const auto fetch = [&] (const ReadReader& reader) { return reader.fetch_reads(samples, region, filter); };
     SampleReadMap result {samples.size()};
     // Populate here so we can make unchecked access
     for (const auto& sample : samples) {
         result.emplace(std::piecewise_construct, std::forward_as_tuple(sample), std::forward_as_tuple());
     }
     if (all_readers_are_open()) {
-        for (const auto& p : open_readers_) {
-            auto reads = p.second.fetch_reads(samples, region);
-            for (auto&& r : reads) {
-                merge_insert(std::move(r.second), result.at(r.first));
-                r.second.clear();
-                r.second.shrink_to_fit();
-            }
-        }
+        merge_insert(fetch_each(get_open_readers(), fetch, workers_.get()), result, workers_.get());
     } else {
         std::lock_guard<std::mutex> lock {mutex_};
         auto reader_paths = get_possible_reader_paths(samples, region);
         auto reader_itr = partition_open(reader_paths);
         while (!reader_paths.empty()) {
-            using std::begin; using std::end; using std::make_move_iterator; using std::for_each;
-            for_each(reader_itr, end(reader_paths), [&] (const auto& reader_path) {
-                auto reads = open_readers_.at(reader_path).fetch_reads(samples, region);
-                for (auto&& r : reads) {
-                    merge_insert(std::move(r.second), result.at(r.first));
-                    r.second.clear();
-                    r.second.shrink_to_fit();
-                }
-            });
+            using std::begin; using std::end;
+            merge_insert(fetch_each(get_open_readers(reader_itr, end(reader_paths)), fetch, workers_.get()), result, workers_.get());
             reader_paths.erase(reader_itr, end(reader_paths));
             reader_itr = open_readers(begin(reader_paths), end(reader_paths));
         }
@@ -417,9 +554,9 @@ ReadManager::SampleReadMap ReadManager::fetch_reads(const std::vector<SampleName
     return result;
 }
 
-ReadManager::SampleReadMap ReadManager::fetch_reads(const GenomicRegion& region) const
+ReadManager::SampleReadMap ReadManager::fetch_reads(const GenomicRegion& region, const ReadCoreFilter& filter) const
 {
-    return fetch_reads(samples(), region);
+    return fetch_reads(samples(), region, filter);
 }
 
 // Private methods
@@ -484,6 +621,26 @@ bool ReadManager::all_readers_are_open() const noexcept
     return num_files_ <= max_open_files_;
 }
 
+std::vector<const ReadReader*> ReadManager::get_open_readers() const
+{
+    std::vector<const ReadReader*> result {};
+    result.reserve(open_readers_.size());
+    for (const auto& p : open_readers_) {
+        result.push_back(std::addressof(p.second));
+    }
+    return result;
+}
+
+std::vector<const ReadReader*> ReadManager::get_open_readers(std::vector<Path>::const_iterator first,
+                                                             std::vector<Path>::const_iterator last) const
+{
+    std::vector<const ReadReader*> result {};
+    result.reserve(std::distance(first, last));
+    std::transform(first, last, std::back_inserter(result),
+                   [this] (const Path& reader_path) { return std::addressof(open_readers_.at(reader_path)); });
+    return result;
+}
+
 bool ReadManager::is_open(const Path& reader_path) const noexcept
 {
     return open_readers_.count(reader_path) == 1;
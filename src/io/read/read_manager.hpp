@@ -11,6 +11,7 @@
 #include <initializer_list>
 #include <cstddef>
 #include <mutex>
+#include <memory>
 
 #include <boost/filesystem.hpp>
 
@@ -18,6 +19,7 @@
 #include "basics/genomic_region.hpp"
 #include "containers/mappable_map.hpp"
 #include "utils/hash_functions.hpp"
+#include "utils/thread_pool.hpp"
 #include "read_reader.hpp"
 #include "read_reader_impl.hpp"
 
@@ -35,10 +37,11 @@ public:
     using SampleName    = IReadReaderImpl::SampleName;
     using ReadContainer = IReadReaderImpl::ReadContainer;
     using SampleReadMap = IReadReaderImpl::SampleReadMap;
+    using PositionList  = IReadReaderImpl::PositionList;
     
     ReadManager() = default;
     
-    ReadManager(std::vector<Path> read_file_paths, unsigned max_open_files);
+    ReadManager(std::vector<Path> read_file_paths, unsigned max_open_files, unsigned max_fetch_threads = 1);
     ReadManager(std::initializer_list<Path> read_file_paths);
     
     ReadManager(const ReadManager&)            = delete;
@@ -72,9 +75,19 @@ public:
                                          std::size_t max_reads) const;
     GenomicRegion find_covered_subregion(const GenomicRegion& region, std::size_t max_reads) const;
     
-    ReadContainer fetch_reads(const SampleName& sample,  const GenomicRegion& region) const;
-    SampleReadMap fetch_reads(const std::vector<SampleName>& samples, const GenomicRegion& region) const;
-    SampleReadMap fetch_reads(const GenomicRegion& region) const;
+    // The sorted mapped begin positions of the first max_reads reads in region
+    PositionList extract_read_positions(const std::vector<SampleName>& samples, const GenomicRegion& region,
+                                        std::size_t max_reads) const;
+    // As above, and gapped_read_positions is set to the sorted positions of the returned reads with an
+    // insertion, deletion or soft clip, which indicate candidate variants
+    PositionList extract_read_positions(const std::vector<SampleName>& samples, const GenomicRegion& region,
+                                        std::size_t max_reads, PositionList& gapped_read_positions) const;
+    
+    ReadContainer fetch_reads(const SampleName& sample,  const GenomicRegion& region,
+                              const ReadCoreFilter& filter = {}) const;
+    SampleReadMap fetch_reads(const std::vector<SampleName>& samples, const GenomicRegion& region,
+                              const ReadCoreFilter& filter = {}) const;
+    SampleReadMap fetch_reads(const GenomicRegion& region, const ReadCoreFilter& filter = {}) const;
     
 private:
     using PathHash = octopus::utils::FilepathHash;
@@ -102,11 +115,17 @@ private:
     
     mutable std::mutex mutex_;
     
+    // Fetches from different files run concurrently on these, if there are any
+    std::unique_ptr<ThreadPool> workers_;
+    
     void setup_reader_samples_and_regions();
     void open_initial_files();
     
     ReadReader make_reader(const Path& reader_path) const;
     bool all_readers_are_open() const noexcept;
+    std::vector<const ReadReader*> get_open_readers() const;
+    std::vector<const ReadReader*> get_open_readers(std::vector<Path>::const_iterator first,
+                                                    std::vector<Path>::const_iterator last) const;
     bool is_open(const Path& reader_path) const noexcept;
     std::vector<Path>::iterator partition_open(std::vector<Path>& reader_paths) const;
     unsigned num_open_readers() const noexcept;
@@ -218,23 +218,33 @@ ReadReader::extract_read_positions(const std::vector<SampleName>& samples,
     return impl_->extract_read_positions(samples, region, max_coverage);
 }
 
-ReadReader::SampleReadMap ReadReader::fetch_reads(const GenomicRegion& region) const
+ReadReader::PositionList
+ReadReader::extract_read_positions(const std::vector<SampleName>& samples, const GenomicRegion& region,
+                                   std::size_t max_coverage, PositionList& gapped_read_positions) const
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    return impl_->extract_read_positions(samples, region, max_coverage, gapped_read_positions);
+}
+
+ReadReader::SampleReadMap ReadReader::fetch_reads(const GenomicRegion& region, const ReadCoreFilter& filter) const
 {
     std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->fetch_reads(region);
+    return impl_->fetch_reads(region, filter);
 }
 
-ReadReader::ReadContainer ReadReader::fetch_reads(const SampleName& sample, const GenomicRegion& region) const
+ReadReader::ReadContainer ReadReader::fetch_reads(const SampleName& sample, const GenomicRegion& region,
+                                                  const ReadCoreFilter& filter) const
 {
     std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->fetch_reads(sample, region);
+    return impl_->fetch_reads(sample, region, filter);
 }
 
 ReadReader::SampleReadMap ReadReader::fetch_reads(const std::vector<SampleName>& samples,
-                                                  const GenomicRegion& region) const
+                                                  const GenomicRegion& region,
+                                                  const ReadCoreFilter& filter) const
 {
     std::lock_guard<std::mutex> lock {mutex_};
-    return impl_->fetch_reads(samples, region);
+    return impl_->fetch_reads(samples, region, filter);
 }
 
 bool operator==(const ReadReader& lhs, const ReadReader& rhs)
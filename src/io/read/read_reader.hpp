@@ -85,12 +85,19 @@ public:
     PositionList extract_read_positions(const std::vector<SampleName>& samples,
                                         const GenomicRegion& region,
                                         std::size_t max_coverage) const;
+    PositionList extract_read_positions(const std::vector<SampleName>& samples,
+                                        const GenomicRegion& region,
+                                        std::size_t max_coverage,
+                                        PositionList& gapped_read_positions) const;
     
-    SampleReadMap fetch_reads(const GenomicRegion& region) const;
+    SampleReadMap fetch_reads(const GenomicRegion& region,
+                              const ReadCoreFilter& filter = {}) const;
     ReadContainer fetch_reads(const SampleName& sample,
-                              const GenomicRegion& region) const;
+                              const GenomicRegion& region,
+                              const ReadCoreFilter& filter = {}) const;
     SampleReadMap fetch_reads(const std::vector<SampleName>& samples,
-                              const GenomicRegion& region) const;
+                              const GenomicRegion& region,
+                              const ReadCoreFilter& filter = {}) const;
     
 private:
     Path file_path_;
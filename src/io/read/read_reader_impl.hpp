@@ -14,6 +14,7 @@
 
 #include "basics/genomic_region.hpp"
 #include "basics/aligned_read.hpp"
+#include "read_core_filter.hpp"
 
 namespace octopus { namespace io {
 
@@ -54,12 +55,20 @@ public:
     virtual PositionList extract_read_positions(const std::vector<SampleName>& samples,
                                                 const GenomicRegion& region,
                                                 std::size_t max_reads) const = 0;
+    // Also appends the positions of the extracted reads with an insertion, deletion or soft clip
+    virtual PositionList extract_read_positions(const std::vector<SampleName>& samples,
+                                                const GenomicRegion& region,
+                                                std::size_t max_reads,
+                                                PositionList& gapped_read_positions) const = 0;
     
-    virtual SampleReadMap fetch_reads(const GenomicRegion& region) const = 0;
+    virtual SampleReadMap fetch_reads(const GenomicRegion& region,
+                                      const ReadCoreFilter& filter) const = 0;
     virtual ReadContainer fetch_reads(const SampleName& sample,
-                                      const GenomicRegion& region) const = 0;
+                                      const GenomicRegion& region,
+                                      const ReadCoreFilter& filter) const = 0;
     virtual SampleReadMap fetch_reads(const std::vector<SampleName>& samples,
-                                      const GenomicRegion& region) const = 0;
+                                      const GenomicRegion& region,
+                                      const ReadCoreFilter& filter) const = 0;
     
     virtual std::vector<GenomicRegion::ContigName> reference_contigs() const = 0;
     virtual GenomicRegion::Size reference_size(const GenomicRegion::ContigName& contig) const = 0;
@@ -0,0 +1,423 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "packed_reference.hpp"
+
+#include <array>
+#include <fstream>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+#include <limits>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "basics/genomic_region.hpp"
+#include "exceptions/missing_file_error.hpp"
+#include "exceptions/malformed_file_error.hpp"
+#include "exceptions/program_error.hpp"
+
+namespace octopus { namespace io {
+
+/*
+ Packed reference file layout (native byte order):
+
+ header    : magic (8 bytes), number of contigs (u64), index offset (u64)
+ contigs   : for each contig, 8 byte aligned
+                packed bases, 4 per byte with base i in bits 2*(i%4), A=0 C=1 G=2 T=3
+                exception runs {begin (u32), end (u32), base (u32)} for any non ACGT base
+                lowercase runs {begin (u32), end (u32)}
+ index     : for each contig, name length (u64), name, then (u64) length, sequence offset,
+             number of exception runs, exception runs offset, number of lowercase runs,
+             lowercase runs offset
+ */
+
+namespace {
+
+constexpr std::array<char, 8> packedReferenceMagic {{'O', 'C', 'T', 'P', 'A', 'C', 'K', '1'}};
+const std::string packedReferenceExtension {".packed"};
+
+struct ExceptionRun
+{
+    std::uint32_t begin, end, base;
+};
+
+struct LowercaseRun
+{
+    std::uint32_t begin, end;
+};
+
+template <typename T>
+T read(const char* data, const std::uint64_t offset)
+{
+    T result;
+    std::memcpy(&result, data + offset, sizeof(T));
+    return result;
+}
+
+template <typename T>
+T read_run(const char* data, const std::uint64_t runs_offset, const std::uint64_t idx)
+{
+    return read<T>(data, runs_offset + idx * sizeof(T));
+}
+
+// Index of the first run ending after position, runs must be sorted and non-overlapping
+template <typename T>
+std::uint64_t find_first_run(const char* data, const std::uint64_t runs_offset, const std::uint64_t num_runs,
+                             const std::uint64_t position)
+{
+    std::uint64_t first {0}, count {num_runs};
+    while (count > 0) {
+        const auto step = count / 2;
+        if (read_run<T>(data, runs_offset, first + step).end <= position) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    return first;
+}
+
+using PackedBaseTable = std::array<std::array<char, 4>, 256>;
+
+PackedBaseTable make_packed_base_table() noexcept
+{
+    static constexpr std::array<char, 4> bases {{'A', 'C', 'G', 'T'}};
+    PackedBaseTable result {};
+    for (unsigned byte {0}; byte < 256; ++byte) {
+        for (unsigned i {0}; i < 4; ++i) {
+            result[byte][i] = bases[(byte >> (2 * i)) & 3u];
+        }
+    }
+    return result;
+}
+
+const PackedBaseTable packedBaseTable {make_packed_base_table()};
+
+class MissingPackedReference : public MissingFileError
+{
+    std::string do_where() const override
+    {
+        return "PackedReference";
+    }
+public:
+    MissingPackedReference(PackedReference::Path file) : MissingFileError {std::move(file), "packed reference"} {}
+};
+
+class MalformedPackedReference : public MalformedFileError
+{
+    std::string do_where() const override
+    {
+        return "PackedReference";
+    }
+public:
+    MalformedPackedReference(PackedReference::Path file) : MalformedFileError {std::move(file), "packed reference"} {}
+};
+
+class BadReferenceRequestRegion : public ProgramError
+{
+    GenomicRegion region;
+
+    std::string do_why() const override
+    {
+        return "Requested bad reference region " + to_string(region);
+    }
+    std::string do_help() const override
+    {
+        return "Send a debug report";
+    }
+    std::string do_where() const override
+    {
+        return "PackedReference";
+    }
+public:
+    BadReferenceRequestRegion(GenomicRegion region) : region {std::move(region)} {}
+};
+
+} // namespace
+
+PackedReference::PackedReference(Path packed_path)
+: PackedReference {std::move(packed_path), Options {}}
+{}
+
+PackedReference::PackedReference(Path packed_path, Options options)
+: path_ {std::move(packed_path)}
+, file_ {}
+, index_ {}
+, options_ {options}
+{
+    if (!boost::filesystem::exists(path_)) {
+        throw MissingPackedReference {path_};
+    }
+    auto file = std::make_shared<boost::iostreams::mapped_file_source>(path_.string());
+    const auto file_size = static_cast<std::uint64_t>(file->size());
+    const auto data = file->data();
+    static constexpr std::uint64_t header_size {sizeof(packedReferenceMagic) + 2 * sizeof(std::uint64_t)};
+    if (file_size < header_size || !std::equal(std::cbegin(packedReferenceMagic), std::cend(packedReferenceMagic), data)) {
+        throw MalformedPackedReference {path_};
+    }
+    const auto num_contigs = read<std::uint64_t>(data, sizeof(packedReferenceMagic));
+    auto offset = read<std::uint64_t>(data, sizeof(packedReferenceMagic) + sizeof(std::uint64_t));
+    auto index = std::make_shared<Index>();
+    index->contig_names.reserve(num_contigs);
+    index->contigs.reserve(num_contigs);
+    for (std::uint64_t i {0}; i < num_contigs; ++i) {
+        if (offset + sizeof(std::uint64_t) > file_size) throw MalformedPackedReference {path_};
+        const auto name_length = read<std::uint64_t>(data, offset);
+        offset += sizeof(std::uint64_t);
+        if (offset + name_length + 6 * sizeof(std::uint64_t) > file_size) throw MalformedPackedReference {path_};
+        ContigName contig {data + offset, name_length};
+        offset += name_length;
+        ContigIndex contig_index {};
+        contig_index.length = static_cast<GenomicSize>(read<std::uint64_t>(data, offset));
+        contig_index.sequence_offset = read<std::uint64_t>(data, offset + 1 * sizeof(std::uint64_t));
+        contig_index.num_exceptions = read<std::uint64_t>(data, offset + 2 * sizeof(std::uint64_t));
+        contig_index.exceptions_offset = read<std::uint64_t>(data, offset + 3 * sizeof(std::uint64_t));
+        contig_index.num_lowercase_runs = read<std::uint64_t>(data, offset + 4 * sizeof(std::uint64_t));
+        contig_index.lowercase_runs_offset = read<std::uint64_t>(data, offset + 5 * sizeof(std::uint64_t));
+        offset += 6 * sizeof(std::uint64_t);
+        if (contig_index.sequence_offset + (contig_index.length + 3) / 4 > file_size
+            || contig_index.exceptions_offset + contig_index.num_exceptions * sizeof(ExceptionRun) > file_size
+            || contig_index.lowercase_runs_offset + contig_index.num_lowercase_runs * sizeof(LowercaseRun) > file_size) {
+            throw MalformedPackedReference {path_};
+        }
+        index->contig_names.push_back(contig);
+        index->contigs.emplace(std::move(contig), contig_index);
+    }
+    file_  = std::move(file);
+    index_ = std::move(index);
+}
+
+// virtual private methods
+
+std::unique_ptr<ReferenceReader> PackedReference::do_clone() const
+{
+    return std::make_unique<PackedReference>(*this);
+}
+
+bool PackedReference::do_is_open() const noexcept
+{
+    return file_ && file_->is_open();
+}
+
+std::string PackedReference::do_fetch_reference_name() const
+{
+    return path_.stem().stem().string();
+}
+
+std::vector<PackedReference::ContigName> PackedReference::do_fetch_contig_names() const
+{
+    return index_->contig_names;
+}
+
+PackedReference::GenomicSize PackedReference::do_fetch_contig_size(const ContigName& contig) const
+{
+    return get_contig_index(contig).length;
+}
+
+PackedReference::GeneticSequence PackedReference::do_fetch_sequence(const GenomicRegion& region) const
+{
+    const auto& contig = get_contig_index(contig_name(region));
+    const auto begin = std::min(mapped_begin(region), contig.length);
+    const auto end = std::min(mapped_end(region), contig.length);
+    GeneticSequence result(end - begin, 'N');
+    const auto data = file_->data();
+    const auto packed = reinterpret_cast<const unsigned char*>(data + contig.sequence_offset);
+    auto pos = begin;
+    for (; pos < end && (pos % 4) != 0; ++pos) {
+        result[pos - begin] = packedBaseTable[packed[pos / 4]][pos % 4];
+    }
+    for (; pos + 4 <= end; pos += 4) {
+        std::memcpy(&result[pos - begin], packedBaseTable[packed[pos / 4]].data(), 4);
+    }
+    for (; pos < end; ++pos) {
+        result[pos - begin] = packedBaseTable[packed[pos / 4]][pos % 4];
+    }
+    auto run_idx = find_first_run<ExceptionRun>(data, contig.exceptions_offset, contig.num_exceptions, begin);
+    for (; run_idx < contig.num_exceptions; ++run_idx) {
+        const auto run = read_run<ExceptionRun>(data, contig.exceptions_offset, run_idx);
+        if (run.begin >= end) break;
+        const auto run_begin = std::max<GenomicSize>(run.begin, begin), run_end = std::min<GenomicSize>(run.end, end);
+        std::fill(std::next(std::begin(result), run_begin - begin), std::next(std::begin(result), run_end - begin),
+                  static_cast<char>(run.base));
+    }
+    if (options_.base_transform_policy != Options::BaseTransformPolicy::capitalise) {
+        run_idx = find_first_run<LowercaseRun>(data, contig.lowercase_runs_offset, contig.num_lowercase_runs, begin);
+        for (; run_idx < contig.num_lowercase_runs; ++run_idx) {
+            const auto run = read_run<LowercaseRun>(data, contig.lowercase_runs_offset, run_idx);
+            if (run.begin >= end) break;
+            const auto run_begin = std::max<GenomicSize>(run.begin, begin), run_end = std::min<GenomicSize>(run.end, end);
+            std::transform(std::next(std::begin(result), run_begin - begin), std::next(std::begin(result), run_end - begin),
+                           std::next(std::begin(result), run_begin - begin), [] (char base) { return std::tolower(base); });
+        }
+    }
+    if (result.size() < size(region)) {
+        if (options_.base_fill_policy == Options::BaseFillPolicy::throw_exception) {
+            throw BadReferenceRequestRegion {region};
+        }
+        if (options_.base_fill_policy == Options::BaseFillPolicy::fill_with_ns) {
+            result.resize(size(region), 'N');
+        }
+    }
+    return result;
+}
+
+const PackedReference::ContigIndex& PackedReference::get_contig_index(const ContigName& contig) const
+{
+    const auto itr = index_->contigs.find(contig);
+    if (itr == std::cend(index_->contigs)) {
+        throw std::runtime_error {"contig \"" + contig + "\" not found in packed reference \"" + path_.string() + "\""};
+    }
+    return itr->second;
+}
+
+// non-member methods
+
+bool is_packed_reference(const boost::filesystem::path& reference_path)
+{
+    return reference_path.extension().string() == packedReferenceExtension;
+}
+
+boost::filesystem::path get_packed_reference_path(const boost::filesystem::path& fasta_path)
+{
+    return fasta_path.string() + packedReferenceExtension;
+}
+
+namespace {
+
+template <typename T>
+void write(const T& value, std::ostream& out)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void write(const std::vector<T>& values, std::ostream& out)
+{
+    out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+void align(std::ostream& out, const std::size_t alignment = 8)
+{
+    static const std::array<char, 8> padding {};
+    const auto remainder = static_cast<std::size_t>(out.tellp()) % alignment;
+    if (remainder > 0) out.write(padding.data(), alignment - remainder);
+}
+
+std::uint8_t pack_base(const char base) noexcept
+{
+    switch (base) {
+        case 'A': return 0;
+        case 'C': return 1;
+        case 'G': return 2;
+        case 'T': return 3;
+        default: return 4;
+    }
+}
+
+template <typename Run>
+void extend_or_add_run(std::vector<Run>& runs, const std::uint32_t position)
+{
+    if (!runs.empty() && runs.back().end == position) {
+        ++runs.back().end;
+    } else {
+        runs.push_back({position, position + 1});
+    }
+}
+
+void extend_or_add_run(std::vector<ExceptionRun>& runs, const std::uint32_t position, const char base)
+{
+    if (!runs.empty() && runs.back().end == position && runs.back().base == static_cast<std::uint32_t>(base)) {
+        ++runs.back().end;
+    } else {
+        runs.push_back({position, position + 1, static_cast<std::uint32_t>(base)});
+    }
+}
+
+struct PackedContigIndex
+{
+    std::string name;
+    std::uint64_t length, sequence_offset, num_exceptions, exceptions_offset, num_lowercase_runs, lowercase_runs_offset;
+};
+
+} // namespace
+
+void make_packed_reference(const ReferenceReader& source, const boost::filesystem::path& packed_path)
+{
+    static constexpr std::uint32_t chunkSize {10'000'000};
+    std::ofstream out {packed_path.string(), std::ios::binary};
+    if (!out) {
+        throw std::runtime_error {"could not open \"" + packed_path.string() + "\" for writing"};
+    }
+    const auto contigs = source.fetch_contig_names();
+    out.write(packedReferenceMagic.data(), packedReferenceMagic.size());
+    write(static_cast<std::uint64_t>(contigs.size()), out);
+    write(std::uint64_t {0}, out); // index offset placeholder
+    std::vector<PackedContigIndex> index {};
+    index.reserve(contigs.size());
+    for (const auto& contig : contigs) {
+        const std::uint64_t contig_length {source.fetch_contig_size(contig)};
+        if (contig_length > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::runtime_error {"contig \"" + contig + "\" is too long to pack"};
+        }
+        std::vector<std::uint8_t> packed((contig_length + 3) / 4, 0);
+        std::vector<ExceptionRun> exceptions {};
+        std::vector<LowercaseRun> lowercase_runs {};
+        for (std::uint32_t chunk_begin {0}; chunk_begin < contig_length; chunk_begin += chunkSize) {
+            const auto chunk_end = static_cast<std::uint32_t>(std::min<std::uint64_t>(chunk_begin + chunkSize, contig_length));
+            const auto chunk = source.fetch_sequence(GenomicRegion {contig, chunk_begin, chunk_end});
+            if (chunk.size() != chunk_end - chunk_begin) {
+                throw std::runtime_error {"could not read all of contig \"" + contig + "\""};
+            }
+            for (std::uint32_t i {0}; i < chunk.size(); ++i) {
+                const auto position = chunk_begin + i;
+                auto base = chunk[i];
+                if (std::islower(base)) {
+                    extend_or_add_run(lowercase_runs, position);
+                    base = std::toupper(base);
+                }
+                const auto code = pack_base(base);
+                if (code < 4) {
+                    packed[position / 4] |= code << (2 * (position % 4));
+                } else {
+                    extend_or_add_run(exceptions, position, base);
+                }
+            }
+        }
+        align(out);
+        const std::uint64_t sequence_offset = out.tellp();
+        write(packed, out);
+        align(out);
+        const std::uint64_t exceptions_offset = out.tellp();
+        write(exceptions, out);
+        align(out);
+        const std::uint64_t lowercase_runs_offset = out.tellp();
+        write(lowercase_runs, out);
+        PackedContigIndex contig_index {contig, contig_length, sequence_offset, exceptions.size(), exceptions_offset,
+                                        lowercase_runs.size(), lowercase_runs_offset};
+        index.push_back(std::move(contig_index));
+    }
+    align(out);
+    const std::uint64_t index_offset = out.tellp();
+    for (const auto& contig : index) {
+        write(static_cast<std::uint64_t>(contig.name.size()), out);
+        out.write(contig.name.data(), contig.name.size());
+        write(contig.length, out);
+        write(contig.sequence_offset, out);
+        write(contig.num_exceptions, out);
+        write(contig.exceptions_offset, out);
+        write(contig.num_lowercase_runs, out);
+        write(contig.lowercase_runs_offset, out);
+    }
+    out.seekp(packedReferenceMagic.size() + sizeof(std::uint64_t));
+    write(index_offset, out);
+    if (!out) {
+        throw std::runtime_error {"failed writing packed reference \"" + packed_path.string() + "\""};
+    }
+}
+
+} // namespace io
+} // namespace octopus
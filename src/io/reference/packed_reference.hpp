@@ -0,0 +1,92 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef packed_reference_hpp
+#define packed_reference_hpp
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "reference_reader.hpp"
+#include "fasta.hpp"
+
+namespace octopus {
+
+class GenomicRegion;
+
+namespace io {
+
+/*
+ PackedReference reads a memory mapped reference made by make_packed_reference. Bases are
+ stored with 2 bits each; any other IUPAC codes and soft-masked (lowercase) bases are stored
+ as run lists. The mapping is read only and shared between clones so fetch_sequence can be
+ called concurrently without locking.
+ */
+class PackedReference : public ReferenceReader
+{
+public:
+    using Path    = boost::filesystem::path;
+    using Options = Fasta::Options;
+
+    using ContigName      = ReferenceReader::ContigName;
+    using GenomicSize     = ReferenceReader::GenomicSize;
+    using GeneticSequence = ReferenceReader::GeneticSequence;
+
+    PackedReference() = delete;
+
+    PackedReference(Path packed_path);
+    PackedReference(Path packed_path, Options options);
+
+    PackedReference(const PackedReference&)            = default;
+    PackedReference& operator=(const PackedReference&) = default;
+    PackedReference(PackedReference&&)                 = default;
+    PackedReference& operator=(PackedReference&&)      = default;
+
+    ~PackedReference() = default;
+
+private:
+    struct ContigIndex
+    {
+        GenomicSize length;
+        std::uint64_t sequence_offset;
+        std::uint64_t num_exceptions, exceptions_offset;
+        std::uint64_t num_lowercase_runs, lowercase_runs_offset;
+    };
+
+    struct Index
+    {
+        std::vector<ContigName> contig_names;
+        std::unordered_map<ContigName, ContigIndex> contigs;
+    };
+
+    Path path_;
+    std::shared_ptr<const boost::iostreams::mapped_file_source> file_;
+    std::shared_ptr<const Index> index_;
+    Options options_;
+
+    std::unique_ptr<ReferenceReader> do_clone() const override;
+    bool do_is_open() const noexcept override;
+    std::string do_fetch_reference_name() const override;
+    std::vector<ContigName> do_fetch_contig_names() const override;
+    GenomicSize do_fetch_contig_size(const ContigName& contig) const override;
+    GeneticSequence do_fetch_sequence(const GenomicRegion& region) const override;
+
+    const ContigIndex& get_contig_index(const ContigName& contig) const;
+};
+
+bool is_packed_reference(const boost::filesystem::path& reference_path);
+
+boost::filesystem::path get_packed_reference_path(const boost::filesystem::path& fasta_path);
+
+void make_packed_reference(const ReferenceReader& source, const boost::filesystem::path& packed_path);
+
+} // namespace io
+} // namespace octopus
+
+#endif
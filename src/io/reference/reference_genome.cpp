@@ -11,6 +11,7 @@
 #include "fasta.hpp"
 #include "threadsafe_fasta.hpp"
 #include "caching_fasta.hpp"
+#include "packed_reference.hpp"
 
 namespace octopus {
 
@@ -106,6 +107,10 @@ ReferenceGenome make_reference(boost::filesystem::path reference_path,
         options.base_transform_policy = Fasta::Options::BaseTransformPolicy::capitalise;
     }
     options.base_fill_policy = Fasta::Options::BaseFillPolicy::fill_with_ns;
+    if (is_packed_reference(reference_path)) {
+        // Packed references are memory mapped so are already thread-safe and cached by the OS
+        return ReferenceGenome {std::make_unique<PackedReference>(std::move(reference_path), options)};
+    }
     if (is_threaded) {
         impl_ = std::make_unique<ThreadsafeFasta>(std::make_unique<Fasta>(reference_path, options));
     } else {
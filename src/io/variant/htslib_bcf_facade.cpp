@@ -39,6 +39,16 @@ bool is_missing(const std::string& value) noexcept
 
 namespace bc = boost::container;
 
+bool is_bcf(const boost::filesystem::path& file_path)
+{
+    return file_path.extension() == ".bcf";
+}
+
+bool is_bgzipped_vcf(const boost::filesystem::path& file_path)
+{
+    return file_path.extension() == ".gz" && file_path.stem().extension() == ".vcf";
+}
+
 } // namespace
 
 char* malloc_copy(const std::string& source)
@@ -70,10 +80,9 @@ std::string get_hts_mode(const HtslibBcfFacade::Path& file_path, HtslibBcfFacade
         result += "r]";
     } else {
         result += 'w';
-        auto extension = file_path.extension();
-        if (extension == ".bcf") {
+        if (is_bcf(file_path)) {
             result += "b";
-        } else if (extension == ".gz" && file_path.stem().extension() == ".vcf") {
+        } else if (is_bgzipped_vcf(file_path)) {
             result += "z";
         }
     }
@@ -85,6 +94,7 @@ HtslibBcfFacade::HtslibBcfFacade()
 , file_ {bcf_open("-", "[w]"), HtsFileDeleter {}}
 , header_ {bcf_hdr_init("w"), HtsHeaderDeleter {}}
 , samples_ {}
+, index_path_ {}
 {
     if (file_ == nullptr) {
         throw std::runtime_error {"HtslibBcfFacade: could not open stdout writer"};
@@ -99,6 +109,7 @@ HtslibBcfFacade::HtslibBcfFacade(Path file_path, Mode mode)
 , file_ {nullptr, HtsFileDeleter {}}
 , header_ {nullptr, HtsHeaderDeleter {}}
 , samples_ {}
+, index_path_ {}
 {
     const auto hts_mode = get_hts_mode(file_path_, mode);
     if (mode == Mode::read) {
@@ -119,6 +130,15 @@ HtslibBcfFacade::HtslibBcfFacade(Path file_path, Mode mode)
     }
 }
 
+HtslibBcfFacade::~HtslibBcfFacade() noexcept
+{
+    #ifdef HTS_VERSION
+    if (file_ && index_path_) {
+        bcf_idx_save(file_.get()); // failure just leaves the output unindexed
+    }
+    #endif
+}
+
 std::unordered_map<std::string, std::string> extract_format(const bcf_hrec_t* line);
 
 bool HtslibBcfFacade::is_header_written() const noexcept
@@ -307,6 +327,22 @@ auto hts_tag_type(const std::string& tag)
     return (types.count(tag) == 1) ? types.at(tag) : BCF_HL_STR;
 }
 
+void HtslibBcfFacade::set_threads(const unsigned num_threads)
+{
+    if (num_threads == 0) return;
+    if (file_ == nullptr) {
+        throw std::runtime_error {"HtslibBcfFacade: trying to set threads on closed file"};
+    }
+    if (hts_set_threads(file_.get(), static_cast<int>(num_threads)) != 0) {
+        throw std::runtime_error {"HtslibBcfFacade: failed to set compression threads"};
+    }
+}
+
+bool HtslibBcfFacade::is_indexing() const noexcept
+{
+    return static_cast<bool>(index_path_);
+}
+
 void HtslibBcfFacade::write(const VcfHeader& header)
 {
     if (file_ == nullptr) {
@@ -369,6 +405,31 @@ void HtslibBcfFacade::write(const VcfHeader& header)
     }
     header_.reset(hdr);
     samples_ = extract_samples(header_.get());
+    init_index();
+}
+
+// Builds the same index as index_vcf (CSI for BCF, TBI for bgzipped VCF) while records are
+// written, rather than re-reading the file once it is closed. Needs htslib 1.10 or later.
+void HtslibBcfFacade::init_index()
+{
+    #ifdef HTS_VERSION
+    if (file_path_.empty() || index_path_) return;
+    int min_shift;
+    std::string index_path;
+    if (is_bcf(file_path_)) {
+        min_shift = 14;
+        index_path = file_path_.string() + ".csi";
+    } else if (is_bgzipped_vcf(file_path_)) {
+        min_shift = 0;
+        index_path = file_path_.string() + ".tbi";
+    } else {
+        return;
+    }
+    auto stable_index_path = std::make_unique<const std::string>(std::move(index_path));
+    if (bcf_idx_init(file_.get(), header_.get(), min_shift, stable_index_path->c_str()) == 0) {
+        index_path_ = std::move(stable_index_path);
+    }
+    #endif
 }
 
 void set_chrom(const bcf_hdr_t* header, bcf1_t* record, const std::string& chrom);
@@ -574,6 +635,16 @@ void set_filter(const bcf_hdr_t* header, bcf1_t* record, const std::vector<std::
     }
 }
 
+VcfRecord::ValueType to_value(const int value)
+{
+    return value != bcf_int32_missing ? VcfRecord::ValueType {value} : VcfRecord::ValueType {};
+}
+
+VcfRecord::ValueType to_value(const float value)
+{
+    return !bcf_float_is_missing(value) ? VcfRecord::ValueType {value} : VcfRecord::ValueType {};
+}
+
 void extract_info(const bcf_hdr_t* header, bcf1_t* record, VcfRecord::Builder& builder)
 {
     int* intinfo {nullptr};
@@ -588,16 +659,14 @@ void extract_info(const bcf_hdr_t* header, bcf1_t* record, VcfRecord::Builder& b
             throw std::runtime_error {"HtslibBcfFacade: found INFO key not present in header file"};
         }
         const char* key {header->id[BCF_DT_ID][key_id].key};
-        std::vector<std::string> values {};
+        std::vector<VcfRecord::ValueType> values {};
         switch (bcf_hdr_id2type(header, BCF_HL_INFO, key_id)) {
             case BCF_HT_INT: {
                 const auto num_values_written = bcf_get_info_int32(header, record, key, &intinfo, &nintinfo);
                 if (num_values_written > 0) {
                     values.reserve(num_values_written);
                     std::transform(intinfo, intinfo + num_values_written, std::back_inserter(values),
-                                   [](auto v) {
-                                       return v != bcf_int32_missing ? std::to_string(v) : bcf_missing_str;
-                                   });
+                                   [] (auto v) { return to_value(v); });
                 }
                 break;
             }
@@ -606,9 +675,7 @@ void extract_info(const bcf_hdr_t* header, bcf1_t* record, VcfRecord::Builder& b
                 if (num_values_written > 0) {
                     values.reserve(num_values_written);
                     std::transform(floatinfo, floatinfo + num_values_written, std::back_inserter(values),
-                                   [] (auto v) {
-                                       return v != bcf_float_missing ? std::to_string(v) : bcf_missing_str;
-                                   });
+                                   [] (auto v) { return to_value(v); });
                 }
                 break;
             }
@@ -616,13 +683,15 @@ void extract_info(const bcf_hdr_t* header, bcf1_t* record, VcfRecord::Builder& b
                 const auto nchars = bcf_get_info_string(header, record, key, &stringinfo, &nstringinfo);
                 if (nchars > 0) {
                     std::string tmp(stringinfo, nchars);
-                    values = utils::split(tmp, vcfspec::info::valueSeperator);
+                    for (auto& value : utils::split(tmp, vcfspec::info::valueSeperator)) {
+                        values.emplace_back(std::move(value));
+                    }
                 }
                 break;
             }
             case BCF_HT_FLAG: {
                 values.reserve(1);
-                values.emplace_back((bcf_get_info_flag(header, record, key, &flaginfo, &nflaginfo) == 1) ? "1" : "0");
+                values.emplace_back((bcf_get_info_flag(header, record, key, &flaginfo, &nflaginfo) == 1) ? 1 : 0);
                 break;
             }
         }
@@ -641,6 +710,18 @@ float get_bcf_float_missing() noexcept
     return result;
 }
 
+// Numeric values are encoded directly; only values that were read from text are parsed
+
+int to_bcf_int(const VcfRecord::ValueType& value)
+{
+    return !value.is_missing() ? static_cast<int>(value.to_integer()) : bcf_int32_missing;
+}
+
+float to_bcf_float(const VcfRecord::ValueType& value)
+{
+    return !value.is_missing() ? static_cast<float>(value.to_real()) : get_bcf_float_missing();
+}
+
 void set_info(const bcf_hdr_t* header, bcf1_t* dest, const VcfRecord& source)
 {
     for (const auto& key : source.info_keys()) {
@@ -652,7 +733,7 @@ void set_info(const bcf_hdr_t* header, bcf1_t* dest, const VcfRecord& source)
             {
                 bc::small_vector<int, defaultBufferCapacity> vals(num_values);
                 std::transform(std::cbegin(values), std::cend(values), std::begin(vals),
-                               [] (const auto& v) { return !is_missing(v) ? std::stoi(v) : bcf_int32_missing; });
+                               [] (const auto& v) { return to_bcf_int(v); });
                 bcf_update_info_int32(header, dest, key.c_str(), vals.data(), num_values);
                 break;
             }
@@ -660,20 +741,20 @@ void set_info(const bcf_hdr_t* header, bcf1_t* dest, const VcfRecord& source)
             {
                 bc::small_vector<float, defaultBufferCapacity> vals(num_values);
                 std::transform(std::cbegin(values), std::cend(values), std::begin(vals),
-                               [] (const auto& v) { return !is_missing(v) ? std::stof(v) : get_bcf_float_missing(); });
+                               [] (const auto& v) { return to_bcf_float(v); });
                 bcf_update_info_float(header, dest, key.c_str(), vals.data(), num_values);
                 break;
             }
             case BCF_HT_STR:
             {
                 // Can we also use small_vector here?
-                const auto vals = utils::join(values, vcfspec::info::valueSeperator);
+                const auto vals = utils::join(to_strings(values), vcfspec::info::valueSeperator);
                 bcf_update_info_string(header, dest, key.c_str(), vals.c_str());
                 break;
             }
             case BCF_HT_FLAG:
             {
-                bcf_update_info_flag(header, dest, key.c_str(), "", values.empty() || values.front() == "1");
+                bcf_update_info_flag(header, dest, key.c_str(), "", values.empty() || values.front() == 1);
                 break;
             }
         }
@@ -742,7 +823,7 @@ void extract_samples(const bcf_hdr_t* header, bcf1_t* record, VcfRecord::Builder
     int nintformat {}, nfloatformat {}, nstringformat {};
     for (auto itr = first_format, end = std::cend(format); itr != end; ++itr) {
         const auto& key = *itr;
-        std::vector<std::vector<std::string>> values(num_samples, std::vector<std::string> {});
+        std::vector<std::vector<VcfRecord::ValueType>> values(num_samples, std::vector<VcfRecord::ValueType> {});
         switch (bcf_hdr_id2type(header, BCF_HL_FMT, bcf_hdr_id2int(header, BCF_DT_ID, key.c_str()))) {
             case BCF_HT_INT: {
                 const auto num_values_written = bcf_get_format_int32(header, record, key.c_str(), &intformat, &nintformat);
@@ -752,9 +833,7 @@ void extract_samples(const bcf_hdr_t* header, bcf1_t* record, VcfRecord::Builder
                     for (unsigned sample {0}; sample < num_samples; ++sample, ptr += num_values_per_sample) {
                         values[sample].reserve(num_values_per_sample);
                         std::transform(ptr, ptr + num_values_per_sample, std::back_inserter(values[sample]),
-                                       [] (auto v) {
-                                           return v != bcf_int32_missing ? std::to_string(v) : bcf_missing_str;
-                                       });
+                                       [] (auto v) { return to_value(v); });
                     }
                 }
                 break;
@@ -767,9 +846,7 @@ void extract_samples(const bcf_hdr_t* header, bcf1_t* record, VcfRecord::Builder
                     for (unsigned sample {0}; sample < num_samples; ++sample, ptr += num_values_per_sample) {
                         values[sample].reserve(num_values_per_sample);
                         std::transform(ptr, ptr + num_values_per_sample, std::back_inserter(values[sample]),
-                                       [] (auto v) {
-                                           return v != bcf_float_missing ? std::to_string(v) : bcf_missing_str;
-                                       });
+                                       [] (auto v) { return to_value(v); });
                     }
                 }
                 break;
@@ -810,15 +887,38 @@ auto genotype_number(const T& allele, const Container& alleles, const bool is_ph
     return (is_phased) ? allele_num + 1 : allele_num;
 }
 
-auto max_format_cardinality(const VcfRecord& record, const VcfRecord::KeyType& key, const std::vector<std::string>& samples)
+auto max_format_cardinality(const VcfRecord& record, const std::size_t key_idx, const std::vector<std::size_t>& sample_indices)
 {
     std::size_t result {0};
+    for (const auto sample_idx : sample_indices) {
+        result = std::max(result, record.get_sample_value(sample_idx, key_idx).size());
+    }
+    return result;
+}
+
+auto get_sample_indices(const VcfRecord& record, const std::vector<std::string>& samples)
+{
+    std::vector<std::size_t> result {};
+    result.reserve(samples.size());
     for (const auto& sample : samples) {
-        result = std::max(result, record.get_sample_value(sample, key).size());
+        const auto sample_idx = record.sample_index(sample);
+        if (!sample_idx) {
+            throw std::runtime_error {"HtslibBcfFacade: record is missing sample " + sample};
+        }
+        result.push_back(*sample_idx);
     }
     return result;
 }
 
+auto get_format_index(const VcfRecord& record, const VcfRecord::KeyType& key)
+{
+    const auto result = record.format_index(key);
+    if (!result) {
+        throw std::runtime_error {"HtslibBcfFacade: record is missing FORMAT values for " + key};
+    }
+    return *result;
+}
+
 float get_bcf_float_pad() noexcept
 {
     float result;
@@ -850,7 +950,7 @@ void set_samples(const bcf_hdr_t* header, bcf1_t* dest, const VcfRecord& source,
         auto genotype_itr = std::begin(genotype);
         for (const auto& sample : samples) {
             const bool is_phased {source.is_sample_phased(sample)};
-            const auto& genotype = source.get_sample_value(sample, vcfspec::format::genotype);
+            const auto& genotype = source.genotype(sample);
             const auto ploidy = static_cast<unsigned>(genotype.size());
             genotype_itr = std::transform(std::cbegin(genotype), std::cend(genotype), genotype_itr,
                                           [is_phased, &alleles] (const auto& allele) {
@@ -861,14 +961,18 @@ void set_samples(const bcf_hdr_t* header, bcf1_t* dest, const VcfRecord& source,
         bcf_update_genotypes(header, dest, genotype.data(), ngt);
         ++first_format;
     }
+    if (first_format == std::cend(format)) return;
+    // Resolve sample and key positions once, rather than looking up every value by name
+    const auto sample_indices = get_sample_indices(source, samples);
     std::vector<std::string> str_buffer {};
     std::for_each(first_format, std::cend(format), [&] (const auto& key) {
+        const auto key_idx = get_format_index(source, key);
         const auto key_cardinality = source.format_cardinality(key);
         int num_values {};
         if (key_cardinality) {
             num_values = *key_cardinality * num_samples;
         } else {
-            num_values = max_format_cardinality(source, key, samples) * num_samples;
+            num_values = max_format_cardinality(source, key_idx, sample_indices) * num_samples;
         }
         const auto num_values_per_sample = static_cast<std::size_t>(num_values / num_samples);
         static constexpr std::size_t defaultValueCapacity {1'000};
@@ -878,10 +982,10 @@ void set_samples(const bcf_hdr_t* header, bcf1_t* dest, const VcfRecord& source,
               static const int pad {bcf_int32_vector_end};
               bc::small_vector<int, defaultValueCapacity> typed_values(num_values);
               auto value_itr = std::begin(typed_values);
-              for (const auto& sample : samples) {
-                  const auto& values = source.get_sample_value(sample, key);
+              for (const auto sample_idx : sample_indices) {
+                  const auto& values = source.get_sample_value(sample_idx, key_idx);
                   value_itr = std::transform(std::cbegin(values), std::cend(values), value_itr,
-                                             [] (const auto& v) { return !is_missing(v) ? std::stoi(v) : bcf_int32_missing; });
+                                             [] (const auto& v) { return to_bcf_int(v); });
                   assert(values.size() <= num_values_per_sample);
                   value_itr = std::fill_n(value_itr, num_values_per_sample - values.size(), pad);
               }
@@ -893,10 +997,10 @@ void set_samples(const bcf_hdr_t* header, bcf1_t* dest, const VcfRecord& source,
               static const float pad {get_bcf_float_pad()};
               bc::small_vector<float, defaultValueCapacity> typed_values(num_values);
               auto value_itr = std::begin(typed_values);
-              for (const auto& sample : samples) {
-                  const auto& values = source.get_sample_value(sample, key);
+              for (const auto sample_idx : sample_indices) {
+                  const auto& values = source.get_sample_value(sample_idx, key_idx);
                   value_itr = std::transform(std::cbegin(values), std::cend(values), value_itr,
-                                             [] (const auto& v) { return !is_missing(v) ? std::stof(v) : get_bcf_float_missing(); });
+                                             [] (const auto& v) { return to_bcf_float(v); });
                   assert(values.size() <= num_values_per_sample);
                   value_itr = std::fill_n(value_itr, num_values_per_sample - values.size(), pad);
               }
@@ -906,25 +1010,24 @@ void set_samples(const bcf_hdr_t* header, bcf1_t* dest, const VcfRecord& source,
           case BCF_HT_STR:
           {
               bc::small_vector<const char*, defaultValueCapacity> typed_values;
+              str_buffer.clear();
               if (key_cardinality && *key_cardinality <= 1) {
-                  typed_values.resize(num_values);
-                  auto value_itr = std::begin(typed_values);
-                  for (const auto& sample : samples) {
-                      const auto& values = source.get_sample_value(sample, key);
-                      value_itr = std::transform(std::cbegin(values), std::cend(values), value_itr,
-                                                 [] (const auto& value) { return value.c_str(); });
+                  str_buffer.reserve(num_values);
+                  for (const auto sample_idx : sample_indices) {
+                      for (const auto& value : source.get_sample_value(sample_idx, key_idx)) {
+                          str_buffer.push_back(value.str());
+                      }
                   }
               } else {
-                  str_buffer.clear();
                   str_buffer.reserve(num_samples);
-                  for (const auto& sample : samples) {
-                      str_buffer.push_back(utils::join(source.get_sample_value(sample, key), vcfspec::format::valueSeperator));
+                  for (const auto sample_idx : sample_indices) {
+                      str_buffer.push_back(utils::join(to_strings(source.get_sample_value(sample_idx, key_idx)), vcfspec::format::valueSeperator));
                   }
                   num_values = num_samples;
-                  typed_values.resize(num_values);
-                  std::transform(std::cbegin(str_buffer), std::cend(str_buffer), std::begin(typed_values),
-                                 [] (const auto& value) { return value.c_str(); });
               }
+              typed_values.resize(num_values);
+              std::transform(std::cbegin(str_buffer), std::cend(str_buffer), std::begin(typed_values),
+                             [] (const auto& value) { return value.c_str(); });
               bcf_update_format_string(header, dest, key.c_str(), typed_values.data(), num_values);
               break;
           }
@@ -43,7 +43,7 @@ public:
     HtslibBcfFacade(HtslibBcfFacade&&)                 = default;
     HtslibBcfFacade& operator=(HtslibBcfFacade&&)      = default;
     
-    ~HtslibBcfFacade() noexcept override = default;
+    ~HtslibBcfFacade() noexcept override;
     
     bool is_header_written() const noexcept override;
     
@@ -61,6 +61,12 @@ public:
     RecordContainer fetch_records(const std::string& contig, UnpackPolicy level) const override;
     RecordContainer fetch_records(const GenomicRegion& region, UnpackPolicy level) const override;
     
+    // Compresses output with num_threads worker threads. Must be called before the header is written
+    void set_threads(unsigned num_threads);
+    
+    // True if an index is being built as records are written. The index is saved when the file is closed
+    bool is_indexing() const noexcept;
+    
     void write(const VcfHeader& header);
     void write(const VcfRecord& record);
     
@@ -89,7 +95,10 @@ private:
     std::unique_ptr<htsFile, HtsFileDeleter> file_;
     std::unique_ptr<bcf_hdr_t, HtsHeaderDeleter> header_;
     std::vector<std::string> samples_;
+    // htslib keeps a pointer to the index path, so it must not move
+    std::unique_ptr<const std::string> index_path_;
     
+    void init_index();
     std::size_t count_records(HtsBcfSrPtr& sr) const;
     VcfRecord fetch_record(const bcf_srs_t* sr, UnpackPolicy level) const;
     RecordContainer fetch_records(bcf_srs_t*, UnpackPolicy level, size_t num_records) const;
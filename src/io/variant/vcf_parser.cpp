@@ -285,11 +285,12 @@ bool overlaps(const std::string& line, const GenomicRegion& region)
                 std::max(static_cast<long>(region.begin()), begin)) > 0;
 }
 
-std::vector<std::string> split(const std::string& str, char delim = ',')
+template <typename T = std::string>
+std::vector<T> split(const std::string& str, char delim = ',')
 {
     std::stringstream ss {str};
     std::string item;
-    std::vector<std::string> result {};
+    std::vector<T> result {};
     result.reserve(std::count(std::cbegin(str), std::cend(str), delim) + 1);
     while (std::getline(ss, item, delim)) {
         result.emplace_back(item);
@@ -303,7 +304,7 @@ void parse_info_field(const std::string& field, VcfRecord::Builder& rb)
     if (pos == std::string::npos) {
         rb.set_info_flag(field);
     } else {
-        rb.set_info(field.substr(0, pos), split(field.substr(pos + 1), ','));
+        rb.set_info(field.substr(0, pos), split<VcfRecord::ValueType>(field.substr(pos + 1), ','));
     }
 }
 
@@ -364,7 +365,7 @@ void parse_sample(const std::string& column, const VcfRecord::SampleName& sample
     }
     std::for_each(first_value, std::istream_iterator<SampleField> {},
                   [&rb, &sample, &first_key] (const std::string& value) {
-                      rb.set_format(sample, *first_key, split(value, ','));
+                      rb.set_format(sample, *first_key, split<VcfRecord::ValueType>(value, ','));
                       ++first_key;
                   });
 }
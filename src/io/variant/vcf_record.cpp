@@ -5,8 +5,7 @@
 
 #include <algorithm>
 #include <iterator>
-
-#include <boost/lexical_cast.hpp>
+#include <stdexcept>
 
 #include "vcf_spec.hpp"
 
@@ -95,8 +94,12 @@ boost::optional<unsigned> VcfRecord::format_cardinality(const KeyType& key) cons
 {
     boost::optional<unsigned> result {};
     if (has_format(key)) {
-        for (const auto& p : samples_) {
-            const auto sample_format_cardinality = p.second.at(key).size();
+        const auto key_idx = format_index(key);
+        if (!key_idx) return result;
+        for (std::size_t sample_idx {0}; sample_idx < sample_names_.size(); ++sample_idx) {
+            const auto& values = sample_values_[sample_idx * sample_keys_.size() + *key_idx];
+            if (!values) continue;
+            const auto sample_format_cardinality = static_cast<unsigned>(values->size());
             if (result) {
                 if (*result != sample_format_cardinality) return boost::none;
             } else {
@@ -114,7 +117,7 @@ const std::vector<VcfRecord::KeyType>& VcfRecord::format() const noexcept
 
 unsigned VcfRecord::num_samples() const noexcept
 {
-    return static_cast<unsigned>((has_genotypes()) ? genotypes_.size() : samples_.size());
+    return num_samples_;
 }
 
 bool VcfRecord::has_genotypes() const noexcept
@@ -124,17 +127,22 @@ bool VcfRecord::has_genotypes() const noexcept
 
 unsigned VcfRecord::ploidy(const SampleName& sample) const
 {
-    return static_cast<unsigned>(genotypes_.at(sample).first.size());
+    return static_cast<unsigned>(get_genotype(sample).first.size());
 }
 
 bool VcfRecord::is_sample_phased(const SampleName& sample) const
 {
-    return genotypes_.at(sample).second;
+    return get_genotype(sample).second;
+}
+
+const std::vector<VcfRecord::NucleotideSequence>& VcfRecord::genotype(const SampleName& sample) const
+{
+    return get_genotype(sample).first;
 }
 
 bool VcfRecord::is_homozygous(const SampleName& sample) const
 {
-    const auto& genotype = genotypes_.at(sample).first;
+    const auto& genotype = get_genotype(sample).first;
     return std::adjacent_find(std::cbegin(genotype), std::cend(genotype),
                               std::not_equal_to<NucleotideSequence>()) == std::cend(genotype);
 }
@@ -146,26 +154,26 @@ bool VcfRecord::is_heterozygous(const SampleName& sample) const
 
 bool VcfRecord::is_homozygous_ref(const SampleName& sample) const
 {
-    const auto& genotype = genotypes_.at(sample).first;
+    const auto& genotype = get_genotype(sample).first;
     return std::all_of(std::cbegin(genotype), std::cend(genotype),
                        [this] (const auto& allele) { return allele == ref_; });
 }
 
 bool VcfRecord::is_homozygous_non_ref(const SampleName& sample) const
 {
-    const auto& genotype = genotypes_.at(sample).first;
+    const auto& genotype = get_genotype(sample).first;
     return genotype.front() != ref_ && is_homozygous(sample);
 }
 
 bool VcfRecord::has_ref_allele(const SampleName& sample) const
 {
-    const auto& genotype = genotypes_.at(sample).first;
+    const auto& genotype = get_genotype(sample).first;
     return std::find(std::cbegin(genotype), std::cend(genotype), ref_) != std::cend(genotype);
 }
 
 bool VcfRecord::has_alt_allele(const SampleName& sample) const
 {
-    const auto& genotype = genotypes_.at(sample).first;
+    const auto& genotype = get_genotype(sample).first;
     return std::find_if_not(std::cbegin(genotype), std::cend(genotype),
                             [this] (const auto& allele) {
                                 return allele == ref_;
@@ -174,7 +182,46 @@ bool VcfRecord::has_alt_allele(const SampleName& sample) const
 
 const std::vector<VcfRecord::ValueType>& VcfRecord::get_sample_value(const SampleName& sample, const KeyType& key) const
 {
-    return (key == vcfspec::format::genotype) ? genotypes_.at(sample).first : samples_.at(sample).at(key);
+    const auto sample_idx = sample_index(sample);
+    const auto key_idx = format_index(key);
+    if (!sample_idx || !key_idx) {
+        throw std::out_of_range {"VcfRecord: no value for sample " + sample + " and key " + key};
+    }
+    return get_sample_value(*sample_idx, *key_idx);
+}
+
+namespace {
+
+template <typename Container, typename T>
+boost::optional<std::size_t> binary_find(const Container& values, const T& value) noexcept
+{
+    const auto itr = std::lower_bound(std::cbegin(values), std::cend(values), value);
+    if (itr != std::cend(values) && *itr == value) {
+        return static_cast<std::size_t>(std::distance(std::cbegin(values), itr));
+    } else {
+        return boost::none;
+    }
+}
+
+} // namespace
+
+boost::optional<std::size_t> VcfRecord::sample_index(const SampleName& sample) const noexcept
+{
+    return binary_find(sample_names_, sample);
+}
+
+boost::optional<std::size_t> VcfRecord::format_index(const KeyType& key) const noexcept
+{
+    return binary_find(sample_keys_, key);
+}
+
+const std::vector<VcfRecord::ValueType>& VcfRecord::get_sample_value(const std::size_t sample_idx, const std::size_t format_idx) const
+{
+    const auto& result = sample_values_.at(sample_idx * sample_keys_.size() + format_idx);
+    if (!result) {
+        throw std::out_of_range {"VcfRecord: no value for sample " + sample_names_[sample_idx] + " and key " + sample_keys_[format_idx]};
+    }
+    return *result;
 }
 
 // helper non-members needed for printing
@@ -205,20 +252,53 @@ std::ostream& operator<<(std::ostream& os, const std::vector<T>& v)
 
 // private methods
 
+void VcfRecord::pack(GenotypeMap genotypes, SampleValueMap values)
+{
+    sample_names_.reserve(std::max(genotypes.size(), values.size()));
+    for (const auto& p : genotypes) sample_names_.push_back(p.first);
+    for (const auto& p : values) {
+        if (genotypes.count(p.first) == 0) sample_names_.push_back(p.first);
+        for (const auto& kv : p.second) sample_keys_.push_back(kv.first);
+    }
+    std::sort(std::begin(sample_names_), std::end(sample_names_));
+    std::sort(std::begin(sample_keys_), std::end(sample_keys_));
+    sample_keys_.erase(std::unique(std::begin(sample_keys_), std::end(sample_keys_)), std::end(sample_keys_));
+    if (!genotypes.empty()) {
+        genotypes_.resize(sample_names_.size());
+        for (auto& p : genotypes) {
+            genotypes_[*sample_index(p.first)] = std::move(p.second);
+        }
+    }
+    sample_values_.resize(sample_names_.size() * sample_keys_.size());
+    for (auto& p : values) {
+        const auto offset = *sample_index(p.first) * sample_keys_.size();
+        for (auto& kv : p.second) {
+            sample_values_[offset + *format_index(kv.first)] = std::move(kv.second);
+        }
+    }
+    num_samples_ = static_cast<unsigned>(genotypes.empty() ? values.size() : genotypes.size());
+}
+
+const VcfRecord::Genotype& VcfRecord::get_genotype(const SampleName& sample) const
+{
+    const auto sample_idx = sample_index(sample);
+    if (!sample_idx || genotypes_.empty() || !genotypes_[*sample_idx]) {
+        throw std::out_of_range {"VcfRecord: no genotype for sample " + sample};
+    }
+    return *genotypes_[*sample_idx];
+}
+
 std::vector<VcfRecord::SampleName> VcfRecord::samples() const
 {
     std::vector<SampleName> result {};
-    
+    result.reserve(num_samples_);
     if (has_genotypes()) {
-        result.reserve(genotypes_.size());
-        std::transform(std::cbegin(genotypes_), std::cend(genotypes_), std::back_inserter(result),
-                       [] (const auto& p) { return p.first; });
+        for (std::size_t sample_idx {0}; sample_idx < sample_names_.size(); ++sample_idx) {
+            if (genotypes_[sample_idx]) result.push_back(sample_names_[sample_idx]);
+        }
     } else {
-        result.reserve(samples_.size());
-        std::transform(std::cbegin(samples_), std::cend(samples_), std::back_inserter(result),
-                       [] (const auto& p) { return p.first; });
+        result = sample_names_;
     }
-    
     return result;
 }
 
@@ -257,60 +337,40 @@ void VcfRecord::print_info(std::ostream& os) const
 
 void VcfRecord::print_genotype_allele_numbers(std::ostream& os, const SampleName& sample) const
 {
-    std::vector<std::string> allele_numbers(ploidy(sample));
-    const auto& genotype = genotypes_.at(sample);
+    const auto& genotype = get_genotype(sample);
+    std::vector<std::string> allele_numbers(genotype.first.size());
     std::transform(std::cbegin(genotype.first), std::cend(genotype.first), std::begin(allele_numbers),
                    [this] (const std::string& allele) { return get_allele_number(allele); });
     print(os, allele_numbers, (genotype.second) ? "|" : "/");
 }
 
-void VcfRecord::print_other_sample_data(std::ostream& os, const SampleName& sample) const
-{
-    if (!samples_.empty()) {
-        if (samples_.at(sample).empty()) {
-            os << ".";
-        } else {
-            const auto& data = samples_.at(sample);
-            auto last = std::next(cbegin(data), data.size() - 1);
-            std::for_each(std::cbegin(data), last, [&os] (const auto& p) {
-                print(os, p.second, ",");
-                os << ":";
-            });
-            print(os, last->second, ",");
-        }
-    }
-}
-
 void VcfRecord::print_sample_data(std::ostream& os) const
 {
     if (num_samples() > 0) {
         print(os, format_, ":");
-        os << '\t';
-        auto samples = this->samples();
-        std::for_each(std::cbegin(samples), std::prev(std::cend(samples)),
-                      [this, &os] (const SampleName& sample) {
-                          auto it = std::cbegin(format_);
-                          if (*it == vcfspec::format::genotype) {
-                              print_genotype_allele_numbers(os, sample);
-                              ++it;
-                          }
-                          std::for_each(it, std::cend(format_),
-                                        [this, &os, &sample] (const KeyType& key) {
-                                            os << ':';
-                                            print(os, get_sample_value(sample, key), ",");
-                                        });
-                          os << '\t';
+        auto first_key = std::cbegin(format_);
+        const bool has_genotype_key {first_key != std::cend(format_) && *first_key == vcfspec::format::genotype};
+        if (has_genotype_key) ++first_key;
+        std::vector<std::size_t> key_indices {};
+        key_indices.reserve(format_.size());
+        std::for_each(first_key, std::cend(format_), [&] (const KeyType& key) {
+            const auto key_idx = format_index(key);
+            if (!key_idx) throw std::out_of_range {"VcfRecord: no sample values for key " + key};
+            key_indices.push_back(*key_idx);
         });
-        auto it = std::cbegin(format_);
-        if (*it == vcfspec::format::genotype) {
-            print_genotype_allele_numbers(os, samples.back());
-            ++it;
+        for (const auto& sample : samples()) {
+            os << '\t';
+            if (has_genotype_key) {
+                print_genotype_allele_numbers(os, sample);
+            }
+            const auto sample_idx = *sample_index(sample);
+            bool is_first {!has_genotype_key};
+            for (const auto key_idx : key_indices) {
+                if (!is_first) os << ':';
+                print(os, get_sample_value(sample_idx, key_idx), ",");
+                is_first = false;
+            }
         }
-        std::for_each(it, std::cend(format_),
-                      [this, &os, &samples] (const KeyType& key) {
-                          os << ':';
-                          print(os, get_sample_value(samples.back(), key), ",");
-                      });
     }
 }
 
@@ -318,7 +378,7 @@ void VcfRecord::print_sample_data(std::ostream& os) const
 
 std::vector<VcfRecord::NucleotideSequence> get_genotype(const VcfRecord& record, const VcfRecord::SampleName& sample)
 {
-    return record.get_sample_value(sample, vcfspec::format::genotype);
+    return record.genotype(sample);
 }
 
 bool is_filtered(const VcfRecord& record) noexcept
@@ -362,7 +422,7 @@ boost::optional<GenomicRegion> get_phase_region(const VcfRecord& record, const V
     if (record.is_sample_phased(sample) && record.has_format(vcfspec::format::phaseSet)) {
         return GenomicRegion {
         record.chrom(),
-        boost::lexical_cast<ContigRegion::Position>(record.get_sample_value(sample, vcfspec::format::phaseSet).front()) - 1,
+        static_cast<ContigRegion::Position>(record.get_sample_value(sample, vcfspec::format::phaseSet).front().to_integer()) - 1,
         static_cast<ContigRegion::Position>(record.pos() + record.ref().size()) - 1
         };
     } else {
@@ -421,8 +481,10 @@ VcfRecord::Builder::Builder(const VcfRecord& call)
 , filter_ {call.filter()}
 , info_ {call.info_}
 , format_ {call.format()}
+, sample_names_ {call.sample_names_}
 , genotypes_ {call.genotypes_}
-, samples_ {call.samples_}
+, sample_keys_ {call.sample_keys_}
+, sample_values_ {call.sample_values_}
 {}
 
 VcfRecord::Builder& VcfRecord::Builder::set_chrom(std::string name)
@@ -546,7 +608,7 @@ VcfRecord::Builder& VcfRecord::Builder::set_info_flag(KeyType key)
 
 VcfRecord::Builder& VcfRecord::Builder::set_info_missing(const KeyType& key)
 {
-    return this->set_info(key, {vcfspec::missingValue});
+    return this->set_info(key, ValueType {});
 }
 
 VcfRecord::Builder& VcfRecord::Builder::clear_info() noexcept
@@ -581,7 +643,7 @@ VcfRecord::Builder& VcfRecord::Builder::add_format(KeyType key)
 
 VcfRecord::Builder& VcfRecord::Builder::reserve_samples(unsigned n)
 {
-    genotypes_.reserve(n);
+    sample_names_.reserve(n);
     return *this;
 }
 
@@ -594,7 +656,9 @@ VcfRecord::Builder&VcfRecord::Builder:: set_homozygous_ref_genotype(const Sample
 VcfRecord::Builder& VcfRecord::Builder::set_genotype(const SampleName& sample, std::vector<NucleotideSequence> alleles,
                                                      Phasing phasing)
 {
-    genotypes_[sample] = std::make_pair(std::move(alleles), phasing == Phasing::phased);
+    const auto sample_idx = get_or_insert_sample(sample);
+    if (genotypes_.empty()) genotypes_.resize(sample_names_.size());
+    genotypes_[sample_idx] = std::make_pair(std::move(alleles), phasing == Phasing::phased);
     return *this;
 }
 
@@ -616,7 +680,11 @@ VcfRecord::Builder& VcfRecord::Builder::set_genotype(const SampleName& sample, c
 
 VcfRecord::Builder& VcfRecord::Builder::clear_genotype(const SampleName& sample) noexcept
 {
-    genotypes_.erase(sample);
+    const auto sample_idx = binary_find(sample_names_, sample);
+    if (sample_idx && !genotypes_.empty()) {
+        genotypes_[*sample_idx] = boost::none;
+        if (!has_values(*sample_idx)) erase_sample(*sample_idx);
+    }
     return *this;
 }
 
@@ -627,7 +695,7 @@ VcfRecord::Builder& VcfRecord::Builder::set_format(const SampleName& sample, con
 
 VcfRecord::Builder& VcfRecord::Builder::set_format(const SampleName& sample, const KeyType& key, std::vector<ValueType> values)
 {
-    samples_[sample][key] = std::move(values);
+    get_or_insert_value(sample, key) = std::move(values);
     return *this;
 }
 
@@ -638,29 +706,32 @@ VcfRecord::Builder& VcfRecord::Builder::set_format(const SampleName& sample, con
 
 VcfRecord::Builder& VcfRecord::Builder::set_format_missing(const SampleName& sample, const KeyType& key)
 {
-    return this->set_format(sample, key, std::string {vcfspec::missingValue});
+    return this->set_format(sample, key, ValueType {});
 }
 
 VcfRecord::Builder& VcfRecord::Builder::clear_format() noexcept
 {
     format_.clear();
-    samples_.clear();
+    sample_names_.clear();
     genotypes_.clear();
+    sample_keys_.clear();
+    sample_values_.clear();
     return *this;
 }
 
 VcfRecord::Builder& VcfRecord::Builder::clear_format(const SampleName& sample) noexcept
 {
-    samples_.erase(sample);
-    genotypes_.erase(sample);
+    const auto sample_idx = binary_find(sample_names_, sample);
+    if (sample_idx) erase_sample(*sample_idx);
     return *this;
 }
 
 VcfRecord::Builder& VcfRecord::Builder::clear_format(const SampleName& sample, const KeyType& key) noexcept
 {
-    const auto sample_itr = samples_.find(sample);
-    if (sample_itr != std::cend(samples_)) {
-        sample_itr->second.erase(key);
+    const auto sample_idx = binary_find(sample_names_, sample);
+    const auto key_idx = binary_find(sample_keys_, key);
+    if (sample_idx && key_idx) {
+        sample_values_[*sample_idx * sample_keys_.size() + *key_idx] = boost::none;
     }
     return *this;
 }
@@ -672,17 +743,22 @@ VcfRecord::Builder& VcfRecord::Builder::set_passed(const SampleName& sample)
 
 VcfRecord::Builder& VcfRecord::Builder::set_filter(const SampleName& sample, std::vector<KeyType> filter)
 {
-    return this->set_format(sample, vcfspec::format::filter, std::move(filter));
+    std::vector<ValueType> values {};
+    values.reserve(filter.size());
+    for (auto& key : filter) values.emplace_back(std::move(key));
+    return this->set_format(sample, vcfspec::format::filter, std::move(values));
 }
 
 VcfRecord::Builder& VcfRecord::Builder::set_filter(const SampleName& sample, std::initializer_list<KeyType> filter)
 {
-    return this->set_format(sample, vcfspec::format::filter, std::move(filter));
+    return this->set_filter(sample, std::vector<KeyType> {filter});
 }
 
 VcfRecord::Builder& VcfRecord::Builder::add_filter(const SampleName& sample, KeyType filter)
 {
-    samples_[sample][vcfspec::format::filter].push_back(std::move(filter));
+    auto& filters = get_or_insert_value(sample, vcfspec::format::filter);
+    if (!filters) filters = std::vector<ValueType> {};
+    filters->push_back(std::move(filter));
     return *this;
 }
 
@@ -718,23 +794,100 @@ GenomicRegion::Position VcfRecord::Builder::pos() const noexcept
 
 VcfRecord VcfRecord::Builder::build() const
 {
-    if (genotypes_.empty() && samples_.empty()) {
-        return VcfRecord {chrom_, pos_, id_, ref_, alt_, qual_, filter_, info_};
-    } else {
-        return VcfRecord {chrom_, pos_, id_, ref_, alt_, qual_, filter_, info_, format_, genotypes_, samples_};
+    VcfRecord result {chrom_, pos_, id_, ref_, alt_, qual_, filter_, info_};
+    if (!sample_names_.empty()) {
+        const auto num_genotypes = this->num_genotypes();
+        result.num_samples_ = static_cast<unsigned>(num_genotypes > 0 ? num_genotypes : sample_names_.size());
+        result.format_ = format_;
+        result.sample_names_ = sample_names_;
+        if (num_genotypes > 0) result.genotypes_ = genotypes_;
+        result.sample_keys_ = sample_keys_;
+        result.sample_values_ = sample_values_;
     }
+    return result;
 }
 
 VcfRecord VcfRecord::Builder::build_once() noexcept
 {
-    if (genotypes_.empty() && samples_.empty()) {
-        return VcfRecord {std::move(chrom_), pos_, std::move(id_), std::move(ref_),
-                          std::move(alt_), qual_, std::move(filter_), std::move(info_)};
-    } else {
-        return VcfRecord {std::move(chrom_), pos_, std::move(id_), std::move(ref_),
-                          std::move(alt_), qual_, std::move(filter_), std::move(info_),
-                          std::move(format_), std::move(genotypes_), std::move(samples_)};
+    VcfRecord result {std::move(chrom_), pos_, std::move(id_), std::move(ref_),
+                      std::move(alt_), qual_, std::move(filter_), std::move(info_)};
+    if (!sample_names_.empty()) {
+        const auto num_genotypes = this->num_genotypes();
+        result.num_samples_ = static_cast<unsigned>(num_genotypes > 0 ? num_genotypes : sample_names_.size());
+        result.format_ = std::move(format_);
+        result.sample_names_ = std::move(sample_names_);
+        if (num_genotypes > 0) result.genotypes_ = std::move(genotypes_);
+        result.sample_keys_ = std::move(sample_keys_);
+        result.sample_values_ = std::move(sample_values_);
+    }
+    return result;
+}
+
+// VcfRecord::Builder private methods
+
+std::size_t VcfRecord::Builder::get_or_insert_sample(const SampleName& sample)
+{
+    const auto itr = std::lower_bound(std::cbegin(sample_names_), std::cend(sample_names_), sample);
+    const auto sample_idx = static_cast<std::size_t>(std::distance(std::cbegin(sample_names_), itr));
+    if (itr == std::cend(sample_names_) || *itr != sample) {
+        sample_names_.insert(itr, sample);
+        if (!genotypes_.empty()) {
+            genotypes_.insert(std::next(std::cbegin(genotypes_), sample_idx), boost::none);
+        }
+        const auto row_begin = std::next(std::cbegin(sample_values_), sample_idx * sample_keys_.size());
+        sample_values_.insert(row_begin, sample_keys_.size(), boost::none);
+    }
+    return sample_idx;
+}
+
+std::size_t VcfRecord::Builder::get_or_insert_key(const KeyType& key)
+{
+    const auto itr = std::lower_bound(std::cbegin(sample_keys_), std::cend(sample_keys_), key);
+    const auto key_idx = static_cast<std::size_t>(std::distance(std::cbegin(sample_keys_), itr));
+    if (itr == std::cend(sample_keys_) || *itr != key) {
+        // A new key widens every sample's row
+        const auto num_keys = sample_keys_.size();
+        decltype(sample_values_) values(sample_names_.size() * (num_keys + 1));
+        for (std::size_t sample_idx {0}; sample_idx < sample_names_.size(); ++sample_idx) {
+            const auto row_begin = std::next(std::begin(sample_values_), sample_idx * num_keys);
+            const auto new_row_begin = std::next(std::begin(values), sample_idx * (num_keys + 1));
+            std::move(row_begin, std::next(row_begin, key_idx), new_row_begin);
+            std::move(std::next(row_begin, key_idx), std::next(row_begin, num_keys), std::next(new_row_begin, key_idx + 1));
+        }
+        sample_keys_.insert(itr, key);
+        sample_values_ = std::move(values);
     }
+    return key_idx;
+}
+
+boost::optional<std::vector<VcfRecord::ValueType>>&
+VcfRecord::Builder::get_or_insert_value(const SampleName& sample, const KeyType& key)
+{
+    const auto key_idx = get_or_insert_key(key);
+    const auto sample_idx = get_or_insert_sample(sample);
+    return sample_values_[sample_idx * sample_keys_.size() + key_idx];
+}
+
+bool VcfRecord::Builder::has_values(const std::size_t sample_idx) const noexcept
+{
+    const auto row_begin = std::next(std::cbegin(sample_values_), sample_idx * sample_keys_.size());
+    return std::any_of(row_begin, std::next(row_begin, sample_keys_.size()), [] (const auto& values) { return static_cast<bool>(values); });
+}
+
+void VcfRecord::Builder::erase_sample(const std::size_t sample_idx) noexcept
+{
+    sample_names_.erase(std::next(std::cbegin(sample_names_), sample_idx));
+    if (!genotypes_.empty()) {
+        genotypes_.erase(std::next(std::cbegin(genotypes_), sample_idx));
+    }
+    const auto row_begin = std::next(std::cbegin(sample_values_), sample_idx * sample_keys_.size());
+    sample_values_.erase(row_begin, std::next(row_begin, sample_keys_.size()));
+}
+
+std::size_t VcfRecord::Builder::num_genotypes() const noexcept
+{
+    return std::count_if(std::cbegin(genotypes_), std::cend(genotypes_),
+                         [] (const auto& genotype) { return static_cast<bool>(genotype); });
 }
 
 } // namespace octopus
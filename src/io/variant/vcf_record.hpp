@@ -5,6 +5,7 @@
 #define vcf_record_hpp
 
 #include <cstdint>
+#include <cstddef>
 #include <string>
 #include <vector>
 #include <map>
@@ -13,6 +14,7 @@
 #include <utility>
 #include <initializer_list>
 #include <functional>
+#include <type_traits>
 
 #include <boost/optional.hpp>
 #include <boost/container/flat_map.hpp>
@@ -21,11 +23,17 @@
 #include "concepts/mappable.hpp"
 #include "basics/genomic_region.hpp"
 #include "utils/string_utils.hpp"
+#include "vcf_value.hpp"
 
 namespace octopus {
 
-// TODO: consider using boosts small_vector for INFO and genotype fields
-
+/*
+ Sample data is packed when a record is built: sample names and FORMAT keys are each stored once,
+ in sorted order, and each sample's values are held contiguously, indexed by key position. Names are
+ resolved to positions with a binary search, so bulk readers (e.g. the BCF writer) can resolve a key
+ once and then index each sample's values directly. INFO and FORMAT values are typed (see VcfValue),
+ and are only rendered as text when the record is printed.
+ */
 class VcfRecord : public Comparable<VcfRecord>, public Mappable<VcfRecord>
 {
 public:
@@ -35,7 +43,7 @@ public:
     using QualityType        = float;
     using SampleName         = std::string;
     using KeyType            = std::string;
-    using ValueType          = std::string;
+    using ValueType          = VcfValue;
     
     VcfRecord() = default;
     
@@ -89,13 +97,21 @@ public:
     bool has_genotypes() const noexcept;
     unsigned ploidy(const SampleName& sample) const;
     bool is_sample_phased(const SampleName& sample) const;
+    const std::vector<NucleotideSequence>& genotype(const SampleName& sample) const;
     bool is_homozygous(const SampleName& sample) const;
     bool is_heterozygous(const SampleName& sample) const;
     bool is_homozygous_ref(const SampleName& sample) const;
     bool is_homozygous_non_ref(const SampleName& sample) const;
     bool has_ref_allele(const SampleName& sample) const;
     bool has_alt_allele(const SampleName& sample) const;
-    const std::vector<ValueType>& get_sample_value(const SampleName& sample, const KeyType& key) const;
+    const std::vector<ValueType>& get_sample_value(const SampleName& sample, const KeyType& key) const; // not for GT
+    
+    //
+    // Positional sample access, for resolving names once when reading many values
+    //
+    boost::optional<std::size_t> sample_index(const SampleName& sample) const noexcept;
+    boost::optional<std::size_t> format_index(const KeyType& key) const noexcept; // not for GT
+    const std::vector<ValueType>& get_sample_value(std::size_t sample_idx, std::size_t format_idx) const;
     
     friend std::ostream& operator<<(std::ostream& os, const VcfRecord& record);
     friend Builder;
@@ -103,6 +119,8 @@ public:
 private:
     using Genotype = std::pair<std::vector<NucleotideSequence>, bool>;
     using ValueMap = boost::container::flat_map<KeyType, std::vector<ValueType>>;
+    using GenotypeMap = boost::container::flat_map<SampleName, Genotype>;
+    using SampleValueMap = boost::container::flat_map<SampleName, ValueMap>;
     
     // mandatory fields
     GenomicRegion region_;
@@ -115,15 +133,20 @@ private:
     
     // optional fields
     std::vector<KeyType> format_;
-    boost::container::flat_map<SampleName, Genotype> genotypes_;
-    boost::container::flat_map<SampleName, ValueMap> samples_;
+    std::vector<SampleName> sample_names_; // sorted
+    std::vector<boost::optional<Genotype>> genotypes_; // by sample index, empty if no genotypes
+    std::vector<KeyType> sample_keys_; // sorted, excludes GT
+    std::vector<boost::optional<std::vector<ValueType>>> sample_values_; // by sample index * sample_keys_.size() + key index
+    unsigned num_samples_ = 0;
+    
+    void pack(GenotypeMap genotypes, SampleValueMap values);
+    const Genotype& get_genotype(const SampleName& sample) const;
     
     std::string get_allele_number(const NucleotideSequence& allele) const;
     
     std::vector<SampleName> samples() const;
     void print_info(std::ostream& os) const;
     void print_genotype_allele_numbers(std::ostream& os, const SampleName& sample) const;
-    void print_other_sample_data(std::ostream& os, const SampleName& sample) const;
     void print_sample_data(std::ostream& os) const;
 };
 
@@ -186,7 +209,8 @@ public:
     Builder& reserve_info(unsigned n);
     Builder& add_info(const KeyType& key); // flags
     Builder& set_info(const KeyType& key, const ValueType& value);
-    template <typename T> Builder& set_info(const KeyType& key, const T& value); // calls std::to_string
+    template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+    Builder& set_info(const KeyType& key, T value); // stored natively
     Builder& set_info(const KeyType& key, std::vector<ValueType> values);
     Builder& set_info(const KeyType& key, std::initializer_list<ValueType> values);
     Builder& set_info_flag(KeyType key);
@@ -203,8 +227,8 @@ public:
     Builder& set_genotype(const SampleName& sample, const std::vector<boost::optional<unsigned>>& alleles, Phasing is_phased);
     Builder& clear_genotype(const SampleName& sample) noexcept;
     Builder& set_format(const SampleName& sample, const KeyType& key, const ValueType& value);
-    template <typename T>
-    Builder& set_format(const SampleName& sample, const KeyType& key, const T& value); // calls std::to_string
+    template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+    Builder& set_format(const SampleName& sample, const KeyType& key, T value); // stored natively
     Builder& set_format(const SampleName& sample, const KeyType& key, std::vector<ValueType> values);
     Builder& set_format(const SampleName& sample, const KeyType& key, std::initializer_list<ValueType> values);
     Builder& set_format_missing(const SampleName& sample, const KeyType& key);
@@ -237,8 +261,18 @@ private:
     decltype(VcfRecord::filter_) filter_ = {};
     decltype(VcfRecord::info_) info_ = {};
     decltype(VcfRecord::format_) format_ = {};
+    // sample data is kept in the record's packed layout, so records are copied in and out without repacking
+    decltype(VcfRecord::sample_names_) sample_names_ = {};
     decltype(VcfRecord::genotypes_) genotypes_ = {};
-    decltype(VcfRecord::samples_) samples_ = {};
+    decltype(VcfRecord::sample_keys_) sample_keys_ = {};
+    decltype(VcfRecord::sample_values_) sample_values_ = {};
+    
+    std::size_t get_or_insert_sample(const SampleName& sample);
+    std::size_t get_or_insert_key(const KeyType& key);
+    boost::optional<std::vector<ValueType>>& get_or_insert_value(const SampleName& sample, const KeyType& key);
+    bool has_values(std::size_t sample_idx) const noexcept;
+    void erase_sample(std::size_t sample_idx) noexcept;
+    std::size_t num_genotypes() const noexcept;
 };
 
 template <typename String1, typename String2, typename Sequence1, typename Sequence2,
@@ -253,8 +287,11 @@ VcfRecord::VcfRecord(String1&& chrom, GenomicRegion::Position pos, String2&& id,
 , filter_ {std::forward<Filters>(filters)}
 , info_ {std::forward<Info>(info)}
 , format_ {}
+, sample_names_ {}
 , genotypes_ {}
-, samples_ {}
+, sample_keys_ {}
+, sample_values_ {}
+, num_samples_ {0}
 {}
 
 template <typename String1, typename String2, typename Sequence1, typename Sequence2,
@@ -270,22 +307,25 @@ VcfRecord::VcfRecord(String1&& chrom, GenomicRegion::Position pos, String2&& id,
 , filter_ {std::forward<Filters>(filters)}
 , info_ {std::forward<Info>(info)}
 , format_ {std::forward<Format>(format)}
-, genotypes_ {std::forward<Genotypes>(genotypes)}
-, samples_ {std::forward<Samples>(samples)}
-{}
+, sample_names_ {}
+, genotypes_ {}
+, sample_keys_ {}
+, sample_values_ {}
+, num_samples_ {0}
+{
+    pack(std::forward<Genotypes>(genotypes), std::forward<Samples>(samples));
+}
 
-template <typename T>
-VcfRecord::Builder& VcfRecord::Builder::set_info(const KeyType& key, const T& value)
+template <typename T, typename>
+VcfRecord::Builder& VcfRecord::Builder::set_info(const KeyType& key, const T value)
 {
-    using std::to_string;
-    return set_info(key, to_string(value));
+    return set_info(key, ValueType {value});
 }
 
-template <typename T>
-VcfRecord::Builder& VcfRecord::Builder::set_format(const SampleName& sample, const KeyType& key, const T& value)
+template <typename T, typename>
+VcfRecord::Builder& VcfRecord::Builder::set_format(const SampleName& sample, const KeyType& key, const T value)
 {
-    using std::to_string;
-    return set_format(sample, key, to_string(value));
+    return set_format(sample, key, ValueType {value});
 }
 
 } // namespace octopus
@@ -13,6 +13,8 @@
 #include <stdexcept>
 #include <numeric>
 
+#include <boost/filesystem/operations.hpp>
+
 #include "htslib/vcf.h"
 #include "htslib/tbx.h"
 
@@ -41,14 +43,14 @@ unsigned get_field_cardinality(const VcfHeader::StructuredKey& key, const VcfRec
 std::vector<VcfType> get_typed_info_values(const VcfHeader& header, const VcfRecord& record,
                                            const VcfHeader::StructuredKey& key)
 {
-    return get_typed_info_values(header, key, record.info_value(key.value));
+    return get_typed_info_values(header, key, to_strings(record.info_value(key.value)));
 }
 
 std::vector<VcfType> get_typed_format_values(const VcfHeader& header, const VcfRecord& record,
                                              const VcfRecord::SampleName sample,
                                              const VcfHeader::StructuredKey& key)
 {
-    return get_typed_format_values(header, key, record.get_sample_value(sample, key.value));
+    return get_typed_format_values(header, key, to_strings(record.get_sample_value(sample, key.value)));
 }
 
 bool is_indexable(const boost::filesystem::path& vcf_path)
@@ -57,6 +59,12 @@ bool is_indexable(const boost::filesystem::path& vcf_path)
     return extension == ".bcf" || extension == ".gz";
 }
 
+bool is_indexed(const boost::filesystem::path& vcf_path)
+{
+    using boost::filesystem::exists;
+    return exists(vcf_path.string() + ".csi") || exists(vcf_path.string() + ".tbi");
+}
+
 void index_vcf(const boost::filesystem::path& vcf_path)
 {
     auto* const fp = hts_open(vcf_path.c_str(), "r");
@@ -463,7 +471,7 @@ VcfRecord convert_to_legacy(const VcfRecord& record, const std::vector<std::stri
         cb.set_alt(std::move(new_alt));
     }
     for (const auto& sample : samples) {
-        const auto& gt = record.get_sample_value(sample, vcfspec::format::genotype);
+        const auto& gt = record.genotype(sample);
         const auto first_non_legacy = std::find_if(std::cbegin(gt), std::cend(gt), is_missing_or_has_deleted);
         if (first_non_legacy != std::cend(gt)) {
             const auto& ref = record.ref();
@@ -29,6 +29,7 @@ std::vector<VcfType> get_typed_format_values(const VcfHeader& header, const VcfR
                                              const VcfHeader::StructuredKey& key);
 
 bool is_indexable(const boost::filesystem::path& vcf_path);
+bool is_indexed(const boost::filesystem::path& vcf_path);
 
 void index_vcf(const boost::filesystem::path& vcf_path);
 void index_vcf(const VcfReader& reader);
@@ -0,0 +1,117 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "vcf_value.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+
+#include "vcf_spec.hpp"
+
+namespace octopus {
+
+constexpr unsigned VcfValue::defaultPrecision;
+
+VcfValue::VcfValue(std::string value)
+: type_ {Type::string}
+, string_ {std::move(value)}
+{}
+
+VcfValue::VcfValue(const char* value)
+: type_ {Type::string}
+, string_ {value}
+{}
+
+VcfValue::VcfValue(const RealType value, const unsigned precision)
+: type_ {Type::real}
+, precision_ {static_cast<std::uint8_t>(precision)}
+, real_ {value}
+{}
+
+bool VcfValue::is_missing() const noexcept
+{
+    return type_ == Type::missing || (type_ == Type::string && string_ == vcfspec::missingValue);
+}
+
+VcfValue::IntegerType VcfValue::to_integer() const
+{
+    switch (type_) {
+        case Type::integer: return integer_;
+        case Type::real: return static_cast<IntegerType>(real_);
+        case Type::string: return std::stoll(string_);
+        default: throw std::invalid_argument {"VcfValue: missing value is not an integer"};
+    }
+}
+
+VcfValue::RealType VcfValue::to_real() const
+{
+    switch (type_) {
+        case Type::integer: return static_cast<RealType>(integer_);
+        case Type::real: return real_;
+        case Type::string: return std::stod(string_);
+        default: throw std::invalid_argument {"VcfValue: missing value is not a real"};
+    }
+}
+
+std::string VcfValue::str() const
+{
+    switch (type_) {
+        case Type::integer: return std::to_string(integer_);
+        case Type::string: return string_;
+        case Type::missing: return vcfspec::missingValue;
+        default: {
+            std::ostringstream ss {};
+            ss << *this;
+            return ss.str();
+        }
+    }
+}
+
+bool operator==(const VcfValue& lhs, const VcfValue& rhs)
+{
+    using Type = VcfValue::Type;
+    if (lhs.type_ == rhs.type_) {
+        switch (lhs.type_) {
+            case Type::integer: return lhs.integer_ == rhs.integer_;
+            case Type::string: return lhs.string_ == rhs.string_;
+            case Type::missing: return true;
+            default: break;
+        }
+    }
+    // Values of different types are equal if they print the same
+    return lhs.str() == rhs.str();
+}
+
+std::ostream& operator<<(std::ostream& os, const VcfValue& value)
+{
+    using Type = VcfValue::Type;
+    switch (value.type_) {
+        case Type::integer: os << value.integer_; break;
+        case Type::string: os << value.string_; break;
+        case Type::missing: os << vcfspec::missingValue; break;
+        case Type::real: {
+            const auto flags = os.flags();
+            const auto precision = os.precision();
+            os << std::fixed << std::setprecision(value.precision_) << value.real_;
+            os.flags(flags);
+            os.precision(precision);
+            break;
+        }
+    }
+    return os;
+}
+
+std::vector<std::string> to_strings(const std::vector<VcfValue>& values)
+{
+    std::vector<std::string> result {};
+    result.reserve(values.size());
+    std::transform(std::cbegin(values), std::cend(values), std::back_inserter(result),
+                   [] (const VcfValue& value) { return value.str(); });
+    return result;
+}
+
+} // namespace octopus
@@ -0,0 +1,81 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef vcf_value_hpp
+#define vcf_value_hpp
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <type_traits>
+#include <iosfwd>
+
+#include "concepts/equitable.hpp"
+
+namespace octopus {
+
+/**
+ A single INFO or FORMAT value. Numbers are stored natively (reals with the number of decimal
+ places to print), so they are only rendered as text when a record is written as VCF, and are
+ encoded into BCF without a round trip through strings. Values read from text are kept as
+ strings and parsed when a typed value is requested.
+ */
+class VcfValue : public Equitable<VcfValue>
+{
+public:
+    using IntegerType = std::int64_t;
+    using RealType    = double;
+
+    enum class Type : std::uint8_t { missing, integer, real, string };
+
+    static constexpr unsigned defaultPrecision {6}; // same as std::to_string
+
+    VcfValue() = default; // missing
+
+    VcfValue(std::string value);
+    VcfValue(const char* value);
+    template <typename T,
+              typename = std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, char>::value>>
+    VcfValue(T value);
+    VcfValue(RealType value, unsigned precision = defaultPrecision);
+
+    VcfValue(const VcfValue&)            = default;
+    VcfValue& operator=(const VcfValue&) = default;
+    VcfValue(VcfValue&&)                 = default;
+    VcfValue& operator=(VcfValue&&)      = default;
+
+    ~VcfValue() = default;
+
+    Type type() const noexcept { return type_; }
+    bool is_missing() const noexcept;
+
+    // Strings are parsed, so these throw std::invalid_argument for non-numeric values
+    IntegerType to_integer() const;
+    RealType to_real() const;
+
+    std::string str() const;
+
+    friend bool operator==(const VcfValue& lhs, const VcfValue& rhs);
+    friend std::ostream& operator<<(std::ostream& os, const VcfValue& value);
+
+private:
+    Type type_ = Type::missing;
+    std::uint8_t precision_ = defaultPrecision;
+    union {
+        IntegerType integer_;
+        RealType real_ = 0;
+    };
+    std::string string_ = {};
+};
+
+template <typename T, typename>
+VcfValue::VcfValue(T value)
+: type_ {Type::integer}
+, integer_ {static_cast<IntegerType>(value)}
+{}
+
+std::vector<std::string> to_strings(const std::vector<VcfValue>& values);
+
+} // namespace octopus
+
+#endif
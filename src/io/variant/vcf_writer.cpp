@@ -26,18 +26,29 @@ auto make_vcf_writer(boost::optional<VcfWriter::Path> path = boost::none)
     }
 }
 
+// Any existing index belongs to a previous file at the same path
+void remove_index(const VcfWriter::Path& file_path)
+{
+    boost::filesystem::remove(file_path.string() + ".csi");
+    boost::filesystem::remove(file_path.string() + ".tbi");
+}
+
 } // namespace
 
 VcfWriter::VcfWriter()
 : file_path_ {}
 , writer_ {make_vcf_writer()}
 , is_header_written_ {false}
+, num_compression_threads_ {0}
+, is_indexed_ {false}
 {}
 
 VcfWriter::VcfWriter(Path file_path)
 : file_path_ {std::move(file_path)}
 , writer_ {nullptr}
 , is_header_written_ {false}
+, num_compression_threads_ {0}
+, is_indexed_ {false}
 {
     using namespace boost::filesystem;
     
@@ -53,12 +64,7 @@ VcfWriter::VcfWriter(Path file_path)
             throw std::runtime_error {ss.str()};
         }
     }
-    Path index_path1 {file_path_->string() + ".csi"}, index_path2 {file_path_->string() + ".tbi"};
-    if (exists(index_path1)) {
-        remove(index_path1);
-    } else if (exists(index_path2)) {
-        remove(index_path2);
-    }
+    remove_index(*file_path_);
     writer_ = make_vcf_writer(*file_path_);
 }
 
@@ -77,9 +83,11 @@ VcfWriter::VcfWriter(Path file_path, const VcfHeader& header)
 VcfWriter::VcfWriter(VcfWriter&& other)
 {
     std::lock_guard<std::mutex> lock {other.mutex_};
-    file_path_         = std::move(other.file_path_);
-    is_header_written_ = other.is_header_written_;
-    writer_            = std::move(other.writer_);
+    file_path_               = std::move(other.file_path_);
+    is_header_written_       = other.is_header_written_;
+    num_compression_threads_ = other.num_compression_threads_;
+    is_indexed_              = other.is_indexed_;
+    writer_                  = std::move(other.writer_);
 }
 
 VcfWriter& VcfWriter::operator=(VcfWriter&& other)
@@ -87,9 +95,11 @@ VcfWriter& VcfWriter::operator=(VcfWriter&& other)
     if (this != &other) {
         std::unique_lock<std::mutex> lock_lhs {mutex_, std::defer_lock}, lock_rhs {other.mutex_, std::defer_lock};
         std::lock(lock_lhs, lock_rhs);
-        file_path_         = std::move(other.file_path_);
-        is_header_written_ = other.is_header_written_;
-        writer_            = std::move(other.writer_);
+        file_path_               = std::move(other.file_path_);
+        is_header_written_       = other.is_header_written_;
+        num_compression_threads_ = other.num_compression_threads_;
+        is_indexed_              = other.is_indexed_;
+        writer_                  = std::move(other.writer_);
     }
     return *this;
 }
@@ -98,9 +108,7 @@ VcfWriter::~VcfWriter()
 {
     try {
         close();
-        if (can_write_index()) {
-            index_vcf(*file_path_);
-        }
+        write_index();
     } catch(...) {
         return;
     }
@@ -114,6 +122,8 @@ void swap(VcfWriter& lhs, VcfWriter& rhs) noexcept
     using std::swap;
     swap(lhs.file_path_, rhs.file_path_);
     swap(lhs.is_header_written_, rhs.is_header_written_);
+    swap(lhs.num_compression_threads_, rhs.num_compression_threads_);
+    swap(lhs.is_indexed_, rhs.is_indexed_);
     swap(lhs.writer_, rhs.writer_);
 }
 
@@ -127,8 +137,11 @@ void VcfWriter::open(Path file_path)
 {
     std::lock_guard<std::mutex> lock {mutex_};
     file_path_         = std::move(file_path);
+    remove_index(*file_path_);
     writer_            = make_vcf_writer(*file_path_);
     is_header_written_ = false;
+    is_indexed_        = false;
+    writer_->set_threads(num_compression_threads_);
 }
 
 void VcfWriter::close() noexcept
@@ -149,11 +162,24 @@ boost::optional<VcfWriter::Path> VcfWriter::path() const
     return file_path_;
 }
 
+void VcfWriter::set_compression_threads(const unsigned num_threads)
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    if (writer_) {
+        if (is_header_written_) {
+            throw std::runtime_error {"VcfWriter::set_compression_threads: header has already been written"};
+        }
+        writer_->set_threads(num_threads);
+    }
+    num_compression_threads_ = num_threads;
+}
+
 void VcfWriter::write(const VcfHeader& header)
 {
     std::lock_guard<std::mutex> lock {mutex_};
     writer_->write(header);
     is_header_written_ = true;
+    is_indexed_ = writer_->is_indexing(); // the index is saved when the file is closed
 }
 
 void VcfWriter::write(const VcfRecord& record)
@@ -166,10 +192,21 @@ void VcfWriter::write(const VcfRecord& record)
     }
 }
 
+void VcfWriter::write_index()
+{
+    std::lock_guard<std::mutex> lock {mutex_};
+    if (can_write_index()) {
+        index_vcf(*file_path_);
+        is_indexed_ = true;
+    }
+}
+
+// Saving an index built while writing can fail, so check it was saved
 bool VcfWriter::can_write_index() const noexcept
 {
-    return file_path_ && is_header_written_
-           && is_indexable(*file_path_) && boost::filesystem::exists(*file_path_);
+    return file_path_ && !writer_ && is_header_written_
+           && is_indexable(*file_path_) && boost::filesystem::exists(*file_path_)
+           && !(is_indexed_ && is_indexed(*file_path_));
 }
 
 // non member methods
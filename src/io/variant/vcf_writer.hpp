@@ -48,13 +48,22 @@ public:
     
     boost::optional<Path> path() const;
     
+    // Compressed output (BCF or bgzipped VCF) is compressed with num_threads worker threads. Applies to
+    // the current file, which must not have a header yet, and to any file opened later.
+    void set_compression_threads(unsigned num_threads);
+    
     void write(const VcfHeader& header);
     void write(const VcfRecord& record);
     
+    // Indexes the closed file, unless this writer already indexed it
+    void write_index();
+    
 private:
     boost::optional<Path> file_path_;
     std::unique_ptr<HtslibBcfFacade> writer_;
     bool is_header_written_;
+    unsigned num_compression_threads_;
+    bool is_indexed_; // by this writer, either while writing or once closed
     mutable std::mutex mutex_;
     
     bool can_write_index() const noexcept;
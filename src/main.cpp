@@ -2,10 +2,14 @@
 // Use of this source code is governed by the MIT license that can be found in the LICENSE file.
 
 #include <iostream>
+#include <fstream>
 #include <cstdlib>
 #include <chrono>
 #include <exception>
 
+#include <boost/optional.hpp>
+#include <boost/filesystem/path.hpp>
+
 #include "config/config.hpp"
 #include "config/common.hpp"
 #include "logging/logging.hpp"
@@ -13,9 +17,12 @@
 #include "config/option_parser.hpp"
 #include "config/option_collation.hpp"
 #include "core/octopus.hpp"
+#include "io/reference/fasta.hpp"
+#include "io/reference/packed_reference.hpp"
 #include "utils/timing.hpp"
 #include "utils/system_utils.hpp"
 #include "utils/string_utils.hpp"
+#include "utils/profiler.hpp"
 #include "exceptions/error.hpp"
 #include "logging/error_handler.hpp"
 
@@ -47,6 +54,35 @@ void init_common(const OptionMap& options)
     TRACE_MODE = options::is_trace_mode(options);
 }
 
+struct ProfileRequest
+{
+    boost::optional<boost::filesystem::path> profile, trace;
+};
+
+ProfileRequest init_profiler(const OptionMap& options)
+{
+    ProfileRequest result {get_profile_file_name(options), get_profile_trace_file_name(options)};
+    if (result.profile || result.trace) {
+        profiling::enable(static_cast<bool>(result.trace));
+    }
+    return result;
+}
+
+void write_profile(const ProfileRequest& request)
+{
+    logging::InfoLogger info_log {};
+    if (request.profile) {
+        std::ofstream file {request.profile->string()};
+        profiling::write_json(file);
+        stream(info_log) << "Profile written to " << request.profile->string();
+    }
+    if (request.trace) {
+        std::ofstream file {request.trace->string()};
+        profiling::write_chrome_trace(file);
+        stream(info_log) << "Profile trace written to " << request.trace->string();
+    }
+}
+
 std::string to_string(const int argc, const char** argv)
 {
     std::vector<std::string> arguements {argv, argv + argc};
@@ -66,6 +102,18 @@ void sanity_check(const OptionMap& options)
     }
 }
 
+void pack_reference(const OptionMap& options)
+{
+    logging::InfoLogger info_log {};
+    const auto fasta_path = get_reference_to_pack(options);
+    const auto packed_path = io::get_packed_reference_path(fasta_path);
+    stream(info_log) << "Packing reference " << fasta_path.string() << " to " << packed_path.string();
+    const auto start = std::chrono::system_clock::now();
+    io::make_packed_reference(io::Fasta {fasta_path}, packed_path);
+    const auto end = std::chrono::system_clock::now();
+    stream(info_log) << "Done packing reference in " << utils::TimeInterval {start, end};
+}
+
 } // namespace
 
 int main(const int argc, const char** argv)
@@ -85,6 +133,7 @@ int main(const int argc, const char** argv)
     if (is_run_command(options)) {
         try {
             init_common(options);
+            const auto profile_request = init_profiler(options);
             log_program_startup();
             logging::InfoLogger info_log {};
             const auto start = std::chrono::system_clock::now();
@@ -97,6 +146,22 @@ int main(const int argc, const char** argv)
             if (validate(components)) {
                 run_octopus(components, to_string(argc, argv));
             }
+            write_profile(profile_request);
+            log_program_end();
+        } catch (const Error& e) {
+            return log_exception(e);
+        } catch (const std::exception& e) {
+            return log_exception(e);
+        } catch (...) {
+            log_unknown_error();
+            log_program_end();
+            return EXIT_FAILURE;
+        }
+    } else if (is_pack_reference_command(options)) {
+        try {
+            init_common(options);
+            log_program_startup();
+            pack_reference(options);
             log_program_end();
         } catch (const Error& e) {
             return log_exception(e);
@@ -35,6 +35,11 @@ bool IsNotSecondaryAlignment::passes(const AlignedRead& read) const noexcept
     return !read.is_marked_secondary_alignment();
 }
 
+void IsNotSecondaryAlignment::do_add_to(ReadCoreFilter& filter) const noexcept
+{
+    filter.remove_secondary_alignments = true;
+}
+
 IsNotSupplementaryAlignment::IsNotSupplementaryAlignment()
 : BasicReadFilter {"IsNotSupplementaryAlignment"} {}
 
@@ -46,6 +51,11 @@ bool IsNotSupplementaryAlignment::passes(const AlignedRead& read) const noexcept
     return !read.is_marked_supplementary_alignment();
 }
 
+void IsNotSupplementaryAlignment::do_add_to(ReadCoreFilter& filter) const noexcept
+{
+    filter.remove_supplementary_alignments = true;
+}
+
 IsGoodMappingQuality::IsGoodMappingQuality(MappingQuality good_mapping_quality)
 :
 BasicReadFilter {"IsGoodMappingQuality"}
@@ -60,6 +70,11 @@ bool IsGoodMappingQuality::passes(const AlignedRead& read) const noexcept
     return read.mapping_quality() >= good_mapping_quality_;
 }
 
+void IsGoodMappingQuality::do_add_to(ReadCoreFilter& filter) const noexcept
+{
+    filter.min_mapping_quality = std::max(filter.min_mapping_quality, good_mapping_quality_);
+}
+
 HasSufficientGoodBaseFraction::HasSufficientGoodBaseFraction(BaseQuality good_base_quality,
                                                              double min_good_base_fraction)
 : BasicReadFilter {"HasSufficientGoodBaseFraction"}
@@ -114,6 +129,11 @@ bool IsMapped::passes(const AlignedRead& read) const noexcept
     return !read.is_marked_unmapped();
 }
 
+void IsMapped::do_add_to(ReadCoreFilter& filter) const noexcept
+{
+    filter.remove_unmapped = true;
+}
+
 IsNotChimeric::IsNotChimeric() : BasicReadFilter {"IsNotChimeric"} {}
 IsNotChimeric::IsNotChimeric(std::string name) :  BasicReadFilter {std::move(name)} {}
 
@@ -130,6 +150,11 @@ bool IsNextSegmentMapped::passes(const AlignedRead& read) const noexcept
     return !read.has_other_segment() || !read.next_segment().is_marked_unmapped();
 }
 
+void IsNextSegmentMapped::do_add_to(ReadCoreFilter& filter) const noexcept
+{
+    filter.remove_unmapped_next_segments = true;
+}
+
 IsNotMarkedDuplicate::IsNotMarkedDuplicate() : BasicReadFilter {"IsNotMarkedDuplicate"} {}
 IsNotMarkedDuplicate::IsNotMarkedDuplicate(std::string name) :  BasicReadFilter {std::move(name)} {}
 
@@ -138,6 +163,11 @@ bool IsNotMarkedDuplicate::passes(const AlignedRead& read) const noexcept
     return !read.is_marked_duplicate();
 }
 
+void IsNotMarkedDuplicate::do_add_to(ReadCoreFilter& filter) const noexcept
+{
+    filter.remove_marked_duplicates = true;
+}
+
 IsShort::IsShort(Length max_length)
 : BasicReadFilter {"IsShort"}
 , max_length_ {max_length} {}
@@ -184,6 +214,11 @@ bool IsNotMarkedQcFail::passes(const AlignedRead& read) const noexcept
     return !read.is_marked_qc_fail();
 }
 
+void IsNotMarkedQcFail::do_add_to(ReadCoreFilter& filter) const noexcept
+{
+    filter.remove_qc_fails = true;
+}
+
 IsProperTemplate::IsProperTemplate() : BasicReadFilter {"IsProperTemplate"} {}
 IsProperTemplate::IsProperTemplate(std::string name) :  BasicReadFilter {std::move(name)} {}
 
@@ -192,6 +227,11 @@ bool IsProperTemplate::passes(const AlignedRead& read) const noexcept
     return !read.has_other_segment() || read.is_marked_all_segments_in_read_aligned();
 }
 
+void IsProperTemplate::do_add_to(ReadCoreFilter& filter) const noexcept
+{
+    filter.remove_improper_templates = true;
+}
+
 IsLocalTemplate::IsLocalTemplate() : BasicReadFilter {"IsLocalTemplate"} {}
 IsLocalTemplate::IsLocalTemplate(std::string name) :  BasicReadFilter {std::move(name)} {}
 
@@ -200,5 +240,10 @@ bool IsLocalTemplate::passes(const AlignedRead& read) const noexcept
     return !read.has_other_segment() || read.next_segment().contig_name() == contig_name(read);
 }
 
+void IsLocalTemplate::do_add_to(ReadCoreFilter& filter) const noexcept
+{
+    filter.remove_distant_templates = true;
+}
+
 } // namespace readpipe
 } // namespace octopus
@@ -12,6 +12,7 @@
 
 #include "basics/cigar_string.hpp"
 #include "basics/aligned_read.hpp"
+#include "io/read/read_core_filter.hpp"
 
 namespace octopus { namespace readpipe
 {
@@ -46,11 +47,18 @@ public:
         return passes(read);
     }
     
+    // Adds this filter to filter if it can be decided from the alignment record core
+    void add_to(ReadCoreFilter& filter) const noexcept
+    {
+        do_add_to(filter);
+    }
+    
 protected:
     BasicReadFilter(std::string name) : Nameable {std::move(name)} {};
     
 private:
     virtual bool passes(const AlignedRead&) const noexcept = 0;
+    virtual void do_add_to(ReadCoreFilter&) const noexcept {}
 };
 
 struct HasWellFormedCigar : BasicReadFilter
@@ -75,6 +83,7 @@ struct IsNotSecondaryAlignment : BasicReadFilter
     IsNotSecondaryAlignment(std::string name);
     
     bool passes(const AlignedRead& read) const noexcept override;
+    void do_add_to(ReadCoreFilter& filter) const noexcept override;
 };
 
 struct IsNotSupplementaryAlignment : BasicReadFilter
@@ -83,6 +92,7 @@ struct IsNotSupplementaryAlignment : BasicReadFilter
     IsNotSupplementaryAlignment(std::string name);
     
     bool passes(const AlignedRead& read) const noexcept override;
+    void do_add_to(ReadCoreFilter& filter) const noexcept override;
 };
 
 struct IsGoodMappingQuality : BasicReadFilter
@@ -96,6 +106,7 @@ struct IsGoodMappingQuality : BasicReadFilter
     IsGoodMappingQuality(std::string name, MappingQuality good_mapping_quality);
     
     bool passes(const AlignedRead& read) const noexcept override;
+    void do_add_to(ReadCoreFilter& filter) const noexcept override;
     
 private:
     MappingQuality good_mapping_quality_;
@@ -141,6 +152,7 @@ struct IsMapped : BasicReadFilter
     IsMapped(std::string name);
     
     bool passes(const AlignedRead& read) const noexcept override;
+    void do_add_to(ReadCoreFilter& filter) const noexcept override;
 };
 
 struct IsNotChimeric : BasicReadFilter
@@ -157,6 +169,7 @@ struct IsNextSegmentMapped : BasicReadFilter
     IsNextSegmentMapped(std::string name);
     
     bool passes(const AlignedRead& read) const noexcept override;
+    void do_add_to(ReadCoreFilter& filter) const noexcept override;
 };
 
 struct IsNotMarkedDuplicate : BasicReadFilter
@@ -165,6 +178,7 @@ struct IsNotMarkedDuplicate : BasicReadFilter
     IsNotMarkedDuplicate(std::string name);
     
     bool passes(const AlignedRead& read) const noexcept override;
+    void do_add_to(ReadCoreFilter& filter) const noexcept override;
 };
 
 struct IsShort : BasicReadFilter
@@ -209,6 +223,7 @@ struct IsNotMarkedQcFail : BasicReadFilter
     IsNotMarkedQcFail(std::string name);
     
     bool passes(const AlignedRead& read) const noexcept override;
+    void do_add_to(ReadCoreFilter& filter) const noexcept override;
 };
 
 struct IsProperTemplate : BasicReadFilter
@@ -217,6 +232,7 @@ struct IsProperTemplate : BasicReadFilter
     IsProperTemplate(std::string name);
     
     bool passes(const AlignedRead& read) const noexcept override;
+    void do_add_to(ReadCoreFilter& filter) const noexcept override;
 };
     
 struct IsLocalTemplate : BasicReadFilter
@@ -225,6 +241,7 @@ struct IsLocalTemplate : BasicReadFilter
     IsLocalTemplate(std::string name);
     
     bool passes(const AlignedRead& read) const noexcept override;
+    void do_add_to(ReadCoreFilter& filter) const noexcept override;
 };
 
 // Context filters
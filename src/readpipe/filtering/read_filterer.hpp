@@ -52,6 +52,9 @@ public:
     
     void shrink_to_fit() noexcept; // Just removes extra capcity for filters
     
+    // The basic filters that readers can apply before decoding reads
+    ReadCoreFilter core_filter() const noexcept;
+    
     // Like std::remove
     BidirIt remove(ReadIterator first, ReadIterator last) const;
     BidirIt remove(ReadIterator first, ReadIterator last, FilterCountMap& filter_counts) const;
@@ -93,6 +96,16 @@ void ReadFilterer<BidirIt>::shrink_to_fit() noexcept
     context_filters_.shrink_to_fit();
 }
 
+template <typename BidirIt>
+ReadCoreFilter ReadFilterer<BidirIt>::core_filter() const noexcept
+{
+    ReadCoreFilter result {};
+    for (const auto& filter : basic_filters_) {
+        filter->add_to(result);
+    }
+    return result;
+}
+
 template <typename BidirIt>
 BidirIt ReadFilterer<BidirIt>::remove(BidirIt first, BidirIt last) const
 {
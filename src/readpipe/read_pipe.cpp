@@ -24,6 +24,7 @@ ReadPipe::ReadPipe(const ReadManager& source, ReadTransformer transformer, ReadF
 : source_ {source}
 , prefilter_transformer_ {std::move(transformer)}
 , filterer_ {std::move(filterer)}
+, core_filter_ {filterer_.core_filter()}
 , postfilter_transformer_ {}
 , downsampler_ {std::move(downsampler)}
 , samples_ {std::move(samples)}
@@ -38,6 +39,7 @@ ReadPipe::ReadPipe(const ReadManager& source, ReadTransformer prefilter_transfor
 : source_ {source}
 , prefilter_transformer_ {std::move(prefilter_transformer)}
 , filterer_ {std::move(filterer)}
+, core_filter_ {filterer_.core_filter()}
 , postfilter_transformer_ {std::move(postfilter_transformer)}
 , downsampler_ {std::move(downsampler)}
 , samples_ {std::move(samples)}
@@ -83,9 +85,10 @@ void sort_each(Map& reads)
     }
 }
 
-auto fetch_batch(const ReadManager& rm, const std::vector<SampleName>& samples, const GenomicRegion& region)
+auto fetch_batch(const ReadManager& rm, const std::vector<SampleName>& samples, const GenomicRegion& region,
+                 const ReadCoreFilter& filter)
 {
-    auto result = rm.fetch_reads(samples, region);
+    auto result = rm.fetch_reads(samples, region, filter);
     sort_each(result);
     return result;
 }
@@ -135,8 +138,10 @@ ReadMap ReadPipe::fetch_reads(const GenomicRegion& region, boost::optional<Repor
     for (const auto& sample : samples_) {
         result.emplace(std::piecewise_construct, std::forward_as_tuple(sample), std::forward_as_tuple());
     }
+    // Reads removed by the core filter would be missing from the debug filter counts
+    const auto core_filter = debug_log_ ? ReadCoreFilter {} : core_filter_;
     for (const auto& batch : batch_samples(samples_)) {
-        auto batch_reads = fetch_batch(source_, batch, region);
+        auto batch_reads = fetch_batch(source_, batch, region, core_filter);
         if (debug_log_) {
             stream(*debug_log_) << "Fetched " << count_reads(batch_reads) << " unfiltered reads from " << region;
         }
@@ -78,6 +78,7 @@ private:
     std::reference_wrapper<const ReadManager> source_;
     ReadTransformer prefilter_transformer_;
     ReadFilterer filterer_;
+    ReadCoreFilter core_filter_;
     boost::optional<ReadTransformer> postfilter_transformer_;
     boost::optional<Downsampler> downsampler_;
     std::vector<SampleName> samples_;
@@ -0,0 +1,70 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "interned_string.hpp"
+
+#include <unordered_set>
+#include <mutex>
+#include <ostream>
+
+namespace octopus {
+
+namespace {
+
+class StringPool
+{
+public:
+    const std::string* intern(const std::string& str)
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+        return std::addressof(*strings_.insert(str).first); // set nodes are never moved
+    }
+
+private:
+    std::mutex mutex_;
+    std::unordered_set<std::string> strings_;
+};
+
+StringPool& string_pool()
+{
+    static StringPool result {};
+    return result;
+}
+
+const std::string* intern(const std::string& str)
+{
+    // Consecutive requests are usually for the same string, and this avoids locking the pool
+    thread_local const std::string* last {nullptr};
+    if (last == nullptr || *last != str) {
+        last = string_pool().intern(str);
+    }
+    return last;
+}
+
+const std::string* empty_string()
+{
+    static const auto result = string_pool().intern("");
+    return result;
+}
+
+} // namespace
+
+InternedString::InternedString()
+: str_ {empty_string()}
+{}
+
+InternedString::InternedString(const std::string& str)
+: str_ {str.empty() ? empty_string() : intern(str)}
+{}
+
+InternedString::InternedString(const char* str)
+: InternedString {std::string {str}}
+{}
+
+std::ostream& operator<<(std::ostream& os, const InternedString& str)
+{
+    os << str.str();
+    return os;
+}
+
+} // namespace octopus
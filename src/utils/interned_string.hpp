@@ -0,0 +1,71 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef interned_string_hpp
+#define interned_string_hpp
+
+#include <string>
+#include <cstring>
+#include <functional>
+#include <iosfwd>
+
+#include "concepts/equitable.hpp"
+
+namespace octopus {
+
+/**
+ InternedString is a handle to a process wide unique copy of a string, so copies and
+ comparisons are pointer operations. It is intended for the few distinct names, such as
+ read groups and contigs, that are repeated across many reads. Interned strings are
+ never freed.
+ */
+class InternedString : public Equitable<InternedString>
+{
+public:
+    InternedString();
+
+    InternedString(const std::string& str);
+    InternedString(const char* str);
+
+    InternedString(const InternedString&)            = default;
+    InternedString& operator=(const InternedString&) = default;
+    InternedString(InternedString&&)                 = default;
+    InternedString& operator=(InternedString&&)      = default;
+
+    ~InternedString() = default;
+
+    const std::string& str() const noexcept { return *str_; }
+    operator const std::string&() const noexcept { return *str_; }
+
+    bool empty() const noexcept { return str_->empty(); }
+    std::size_t size() const noexcept { return str_->size(); }
+
+    // Cheaper than constructing a new InternedString when str is usually the same
+    bool is_same(const char* str) const noexcept { return std::strcmp(str_->c_str(), str) == 0; }
+
+    friend bool operator==(const InternedString& lhs, const InternedString& rhs) noexcept
+    {
+        return lhs.str_ == rhs.str_;
+    }
+
+private:
+    const std::string* str_;
+};
+
+std::ostream& operator<<(std::ostream& os, const InternedString& str);
+
+} // namespace octopus
+
+namespace std {
+
+template <> struct hash<octopus::InternedString>
+{
+    size_t operator()(const octopus::InternedString& str) const noexcept
+    {
+        return hash<const std::string*>()(&str.str());
+    }
+};
+
+} // namespace std
+
+#endif
@@ -3,29 +3,65 @@
 
 #include "kmer_mapper.hpp"
 
+#include <cassert>
+
 namespace octopus {
 
-void map_query_to_target(const KmerPerfectHashes& query, const KmerHashTable& target,
-                         MappedIndexCounts& mapping_counts, std::vector<std::size_t>& result)
+KmerIndex::KmerIndex(const unsigned char kmer_size)
+: kmer_size_ {kmer_size}
+, bin_offsets_(num_kmers(kmer_size) + 1, 0)
+, positions_ {}
+, target_hashes_ {}
+, mapping_counts_ {}
 {
-    map_query_to_target(query, target, mapping_counts, std::back_inserter(result));
+    assert(kmer_size > 0 && 2 * kmer_size <= 32);
 }
 
-std::vector<std::size_t>
-map_query_to_target(const KmerPerfectHashes& query, const KmerHashTable& target,
-                    MappedIndexCounts& mapping_counts)
+unsigned char KmerIndex::kmer_size() const noexcept
 {
-    std::vector<std::size_t> result {};
-    result.reserve(1);
-    map_query_to_target(query, target, mapping_counts, result);
-    return result;
+    return kmer_size_;
+}
+
+std::size_t KmerIndex::num_positions() const noexcept
+{
+    return positions_.size();
+}
+
+void KmerIndex::index(const std::string& target)
+{
+    clear();
+    if (target.size() < kmer_size_) return;
+    const auto num_target_kmers = target.size() - kmer_size_ + 1;
+    target_hashes_.resize(num_target_kmers);
+    detail::compute_kmer_hashes(target, kmer_size_, std::begin(target_hashes_));
+    // Counting sort: count each bin, take the prefix sums, then place positions in order
+    for (const auto hash : target_hashes_) ++bin_offsets_[hash + 1];
+    std::partial_sum(std::cbegin(bin_offsets_), std::cend(bin_offsets_), std::begin(bin_offsets_));
+    positions_.resize(num_target_kmers);
+    for (std::size_t position {0}; position < num_target_kmers; ++position) {
+        positions_[bin_offsets_[target_hashes_[position]]++] = position;
+    }
+    // Each bin offset now points to the end of its bin, which is the start of the next
+    std::copy_backward(std::cbegin(bin_offsets_), std::prev(std::cend(bin_offsets_)), std::end(bin_offsets_));
+    bin_offsets_.front() = 0;
+    mapping_counts_.assign(num_target_kmers, 0);
 }
 
-std::vector<std::size_t>
-map_query_to_target(const KmerPerfectHashes& query, const KmerHashTable& target)
+void KmerIndex::clear() noexcept
 {
-    MappedIndexCounts mapping_counts(target.second, 0);
-    return  map_query_to_target(query, target, mapping_counts);
+    std::fill(std::begin(bin_offsets_), std::end(bin_offsets_), 0);
+    positions_.clear();
+    target_hashes_.clear();
+    mapping_counts_.clear();
+}
+
+std::vector<KmerIndex::Position>
+KmerIndex::map(const KmerPerfectHashes& query, const std::size_t max_mapping_positions)
+{
+    std::vector<Position> result {};
+    result.reserve(1);
+    map(query, std::back_inserter(result), max_mapping_positions);
+    return result;
 }
 
 } // namespace octopus
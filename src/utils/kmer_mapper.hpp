@@ -54,102 +54,112 @@ constexpr auto perfect_kmer_hash(InputIt first)
 
 using KmerPerfectHashes = std::vector<KmerHashType>;
 
-template <unsigned char K>
-auto compute_kmer_hashes(const std::string& sequence)
+namespace detail {
+
+// Each base is 2 bits and the first base is least significant, so the next kmer hash is the last one
+// shifted down with the new base added on top. This gives the same hashes as perfect_kmer_hash.
+template <typename OutputIt>
+OutputIt compute_kmer_hashes(const std::string& sequence, const unsigned char k, OutputIt result)
 {
-    if (sequence.size() < K) {
-        return KmerPerfectHashes {};
+    if (sequence.size() < k) return result;
+    const auto last_base_shift = 2 * (k - 1);
+    KmerHashType hash {0};
+    for (std::size_t i {0}; i < k; ++i) {
+        hash |= perfect_hash<KmerHashType>(sequence[i]) << (2 * i);
     }
-    
-    KmerPerfectHashes result(sequence.size() - K + 1);
-    
-    auto result_it = std::begin(result);
-    
-    for (auto it = std::cbegin(sequence); it != std::prev(std::cend(sequence), K - 1); ++it, ++result_it) {
-        *result_it = perfect_kmer_hash<K>(it);
+    *result++ = hash;
+    for (auto it = std::next(std::cbegin(sequence), k); it != std::cend(sequence); ++it) {
+        hash = (hash >> 2) | (perfect_hash<KmerHashType>(*it) << last_base_shift);
+        *result++ = hash;
     }
-    
     return result;
 }
 
-using KmerHashTable = std::pair<std::vector<std::vector<std::size_t>>, std::size_t>;
+} // namespace detail
 
 template <unsigned char K>
-KmerHashTable init_kmer_hash_table()
-{
-    return std::make_pair(std::vector<std::vector<std::size_t>> {num_kmers(K), std::vector<std::size_t> {}}, 0);
-}
-
-inline void clear_kmer_hash_table(KmerHashTable& table)
+auto compute_kmer_hashes(const std::string& sequence)
 {
-    for (auto& bin : table.first) bin.clear();
-    table.second = 0;
+    static_assert(K > 0 && 2 * K <= 32, "kmer hashes must fit in 32 bits");
+    
+    if (sequence.size() < K) {
+        return KmerPerfectHashes {};
+    }
+    
+    KmerPerfectHashes result(sequence.size() - K + 1);
+    detail::compute_kmer_hashes(sequence, K, std::begin(result));
+    return result;
 }
 
-template <unsigned char K>
-void populate_kmer_hash_table(const std::string& sequence, KmerHashTable& result)
+/*
+    Maps queries to the positions in a target sequence that share the most kmers with them.
+ 
+    The target kmer positions are counting-sorted into one array with a bin offset for each kmer.
+    All buffers are kept between targets and queries, so a reused index does not reallocate.
+    The mapping counts are reset with a single fill after each query. This measured faster than
+    tracking which counts were touched, because most queries touch much of a short target.
+*/
+class KmerIndex
 {
-    if (sequence.size() < K) {
-        return;
-    }
+public:
+    using Position = std::size_t;
     
-    const auto last_index = sequence.size() - K;
+    KmerIndex() = delete;
     
-    auto it = std::cbegin(sequence);
+    KmerIndex(unsigned char kmer_size);
     
-    for (std::size_t index {0}; index <= last_index; ++index, ++it) {
-        result.first[perfect_kmer_hash<K>(it)].push_back(index);
-    }
+    KmerIndex(const KmerIndex&)            = default;
+    KmerIndex& operator=(const KmerIndex&) = default;
+    KmerIndex(KmerIndex&&)                 = default;
+    KmerIndex& operator=(KmerIndex&&)      = default;
     
-    for (auto& bin : result.first) bin.shrink_to_fit();
+    ~KmerIndex() = default;
     
-    result.second = sequence.size() - K + 1;
-}
-
-template <unsigned char K>
-KmerHashTable make_kmer_hash_table(const std::string& sequence)
-{
-    auto result = init_kmer_hash_table<K>();
-    populate_kmer_hash_table<K>(sequence, result);
-    return result;
-}
-
-using MappedIndexCounts = std::vector<unsigned>;
-
-inline MappedIndexCounts init_mapping_counts(const KmerHashTable& target)
-{
-    return MappedIndexCounts(target.second, 0);
-}
-
-inline void reset_mapping_counts(MappedIndexCounts& mapping_counts)
-{
-    std::fill(std::begin(mapping_counts), std::end(mapping_counts), 0);
-}
+    unsigned char kmer_size() const noexcept;
+    std::size_t num_positions() const noexcept;
+    
+    // Replaces the indexed target
+    void index(const std::string& target);
+    void clear() noexcept;
+    
+    template <typename OutputIt>
+    OutputIt map(const KmerPerfectHashes& query, OutputIt result, std::size_t max_mapping_positions = -1);
+    
+    std::vector<Position> map(const KmerPerfectHashes& query, std::size_t max_mapping_positions = -1);
+    
+private:
+    unsigned char kmer_size_;
+    std::vector<std::uint32_t> bin_offsets_;
+    std::vector<Position> positions_;
+    KmerPerfectHashes target_hashes_;
+    std::vector<unsigned> mapping_counts_;
+};
 
 template <typename OutputIt>
-OutputIt map_query_to_target(const KmerPerfectHashes& query, const KmerHashTable& target,
-                             MappedIndexCounts& mapping_counts, OutputIt result,
-                             std::size_t max_mapping_positions = -1)
+OutputIt KmerIndex::map(const KmerPerfectHashes& query, OutputIt result, std::size_t max_mapping_positions)
 {
     unsigned max_hit_count {0};
-    std::size_t first_max_hit_index {0};
+    Position first_max_hit_index {0};
     unsigned num_max_hits {0};
     
     for (std::size_t query_index {0}; query_index < query.size(); ++query_index) {
-        for (const auto target_index : target.first[query[query_index]]) {
-            if (target_index >= query_index) {
-                const auto mapping_begin = target_index - query_index;
+        const auto hash = query[query_index];
+        const auto first_position = std::next(std::cbegin(positions_), bin_offsets_[hash]);
+        const auto last_position  = std::next(std::cbegin(positions_), bin_offsets_[hash + 1]);
+        for (auto it = first_position; it != last_position; ++it) {
+            if (*it < query_index) continue;
+            const auto mapping_begin = *it - query_index;
+            auto& count = mapping_counts_[mapping_begin];
+            
+            if (++count > max_hit_count) {
+                max_hit_count = count;
+                first_max_hit_index = mapping_begin;
+                num_max_hits = 1;
+            } else if (count == max_hit_count) {
+                ++num_max_hits;
                 
-                if (++mapping_counts[mapping_begin] > max_hit_count) {
-                    max_hit_count = mapping_counts[mapping_begin];
+                if (mapping_begin < first_max_hit_index) {
                     first_max_hit_index = mapping_begin;
-                    num_max_hits = 1;
-                } else if (mapping_counts[mapping_begin] == max_hit_count) {
-                    ++num_max_hits;
-                    
-                    if (mapping_begin < first_max_hit_index) {
-                        first_max_hit_index = mapping_begin;
-                    }
                 }
             }
         }
@@ -162,7 +172,7 @@ OutputIt map_query_to_target(const KmerPerfectHashes& query, const KmerHashTable
         --max_mapping_positions;
         
         while (max_mapping_positions > 0 && num_max_hits > 0) {
-            if (mapping_counts[first_max_hit_index] == max_hit_count) {
+            if (mapping_counts_[first_max_hit_index] == max_hit_count) {
                 *result++ = first_max_hit_index;
                 --num_max_hits;
                 --max_mapping_positions;
@@ -171,23 +181,17 @@ OutputIt map_query_to_target(const KmerPerfectHashes& query, const KmerHashTable
         }
     }
     
+    std::fill(std::begin(mapping_counts_), std::end(mapping_counts_), 0);
+    
     return result;
 }
 
-void map_query_to_target(const KmerPerfectHashes& query, const KmerHashTable& target,
-                         MappedIndexCounts& mapping_counts, std::vector<std::size_t>& result);
-
-std::vector<std::size_t>
-map_query_to_target(const KmerPerfectHashes& query, const KmerHashTable& target,
-                    MappedIndexCounts& mapping_counts);
-
-std::vector<std::size_t>
-map_query_to_target(const KmerPerfectHashes& query, const KmerHashTable& target);
-
 template <unsigned char K>
 std::vector<std::size_t> map_query_to_target(const std::string& query, const std::string& target)
 {
-    return map_query_to_target(compute_kmer_hashes<K>(query), make_kmer_hash_table<K>(target));
+    KmerIndex index {K};
+    index.index(target);
+    return index.map(compute_kmer_hashes<K>(query));
 }
 
 } // namespace octopus
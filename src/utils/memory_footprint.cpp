@@ -174,7 +174,7 @@ boost::optional<MemoryFootprint> parse_footprint(std::string footprint_str)
     static const auto is_digit = [] (char c) { return std::isdigit(c); };
     auto last_digit_itr = std::find_if_not(cbegin(footprint_str), cend(footprint_str), is_digit);
     if (last_digit_itr == cend(footprint_str)) {
-        MemoryFootprint {static_cast<std::size_t>(std::stoll(footprint_str))};
+        return MemoryFootprint {static_cast<std::size_t>(std::stoll(footprint_str))};
     }
     bool is_float {false};
     if (*last_digit_itr == '.') {
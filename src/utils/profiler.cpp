@@ -0,0 +1,335 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "profiler.hpp"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <ostream>
+#include <sstream>
+#include <time.h>
+
+#include "basics/genomic_region.hpp"
+
+namespace octopus { namespace profiling {
+
+namespace {
+
+std::atomic_bool enabled {false}, tracing {false};
+
+// Only scopes this close to the root of the thread's stage tree are traced, to bound memory use
+static constexpr unsigned maxTraceDepth {3};
+
+using Clock = std::chrono::steady_clock;
+
+const Clock::time_point epoch {Clock::now()};
+
+std::uint64_t wall_now() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count();
+}
+
+std::uint64_t cpu_now() noexcept
+{
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+}
+
+bool is_same_name(const char* lhs, const char* rhs) noexcept
+{
+    return lhs == rhs || std::strcmp(lhs, rhs) == 0;
+}
+
+} // namespace
+
+struct Counter
+{
+    Counter(const char* name) : name {name}, value {0} {}
+    const char* name;
+    std::atomic<std::uint64_t> value;
+};
+
+// Counts are only updated by the owning thread, but are atomic so a profile can be written while
+// threads are running. The shape of the tree is guarded by the owning ThreadProfile's mutex.
+class ProfileNode
+{
+public:
+    ProfileNode(const char* name, ProfileNode* parent) : name {name}, parent {parent} {}
+    const char* name;
+    ProfileNode* parent;
+    std::atomic<std::uint64_t> calls {0}, wall_ns {0}, cpu_ns {0};
+    std::vector<std::unique_ptr<ProfileNode>> children = {};
+    std::vector<std::unique_ptr<Counter>> counters = {};
+};
+
+namespace {
+
+struct TraceEvent
+{
+    const char* name;
+    std::string label;
+    std::uint64_t start_ns, duration_ns;
+};
+
+struct ThreadProfile
+{
+    ThreadProfile(unsigned id) : id {id}, mutex {}, root {"root", nullptr}, current {&root}, depth {0}, trace {} {}
+    unsigned id;
+    std::mutex mutex;
+    ProfileNode root;
+    ProfileNode* current; // Only used by the owning thread
+    unsigned depth; // Only used by the owning thread
+    std::vector<TraceEvent> trace;
+};
+
+struct ProfileRegistry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadProfile>> profiles;
+};
+
+// Profiles are owned by the registry, rather than the thread, so they outlive the threads
+ProfileRegistry& get_registry()
+{
+    static ProfileRegistry result {};
+    return result;
+}
+
+thread_local ThreadProfile* thread_profile {nullptr};
+
+ThreadProfile& get_thread_profile()
+{
+    if (!thread_profile) {
+        auto& registry = get_registry();
+        std::lock_guard<std::mutex> lock {registry.mutex};
+        registry.profiles.push_back(std::make_unique<ThreadProfile>(registry.profiles.size()));
+        thread_profile = registry.profiles.back().get();
+    }
+    return *thread_profile;
+}
+
+ProfileNode* find_or_add_child(ThreadProfile& profile, ProfileNode& node, const char* name)
+{
+    for (auto& child : node.children) {
+        if (is_same_name(child->name, name)) return child.get();
+    }
+    std::lock_guard<std::mutex> lock {profile.mutex};
+    node.children.push_back(std::make_unique<ProfileNode>(name, &node));
+    return node.children.back().get();
+}
+
+Counter& find_or_add_counter(ThreadProfile& profile, ProfileNode& node, const char* name)
+{
+    for (auto& counter : node.counters) {
+        if (is_same_name(counter->name, name)) return *counter;
+    }
+    std::lock_guard<std::mutex> lock {profile.mutex};
+    node.counters.push_back(std::make_unique<Counter>(name));
+    return *node.counters.back();
+}
+
+} // namespace
+
+void enable(const bool record_trace)
+{
+    enabled = true;
+    tracing = record_trace;
+}
+
+bool is_enabled() noexcept
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+Scope::Scope(const char* name)
+: node_ {nullptr}
+, wall_start_ {}
+, cpu_start_ {}
+, label_ {}
+{
+    if (!is_enabled()) return;
+    auto& profile = get_thread_profile();
+    node_ = find_or_add_child(profile, *profile.current, name);
+    profile.current = node_;
+    ++profile.depth;
+    wall_start_ = wall_now();
+    cpu_start_  = cpu_now();
+}
+
+Scope::Scope(const char* name, const GenomicRegion& region)
+: Scope {name}
+{
+    if (node_ && tracing.load(std::memory_order_relaxed)) {
+        std::ostringstream ss {};
+        ss << region;
+        label_ = ss.str();
+    }
+}
+
+Scope::~Scope() noexcept
+{
+    if (!node_) return;
+    const auto wall_duration = wall_now() - wall_start_;
+    const auto cpu_duration  = cpu_now() - cpu_start_;
+    node_->calls.fetch_add(1, std::memory_order_relaxed);
+    node_->wall_ns.fetch_add(wall_duration, std::memory_order_relaxed);
+    node_->cpu_ns.fetch_add(cpu_duration, std::memory_order_relaxed);
+    auto& profile = *thread_profile;
+    if (tracing.load(std::memory_order_relaxed) && profile.depth <= maxTraceDepth) {
+        try {
+            std::lock_guard<std::mutex> lock {profile.mutex};
+            profile.trace.push_back({node_->name, std::move(label_), wall_start_, wall_duration});
+        } catch (...) {
+            // Losing a trace event is preferable to terminating
+        }
+    }
+    profile.current = node_->parent;
+    --profile.depth;
+}
+
+void count(const char* counter, const std::uint64_t n)
+{
+    if (!is_enabled()) return;
+    auto& profile = get_thread_profile();
+    find_or_add_counter(profile, *profile.current, counter).value.fetch_add(n, std::memory_order_relaxed);
+}
+
+namespace {
+
+struct StageSummary
+{
+    std::string name;
+    std::uint64_t calls = 0, wall_ns = 0, cpu_ns = 0;
+    std::vector<std::pair<std::string, std::uint64_t>> counters = {};
+    std::vector<StageSummary> children = {};
+};
+
+template <typename T>
+T& find_or_add(std::vector<T>& entries, const std::string& name)
+{
+    const auto itr = std::find_if(std::begin(entries), std::end(entries), [&] (const auto& entry) { return entry.name == name; });
+    if (itr != std::end(entries)) return *itr;
+    entries.push_back(T {});
+    entries.back().name = name;
+    return entries.back();
+}
+
+// Requires the mutex of the profile owning node to be held
+void merge(const ProfileNode& node, StageSummary& result)
+{
+    result.calls   += node.calls.load(std::memory_order_relaxed);
+    result.wall_ns += node.wall_ns.load(std::memory_order_relaxed);
+    result.cpu_ns  += node.cpu_ns.load(std::memory_order_relaxed);
+    for (const auto& counter : node.counters) {
+        auto itr = std::find_if(std::begin(result.counters), std::end(result.counters),
+                                [&] (const auto& p) { return p.first == counter->name; });
+        if (itr == std::end(result.counters)) {
+            result.counters.emplace_back(counter->name, 0);
+            itr = std::prev(std::end(result.counters));
+        }
+        itr->second += counter->value.load(std::memory_order_relaxed);
+    }
+    for (const auto& child : node.children) {
+        merge(*child, find_or_add(result.children, child->name));
+    }
+}
+
+StageSummary summarise(unsigned& num_threads)
+{
+    StageSummary result {};
+    auto& registry = get_registry();
+    std::lock_guard<std::mutex> registry_lock {registry.mutex};
+    num_threads = registry.profiles.size();
+    for (const auto& profile : registry.profiles) {
+        std::lock_guard<std::mutex> lock {profile->mutex};
+        for (const auto& child : profile->root.children) {
+            merge(*child, find_or_add(result.children, child->name));
+        }
+    }
+    return result;
+}
+
+void write_escaped(const std::string& str, std::ostream& os)
+{
+    os << '"';
+    for (const char c : str) {
+        if (c == '"' || c == '\\') os << '\\';
+        os << c;
+    }
+    os << '"';
+}
+
+double to_seconds(const std::uint64_t ns) noexcept
+{
+    return static_cast<double>(ns) / 1e9;
+}
+
+void write_json(const StageSummary& stage, std::ostream& os)
+{
+    os << "{\"name\":";
+    write_escaped(stage.name, os);
+    os << ",\"calls\":" << stage.calls
+       << ",\"wall_seconds\":" << to_seconds(stage.wall_ns)
+       << ",\"cpu_seconds\":" << to_seconds(stage.cpu_ns)
+       << ",\"counters\":{";
+    for (std::size_t i {0}; i < stage.counters.size(); ++i) {
+        if (i > 0) os << ',';
+        write_escaped(stage.counters[i].first, os);
+        os << ':' << stage.counters[i].second;
+    }
+    os << "},\"children\":[";
+    for (std::size_t i {0}; i < stage.children.size(); ++i) {
+        if (i > 0) os << ',';
+        write_json(stage.children[i], os);
+    }
+    os << "]}";
+}
+
+} // namespace
+
+void write_json(std::ostream& os)
+{
+    unsigned num_threads;
+    const auto summary = summarise(num_threads);
+    os << "{\"threads\":" << num_threads << ",\"stages\":[";
+    for (std::size_t i {0}; i < summary.children.size(); ++i) {
+        if (i > 0) os << ',';
+        write_json(summary.children[i], os);
+    }
+    os << "]}\n";
+}
+
+void write_chrome_trace(std::ostream& os)
+{
+    auto& registry = get_registry();
+    std::lock_guard<std::mutex> registry_lock {registry.mutex};
+    os << "{\"traceEvents\":[";
+    bool first {true};
+    for (const auto& profile : registry.profiles) {
+        std::lock_guard<std::mutex> lock {profile->mutex};
+        for (const auto& event : profile->trace) {
+            if (!first) os << ",\n";
+            first = false;
+            os << "{\"name\":";
+            write_escaped(event.name, os);
+            os << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << profile->id
+               << ",\"ts\":" << event.start_ns / 1000 << ",\"dur\":" << event.duration_ns / 1000;
+            if (!event.label.empty()) {
+                os << ",\"args\":{\"region\":";
+                write_escaped(event.label, os);
+                os << '}';
+            }
+            os << '}';
+        }
+    }
+    os << "]}\n";
+}
+
+} // namespace profiling
+} // namespace octopus
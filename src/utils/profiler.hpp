@@ -0,0 +1,68 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef profiler_hpp
+#define profiler_hpp
+
+#include <string>
+#include <cstdint>
+#include <iosfwd>
+
+namespace octopus {
+
+class GenomicRegion;
+
+namespace profiling {
+
+/*
+ A low overhead profiler for hot paths that is safe to use from any thread. Scopes nest on each
+ thread to make a stage tree, and record call counts, wall time, and thread CPU time. Counters
+ (e.g. reads or bytes) can be added to the innermost open scope. Each thread records into its own
+ tree, and the trees are merged by stage name when the profile is written.
+
+ Everything is a no-op unless the profiler has been enabled, so scopes can stay in release builds.
+ */
+
+class ProfileNode;
+
+// Must be called before any scopes are opened
+void enable(bool record_trace = false);
+
+bool is_enabled() noexcept;
+
+class Scope
+{
+public:
+    Scope() = delete;
+
+    // name is stored by pointer, so must be a string literal
+    explicit Scope(const char* name);
+    // As above, but labels the scope with the region in the trace
+    Scope(const char* name, const GenomicRegion& region);
+
+    Scope(const Scope&)            = delete;
+    Scope& operator=(const Scope&) = delete;
+    Scope(Scope&&)                 = delete;
+    Scope& operator=(Scope&&)      = delete;
+
+    ~Scope() noexcept;
+
+private:
+    ProfileNode* node_;
+    std::uint64_t wall_start_, cpu_start_;
+    std::string label_;
+};
+
+// Adds n to the named counter of the innermost open scope on this thread
+void count(const char* counter, std::uint64_t n = 1);
+
+// The merged stage tree as JSON
+void write_json(std::ostream& os);
+
+// Scopes near the root of each thread's tree in Chrome trace event format. Requires enable(true)
+void write_chrome_trace(std::ostream& os);
+
+} // namespace profiling
+} // namespace octopus
+
+#endif
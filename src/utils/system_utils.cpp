@@ -14,4 +14,24 @@ std::size_t get_max_open_files()
     return lim.rlim_cur;
 }
 
+namespace {
+
+SimdInstructionSet detect_max_simd_instruction_set() noexcept
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw")) return SimdInstructionSet::avx512;
+    if (__builtin_cpu_supports("avx2")) return SimdInstructionSet::avx2;
+#endif
+    return SimdInstructionSet::sse2;
+}
+
+} // namespace
+
+SimdInstructionSet get_max_simd_instruction_set() noexcept
+{
+    static const auto result = detect_max_simd_instruction_set();
+    return result;
+}
+
 } // namespace octopus
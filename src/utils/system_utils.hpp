@@ -10,6 +10,12 @@ namespace octopus {
 
 std::size_t get_max_open_files();
 
+enum class SimdInstructionSet { sse2, avx2, avx512 };
+
+// The widest SIMD instruction set supported by the host CPU. This is determined once
+// on first use; subsequent calls are cheap.
+SimdInstructionSet get_max_simd_instruction_set() noexcept;
+
 } // namespace octopus
 
 #endif
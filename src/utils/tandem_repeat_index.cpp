@@ -0,0 +1,212 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "tandem_repeat_index.hpp"
+
+#include <array>
+#include <algorithm>
+#include <iterator>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <cstring>
+
+namespace octopus {
+
+namespace {
+
+constexpr auto scanEnd = std::numeric_limits<std::uint32_t>::max();
+
+struct ScanStep
+{
+    std::uint32_t next, reach; // reach is one past the last position looked at, or scanEnd
+    bool has_repeat;
+    tandem::Repeat repeat;
+};
+
+// One iteration of tandem::detail::extract_homopolymers
+bool homopolymer_step(const char* first, const char* last, const std::uint32_t pos, ScanStep& result) noexcept
+{
+    const auto it = std::adjacent_find(first + pos, last);
+    if (it == last) return false;
+    const auto base = *it;
+    const auto it2 = std::find_if_not(std::next(it), last, [base] (const char b) { return b == base; });
+    result.next = static_cast<std::uint32_t>(it2 - first);
+    result.reach = it2 != last ? result.next + 1 : scanEnd;
+    result.has_repeat = true;
+    result.repeat = tandem::Repeat {static_cast<std::uint32_t>(it - first), static_cast<std::uint32_t>(it2 - it), 1};
+    return true;
+}
+
+// One iteration of tandem::detail::extract_exact_tandem_repeats<period>
+bool tandem_step(const unsigned period, const char* first, const char* last, const std::uint32_t pos, ScanStep& result) noexcept
+{
+    const auto it1 = std::adjacent_find(first + pos, last, std::not_equal_to<void> {});
+    if (it1 == last || static_cast<std::size_t>(last - it1) <= period) return false;
+    const auto it2 = it1 + period;
+    const auto p = std::mismatch(it2, last, it1);
+    result.reach = p.first != last ? static_cast<std::uint32_t>(p.first - first) + 1 : scanEnd;
+    result.has_repeat = p.second >= it2;
+    if (result.has_repeat) {
+        result.repeat = tandem::Repeat {static_cast<std::uint32_t>(it1 - first), static_cast<std::uint32_t>(p.first - it1), period};
+        result.next = static_cast<std::uint32_t>(p.second - first);
+    } else {
+        result.next = static_cast<std::uint32_t>(it1 - first) + 1;
+    }
+    return true;
+}
+
+bool scan_step(const unsigned period, const char* first, const char* last, const std::uint32_t pos, ScanStep& result) noexcept
+{
+    return period == 1 ? homopolymer_step(first, last, pos, result) : tandem_step(period, first, last, pos, result);
+}
+
+// Same as std::mismatch, but compares a word at a time as the sequences usually match for a long way
+std::size_t count_matches(const char* lhs, const char* rhs, const std::size_t n) noexcept
+{
+    std::size_t result {0};
+    for (; result + sizeof(std::uint64_t) <= n; result += sizeof(std::uint64_t)) {
+        std::uint64_t lhs_word, rhs_word;
+        std::memcpy(&lhs_word, lhs + result, sizeof(std::uint64_t));
+        std::memcpy(&rhs_word, rhs + result, sizeof(std::uint64_t));
+        if (lhs_word != rhs_word) break;
+    }
+    while (result < n && lhs[result] == rhs[result]) ++result;
+    return result;
+}
+
+bool is_scannable(const std::size_t sequence_size, const unsigned max_period) noexcept
+{
+    // The tandem scanners give up on sequences shorter than two periods
+    return sequence_size >= 2 * max_period && sequence_size < scanEnd;
+}
+
+} // namespace
+
+TandemRepeatIndex::TandemRepeatIndex(const unsigned max_period)
+: max_period_ {max_period}
+{
+    if (max_period_ == 0 || max_period_ > 3) {
+        throw std::domain_error {"TandemRepeatIndex: max_period must be in [1, 3]"};
+    }
+}
+
+unsigned TandemRepeatIndex::max_period() const noexcept
+{
+    return max_period_;
+}
+
+bool TandemRepeatIndex::is_indexed(const GenomicRegion& region) const noexcept
+{
+    return region_ && *region_ == region;
+}
+
+void TandemRepeatIndex::index(const Haplotype& reference)
+{
+    clear();
+    if (!is_scannable(sequence_size(reference), max_period_)) return;
+    region_ = mapped_region(reference);
+    sequence_ = reference.sequence();
+    const auto first = sequence_.data();
+    const auto last  = first + sequence_.size();
+    periods_.resize(max_period_);
+    for (unsigned period {1}; period <= max_period_; ++period) {
+        auto& index = periods_[period - 1];
+        std::uint32_t pos {0}, reach {0};
+        ScanStep step;
+        while (true) {
+            index.scan_positions.push_back(pos);
+            index.scan_reaches.push_back(reach);
+            index.first_repeats.push_back(static_cast<std::uint32_t>(index.repeats.size()));
+            if (!scan_step(period, first, last, pos, step)) break;
+            if (step.has_repeat) index.repeats.push_back(step.repeat);
+            reach = std::max(reach, step.reach);
+            pos = step.next;
+        }
+    }
+}
+
+void TandemRepeatIndex::clear() noexcept
+{
+    region_ = boost::none;
+    sequence_.clear();
+    for (auto& index : periods_) {
+        index.scan_positions.clear();
+        index.scan_reaches.clear();
+        index.first_repeats.clear();
+        index.repeats.clear();
+    }
+}
+
+void TandemRepeatIndex::find(const Haplotype& haplotype, RepeatVector& result) const
+{
+    const auto& sequence = haplotype.sequence();
+    if (!is_indexed(mapped_region(haplotype)) || !is_scannable(sequence.size(), max_period_)) {
+        result = tandem::extract_exact_tandem_repeats(sequence, 1, max_period_);
+        return;
+    }
+    result.clear();
+    const auto first = sequence.data();
+    const auto last  = first + sequence.size();
+    std::array<std::size_t, 4> period_ends {};
+    ScanStep step;
+    for (unsigned period {1}; period <= max_period_; ++period) {
+        const auto& index = periods_[period - 1];
+        std::uint32_t pos {0};
+        while (true) {
+            pos = copy_reference_scan(index, sequence, pos, result);
+            if (!scan_step(period, first, last, pos, step)) break;
+            if (step.has_repeat) result.push_back(step.repeat);
+            pos = step.next;
+        }
+        period_ends[period] = result.size();
+    }
+    // Same order as tandem::extract_exact_tandem_repeats, which merges each period in turn
+    for (unsigned period {2}; period <= max_period_; ++period) {
+        std::inplace_merge(std::begin(result), std::next(std::begin(result), period_ends[period - 1]),
+                           std::next(std::begin(result), period_ends[period]),
+                           [] (const tandem::Repeat& lhs, const tandem::Repeat& rhs) noexcept {
+                               return lhs.pos < rhs.pos;
+                           });
+    }
+}
+
+// private methods
+
+std::uint32_t TandemRepeatIndex::copy_reference_scan(const PeriodIndex& index, const Haplotype::NucleotideSequence& haplotype,
+                                                     const std::uint32_t pos, RepeatVector& result) const
+{
+    const auto reference_size = static_cast<std::int64_t>(sequence_.size());
+    const auto haplotype_size = static_cast<std::int64_t>(haplotype.size());
+    // Without indels the sequences line up everywhere, otherwise at least the ends line up
+    const std::array<std::int64_t, 2> offsets {0, haplotype_size - reference_size};
+    const auto num_offsets = offsets[1] == 0 ? 1 : 2;
+    for (int i {0}; i < num_offsets; ++i) {
+        const auto offset = offsets[i];
+        const auto reference_pos = pos - offset;
+        if (reference_pos < 0 || reference_pos >= reference_size || sequence_[reference_pos] != haplotype[pos]) continue;
+        const auto state_itr = std::lower_bound(std::cbegin(index.scan_positions), std::cend(index.scan_positions), reference_pos);
+        if (state_itr == std::cend(index.scan_positions) || *state_itr != reference_pos) continue;
+        const auto first_state = static_cast<std::size_t>(std::distance(std::cbegin(index.scan_positions), state_itr));
+        const auto max_matches = static_cast<std::size_t>(std::min(reference_size - reference_pos, haplotype_size - pos));
+        const auto match_end = reference_pos + static_cast<std::int64_t>(count_matches(sequence_.data() + reference_pos,
+                                                                                        haplotype.data() + pos, max_matches));
+        // The reference scan can be followed while it has only looked at sequence the haplotype shares
+        if (index.scan_reaches[first_state] > match_end) continue;
+        const auto last_state = static_cast<std::size_t>(std::distance(std::cbegin(index.scan_reaches),
+                                                                       std::upper_bound(std::next(std::cbegin(index.scan_reaches), first_state),
+                                                                                        std::cend(index.scan_reaches), match_end))) - 1;
+        if (last_state == first_state) continue;
+        std::transform(std::next(std::cbegin(index.repeats), index.first_repeats[first_state]),
+                       std::next(std::cbegin(index.repeats), index.first_repeats[last_state]),
+                       std::back_inserter(result),
+                       [offset] (tandem::Repeat repeat) noexcept {
+                           repeat.pos = static_cast<std::uint32_t>(repeat.pos + offset);
+                           return repeat;
+                       });
+        return static_cast<std::uint32_t>(index.scan_positions[last_state] + offset);
+    }
+    return pos;
+}
+
+} // namespace octopus
@@ -0,0 +1,74 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef tandem_repeat_index_hpp
+#define tandem_repeat_index_hpp
+
+#include <vector>
+#include <cstdint>
+
+#include <boost/optional.hpp>
+
+#include "tandem/tandem.hpp"
+
+#include "basics/genomic_region.hpp"
+#include "core/types/haplotype.hpp"
+
+namespace octopus {
+
+/*
+    Finds the short exact tandem repeats of haplotypes from a single scan of the reference sequence
+    of their region.
+
+    The repeat scanners in tandem are greedy, so the steps a scan takes from any position depend only on
+    that position and the sequence the steps look at. The index records every reference scan position,
+    how far the scan had looked by then, and the repeats found. A haplotype is scanned only where it
+    differs from the reference: whenever its scan reaches a reference scan position, the reference steps
+    that only look at sequence the haplotype shares are copied, and scanning resumes where they stop.
+    The result is always identical to tandem::extract_exact_tandem_repeats(haplotype.sequence(), 1, max_period).
+*/
+class TandemRepeatIndex
+{
+public:
+    using RepeatVector = std::vector<tandem::Repeat>;
+    
+    TandemRepeatIndex() = default;
+    
+    TandemRepeatIndex(unsigned max_period); // max_period must be at most 3
+    
+    TandemRepeatIndex(const TandemRepeatIndex&)            = default;
+    TandemRepeatIndex& operator=(const TandemRepeatIndex&) = default;
+    TandemRepeatIndex(TandemRepeatIndex&&)                 = default;
+    TandemRepeatIndex& operator=(TandemRepeatIndex&&)      = default;
+    
+    ~TandemRepeatIndex() = default;
+    
+    unsigned max_period() const noexcept;
+    bool is_indexed(const GenomicRegion& region) const noexcept;
+    
+    void index(const Haplotype& reference);
+    void clear() noexcept;
+    
+    // Haplotypes not mapped to the indexed region are scanned in full
+    void find(const Haplotype& haplotype, RepeatVector& result) const;
+    
+private:
+    struct PeriodIndex
+    {
+        // Before each step: the scan position, one past the furthest position looked at, and the repeats found
+        std::vector<std::uint32_t> scan_positions, scan_reaches, first_repeats;
+        RepeatVector repeats;
+    };
+
+    unsigned max_period_ = 3;
+    boost::optional<GenomicRegion> region_;
+    Haplotype::NucleotideSequence sequence_;
+    std::vector<PeriodIndex> periods_;
+    
+    std::uint32_t copy_reference_scan(const PeriodIndex& index, const Haplotype::NucleotideSequence& haplotype,
+                                      std::uint32_t pos, RepeatVector& result) const;
+};
+
+} // namespace octopus
+
+#endif
@@ -5,6 +5,12 @@
 
 namespace octopus {
 
+namespace {
+
+thread_local ThreadPool* current_pool {nullptr};
+
+} // namespace
+
 ThreadPool::ThreadPool() : ThreadPool {0} {}
 
 ThreadPool::ThreadPool(const std::size_t n_threads)
@@ -14,6 +20,7 @@ ThreadPool::ThreadPool(const std::size_t n_threads)
     workers_.reserve(n_threads);
     for (std::size_t i {0}; i < n_threads; ++i) {
         workers_.emplace_back([this] {
+            current_pool = this;
             std::function<void()> task;
             while (true) {
                 std::unique_lock<std::mutex> lk {mutex_};
@@ -43,6 +50,11 @@ ThreadPool::~ThreadPool() noexcept
     }
 }
 
+ThreadPool* ThreadPool::current() noexcept
+{
+    return current_pool;
+}
+
 std::size_t ThreadPool::size() const noexcept
 {
     return workers_.size();
@@ -35,6 +35,9 @@ public:
     
     ~ThreadPool() noexcept;
     
+    // The pool whose worker is running the calling thread, or nullptr if there is none
+    static ThreadPool* current() noexcept;
+    
     std::size_t size() const noexcept;
     bool empty() const noexcept;
     std::size_t n_idle() const noexcept;
@@ -0,0 +1,98 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+
+#include "benchmark_utils.hpp"
+
+/*
+ Usage: octopus-benchmarks [--min-time SECONDS] [FILTER...]
+
+ Runs every registered benchmark whose name contains one of the filters (all if none are given).
+ Each benchmark is run once to warm up, then repeatedly until min-time has elapsed.
+ */
+
+namespace {
+
+using namespace octopus::benchmark;
+
+using Clock = std::chrono::steady_clock;
+
+struct RunOptions
+{
+    double min_seconds = 1.0;
+    std::vector<std::string> filters = {};
+};
+
+RunOptions parse_run_options(const int argc, const char** argv)
+{
+    RunOptions result {};
+    for (int i {1}; i < argc; ++i) {
+        const std::string arg {argv[i]};
+        if (arg == "--min-time" && i + 1 < argc) {
+            result.min_seconds = std::stod(argv[++i]);
+        } else {
+            result.filters.push_back(arg);
+        }
+    }
+    return result;
+}
+
+bool is_selected(const BenchmarkDefinition& definition, const RunOptions& options)
+{
+    if (options.filters.empty()) return true;
+    for (const auto& filter : options.filters) {
+        if (definition.name.find(filter) != std::string::npos) return true;
+    }
+    return false;
+}
+
+double to_seconds(const Clock::duration duration)
+{
+    return std::chrono::duration<double> {duration}.count();
+}
+
+void run(const BenchmarkDefinition& definition, const RunOptions& options)
+{
+    auto body = definition.factory();
+    do_not_optimise(body());
+    std::size_t num_iterations {0}, num_items {0};
+    Clock::duration elapsed {0};
+    while (to_seconds(elapsed) < options.min_seconds
+           && (definition.max_iterations == 0 || num_iterations < definition.max_iterations)) {
+        const auto start = Clock::now();
+        num_items += body();
+        elapsed += Clock::now() - start;
+        ++num_iterations;
+    }
+    const auto seconds = to_seconds(elapsed);
+    std::cout << std::left << std::setw(48) << definition.name << std::right
+              << std::setw(10) << num_iterations
+              << std::setw(16) << std::fixed << std::setprecision(0) << 1e9 * seconds / num_iterations << " ns/iter"
+              << std::setw(16) << std::setprecision(2) << definition.unit_scale * num_items / seconds
+              << ' ' << definition.unit << "/s" << std::endl;
+    if (definition.report) {
+        std::cout << std::setw(48) << "" << definition.report() << std::endl;
+    }
+}
+
+} // namespace
+
+int main(const int argc, const char** argv)
+{
+    try {
+        const auto options = parse_run_options(argc, argv);
+        for (const auto& definition : registry()) {
+            if (is_selected(definition, options)) run(definition, options);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
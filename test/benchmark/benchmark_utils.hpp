@@ -5,20 +5,71 @@
 #define Octopus_benchmark_utils_hpp
 
 #include <chrono>
+#include <string>
+#include <vector>
+#include <functional>
+#include <utility>
+#include <cstddef>
 
 template <typename D = std::chrono::nanoseconds, typename F>
-D benchmark(F f, unsigned num_tests)
+D benchmark(F f, const unsigned num_tests)
 {
     D total {0};
-    
-    for (; num_tests > 0; --num_tests) {
-        const auto start = std::chrono::system_clock::now();
+
+    for (unsigned test {0}; test < num_tests; ++test) {
+        const auto start = std::chrono::steady_clock::now();
         f();
-        const auto end = std::chrono::system_clock::now();
+        const auto end = std::chrono::steady_clock::now();
         total += std::chrono::duration_cast<D>(end - start);
     }
-    
-    return D {total / num_tests};
+
+    return num_tests > 0 ? D {total / num_tests} : total;
 }
 
+namespace octopus { namespace benchmark {
+
+// A benchmark body does one iteration of work and returns the number of items (e.g. alignments,
+// reads, or bases) processed, which is used to report throughput.
+using BenchmarkBody = std::function<std::size_t()>;
+
+// Setup is done by the factory, which is called once and not timed.
+using BenchmarkFactory = std::function<BenchmarkBody()>;
+
+struct BenchmarkDefinition
+{
+    std::string name, unit;
+    BenchmarkFactory factory;
+    // The runner never does more iterations than this, if non-zero. For long running benchmarks.
+    unsigned max_iterations = 0;
+    // Scales items per second in the report, e.g. 1e-6 to report Mbp/s
+    double unit_scale = 1.0;
+    // Extra results, such as cache hit rates, printed after the timings if set
+    std::function<std::string()> report = nullptr;
+};
+
+inline std::vector<BenchmarkDefinition>& registry()
+{
+    static std::vector<BenchmarkDefinition> result {};
+    return result;
+}
+
+// Registers a benchmark at static initialisation time
+struct Registrar
+{
+    Registrar(BenchmarkDefinition definition)
+    {
+        registry().push_back(std::move(definition));
+    }
+};
+
+// Stops the compiler from optimising away a benchmark result
+template <typename T>
+void do_not_optimise(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+} // namespace benchmark
+} // namespace octopus
+
 #endif
@@ -0,0 +1,60 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <boost/log/core.hpp>
+
+#include "config/option_parser.hpp"
+#include "core/calling_components.hpp"
+#include "core/octopus.hpp"
+
+#include "benchmark_utils.hpp"
+#include "synthetic_data.hpp"
+
+namespace octopus { namespace benchmark {
+
+namespace {
+
+// About the size of the regression test regions
+constexpr std::size_t numContigs {2}, contigSize {500'000};
+
+const SyntheticDataset& get_calling_dataset()
+{
+    static const auto result = make_dataset(numContigs, contigSize, SimulationParameters {});
+    return result;
+}
+
+// Calls the whole synthetic genome from the command line options, as main does
+BenchmarkFactory call_genome(const unsigned num_threads)
+{
+    return [=] () -> BenchmarkBody {
+        const auto& dataset = get_calling_dataset();
+        // Calling progress is logged, which would swamp the benchmark report
+        boost::log::core::get()->set_logging_enabled(false);
+        const auto output_path = (make_temp_directory() / "calls.vcf").string();
+        auto args = std::make_shared<std::vector<std::string>>(std::vector<std::string> {
+            "octopus", "--reference", dataset.reference_path.string(), "--reads", dataset.reads_path.string(),
+            "--output", output_path, "--threads", std::to_string(num_threads)
+        });
+        return [=] () -> std::size_t {
+            std::vector<const char*> argv {};
+            for (const auto& arg : *args) argv.push_back(arg.c_str());
+            const auto options = options::parse_options(static_cast<int>(argv.size()), argv.data());
+            auto components = collate_genome_calling_components(options);
+            run_octopus(components, "octopus-benchmarks");
+            return numContigs * contigSize;
+        };
+    };
+}
+
+Registrar call_genome_single_threaded {{"end_to_end/call/threads1", "Mbp", call_genome(1), 3, 1e-6}};
+// Zero threads lets octopus decide, as with a bare --threads
+Registrar call_genome_multi_threaded {{"end_to_end/call/threads_auto", "Mbp", call_genome(0), 3, 1e-6}};
+
+} // namespace
+
+} // namespace benchmark
+} // namespace octopus
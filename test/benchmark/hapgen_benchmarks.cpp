@@ -0,0 +1,142 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "basics/genomic_region.hpp"
+#include "core/types/allele.hpp"
+#include "core/tools/vargen/utils/assembler.hpp"
+#include "core/tools/hapgen/haplotype_tree.hpp"
+#include "io/reference/reference_genome.hpp"
+
+#include "benchmark_utils.hpp"
+#include "synthetic_data.hpp"
+
+namespace octopus { namespace benchmark {
+
+namespace {
+
+using coretools::Assembler;
+using coretools::HaplotypeTree;
+
+// Assembler
+
+constexpr GenomicRegion::Size assemblyWindowSize {400};
+
+struct AssemblyWindow
+{
+    std::string reference;
+    std::vector<SimulatedRead> reads;
+};
+
+// Non-overlapping windows of a simulated sample, as the local reassembler would see them
+std::vector<AssemblyWindow> make_assembly_windows()
+{
+    std::mt19937 generator {42};
+    SimulationParameters params {};
+    params.snv_rate = 5e-3;
+    const auto contig = make_synthetic_contig("syn", 20'000, generator);
+    const auto sample = simulate_sample(contig, params, generator);
+    std::vector<AssemblyWindow> result {};
+    for (std::size_t begin {0}; begin + assemblyWindowSize <= contig.sequence.size(); begin += assemblyWindowSize) {
+        AssemblyWindow window {contig.sequence.substr(begin, assemblyWindowSize), {}};
+        for (const auto& read : sample.reads) {
+            if (read.begin >= begin && read.begin + read.sequence.size() <= begin + assemblyWindowSize) {
+                window.reads.push_back(read);
+            }
+        }
+        result.push_back(std::move(window));
+    }
+    return result;
+}
+
+BenchmarkFactory assemble(const unsigned kmer_size, const bool extract_bubbles)
+{
+    return [=] () -> BenchmarkBody {
+        auto windows = std::make_shared<std::vector<AssemblyWindow>>(make_assembly_windows());
+        return [=] () -> std::size_t {
+            std::size_t num_reads {0};
+            for (const auto& window : *windows) {
+                try {
+                    Assembler assembler {Assembler::Parameters {kmer_size}, window.reference};
+                    for (const auto& read : window.reads) {
+                        assembler.insert_read(read.sequence, read.is_reverse ? Assembler::Direction::reverse
+                                                                             : Assembler::Direction::forward);
+                    }
+                    num_reads += window.reads.size();
+                    if (extract_bubbles) {
+                        assembler.try_recover_dangling_branches();
+                        assembler.prune(2);
+                        if (!assembler.is_acyclic()) assembler.remove_nonreference_cycles();
+                        assembler.cleanup();
+                        do_not_optimise(assembler.extract_variants(10, 2.0).size());
+                    } else {
+                        do_not_optimise(assembler.num_kmers());
+                    }
+                } catch (const Assembler::NonUniqueReferenceSequence&) {
+                    // The window reference has a repeated kmer, so the local reassembler would skip it too
+                }
+            }
+            return num_reads;
+        };
+    };
+}
+
+Registrar assemble_graph_k15 {{"assembler/build_graph/k15", "reads", assemble(15, false)}};
+Registrar assemble_graph_k35 {{"assembler/build_graph/k35", "reads", assemble(35, false)}};
+Registrar assemble_bubbles_k15 {{"assembler/extract_variants/k15", "reads", assemble(15, true)}};
+Registrar assemble_bubbles_k35 {{"assembler/extract_variants/k35", "reads", assemble(35, true)}};
+
+// HaplotypeTree
+
+struct TreeData
+{
+    TreeData(SyntheticDataset dataset_)
+    : dataset {std::move(dataset_)}
+    , reference {make_reference(dataset.reference_path)}
+    , alleles {}
+    {
+        for (const auto& allele : dataset.simulations.front().alleles) {
+            alleles.push_back(make_reference_allele(mapped_region(allele), reference));
+            alleles.push_back(allele);
+        }
+    }
+
+    SyntheticDataset dataset;
+    ReferenceGenome reference;
+    std::vector<Allele> alleles;
+};
+
+// Each tree is grown until it has 2^depth haplotypes, which is about the size the haplotype generator allows
+BenchmarkFactory extend_tree(const unsigned depth)
+{
+    return [=] () -> BenchmarkBody {
+        SimulationParameters params {};
+        params.snv_rate = 1e-2;
+        auto data = std::make_shared<TreeData>(make_dataset(1, 20'000, params));
+        return [=] () -> std::size_t {
+            const auto& contig = data->dataset.contigs.front().name;
+            const auto max_alleles = 2 * depth;
+            std::size_t num_extensions {0};
+            for (std::size_t first {0}; first + max_alleles <= data->alleles.size(); first += max_alleles) {
+                HaplotypeTree tree {contig, data->reference};
+                for (std::size_t i {first}; i < first + max_alleles; ++i) {
+                    tree.extend(data->alleles[i]);
+                }
+                do_not_optimise(tree.num_haplotypes());
+                num_extensions += max_alleles;
+            }
+            return num_extensions;
+        };
+    };
+}
+
+Registrar extend_tree_d4 {{"haplotype_tree/extend/depth4", "extensions", extend_tree(4)}};
+Registrar extend_tree_d8 {{"haplotype_tree/extend/depth8", "extensions", extend_tree(8)}};
+
+} // namespace
+
+} // namespace benchmark
+} // namespace octopus
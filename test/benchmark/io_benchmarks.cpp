@@ -0,0 +1,103 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <vector>
+#include <memory>
+#include <random>
+
+#include "basics/genomic_region.hpp"
+#include "utils/memory_footprint.hpp"
+#include "io/reference/reference_genome.hpp"
+#include "io/read/read_manager.hpp"
+
+#include "benchmark_utils.hpp"
+#include "synthetic_data.hpp"
+
+namespace octopus { namespace benchmark {
+
+namespace {
+
+constexpr std::size_t numContigs {4}, contigSize {250'000};
+
+const SyntheticDataset& get_io_dataset()
+{
+    static const auto result = make_dataset(numContigs, contigSize, SimulationParameters {});
+    return result;
+}
+
+// Random fetches of the given size, as made by the candidate generators and haplotype generator
+std::vector<GenomicRegion> make_random_regions(const SyntheticDataset& dataset, const GenomicRegion::Size size,
+                                               const std::size_t num_regions)
+{
+    std::mt19937 generator {42};
+    std::uniform_int_distribution<std::size_t> contig_dist {0, dataset.contigs.size() - 1};
+    std::uniform_int_distribution<GenomicRegion::Position> begin_dist {0, contigSize - size};
+    std::vector<GenomicRegion> result {};
+    result.reserve(num_regions);
+    for (std::size_t i {0}; i < num_regions; ++i) {
+        const auto begin = begin_dist(generator);
+        result.emplace_back(dataset.contigs[contig_dist(generator)].name, begin, begin + size);
+    }
+    return result;
+}
+
+// Fetches clustered around a moving locus, like the sequential walk of the calling loop
+std::vector<GenomicRegion> make_local_regions(const SyntheticDataset& dataset, const GenomicRegion::Size size)
+{
+    std::mt19937 generator {42};
+    std::uniform_int_distribution<GenomicRegion::Position> jitter_dist {0, 2 * size};
+    std::vector<GenomicRegion> result {};
+    for (const auto& contig : dataset.contigs) {
+        for (GenomicRegion::Position pos {0}; pos + 3 * size <= contigSize; pos += size) {
+            const auto begin = pos + jitter_dist(generator);
+            result.emplace_back(contig.name, begin, begin + size);
+        }
+    }
+    return result;
+}
+
+BenchmarkFactory fetch_reference(const bool use_cache, const bool local)
+{
+    return [=] () -> BenchmarkBody {
+        const auto& dataset = get_io_dataset();
+        const auto cache_size = use_cache ? *parse_footprint("50MB") : MemoryFootprint {0};
+        auto reference = std::make_shared<ReferenceGenome>(make_reference(dataset.reference_path, cache_size));
+        auto regions = std::make_shared<std::vector<GenomicRegion>>(local ? make_local_regions(dataset, 1'000)
+                                                                          : make_random_regions(dataset, 1'000, 1'000));
+        return [=] () -> std::size_t {
+            std::size_t num_bases {0};
+            for (const auto& region : *regions) {
+                num_bases += reference->fetch_sequence(region).size();
+            }
+            return num_bases;
+        };
+    };
+}
+
+Registrar fetch_fasta_random {{"reference/fasta/random", "Mbp", fetch_reference(false, false), 0, 1e-6}};
+Registrar fetch_caching_fasta_random {{"reference/caching_fasta/random", "Mbp", fetch_reference(true, false), 0, 1e-6}};
+Registrar fetch_caching_fasta_local {{"reference/caching_fasta/local", "Mbp", fetch_reference(true, true), 0, 1e-6}};
+
+BenchmarkFactory decode_reads(const GenomicRegion::Size region_size)
+{
+    return [=] () -> BenchmarkBody {
+        const auto& dataset = get_io_dataset();
+        auto manager = std::make_shared<io::ReadManager>(std::vector<io::ReadManager::Path> {dataset.reads_path}, 1);
+        auto regions = std::make_shared<std::vector<GenomicRegion>>(make_random_regions(dataset, region_size, 100));
+        return [=] () -> std::size_t {
+            std::size_t num_reads {0};
+            for (const auto& region : *regions) {
+                num_reads += manager->fetch_reads(dataset.sample, region).size();
+            }
+            return num_reads;
+        };
+    };
+}
+
+Registrar decode_reads_1kb {{"reads/htslib_sam_facade/1kb", "reads", decode_reads(1'000)}};
+Registrar decode_reads_25kb {{"reads/htslib_sam_facade/25kb", "reads", decode_reads(25'000)}};
+
+} // namespace
+
+} // namespace benchmark
+} // namespace octopus
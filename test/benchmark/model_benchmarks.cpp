@@ -0,0 +1,405 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <random>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <sstream>
+#include <iomanip>
+
+#include "basics/genomic_region.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/types/genotype.hpp"
+#include "core/tools/hapgen/haplotype_tree.hpp"
+#include "core/models/pairhmm/simd_pair_hmm.hpp"
+#include "core/models/haplotype_likelihood_model.hpp"
+#include "core/models/haplotype_likelihood_array.hpp"
+#include "core/models/error/error_model_factory.hpp"
+#include "core/models/genotype/germline_likelihood_model.hpp"
+#include "io/reference/reference_genome.hpp"
+#include "utils/tandem_repeat_index.hpp"
+#include "utils/thread_pool.hpp"
+
+#include "benchmark_utils.hpp"
+#include "synthetic_data.hpp"
+
+namespace octopus { namespace benchmark {
+
+namespace {
+
+using coretools::HaplotypeTree;
+using model::GermlineLikelihoodModel;
+
+// Pair HMM
+
+constexpr int readLength {150}, truthLength {readLength + 2 * hmm::simd::min_flank_pad() - 1}, numAlignments {64};
+
+struct AlignmentBatch
+{
+    std::vector<std::string> truths, targets;
+    std::vector<std::vector<std::int8_t>> qualities, gap_opens, gap_extends, snv_priors;
+    std::vector<const char*> truth_ptrs, target_ptrs, snv_mask_ptrs;
+    std::vector<const std::int8_t*> quality_ptrs, gap_open_ptrs, gap_extend_ptrs, snv_prior_ptrs;
+    std::vector<std::vector<char>> aln1, aln2;
+    std::vector<char*> aln1_ptrs, aln2_ptrs;
+    std::vector<int> scores, first_pos;
+};
+
+// Reads sampled from the synthetic reference with a few errors, aligned to their true locus
+AlignmentBatch make_alignment_batch()
+{
+    std::mt19937 generator {42};
+    const auto contig = make_synthetic_contig("syn", 10'000, generator);
+    std::uniform_int_distribution<std::size_t> offset_dist {0, contig.sequence.size() - truthLength};
+    std::uniform_int_distribution<int> position_dist {0, readLength - 1}, quality_dist {10, 40};
+    AlignmentBatch result {};
+    for (int i {0}; i < numAlignments; ++i) {
+        result.truths.push_back(contig.sequence.substr(offset_dist(generator), truthLength));
+        auto target = result.truths.back().substr(hmm::simd::min_flank_pad(), readLength);
+        for (int j {0}; j < 3; ++j) {
+            auto& base = target[position_dist(generator)];
+            base = base == 'A' ? 'C' : 'A';
+        }
+        result.targets.push_back(std::move(target));
+        std::vector<std::int8_t> qualities(readLength);
+        std::generate(std::begin(qualities), std::end(qualities), [&] () { return quality_dist(generator); });
+        result.qualities.push_back(std::move(qualities));
+        result.gap_opens.emplace_back(truthLength, 45);
+        result.gap_extends.emplace_back(truthLength, 3);
+        result.snv_priors.emplace_back(truthLength, 40);
+        result.aln1.emplace_back(2 * (readLength + hmm::simd::min_flank_pad()) + 1);
+        result.aln2.emplace_back(2 * (readLength + hmm::simd::min_flank_pad()) + 1);
+    }
+    for (int i {0}; i < numAlignments; ++i) {
+        result.truth_ptrs.push_back(result.truths[i].data());
+        result.target_ptrs.push_back(result.targets[i].data());
+        result.snv_mask_ptrs.push_back(result.truths[i].data());
+        result.quality_ptrs.push_back(result.qualities[i].data());
+        result.gap_open_ptrs.push_back(result.gap_opens[i].data());
+        result.gap_extend_ptrs.push_back(result.gap_extends[i].data());
+        result.snv_prior_ptrs.push_back(result.snv_priors[i].data());
+        result.aln1_ptrs.push_back(result.aln1[i].data());
+        result.aln2_ptrs.push_back(result.aln2[i].data());
+    }
+    result.scores.resize(numAlignments);
+    result.first_pos.resize(numAlignments);
+    return result;
+}
+
+template <typename F>
+BenchmarkFactory align_each(F f)
+{
+    return [f] () -> BenchmarkBody {
+        auto batch = std::make_shared<AlignmentBatch>(make_alignment_batch());
+        return [batch, f] () -> std::size_t {
+            for (int i {0}; i < numAlignments; ++i) {
+                do_not_optimise(f(*batch, i));
+            }
+            return numAlignments;
+        };
+    };
+}
+
+template <typename F>
+BenchmarkFactory align_batched(F f)
+{
+    return [f] () -> BenchmarkBody {
+        auto batch = std::make_shared<AlignmentBatch>(make_alignment_batch());
+        return [batch, f] () -> std::size_t {
+            f(*batch);
+            do_not_optimise(batch->scores.front());
+            return numAlignments;
+        };
+    };
+}
+
+Registrar align_flat_gap {{"pairhmm/align/flat_gap", "alignments", align_each([] (AlignmentBatch& b, int i) {
+    return hmm::simd::align(b.truth_ptrs[i], b.target_ptrs[i], b.quality_ptrs[i], truthLength, readLength, 45, 3, 2);
+})}};
+
+Registrar align_gap_open {{"pairhmm/align/gap_open", "alignments", align_each([] (AlignmentBatch& b, int i) {
+    return hmm::simd::align(b.truth_ptrs[i], b.target_ptrs[i], b.quality_ptrs[i], truthLength, readLength,
+                            b.gap_open_ptrs[i], 3, 2);
+})}};
+
+Registrar align_gap_open_extend {{"pairhmm/align/gap_open_extend", "alignments", align_each([] (AlignmentBatch& b, int i) {
+    return hmm::simd::align(b.truth_ptrs[i], b.target_ptrs[i], b.quality_ptrs[i], truthLength, readLength,
+                            b.gap_open_ptrs[i], b.gap_extend_ptrs[i], 2);
+})}};
+
+Registrar align_snv_mask {{"pairhmm/align/snv_mask", "alignments", align_each([] (AlignmentBatch& b, int i) {
+    return hmm::simd::align(b.truth_ptrs[i], b.target_ptrs[i], b.quality_ptrs[i], truthLength, readLength,
+                            b.snv_mask_ptrs[i], b.snv_prior_ptrs[i], b.gap_open_ptrs[i], 3, 2);
+})}};
+
+Registrar align_traceback {{"pairhmm/align/traceback", "alignments", align_each([] (AlignmentBatch& b, int i) {
+    return hmm::simd::align(b.truth_ptrs[i], b.target_ptrs[i], b.quality_ptrs[i], truthLength, readLength,
+                            b.gap_open_ptrs[i], 3, 2, b.first_pos[i], b.aln1_ptrs[i], b.aln2_ptrs[i]);
+})}};
+
+Registrar align_snv_mask_traceback {{"pairhmm/align/snv_mask_traceback", "alignments", align_each([] (AlignmentBatch& b, int i) {
+    return hmm::simd::align(b.truth_ptrs[i], b.target_ptrs[i], b.quality_ptrs[i], truthLength, readLength,
+                            b.snv_mask_ptrs[i], b.snv_prior_ptrs[i], b.gap_open_ptrs[i], 3, 2,
+                            b.aln1_ptrs[i], b.aln2_ptrs[i], b.first_pos[i]);
+})}};
+
+Registrar batched_align_flat_gap {{"pairhmm/batched_align/flat_gap", "alignments", align_batched([] (AlignmentBatch& b) {
+    hmm::simd::align(b.truth_ptrs.data(), b.target_ptrs.data(), b.quality_ptrs.data(), truthLength, readLength,
+                     numAlignments, 45, 3, 2, b.scores.data());
+})}};
+
+Registrar batched_align_gap_open {{"pairhmm/batched_align/gap_open", "alignments", align_batched([] (AlignmentBatch& b) {
+    hmm::simd::align(b.truth_ptrs.data(), b.target_ptrs.data(), b.quality_ptrs.data(), truthLength, readLength,
+                     numAlignments, b.gap_open_ptrs.data(), 3, 2, b.scores.data());
+})}};
+
+Registrar batched_align_snv_mask {{"pairhmm/batched_align/snv_mask", "alignments", align_batched([] (AlignmentBatch& b) {
+    hmm::simd::align(b.truth_ptrs.data(), b.target_ptrs.data(), b.quality_ptrs.data(), truthLength, readLength,
+                     numAlignments, b.snv_mask_ptrs.data(), b.snv_prior_ptrs.data(), b.gap_open_ptrs.data(), 3, 2,
+                     b.scores.data());
+})}};
+
+Registrar batched_align_traceback {{"pairhmm/batched_align/traceback", "alignments", align_batched([] (AlignmentBatch& b) {
+    hmm::simd::align(b.truth_ptrs.data(), b.target_ptrs.data(), b.quality_ptrs.data(), truthLength, readLength,
+                     numAlignments, b.gap_open_ptrs.data(), 3, 2,
+                     b.scores.data(), b.first_pos.data(), b.aln1_ptrs.data(), b.aln2_ptrs.data());
+})}};
+
+// Likelihoods
+
+constexpr GenomicRegion::Size activeRegionSize {600}, activeRegionPad {30};
+constexpr unsigned maxSnvs {3};
+
+// An active region with the haplotypes for every combination of the SNVs simulated in it
+struct ActiveRegion
+{
+    ActiveRegion(SyntheticDataset dataset_)
+    : dataset {std::move(dataset_)}
+    , reference {make_reference(dataset.reference_path)}
+    , region {dataset.contigs.front().name, 2'000, 2'000 + activeRegionSize}
+    {
+        std::vector<SimulatedRead> region_reads {};
+        for (const auto& read : dataset.simulations.front().reads) {
+            if (read.begin >= region.begin() + activeRegionPad
+                && read.begin + read.sequence.size() + activeRegionPad <= region.end()) {
+                region_reads.push_back(read);
+            }
+        }
+        reads = make_read_map(dataset.sample, region_reads);
+        HaplotypeTree tree {region.contig_name(), reference};
+        unsigned num_snvs {0};
+        for (const auto& allele : dataset.simulations.front().alleles) {
+            if (contains(region, allele) && num_snvs < maxSnvs) {
+                tree.extend(make_reference_allele(mapped_region(allele), reference));
+                tree.extend(allele);
+                ++num_snvs;
+            }
+        }
+        haplotypes = tree.is_empty() ? std::vector<Haplotype> {Haplotype {region, reference}} : tree.extract_haplotypes(region);
+    }
+
+    SyntheticDataset dataset;
+    ReferenceGenome reference;
+    GenomicRegion region;
+    ReadMap reads;
+    std::vector<Haplotype> haplotypes;
+};
+
+std::shared_ptr<ActiveRegion> make_active_region()
+{
+    SimulationParameters params {};
+    params.snv_rate = 5e-3;
+    return std::make_shared<ActiveRegion>(make_dataset(1, 5'000, params));
+}
+
+std::size_t num_reads(const ActiveRegion& active_region)
+{
+    return active_region.reads.at(active_region.dataset.sample).size();
+}
+
+BenchmarkFactory populate_likelihoods(const ExecutionPolicy execution_policy)
+{
+    return [=] () -> BenchmarkBody {
+        auto active_region = make_active_region();
+        const std::vector<SampleName> samples {active_region->dataset.sample};
+        const auto populate = [=] () -> std::size_t {
+            const auto& haplotypes = active_region->haplotypes;
+            HaplotypeLikelihoodArray likelihoods {make_haplotype_likelihood_model("HiSeq"),
+                                                  static_cast<unsigned>(haplotypes.size()), samples, execution_policy};
+            likelihoods.populate(active_region->reads, haplotypes);
+            do_not_optimise(likelihoods.num_likelihoods(samples.front()));
+            return num_reads(*active_region) * haplotypes.size();
+        };
+        if (execution_policy == ExecutionPolicy::seq) return populate;
+        // Parallel populating shares the pool running it, as calling tasks share the task pool
+        return [=] () -> std::size_t {
+            static ThreadPool workers {std::max(std::thread::hardware_concurrency(), 2u)};
+            return workers.push(populate).get();
+        };
+    };
+}
+
+Registrar populate_likelihoods_seq {{"likelihoods/populate", "read-haplotype pairs", populate_likelihoods(ExecutionPolicy::seq)}};
+Registrar populate_likelihoods_par {{"likelihoods/populate_parallel", "read-haplotype pairs", populate_likelihoods(ExecutionPolicy::par)}};
+
+// Successive calling windows, each with the haplotypes for every combination of a few consecutive SNVs.
+// Windows step one SNV at a time, so neighbouring windows share most of their haplotype sequence.
+struct CallingWindow
+{
+    ReadMap reads;
+    std::vector<Haplotype> haplotypes;
+};
+
+constexpr GenomicRegion::Size windowedRegionSize {5'000};
+constexpr unsigned snvsPerWindow {3};
+
+struct WindowedRegion
+{
+    WindowedRegion(SyntheticDataset dataset_)
+    : dataset {std::move(dataset_)}
+    , reference {make_reference(dataset.reference_path)}
+    {
+        const auto& simulation = dataset.simulations.front();
+        const auto& alleles = simulation.alleles;
+        const auto pad = HaplotypeLikelihoodModel::pad_requirement();
+        for (std::size_t first {0}; first + snvsPerWindow <= alleles.size(); ++first) {
+            const auto active_region = encompassing_region(mapped_region(alleles[first]),
+                                                           mapped_region(alleles[first + snvsPerWindow - 1]));
+            const auto contig_size = dataset.contigs.front().sequence.size();
+            std::vector<SimulatedRead> window_reads {};
+            std::size_t reads_begin {contig_size}, reads_end {0};
+            for (const auto& read : simulation.reads) {
+                const auto read_end = read.begin + read.sequence.size();
+                if (read.begin < active_region.end() && active_region.begin() < read_end
+                    && read.begin >= pad && read_end + pad <= contig_size) {
+                    window_reads.push_back(read);
+                    reads_begin = std::min<std::size_t>(reads_begin, read.begin);
+                    reads_end = std::max(reads_end, read_end);
+                }
+            }
+            if (window_reads.empty()) continue;
+            const GenomicRegion haplotype_region {active_region.contig_name(),
+                                                  static_cast<GenomicRegion::Position>(reads_begin - pad),
+                                                  static_cast<GenomicRegion::Position>(reads_end + pad)};
+            HaplotypeTree tree {haplotype_region.contig_name(), reference};
+            for (std::size_t i {first}; i < first + snvsPerWindow; ++i) {
+                tree.extend(make_reference_allele(mapped_region(alleles[i]), reference));
+                tree.extend(alleles[i]);
+            }
+            windows.push_back({make_read_map(dataset.sample, window_reads), tree.extract_haplotypes(haplotype_region)});
+        }
+    }
+    
+    SyntheticDataset dataset;
+    ReferenceGenome reference;
+    std::vector<CallingWindow> windows;
+};
+
+// Populates the windows in order with one HaplotypeLikelihoodArray, as Caller::call_variants does for a
+// calling task, so the likelihood model's read likelihood cache persists between windows. Comparing the
+// cache and no_cache throughput gives the net cost of the cache, and the hit rate is reported after the
+// timings. The cache is recreated each iteration so hits are only between windows of one pass.
+BenchmarkDefinition populate_windows(const std::string name, const std::size_t max_cache_memory)
+{
+    auto statistics = std::make_shared<HaplotypeLikelihoodModel::CacheStatistics>();
+    BenchmarkDefinition result {name, "read-haplotype pairs", [=] () -> BenchmarkBody {
+        SimulationParameters params {};
+        params.snv_rate = 5e-3;
+        const auto region = std::make_shared<WindowedRegion>(make_dataset(1, windowedRegionSize, params));
+        const std::vector<SampleName> samples {region->dataset.sample};
+        HaplotypeLikelihoodModel::Config config {};
+        config.max_cache_memory = max_cache_memory;
+        const HaplotypeLikelihoodModel model {make_snv_error_model("HiSeq"), make_indel_error_model("HiSeq"), config};
+        return [=] () -> std::size_t {
+            HaplotypeLikelihoodArray likelihoods {model, 1u << snvsPerWindow, samples};
+            std::size_t num_pairs {0};
+            for (const auto& window : region->windows) {
+                likelihoods.clear();
+                likelihoods.populate(window.reads, window.haplotypes);
+                num_pairs += window.reads.at(samples.front()).size() * window.haplotypes.size();
+            }
+            const auto pass_statistics = likelihoods.cache_statistics();
+            statistics->hits += pass_statistics.hits;
+            statistics->lookups += pass_statistics.lookups;
+            return num_pairs;
+        };
+    }};
+    if (max_cache_memory > 0) {
+        result.report = [=] () {
+            std::ostringstream ss {};
+            ss << "cache hit rate " << std::fixed << std::setprecision(1)
+               << (statistics->lookups > 0 ? 100.0 * statistics->hits / statistics->lookups : 0.0) << '%';
+            return ss.str();
+        };
+    }
+    return result;
+}
+
+Registrar populate_windows_no_cache {populate_windows("likelihoods/populate_windows/no_cache", 0)};
+Registrar populate_windows_cache {populate_windows("likelihoods/populate_windows/cache", 100'000'000)};
+
+// The per-haplotype error model set up that precedes alignment
+BenchmarkFactory reset_likelihood_model(const bool index_repeats)
+{
+    return [=] () -> BenchmarkBody {
+        auto active_region = make_active_region();
+        return [=] () -> std::size_t {
+            const auto& haplotypes = active_region->haplotypes;
+            auto model = make_haplotype_likelihood_model("HiSeq");
+            TandemRepeatIndex repeat_index {HaplotypeLikelihoodModel::max_repeat_period()};
+            if (index_repeats) repeat_index.index(make_reference_haplotype(haplotypes.front()));
+            for (const auto& haplotype : haplotypes) {
+                model.reset(haplotype, repeat_index);
+            }
+            return haplotypes.size();
+        };
+    };
+}
+
+Registrar reset_likelihood_model_scan {{"likelihoods/reset", "haplotypes", reset_likelihood_model(false)}};
+Registrar reset_likelihood_model_index {{"likelihoods/reset_repeat_index", "haplotypes", reset_likelihood_model(true)}};
+
+BenchmarkFactory evaluate_germline_genotypes(const unsigned ploidy, const bool batch)
+{
+    return [=] () -> BenchmarkBody {
+        auto active_region = make_active_region();
+        const auto& haplotypes = active_region->haplotypes;
+        const std::vector<SampleName> samples {active_region->dataset.sample};
+        auto likelihoods = std::make_shared<HaplotypeLikelihoodArray>(make_haplotype_likelihood_model("HiSeq"),
+                                                                      static_cast<unsigned>(haplotypes.size()), samples);
+        likelihoods->populate(active_region->reads, haplotypes);
+        likelihoods->prime(samples.front());
+        auto genotypes = std::make_shared<std::vector<Genotype<Haplotype>>>(generate_all_genotypes(haplotypes, ploidy));
+        return [active_region, likelihoods, genotypes, batch] () -> std::size_t {
+            const GermlineLikelihoodModel model {*likelihoods};
+            if (batch) {
+                std::vector<GermlineLikelihoodModel::LogProbability> result {};
+                model.evaluate(*genotypes, result);
+                do_not_optimise(result.back());
+            } else {
+                for (const auto& genotype : *genotypes) {
+                    do_not_optimise(model.evaluate(genotype));
+                }
+            }
+            return genotypes->size();
+        };
+    };
+}
+
+Registrar evaluate_haploid {{"likelihoods/germline_evaluate/ploidy1", "genotypes", evaluate_germline_genotypes(1, false)}};
+Registrar evaluate_diploid {{"likelihoods/germline_evaluate/ploidy2", "genotypes", evaluate_germline_genotypes(2, false)}};
+Registrar evaluate_triploid {{"likelihoods/germline_evaluate/ploidy3", "genotypes", evaluate_germline_genotypes(3, false)}};
+Registrar evaluate_tetraploid {{"likelihoods/germline_evaluate/ploidy4", "genotypes", evaluate_germline_genotypes(4, false)}};
+Registrar evaluate_diploid_batch {{"likelihoods/germline_evaluate_batch/ploidy2", "genotypes", evaluate_germline_genotypes(2, true)}};
+Registrar evaluate_triploid_batch {{"likelihoods/germline_evaluate_batch/ploidy3", "genotypes", evaluate_germline_genotypes(3, true)}};
+Registrar evaluate_tetraploid_batch {{"likelihoods/germline_evaluate_batch/ploidy4", "genotypes", evaluate_germline_genotypes(4, true)}};
+
+} // namespace
+
+} // namespace benchmark
+} // namespace octopus
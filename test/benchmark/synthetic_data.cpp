@@ -0,0 +1,276 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include "synthetic_data.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <cctype>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <htslib/sam.h>
+
+#include "basics/cigar_string.hpp"
+
+#ifndef OCTOPUS_TEST_DATA_DIR
+#define OCTOPUS_TEST_DATA_DIR "test/data"
+#endif
+
+namespace octopus { namespace benchmark {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+const std::string bases {"ACGT"};
+
+char random_base(std::mt19937& generator)
+{
+    std::uniform_int_distribution<std::size_t> dist {0, bases.size() - 1};
+    return bases[dist(generator)];
+}
+
+char random_other_base(const char base, std::mt19937& generator)
+{
+    char result;
+    do {
+        result = random_base(generator);
+    } while (result == base);
+    return result;
+}
+
+bool is_canonical_base(const char base) noexcept
+{
+    return bases.find(base) != std::string::npos;
+}
+
+std::string read_name(const std::size_t i)
+{
+    return "read" + std::to_string(i);
+}
+
+std::string to_string(const AlignedRead::BaseQualityVector& qualities)
+{
+    std::string result(qualities.size(), '!');
+    std::transform(std::cbegin(qualities), std::cend(qualities), std::begin(result),
+                   [] (auto quality) { return static_cast<char>(quality + 33); });
+    return result;
+}
+
+void write_sam(const std::vector<SimulatedRead>& reads, const std::vector<SyntheticContig>& contigs,
+               const SampleName& sample, const fs::path& path)
+{
+    std::ofstream sam {path.string()};
+    sam << "@HD\tVN:1.4\tSO:coordinate\n";
+    for (const auto& contig : contigs) {
+        sam << "@SQ\tSN:" << contig.name << "\tLN:" << contig.sequence.size() << '\n';
+    }
+    sam << "@RG\tID:synthetic\tSM:" << sample << '\n';
+    for (std::size_t i {0}; i < reads.size(); ++i) {
+        const auto& read = reads[i];
+        sam << read_name(i) << '\t' << (read.is_reverse ? 16 : 0) << '\t' << read.contig << '\t'
+            << read.begin + 1 << "\t60\t" << read.sequence.size() << "M\t*\t0\t0\t"
+            << read.sequence << '\t' << to_string(read.qualities) << "\tRG:Z:synthetic\n";
+    }
+}
+
+void convert_to_bam(const fs::path& sam_path, const fs::path& bam_path)
+{
+    samFile* in {sam_open(sam_path.c_str(), "r")};
+    if (!in) throw std::runtime_error {"could not open " + sam_path.string()};
+    bam_hdr_t* header {sam_hdr_read(in)};
+    samFile* out {sam_open(bam_path.c_str(), "wb")};
+    if (!header || !out || sam_hdr_write(out, header) < 0) {
+        throw std::runtime_error {"could not write " + bam_path.string()};
+    }
+    bam1_t* record {bam_init1()};
+    while (sam_read1(in, header, record) >= 0) {
+        if (sam_write1(out, header, record) < 0) {
+            throw std::runtime_error {"could not write " + bam_path.string()};
+        }
+    }
+    bam_destroy1(record);
+    bam_hdr_destroy(header);
+    sam_close(out);
+    sam_close(in);
+    if (sam_index_build(bam_path.c_str(), 0) != 0) {
+        throw std::runtime_error {"could not index " + bam_path.string()};
+    }
+}
+
+struct TempDirectoryCleaner
+{
+    std::vector<fs::path> directories = {};
+    ~TempDirectoryCleaner()
+    {
+        for (const auto& directory : directories) {
+            boost::system::error_code ec;
+            fs::remove_all(directory, ec);
+        }
+    }
+};
+
+} // namespace
+
+std::vector<SyntheticContig> read_test_reference()
+{
+    const fs::path path {fs::path {OCTOPUS_TEST_DATA_DIR} / "reference.fa"};
+    std::ifstream fasta {path.string()};
+    if (!fasta) throw std::runtime_error {"could not open " + path.string()};
+    std::vector<SyntheticContig> result {};
+    std::string line;
+    while (std::getline(fasta, line)) {
+        if (line.empty()) continue;
+        if (line.front() == '>') {
+            const auto name_end = line.find_first_of(" \t");
+            result.push_back({line.substr(1, name_end == std::string::npos ? name_end : name_end - 1), ""});
+        } else if (!result.empty()) {
+            result.back().sequence += line;
+        }
+    }
+    return result;
+}
+
+SyntheticContig make_synthetic_contig(std::string name, const std::size_t size, std::mt19937& generator)
+{
+    static const auto test_contigs = read_test_reference();
+    std::bernoulli_distribution mutate {0.25};
+    std::string sequence {};
+    sequence.reserve(size);
+    while (sequence.size() < size) {
+        for (const auto& contig : test_contigs) {
+            for (char base : contig.sequence) {
+                if (sequence.size() == size) break;
+                base = std::toupper(base);
+                if (!is_canonical_base(base) || mutate(generator)) base = random_base(generator);
+                sequence.push_back(base);
+            }
+        }
+    }
+    return {std::move(name), std::move(sequence)};
+}
+
+SimulatedSample simulate_sample(const SyntheticContig& contig, const SimulationParameters params, std::mt19937& generator)
+{
+    SimulatedSample result {};
+    const auto& reference = contig.sequence;
+    if (reference.size() < params.read_length) return result;
+    std::string alt_haplotype {reference};
+    std::bernoulli_distribution is_snv {params.snv_rate};
+    for (std::size_t pos {0}; pos < reference.size(); ++pos) {
+        if (is_snv(generator)) {
+            alt_haplotype[pos] = random_other_base(reference[pos], generator);
+            result.alleles.emplace_back(GenomicRegion {contig.name, static_cast<GenomicRegion::Position>(pos),
+                                                       static_cast<GenomicRegion::Position>(pos + 1)},
+                                        std::string {alt_haplotype[pos]});
+        }
+    }
+    const auto num_reads = static_cast<std::size_t>(params.depth) * reference.size() / params.read_length;
+    std::uniform_int_distribution<std::size_t> begin_dist {0, reference.size() - params.read_length};
+    std::uniform_int_distribution<unsigned> quality_dist {20, 40};
+    std::bernoulli_distribution coin {0.5}, is_error {params.error_rate};
+    result.reads.reserve(num_reads);
+    for (std::size_t i {0}; i < num_reads; ++i) {
+        const auto begin = begin_dist(generator);
+        const auto& haplotype = coin(generator) ? reference : alt_haplotype;
+        auto sequence = haplotype.substr(begin, params.read_length);
+        for (auto& base : sequence) {
+            if (is_error(generator)) base = random_other_base(base, generator);
+        }
+        AlignedRead::BaseQualityVector qualities(params.read_length);
+        std::generate(std::begin(qualities), std::end(qualities), [&] () { return quality_dist(generator); });
+        result.reads.push_back({contig.name, static_cast<GenomicRegion::Position>(begin), std::move(sequence),
+                                std::move(qualities), coin(generator)});
+    }
+    std::sort(std::begin(result.reads), std::end(result.reads),
+              [] (const auto& lhs, const auto& rhs) { return lhs.begin < rhs.begin; });
+    return result;
+}
+
+std::vector<AlignedRead> to_aligned_reads(const std::vector<SimulatedRead>& reads)
+{
+    std::vector<AlignedRead> result {};
+    result.reserve(reads.size());
+    for (std::size_t i {0}; i < reads.size(); ++i) {
+        const auto& read = reads[i];
+        AlignedRead::Flags flags {};
+        flags.reverse_mapped = read.is_reverse;
+        const auto end = static_cast<GenomicRegion::Position>(read.begin + read.sequence.size());
+        result.emplace_back(read_name(i), GenomicRegion {read.contig, read.begin, end}, read.sequence, read.qualities,
+                            parse_cigar(std::to_string(read.sequence.size()) + "M"), 60, flags, "synthetic");
+    }
+    return result;
+}
+
+ReadMap make_read_map(const SampleName& sample, const std::vector<SimulatedRead>& reads)
+{
+    const auto aligned_reads = to_aligned_reads(reads);
+    ReadMap result {};
+    result.emplace(sample, ReadContainer {std::cbegin(aligned_reads), std::cend(aligned_reads)});
+    return result;
+}
+
+void write_fasta(const std::vector<SyntheticContig>& contigs, const fs::path& path)
+{
+    static constexpr std::size_t lineWidth {60};
+    std::ofstream fasta {path.string(), std::ios::binary}, index {path.string() + ".fai"};
+    for (const auto& contig : contigs) {
+        fasta << '>' << contig.name << '\n';
+        const auto offset = static_cast<std::size_t>(fasta.tellp());
+        for (std::size_t pos {0}; pos < contig.sequence.size(); pos += lineWidth) {
+            fasta << contig.sequence.substr(pos, lineWidth) << '\n';
+        }
+        index << contig.name << '\t' << contig.sequence.size() << '\t' << offset << '\t'
+              << lineWidth << '\t' << lineWidth + 1 << '\n';
+    }
+}
+
+void write_bam(const std::vector<SimulatedRead>& reads, const std::vector<SyntheticContig>& contigs,
+               const SampleName& sample, const fs::path& path)
+{
+    auto sam_path = path;
+    sam_path.replace_extension(".sam");
+    write_sam(reads, contigs, sample, sam_path);
+    convert_to_bam(sam_path, path);
+    fs::remove(sam_path);
+}
+
+fs::path make_temp_directory()
+{
+    static TempDirectoryCleaner cleaner {};
+    auto result = fs::temp_directory_path() / fs::unique_path("octopus-benchmark-%%%%-%%%%-%%%%");
+    fs::create_directories(result);
+    cleaner.directories.push_back(result);
+    return result;
+}
+
+SyntheticDataset make_dataset(const std::size_t num_contigs, const std::size_t contig_size,
+                              const SimulationParameters params, const std::mt19937::result_type seed)
+{
+    std::mt19937 generator {seed};
+    const auto directory = make_temp_directory();
+    SyntheticDataset result {directory / "reference.fa", directory / "reads.bam", {}, "synthetic", {}};
+    std::vector<SimulatedRead> reads {};
+    for (std::size_t i {1}; i <= num_contigs; ++i) {
+        result.contigs.push_back(make_synthetic_contig("syn" + std::to_string(i), contig_size, generator));
+        result.simulations.push_back(simulate_sample(result.contigs.back(), params, generator));
+        const auto& contig_reads = result.simulations.back().reads;
+        reads.insert(std::cend(reads), std::cbegin(contig_reads), std::cend(contig_reads));
+    }
+    write_fasta(result.contigs, result.reference_path);
+    write_bam(reads, result.contigs, result.sample, result.reads_path);
+    return result;
+}
+
+std::string random_sequence(const std::size_t length, std::mt19937& generator)
+{
+    std::string result(length, 'N');
+    for (auto& base : result) base = random_base(generator);
+    return result;
+}
+
+} // namespace benchmark
+} // namespace octopus
@@ -0,0 +1,94 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#ifndef synthetic_data_hpp
+#define synthetic_data_hpp
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <random>
+
+#include <boost/filesystem/path.hpp>
+
+#include "config/common.hpp"
+#include "basics/genomic_region.hpp"
+#include "basics/aligned_read.hpp"
+#include "core/types/allele.hpp"
+
+namespace octopus { namespace benchmark {
+
+/*
+ Synthetic data for the benchmarks. Everything is derived from the contigs in test/data/reference.fa,
+ which are too small to benchmark on directly, and is deterministic given the generator seed.
+ */
+
+struct SyntheticContig
+{
+    std::string name, sequence;
+};
+
+struct SimulatedRead
+{
+    std::string contig;
+    GenomicRegion::Position begin;
+    std::string sequence;
+    AlignedRead::BaseQualityVector qualities;
+    bool is_reverse;
+};
+
+struct SimulationParameters
+{
+    unsigned depth = 30, read_length = 150;
+    double snv_rate = 1e-3, error_rate = 1e-3;
+};
+
+struct SimulatedSample
+{
+    // Heterozygous SNVs
+    std::vector<Allele> alleles;
+    // Sorted by position
+    std::vector<SimulatedRead> reads;
+};
+
+std::vector<SyntheticContig> read_test_reference();
+
+// Makes a contig of the given size by tiling the test reference contigs, mutating some bases of each
+// tile so the contig is not repetitive.
+SyntheticContig make_synthetic_contig(std::string name, std::size_t size, std::mt19937& generator);
+
+// Makes a diploid sample, heterozygous for random SNVs, with reads mapped without error
+SimulatedSample simulate_sample(const SyntheticContig& contig, SimulationParameters params, std::mt19937& generator);
+
+std::vector<AlignedRead> to_aligned_reads(const std::vector<SimulatedRead>& reads);
+
+ReadMap make_read_map(const SampleName& sample, const std::vector<SimulatedRead>& reads);
+
+// Writes an indexed FASTA
+void write_fasta(const std::vector<SyntheticContig>& contigs, const boost::filesystem::path& path);
+
+// Writes a coordinate sorted and indexed BAM with a single read group for the sample
+void write_bam(const std::vector<SimulatedRead>& reads, const std::vector<SyntheticContig>& contigs,
+               const SampleName& sample, const boost::filesystem::path& path);
+
+// A unique directory that is removed at exit
+boost::filesystem::path make_temp_directory();
+
+// A synthetic reference, and a sample simulated on each contig, written to a temporary directory
+struct SyntheticDataset
+{
+    boost::filesystem::path reference_path, reads_path;
+    std::vector<SyntheticContig> contigs;
+    SampleName sample;
+    std::vector<SimulatedSample> simulations;
+};
+
+SyntheticDataset make_dataset(std::size_t num_contigs, std::size_t contig_size, SimulationParameters params,
+                              std::mt19937::result_type seed = 42);
+
+std::string random_sequence(std::size_t length, std::mt19937& generator);
+
+} // namespace benchmark
+} // namespace octopus
+
+#endif
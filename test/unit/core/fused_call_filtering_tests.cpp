@@ -0,0 +1,108 @@
+// Copyright (c) 2015-2018 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include <boost/log/core.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include "config/option_parser.hpp"
+#include "core/calling_components.hpp"
+#include "core/octopus.hpp"
+
+#include "benchmark/synthetic_data.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(fused_call_filtering)
+
+namespace {
+
+const benchmark::SyntheticDataset& get_dataset()
+{
+    static const auto result = benchmark::make_dataset(1, 200'000, benchmark::SimulationParameters {});
+    return result;
+}
+
+// Silences logging and provides a working directory for the calls, restoring both on exit
+struct CallingFixture
+{
+    CallingFixture()
+    : logging_was_enabled {boost::log::core::get()->get_logging_enabled()}
+    , working_directory {boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("octopus-fused-%%%%-%%%%-%%%%")}
+    {
+        boost::log::core::get()->set_logging_enabled(false);
+        boost::filesystem::create_directories(working_directory);
+    }
+    
+    ~CallingFixture()
+    {
+        boost::system::error_code ec {};
+        boost::filesystem::remove_all(working_directory, ec);
+        boost::log::core::get()->set_logging_enabled(logging_was_enabled);
+    }
+    
+    bool logging_was_enabled;
+    boost::filesystem::path working_directory;
+};
+
+// Calls the synthetic genome from the command line options, as main does, and returns the output records
+std::vector<std::string> call(const boost::filesystem::path& working_directory, const std::string& name,
+                              std::vector<std::string> options)
+{
+    const auto& dataset = get_dataset();
+    const auto output_path = (working_directory / (name + ".vcf")).string();
+    // A small read buffer cuts the contig into many calling tasks
+    std::vector<std::string> args {
+        "octopus", "--reference", dataset.reference_path.string(), "--reads", dataset.reads_path.string(),
+        "--output", output_path, "--working-directory", working_directory.string(),
+        "--target-read-buffer-footprint", "1MB"
+    };
+    args.insert(std::cend(args), std::cbegin(options), std::cend(options));
+    std::vector<const char*> argv {};
+    for (const auto& arg : args) argv.push_back(arg.c_str());
+    {
+        const auto parsed_options = options::parse_options(static_cast<int>(argv.size()), argv.data());
+        auto components = collate_genome_calling_components(parsed_options);
+        run_octopus(components, "octopus-tests");
+    }
+    std::ifstream vcf {output_path};
+    std::vector<std::string> result {};
+    for (std::string line; std::getline(vcf, line);) {
+        if (!line.empty() && line.front() != '#') result.push_back(line);
+    }
+    return result;
+}
+
+void check_fused_matches_two_pass(const boost::filesystem::path& working_directory, const std::string& num_threads)
+{
+    const auto two_pass = call(working_directory, "two_pass", {"--threads", num_threads});
+    const auto fused = call(working_directory, "fused", {"--threads", num_threads, "--filter-during-calling"});
+    BOOST_REQUIRE(!two_pass.empty());
+    BOOST_CHECK_EQUAL_COLLECTIONS(std::cbegin(fused), std::cend(fused), std::cbegin(two_pass), std::cend(two_pass));
+}
+
+} // namespace
+
+// Calls spanning a task boundary must be filtered after the tasks' connecting calls are merged
+BOOST_FIXTURE_TEST_CASE(fused_filtering_matches_two_pass_filtering_across_task_boundaries_single_threaded, CallingFixture)
+{
+    check_fused_matches_two_pass(working_directory, "1");
+}
+
+BOOST_FIXTURE_TEST_CASE(fused_filtering_matches_two_pass_filtering_across_task_boundaries_multi_threaded, CallingFixture)
+{
+    check_fused_matches_two_pass(working_directory, "4");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
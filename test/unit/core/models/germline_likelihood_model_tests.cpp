@@ -1,4 +1,210 @@
 // Copyright (c) 2017 Daniel Cooke
 // Use of this source code is governed by the MIT license that can be found in the LICENSE file.
 
-#include <stdio.h>
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+#include "basics/genomic_region.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/types/genotype.hpp"
+#include "core/models/haplotype_likelihood_array.hpp"
+#include "core/models/genotype/germline_likelihood_model.hpp"
+#include "utils/maths.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(germline_likelihood_model)
+
+namespace {
+
+using model::GermlineLikelihoodModel;
+
+const SampleName sample {"test"};
+
+std::vector<Haplotype> make_haplotypes(const ReferenceGenome& reference, const std::size_t n)
+{
+    const GenomicRegion region {"1", 100, 120};
+    const auto reference_sequence = reference.fetch_sequence(region);
+    std::vector<Haplotype> result {};
+    for (std::size_t i {0}; i < n; ++i) {
+        auto sequence = reference_sequence;
+        sequence[i] = sequence[i] == 'A' ? 'C' : 'A';
+        result.emplace_back(region, std::move(sequence), reference);
+    }
+    return result;
+}
+
+// Random read likelihoods, where some reads have haplotypes far less likely than the best haplotype,
+// which is more than exp can represent relative to the best
+std::vector<std::vector<double>> make_likelihoods(const std::size_t num_haplotypes, const std::size_t num_reads,
+                                                  std::mt19937& generator)
+{
+    std::uniform_real_distribution<double> likelihood_dist {-50, 0};
+    std::uniform_int_distribution<std::size_t> haplotype_dist {0, num_haplotypes - 1};
+    std::vector<std::vector<double>> result(num_haplotypes, std::vector<double>(num_reads));
+    for (std::size_t read {0}; read < num_reads; ++read) {
+        for (auto& likelihoods : result) likelihoods[read] = likelihood_dist(generator);
+        switch (read % 4) {
+            case 1: // one haplotype is much worse
+                result[haplotype_dist(generator)][read] -= 750;
+                break;
+            case 2: // all but one haplotype are much worse
+            {
+                const auto best = haplotype_dist(generator);
+                for (std::size_t haplotype {0}; haplotype < num_haplotypes; ++haplotype) {
+                    if (haplotype != best) result[haplotype][read] -= haplotype % 2 == 0 ? 720 : 1500;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return result;
+}
+
+HaplotypeLikelihoodArray make_likelihood_array(const std::vector<Haplotype>& haplotypes,
+                                               const std::vector<std::vector<double>>& likelihoods)
+{
+    HaplotypeLikelihoodArray result {};
+    for (std::size_t i {0}; i < haplotypes.size(); ++i) {
+        result.insert(sample, haplotypes[i], likelihoods[i]);
+    }
+    result.prime(sample);
+    return result;
+}
+
+void generate_genotype_indices(const unsigned ploidy, const unsigned num_haplotypes, GenotypeIndex& genotype,
+                               std::vector<GenotypeIndex>& result)
+{
+    if (genotype.size() == ploidy) {
+        result.push_back(genotype);
+        return;
+    }
+    for (unsigned i {genotype.empty() ? 0 : genotype.back()}; i < num_haplotypes; ++i) {
+        genotype.push_back(i);
+        generate_genotype_indices(ploidy, num_haplotypes, genotype, result);
+        genotype.pop_back();
+    }
+}
+
+std::vector<GenotypeIndex> generate_genotype_indices(const unsigned ploidy, const unsigned num_haplotypes)
+{
+    std::vector<GenotypeIndex> result {};
+    GenotypeIndex genotype {};
+    generate_genotype_indices(ploidy, num_haplotypes, genotype, result);
+    return result;
+}
+
+Genotype<Haplotype> make_genotype(const GenotypeIndex& indices, const std::vector<Haplotype>& haplotypes)
+{
+    Genotype<Haplotype> result {static_cast<unsigned>(indices.size())};
+    for (const auto index : indices) result.emplace(haplotypes[index]);
+    return result;
+}
+
+// ln p(reads | genotype) = sum {read} ln sum {haplotype in genotype} p(read | haplotype) - ln ploidy
+double naive_evaluate(const GenotypeIndex& genotype, const std::vector<std::vector<double>>& likelihoods)
+{
+    double result {0};
+    std::vector<double> buffer(genotype.size());
+    for (std::size_t read {0}; read < likelihoods.front().size(); ++read) {
+        std::transform(std::cbegin(genotype), std::cend(genotype), std::begin(buffer),
+                       [&] (auto haplotype) { return likelihoods[haplotype][read]; });
+        result += maths::log_sum_exp(buffer) - std::log(genotype.size());
+    }
+    return result;
+}
+
+constexpr double tolerance {1e-8}; // percent
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(batch_evaluation_matches_per_genotype_evaluation)
+{
+    const auto reference = mock::make_reference();
+    std::mt19937 generator {17};
+    constexpr unsigned num_haplotypes {5};
+    const auto haplotypes = make_haplotypes(reference, num_haplotypes);
+    for (const std::size_t num_reads : {1, 4, 50}) {
+        const auto read_likelihoods = make_likelihoods(num_haplotypes, num_reads, generator);
+        const auto likelihoods = make_likelihood_array(haplotypes, read_likelihoods);
+        const GermlineLikelihoodModel model {likelihoods, haplotypes};
+        for (unsigned ploidy {1}; ploidy <= 4; ++ploidy) {
+            BOOST_TEST_CONTEXT("ploidy " << ploidy << ", " << num_reads << " reads") {
+                const auto genotype_indices = generate_genotype_indices(ploidy, num_haplotypes);
+                std::vector<Genotype<Haplotype>> genotypes {};
+                for (const auto& indices : genotype_indices) genotypes.push_back(make_genotype(indices, haplotypes));
+                std::vector<double> batch_likelihoods {}, batch_index_likelihoods {};
+                model.evaluate(genotypes, batch_likelihoods);
+                model.evaluate(genotype_indices, batch_index_likelihoods);
+                BOOST_REQUIRE_EQUAL(batch_likelihoods.size(), genotypes.size());
+                BOOST_REQUIRE_EQUAL(batch_index_likelihoods.size(), genotypes.size());
+                for (std::size_t i {0}; i < genotypes.size(); ++i) {
+                    const auto expected = naive_evaluate(genotype_indices[i], read_likelihoods);
+                    BOOST_CHECK(std::isfinite(batch_likelihoods[i]));
+                    BOOST_CHECK_CLOSE(model.evaluate(genotypes[i]), expected, tolerance);
+                    BOOST_CHECK_CLOSE(model.evaluate(genotype_indices[i]), expected, tolerance);
+                    BOOST_CHECK_CLOSE(batch_likelihoods[i], expected, tolerance);
+                    BOOST_CHECK_CLOSE(batch_index_likelihoods[i], expected, tolerance);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(batch_evaluation_of_a_genotype_subset_matches_per_genotype_evaluation)
+{
+    // The scaling is relative to the haplotypes in the batch, so a batch without the best haplotype for
+    // some reads is evaluated differently to the full set of genotypes
+    const auto reference = mock::make_reference();
+    std::mt19937 generator {23};
+    constexpr unsigned num_haplotypes {4};
+    const auto haplotypes = make_haplotypes(reference, num_haplotypes);
+    const auto read_likelihoods = make_likelihoods(num_haplotypes, 40, generator);
+    const auto likelihoods = make_likelihood_array(haplotypes, read_likelihoods);
+    const GermlineLikelihoodModel model {likelihoods, haplotypes};
+    const std::vector<GenotypeIndex> genotype_indices {{1}, {2, 3}, {1, 1, 3}, {1, 2, 2, 3}, {3, 3, 3, 3}};
+    std::vector<double> batch_likelihoods {};
+    model.evaluate(genotype_indices, batch_likelihoods);
+    BOOST_REQUIRE_EQUAL(batch_likelihoods.size(), genotype_indices.size());
+    for (std::size_t i {0}; i < genotype_indices.size(); ++i) {
+        BOOST_CHECK_CLOSE(batch_likelihoods[i], naive_evaluate(genotype_indices[i], read_likelihoods), tolerance);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(tetraploid_genotypes_with_two_haplotypes_are_weighted_by_copy_number)
+{
+    const auto reference = mock::make_reference();
+    const auto haplotypes = make_haplotypes(reference, 2);
+    const std::vector<std::vector<double>> read_likelihoods {{-1.0, -5.0, -0.5, -800.0}, {-3.0, -0.1, -2.0, -1.0}};
+    const auto likelihoods = make_likelihood_array(haplotypes, read_likelihoods);
+    const GermlineLikelihoodModel model {likelihoods, haplotypes};
+    for (const GenotypeIndex indices : {GenotypeIndex {0, 0, 1, 1}, GenotypeIndex {0, 0, 0, 1}, GenotypeIndex {0, 1, 1, 1}}) {
+        const auto genotype = make_genotype(indices, haplotypes);
+        // (2, 2): ln (2 p1 + 2 p2) - ln 4 = ln (p1 + p2) - ln 2 for each read
+        const auto expected = naive_evaluate(indices, read_likelihoods);
+        BOOST_CHECK_CLOSE(model.evaluate(genotype), expected, tolerance);
+        BOOST_CHECK_CLOSE(evaluate(std::vector<Genotype<Haplotype>> {genotype}, model).front(), expected, tolerance);
+    }
+    const auto balanced = make_genotype({0, 0, 1, 1}, haplotypes);
+    double expected_balanced {0};
+    for (std::size_t read {0}; read < 4; ++read) {
+        expected_balanced += maths::log_sum_exp(read_likelihoods[0][read], read_likelihoods[1][read]) - std::log(2);
+    }
+    BOOST_CHECK_CLOSE(model.evaluate(balanced), expected_balanced, tolerance);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -1,4 +1,84 @@
 // Copyright (c) 2017 Daniel Cooke
 // Use of this source code is governed by the MIT license that can be found in the LICENSE file.
 
-#include <stdio.h>
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "basics/genomic_region.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/models/haplotype_likelihood_array.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(haplotype_likelihood_array)
+
+namespace {
+
+std::vector<Haplotype> make_haplotypes(const ReferenceGenome& reference, const std::size_t n)
+{
+    const GenomicRegion region {"1", 100, 120};
+    const auto reference_sequence = reference.fetch_sequence(region);
+    std::vector<Haplotype> result {};
+    for (std::size_t i {0}; i < n; ++i) {
+        auto sequence = reference_sequence;
+        sequence[i] = sequence[i] == 'A' ? 'C' : 'A';
+        result.emplace_back(region, std::move(sequence), reference);
+    }
+    return result;
+}
+
+std::vector<double> make_likelihoods(const std::size_t haplotype)
+{
+    return {-1.0 * haplotype, -2.0 * haplotype, -3.0 * haplotype};
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(insert_after_erase_does_not_overwrite_existing_haplotypes)
+{
+    const auto reference = mock::make_reference();
+    const auto haplotypes = make_haplotypes(reference, 4);
+    const SampleName sample {"test"};
+    HaplotypeLikelihoodArray likelihoods {};
+    for (std::size_t i {0}; i < 3; ++i) {
+        likelihoods.insert(sample, haplotypes[i], make_likelihoods(i));
+    }
+    likelihoods.erase(std::vector<Haplotype> {haplotypes[0]});
+    likelihoods.insert(sample, haplotypes[3], make_likelihoods(3));
+    BOOST_CHECK(!likelihoods.contains(haplotypes[0]));
+    for (std::size_t i {1}; i < 4; ++i) {
+        const auto expected = make_likelihoods(i);
+        const auto& row = likelihoods(sample, haplotypes[i]);
+        BOOST_CHECK_EQUAL_COLLECTIONS(std::cbegin(row), std::cend(row), std::cbegin(expected), std::cend(expected));
+    }
+    BOOST_CHECK_NE(likelihoods.index_of(haplotypes[3]), likelihoods.index_of(haplotypes[1]));
+    BOOST_CHECK_NE(likelihoods.index_of(haplotypes[3]), likelihoods.index_of(haplotypes[2]));
+}
+
+BOOST_AUTO_TEST_CASE(insert_keeps_references_to_existing_rows_valid)
+{
+    const auto reference = mock::make_reference();
+    const auto haplotypes = make_haplotypes(reference, 20);
+    const SampleName sample {"test"};
+    HaplotypeLikelihoodArray likelihoods {};
+    likelihoods.insert(sample, haplotypes[0], make_likelihoods(0));
+    likelihoods.insert(sample, haplotypes[1], make_likelihoods(1));
+    const auto& row = likelihoods(sample, haplotypes[1]);
+    for (std::size_t i {2}; i < haplotypes.size(); ++i) {
+        likelihoods.insert(sample, haplotypes[i], make_likelihoods(i));
+    }
+    BOOST_CHECK_EQUAL(&row, &likelihoods(sample, haplotypes[1]));
+    const auto expected = make_likelihoods(1);
+    BOOST_CHECK_EQUAL_COLLECTIONS(std::cbegin(row), std::cend(row), std::cbegin(expected), std::cend(expected));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -1,4 +1,82 @@
 // Copyright (c) 2017 Daniel Cooke
 // Use of this source code is governed by the MIT license that can be found in the LICENSE file.
 
-#include <stdio.h>
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <cstddef>
+
+#include "basics/genomic_region.hpp"
+#include "basics/cigar_string.hpp"
+#include "basics/aligned_read.hpp"
+#include "core/types/haplotype.hpp"
+#include "core/models/haplotype_likelihood_model.hpp"
+#include "core/models/pairhmm/pair_hmm.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(haplotype_likelihood_model)
+
+namespace {
+
+AlignedRead make_read(const GenomicRegion& region, std::string sequence)
+{
+    const auto size = sequence.size();
+    return AlignedRead {
+        "test", region, std::move(sequence), AlignedRead::BaseQualityVector(size, 30),
+        parse_cigar(std::to_string(size) + "M"), 60, AlignedRead::Flags {}, "RG"
+    };
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(cached_likelihoods_are_not_shared_between_haplotypes_that_differ_in_the_aligned_span)
+{
+    const auto reference = mock::make_reference();
+    const GenomicRegion haplotype_region {"1", 100, 140};
+    const auto reference_sequence = reference.fetch_sequence(haplotype_region);
+    const auto read_size = std::size_t {10};
+    const auto read = make_read(GenomicRegion {"1", 100, 100 + read_size}, reference_sequence.substr(0, read_size));
+    const HaplotypeLikelihoodModel::MappingPositionVector mapping_positions {0};
+    const Haplotype reference_haplotype {haplotype_region, reference_sequence, reference};
+    HaplotypeLikelihoodModel::Config cached_config {};
+    cached_config.max_cache_memory = 1'000'000;
+    HaplotypeLikelihoodModel cached_model {cached_config}, uncached_model {};
+    const auto pad = static_cast<std::size_t>(hmm::min_flank_pad());
+    // Includes the bases just past read_size + pad that the HMM still aligns to
+    for (std::size_t i {read_size}; i < read_size + 2 * pad; ++i) {
+        auto sequence = reference_sequence;
+        sequence[i] = sequence[i] == 'A' ? 'C' : 'A';
+        const Haplotype haplotype {haplotype_region, sequence, reference};
+        cached_model.reset(reference_haplotype);
+        cached_model.evaluate(read, mapping_positions);
+        cached_model.reset(haplotype);
+        uncached_model.reset(haplotype);
+        BOOST_CHECK_EQUAL(cached_model.evaluate(read, mapping_positions), uncached_model.evaluate(read, mapping_positions));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(cached_likelihoods_are_reused_for_identical_haplotypes)
+{
+    const auto reference = mock::make_reference();
+    const GenomicRegion haplotype_region {"1", 100, 140};
+    const auto reference_sequence = reference.fetch_sequence(haplotype_region);
+    const auto read = make_read(GenomicRegion {"1", 110, 120}, reference_sequence.substr(10, 10));
+    const Haplotype haplotype {haplotype_region, reference_sequence, reference};
+    HaplotypeLikelihoodModel::Config config {};
+    config.max_cache_memory = 1'000'000;
+    HaplotypeLikelihoodModel model {config};
+    model.reset(haplotype);
+    const auto likelihood = model.evaluate(read);
+    model.reset(haplotype);
+    BOOST_CHECK_EQUAL(model.evaluate(read), likelihood);
+    BOOST_CHECK_EQUAL(model.cache_statistics().hits, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
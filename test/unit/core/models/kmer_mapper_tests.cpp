@@ -1,4 +1,118 @@
 // Copyright (c) 2017 Daniel Cooke
 // Use of this source code is governed by the MIT license that can be found in the LICENSE file.
 
-#include <stdio.h>
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <random>
+#include <algorithm>
+#include <iterator>
+
+#include "utils/kmer_mapper.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(kmer_mapper)
+
+namespace {
+
+std::string random_sequence(const std::size_t length, std::mt19937& generator)
+{
+    static const std::string bases {"ACGT"};
+    std::uniform_int_distribution<std::size_t> dist {0, bases.size() - 1};
+    std::string result(length, 'N');
+    for (auto& base : result) base = bases[dist(generator)];
+    return result;
+}
+
+// A read copied from the target with a few substitutions, or a random read that may not map at all
+std::string random_read(const std::string& target, std::mt19937& generator)
+{
+    std::uniform_int_distribution<std::size_t> length_dist {1, 120};
+    const auto length = length_dist(generator);
+    if (target.size() < length || std::bernoulli_distribution {0.2}(generator)) {
+        return random_sequence(length, generator);
+    }
+    std::uniform_int_distribution<std::size_t> begin_dist {0, target.size() - length};
+    auto result = target.substr(begin_dist(generator), length);
+    std::uniform_int_distribution<std::size_t> position_dist {0, length - 1};
+    for (int i {0}; i < 3; ++i) {
+        auto& base = result[position_dist(generator)];
+        base = base == 'A' ? 'C' : 'A';
+    }
+    return result;
+}
+
+// Counts the kmers shared by the query and each target offset by comparing the kmer strings directly,
+// and returns the offsets with the most shared kmers in ascending order
+std::vector<std::size_t> naive_map(const std::string& query, const std::string& target, const std::size_t k,
+                                   const std::size_t max_mapping_positions)
+{
+    if (query.size() < k || target.size() < k) return {};
+    std::vector<unsigned> counts(target.size() - k + 1, 0);
+    for (std::size_t query_index {0}; query_index + k <= query.size(); ++query_index) {
+        for (std::size_t target_index {query_index}; target_index + k <= target.size(); ++target_index) {
+            if (target.compare(target_index, k, query, query_index, k) == 0) {
+                ++counts[target_index - query_index];
+            }
+        }
+    }
+    const auto max_count = *std::max_element(std::cbegin(counts), std::cend(counts));
+    std::vector<std::size_t> result {};
+    if (max_count == 0) return result;
+    for (std::size_t position {0}; position < counts.size() && result.size() < max_mapping_positions; ++position) {
+        if (counts[position] == max_count) result.push_back(position);
+    }
+    return result;
+}
+
+template <unsigned char K>
+void check_index_matches_naive_mapper(const std::size_t max_mapping_positions, std::mt19937& generator)
+{
+    KmerIndex index {K};
+    // Shorter and longer targets are interleaved so the reused index both grows and shrinks
+    const std::vector<std::size_t> target_lengths {300, 20, K - 1, 1000, K, 50, 0, 120, 2, 700};
+    for (const auto target_length : target_lengths) {
+        auto target = random_sequence(target_length, generator);
+        // A tandem repeat gives reads many equally good mapping positions
+        if (target_length >= 200) target.replace(100, 60, std::string(60, 'A'));
+        index.index(target);
+        BOOST_REQUIRE_EQUAL(index.num_positions(), target.size() < K ? 0 : target.size() - K + 1);
+        for (int i {0}; i < 100; ++i) {
+            auto read = random_read(target, generator);
+            if (i == 0) read = std::string(40, 'A');
+            const auto expected = naive_map(read, target, K, max_mapping_positions);
+            const auto positions = index.map(compute_kmer_hashes<K>(read), max_mapping_positions);
+            BOOST_CHECK_EQUAL_COLLECTIONS(std::cbegin(positions), std::cend(positions),
+                                          std::cbegin(expected), std::cend(expected));
+        }
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(kmer_index_maps_reads_to_the_same_positions_as_a_naive_mapper)
+{
+    std::mt19937 generator {42};
+    check_index_matches_naive_mapper<6>(-1, generator);
+    check_index_matches_naive_mapper<4>(-1, generator);
+    check_index_matches_naive_mapper<10>(-1, generator);
+}
+
+BOOST_AUTO_TEST_CASE(kmer_index_returns_at_most_max_mapping_positions)
+{
+    std::mt19937 generator {7};
+    for (const std::size_t max_mapping_positions : {1, 2, 3, 10}) {
+        check_index_matches_naive_mapper<6>(max_mapping_positions, generator);
+        check_index_matches_naive_mapper<4>(max_mapping_positions, generator);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -1,4 +1,419 @@
 // Copyright (c) 2017 Daniel Cooke
 // Use of this source code is governed by the MIT license that can be found in the LICENSE file.
 
-#include <stdio.h>
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <random>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "utils/system_utils.hpp"
+#include "core/models/pairhmm/simd_pair_hmm.hpp"
+#include "core/models/pairhmm/simd_pair_hmm_kernels.hpp"
+#include "core/models/pairhmm/pair_hmm.hpp"
+
+#include "baseline_pair_hmm.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(core)
+BOOST_AUTO_TEST_SUITE(pair_hmm)
+
+namespace {
+
+std::string random_sequence(const std::size_t length, std::mt19937& generator)
+{
+    static const std::string bases {"ACGT"};
+    std::uniform_int_distribution<std::size_t> dist {0, bases.size() - 1};
+    std::string result(length, 'N');
+    for (auto& base : result) base = bases[dist(generator)];
+    return result;
+}
+
+// Random alignments with every penalty array populated, so the same set can be used for
+// all of the align overloads
+struct AlignmentProblems
+{
+    static constexpr int target_len {100}, truth_len {target_len + 2 * hmm::simd::min_flank_pad() - 1};
+    static constexpr int aln_len {truth_len + target_len + 1};
+    
+    std::vector<std::string> truths, targets, snv_masks;
+    std::vector<std::vector<std::int8_t>> qualities, gap_opens, gap_extends, snv_priors;
+    std::vector<const char*> truth_ptrs, target_ptrs, snv_mask_ptrs;
+    std::vector<const std::int8_t*> quality_ptrs, gap_open_ptrs, gap_extend_ptrs, snv_prior_ptrs;
+    
+    AlignmentProblems(const int num_alignments, std::mt19937& generator)
+    {
+        std::uniform_int_distribution<int> quality_dist {2, 40}, gap_open_dist {10, 45}, gap_extend_dist {1, 10};
+        std::uniform_int_distribution<int> position_dist {1, target_len - 2}, mask_dist {0, 3};
+        for (int i {0}; i < num_alignments; ++i) {
+            auto truth = random_sequence(truth_len, generator);
+            auto target = truth.substr(hmm::simd::min_flank_pad(), target_len);
+            // Substitutions, sometimes an N, and sometimes an insertion or deletion
+            for (int j {0}; j < 3; ++j) {
+                auto& base = target[position_dist(generator)];
+                base = base == 'A' ? 'C' : 'A';
+            }
+            if (i % 5 == 1) truth[position_dist(generator)] = 'N';
+            if (i % 3 == 1) {
+                target.erase(position_dist(generator), 1);
+                target.push_back('G');
+            } else if (i % 3 == 2) {
+                target.insert(position_dist(generator), 1, 'T');
+                target.pop_back();
+            }
+            std::string snv_mask(truth_len, 'N');
+            std::vector<std::int8_t> snv_prior(truth_len), gap_open(truth_len), gap_extend(truth_len), quality(target_len);
+            for (int j {0}; j < truth_len; ++j) {
+                if (mask_dist(generator) == 0) snv_mask[j] = truth[j] == 'A' ? 'C' : 'A';
+                snv_prior[j]  = quality_dist(generator);
+                gap_open[j]   = gap_open_dist(generator);
+                gap_extend[j] = gap_extend_dist(generator);
+            }
+            for (auto& q : quality) q = quality_dist(generator);
+            truths.push_back(std::move(truth));
+            targets.push_back(std::move(target));
+            snv_masks.push_back(std::move(snv_mask));
+            qualities.push_back(std::move(quality));
+            gap_opens.push_back(std::move(gap_open));
+            gap_extends.push_back(std::move(gap_extend));
+            snv_priors.push_back(std::move(snv_prior));
+        }
+        for (int i {0}; i < num_alignments; ++i) {
+            truth_ptrs.push_back(truths[i].data());
+            target_ptrs.push_back(targets[i].data());
+            snv_mask_ptrs.push_back(snv_masks[i].data());
+            quality_ptrs.push_back(qualities[i].data());
+            gap_open_ptrs.push_back(gap_opens[i].data());
+            gap_extend_ptrs.push_back(gap_extends[i].data());
+            snv_prior_ptrs.push_back(snv_priors[i].data());
+        }
+    }
+    
+    int size() const noexcept { return static_cast<int>(truths.size()); }
+};
+
+constexpr int AlignmentProblems::target_len;
+constexpr int AlignmentProblems::truth_len;
+constexpr int AlignmentProblems::aln_len;
+
+enum class Penalties { flat_gap, gap_open, gap_open_extend, snv_mask };
+
+constexpr short gapOpen {40}, gapExtend {3}, nucPrior {2};
+
+hmm::simd::AlignmentBatch make_batch(const AlignmentProblems& problems, const Penalties penalties)
+{
+    hmm::simd::AlignmentBatch result {problems.truth_ptrs.data(), problems.target_ptrs.data(), problems.quality_ptrs.data(),
+                                      problems.truth_len, problems.target_len, problems.size()};
+    result.gap_open = gapOpen;
+    result.gap_extend = gapExtend;
+    result.nuc_prior = nucPrior;
+    if (penalties != Penalties::flat_gap) result.gap_opens = problems.gap_open_ptrs.data();
+    if (penalties == Penalties::gap_open_extend) result.gap_extends = problems.gap_extend_ptrs.data();
+    if (penalties == Penalties::snv_mask) {
+        result.snv_masks  = problems.snv_mask_ptrs.data();
+        result.snv_priors = problems.snv_prior_ptrs.data();
+    }
+    return result;
+}
+
+struct AlignmentResults
+{
+    std::vector<int> scores, first_pos;
+    std::vector<std::vector<char>> aln1, aln2;
+    std::vector<char*> aln1_ptrs, aln2_ptrs;
+    
+    AlignmentResults(const int num_alignments)
+    : scores(num_alignments, -2)
+    , first_pos(num_alignments, -2)
+    , aln1(num_alignments, std::vector<char>(AlignmentProblems::aln_len))
+    , aln2(num_alignments, std::vector<char>(AlignmentProblems::aln_len))
+    {
+        for (auto& aln : aln1) aln1_ptrs.push_back(aln.data());
+        for (auto& aln : aln2) aln2_ptrs.push_back(aln.data());
+    }
+    
+    hmm::simd::AlignmentTraceback traceback() noexcept
+    {
+        return {first_pos.data(), aln1_ptrs.data(), aln2_ptrs.data()};
+    }
+};
+
+void check_equal(const AlignmentResults& results, const AlignmentResults& expected, const bool check_traceback)
+{
+    BOOST_CHECK(results.scores == expected.scores);
+    if (check_traceback) {
+        BOOST_CHECK(results.first_pos == expected.first_pos);
+        for (std::size_t i {0}; i < results.scores.size(); ++i) {
+            BOOST_CHECK_EQUAL(std::string {results.aln1[i].data()}, std::string {expected.aln1[i].data()});
+            BOOST_CHECK_EQUAL(std::string {results.aln2[i].data()}, std::string {expected.aln2[i].data()});
+        }
+    }
+}
+
+// Aligns each problem individually with the baseline kernels, which share no code with
+// the current kernels. There is no baseline flat gap traceback overload, so the flat gap
+// open is passed as a constant array for tracebacks.
+AlignmentResults align_baseline(const AlignmentProblems& problems, const Penalties penalties, const bool traceback)
+{
+    using baseline::align;
+    AlignmentResults result {problems.size()};
+    const auto truth_len = problems.truth_len, target_len = problems.target_len;
+    const std::vector<std::int8_t> flat_gap_open(truth_len, gapOpen);
+    for (int i {0}; i < problems.size(); ++i) {
+        const auto truth = problems.truth_ptrs[i], target = problems.target_ptrs[i];
+        const auto quals = problems.quality_ptrs[i];
+        auto& score = result.scores[i];
+        auto& first_pos = result.first_pos[i];
+        const auto aln1 = result.aln1_ptrs[i], aln2 = result.aln2_ptrs[i];
+        switch (penalties) {
+            case Penalties::flat_gap:
+                if (traceback) {
+                    score = align(truth, target, quals, truth_len, target_len, flat_gap_open.data(), gapExtend, nucPrior,
+                                  first_pos, aln1, aln2);
+                } else {
+                    score = align(truth, target, quals, truth_len, target_len, gapOpen, gapExtend, nucPrior);
+                }
+                break;
+            case Penalties::gap_open:
+                if (traceback) {
+                    score = align(truth, target, quals, truth_len, target_len, problems.gap_open_ptrs[i], gapExtend,
+                                  nucPrior, first_pos, aln1, aln2);
+                } else {
+                    score = align(truth, target, quals, truth_len, target_len, problems.gap_open_ptrs[i], gapExtend, nucPrior);
+                }
+                break;
+            case Penalties::gap_open_extend:
+                if (traceback) {
+                    score = align(truth, target, quals, truth_len, target_len, problems.gap_open_ptrs[i],
+                                  problems.gap_extend_ptrs[i], nucPrior, first_pos, aln1, aln2);
+                } else {
+                    score = align(truth, target, quals, truth_len, target_len, problems.gap_open_ptrs[i],
+                                  problems.gap_extend_ptrs[i], nucPrior);
+                }
+                break;
+            case Penalties::snv_mask:
+                if (traceback) {
+                    score = align(truth, target, quals, truth_len, target_len, problems.snv_mask_ptrs[i],
+                                  problems.snv_prior_ptrs[i], problems.gap_open_ptrs[i], gapExtend, nucPrior,
+                                  aln1, aln2, first_pos);
+                } else {
+                    score = align(truth, target, quals, truth_len, target_len, problems.snv_mask_ptrs[i],
+                                  problems.snv_prior_ptrs[i], problems.gap_open_ptrs[i], gapExtend, nucPrior);
+                }
+                break;
+        }
+    }
+    return result;
+}
+
+template <typename Kernel>
+void check_kernel_matches_baseline(Kernel kernel, const int num_alignments)
+{
+    std::mt19937 generator {static_cast<unsigned>(num_alignments)};
+    const AlignmentProblems problems {num_alignments, generator};
+    for (const auto penalties : {Penalties::flat_gap, Penalties::gap_open, Penalties::gap_open_extend, Penalties::snv_mask}) {
+        for (const bool traceback : {false, true}) {
+            const auto expected = align_baseline(problems, penalties, traceback);
+            AlignmentResults results {num_alignments};
+            const auto results_traceback = results.traceback();
+            kernel(make_batch(problems, penalties), results.scores.data(), traceback ? &results_traceback : nullptr);
+            check_equal(results, expected, traceback);
+        }
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(batched_alignment_scores_are_identical_to_individual_scores)
+{
+    using namespace hmm::simd;
+    
+    std::mt19937 generator {42};
+    constexpr int target_len {100}, truth_len {target_len + 2 * min_flank_pad() - 1}, num_alignments {11};
+    std::vector<std::string> truths(num_alignments), targets(num_alignments);
+    std::vector<std::vector<std::int8_t>> qualities(num_alignments), gap_opens(num_alignments);
+    std::vector<const char*> truth_ptrs {}, target_ptrs {};
+    std::vector<const std::int8_t*> quality_ptrs {}, gap_open_ptrs {};
+    std::uniform_int_distribution<int> quality_dist {2, 40};
+    for (int i {0}; i < num_alignments; ++i) {
+        truths[i] = random_sequence(truth_len, generator);
+        // Mostly matching targets so the alignments are not all trivial
+        targets[i] = truths[i].substr(min_flank_pad(), target_len);
+        targets[i][i] = targets[i][i] == 'A' ? 'C' : 'A';
+        for (int j {0}; j < target_len; ++j) qualities[i].push_back(quality_dist(generator));
+        gap_opens[i].assign(truth_len, 30 + i);
+        truth_ptrs.push_back(truths[i].data());
+        target_ptrs.push_back(targets[i].data());
+        quality_ptrs.push_back(qualities[i].data());
+        gap_open_ptrs.push_back(gap_opens[i].data());
+    }
+    std::vector<int> scores(num_alignments);
+    align(truth_ptrs.data(), target_ptrs.data(), quality_ptrs.data(), truth_len, target_len, num_alignments,
+          gap_open_ptrs.data(), 3, 2, scores.data());
+    for (int i {0}; i < num_alignments; ++i) {
+        const auto expected = align(truths[i].data(), targets[i].data(), qualities[i].data(), truth_len, target_len,
+                                    gap_opens[i].data(), 3, 2);
+        BOOST_CHECK_EQUAL(scores[i], expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(batched_evaluation_is_identical_to_individual_evaluation)
+{
+    std::mt19937 generator {7};
+    const auto truth = random_sequence(300, generator);
+    const std::vector<char> snv_mask(std::cbegin(truth), std::cend(truth));
+    const std::vector<std::int8_t> snv_priors(truth.size(), 40), gap_open(truth.size(), 30);
+    hmm::MutationModel model {snv_mask, snv_priors, gap_open, 3};
+    model.lhs_flank_size = 20;
+    model.rhs_flank_size = 20;
+    constexpr std::size_t num_targets {40};
+    std::vector<std::string> sequences(num_targets);
+    std::vector<std::vector<std::uint8_t>> qualities(num_targets);
+    std::vector<hmm::Target> targets {};
+    std::uniform_int_distribution<std::size_t> offset_dist {0, 200}, length_dist {0, 1};
+    for (std::size_t i {0}; i < num_targets; ++i) {
+        const auto offset = offset_dist(generator);
+        sequences[i] = truth.substr(offset, length_dist(generator) == 0 ? 75 : 90);
+        // Some exact matches, some needing a full alignment
+        for (std::size_t j {i % 3}; j < sequences[i].size(); j += 17) {
+            sequences[i][j] = sequences[i][j] == 'A' ? 'C' : 'A';
+        }
+        qualities[i].assign(sequences[i].size(), 30);
+        targets.push_back({sequences[i], qualities[i], offset});
+    }
+    std::vector<double> likelihoods {};
+    hmm::evaluate(targets, truth, model, likelihoods);
+    BOOST_REQUIRE_EQUAL(likelihoods.size(), num_targets);
+    for (std::size_t i {0}; i < num_targets; ++i) {
+        const auto expected = hmm::evaluate(sequences[i], truth, qualities[i], targets[i].offset, model);
+        BOOST_CHECK_EQUAL(likelihoods[i], expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(simd_kernels_are_identical_to_the_baseline_kernels)
+{
+    using namespace hmm::simd;
+    
+    const auto instruction_set = get_max_simd_instruction_set();
+    // Sizes that are not a multiple of the batch size leave part of the last register empty
+    for (const int num_alignments : {1, 2, 3, 4, 5, 8, 11}) {
+        check_kernel_matches_baseline(sse2::align, num_alignments);
+        if (instruction_set != SimdInstructionSet::sse2) {
+            check_kernel_matches_baseline(avx2::align, num_alignments);
+        }
+        if (instruction_set == SimdInstructionSet::avx512) {
+            check_kernel_matches_baseline(avx512::align, num_alignments);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(every_align_overload_is_identical_to_the_baseline_kernels)
+{
+    using namespace hmm::simd;
+    
+    std::mt19937 generator {11};
+    const AlignmentProblems problems {11, generator};
+    const auto n = problems.size();
+    const auto truth_len = problems.truth_len, target_len = problems.target_len;
+    const auto& truths      = problems.truth_ptrs;
+    const auto& targets     = problems.target_ptrs;
+    const auto& quals       = problems.quality_ptrs;
+    const auto& gap_opens   = problems.gap_open_ptrs;
+    const auto& gap_extends = problems.gap_extend_ptrs;
+    const auto& snv_masks   = problems.snv_mask_ptrs;
+    const auto& snv_priors  = problems.snv_prior_ptrs;
+    
+    {
+        const auto expected = align_baseline(problems, Penalties::flat_gap, false);
+        AlignmentResults single {n}, batched {n};
+        for (int i {0}; i < n; ++i) {
+            single.scores[i] = align(truths[i], targets[i], quals[i], truth_len, target_len, gapOpen, gapExtend, nucPrior);
+        }
+        align(truths.data(), targets.data(), quals.data(), truth_len, target_len, n, gapOpen, gapExtend, nucPrior,
+              batched.scores.data());
+        check_equal(single, expected, false);
+        check_equal(batched, expected, false);
+    }
+    {
+        const auto expected = align_baseline(problems, Penalties::gap_open, false);
+        AlignmentResults single {n}, batched {n};
+        for (int i {0}; i < n; ++i) {
+            single.scores[i] = align(truths[i], targets[i], quals[i], truth_len, target_len, gap_opens[i], gapExtend, nucPrior);
+        }
+        align(truths.data(), targets.data(), quals.data(), truth_len, target_len, n, gap_opens.data(), gapExtend, nucPrior,
+              batched.scores.data());
+        check_equal(single, expected, false);
+        check_equal(batched, expected, false);
+    }
+    {
+        const auto expected = align_baseline(problems, Penalties::gap_open, true);
+        AlignmentResults single {n}, batched {n};
+        for (int i {0}; i < n; ++i) {
+            single.scores[i] = align(truths[i], targets[i], quals[i], truth_len, target_len, gap_opens[i], gapExtend, nucPrior,
+                                     single.first_pos[i], single.aln1_ptrs[i], single.aln2_ptrs[i]);
+        }
+        align(truths.data(), targets.data(), quals.data(), truth_len, target_len, n, gap_opens.data(), gapExtend, nucPrior,
+              batched.scores.data(), batched.first_pos.data(), batched.aln1_ptrs.data(), batched.aln2_ptrs.data());
+        check_equal(single, expected, true);
+        check_equal(batched, expected, true);
+    }
+    {
+        const auto expected = align_baseline(problems, Penalties::gap_open_extend, false);
+        AlignmentResults single {n}, batched {n};
+        for (int i {0}; i < n; ++i) {
+            single.scores[i] = align(truths[i], targets[i], quals[i], truth_len, target_len, gap_opens[i], gap_extends[i], nucPrior);
+        }
+        align(truths.data(), targets.data(), quals.data(), truth_len, target_len, n, gap_opens.data(), gap_extends.data(),
+              nucPrior, batched.scores.data());
+        check_equal(single, expected, false);
+        check_equal(batched, expected, false);
+    }
+    {
+        const auto expected = align_baseline(problems, Penalties::gap_open_extend, true);
+        AlignmentResults single {n}, batched {n};
+        for (int i {0}; i < n; ++i) {
+            single.scores[i] = align(truths[i], targets[i], quals[i], truth_len, target_len, gap_opens[i], gap_extends[i], nucPrior,
+                                     single.first_pos[i], single.aln1_ptrs[i], single.aln2_ptrs[i]);
+        }
+        align(truths.data(), targets.data(), quals.data(), truth_len, target_len, n, gap_opens.data(), gap_extends.data(),
+              nucPrior, batched.scores.data(), batched.first_pos.data(), batched.aln1_ptrs.data(), batched.aln2_ptrs.data());
+        check_equal(single, expected, true);
+        check_equal(batched, expected, true);
+    }
+    {
+        const auto expected = align_baseline(problems, Penalties::snv_mask, false);
+        AlignmentResults single {n}, batched {n};
+        for (int i {0}; i < n; ++i) {
+            single.scores[i] = align(truths[i], targets[i], quals[i], truth_len, target_len, snv_masks[i], snv_priors[i],
+                                     gap_opens[i], gapExtend, nucPrior);
+        }
+        align(truths.data(), targets.data(), quals.data(), truth_len, target_len, n, snv_masks.data(), snv_priors.data(),
+              gap_opens.data(), gapExtend, nucPrior, batched.scores.data());
+        check_equal(single, expected, false);
+        check_equal(batched, expected, false);
+    }
+    {
+        const auto expected = align_baseline(problems, Penalties::snv_mask, true);
+        AlignmentResults single {n}, batched {n};
+        for (int i {0}; i < n; ++i) {
+            single.scores[i] = align(truths[i], targets[i], quals[i], truth_len, target_len, snv_masks[i], snv_priors[i],
+                                     gap_opens[i], gapExtend, nucPrior, single.aln1_ptrs[i], single.aln2_ptrs[i], single.first_pos[i]);
+        }
+        align(truths.data(), targets.data(), quals.data(), truth_len, target_len, n, snv_masks.data(), snv_priors.data(),
+              gap_opens.data(), gapExtend, nucPrior, batched.scores.data(), batched.first_pos.data(), batched.aln1_ptrs.data(),
+              batched.aln2_ptrs.data());
+        check_equal(single, expected, true);
+        check_equal(batched, expected, true);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
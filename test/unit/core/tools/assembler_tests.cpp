@@ -4,6 +4,12 @@
 #include <boost/test/unit_test.hpp>
 
 #include <exception>
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
 
 #include "core/tools/vargen/utils/assembler.hpp"
 
@@ -14,13 +20,60 @@ using octopus::coretools::Assembler;
 BOOST_AUTO_TEST_SUITE(core)
 BOOST_AUTO_TEST_SUITE(assembler)
 
+namespace {
+
+const Assembler::NucleotideSequence test_reference {
+    "GGATCACAGTCTACACTGCTCACTCCAACCCCGGCCCCTGAGTCCGAGGAGAGGGTGCTTCAGAGTATGTATACCACTGGGTAG"
+    "GATACGGCGGAGGGCACGTCAATACGGTTCAATGCCCTACTGCATGCTCTTGTGGTTCATCTGCAT"
+};
+
+// Removes the reference context the assembler pads bubbles with
+Assembler::Variant trim(const Assembler::Variant& variant)
+{
+    auto ref = variant.ref, alt = variant.alt;
+    while (!ref.empty() && !alt.empty() && ref.back() == alt.back()) {
+        ref.pop_back(); alt.pop_back();
+    }
+    std::size_t prefix {0};
+    while (prefix < ref.size() && prefix < alt.size() && ref[prefix] == alt[prefix]) ++prefix;
+    return {variant.begin_pos + prefix, ref.substr(prefix), alt.substr(prefix)};
+}
+
+// Runs the same assembly steps as LocalReassembler
+std::vector<Assembler::Variant> assemble(const unsigned kmer_size, const std::vector<Assembler::NucleotideSequence>& reads)
+{
+    Assembler assembler {{kmer_size, 0.01}, test_reference};
+    for (std::size_t i {0}; i < reads.size(); ++i) {
+        assembler.insert_read(reads[i], i % 2 == 0 ? Assembler::Direction::forward : Assembler::Direction::reverse);
+    }
+    assembler.try_recover_dangling_branches();
+    assembler.prune(2);
+    if (!assembler.is_acyclic()) assembler.remove_nonreference_cycles();
+    assembler.cleanup();
+    std::vector<Assembler::Variant> result {};
+    if (assembler.is_empty() || assembler.is_all_reference()) return result;
+    const auto variants = assembler.extract_variants(10, 0);
+    std::transform(std::cbegin(variants), std::cend(variants), std::back_inserter(result), trim);
+    std::sort(std::begin(result), std::end(result),
+              [] (const auto& lhs, const auto& rhs) { return lhs.begin_pos < rhs.begin_pos; });
+    return result;
+}
+
+auto with_snvs(Assembler::NucleotideSequence sequence, const std::vector<std::pair<std::size_t, char>>& snvs)
+{
+    for (const auto& snv : snvs) sequence[snv.first] = snv.second;
+    return sequence;
+}
+
+} // namespace
+
 BOOST_AUTO_TEST_CASE(assembler_can_be_constructed_with_reference_sequence)
 {
     const Assembler::NucleotideSequence reference {"AAAAACCCCC"};
     
     constexpr unsigned kmerSize {5};
     
-    Assembler assembler {kmerSize, reference};
+    Assembler assembler {{kmerSize}, reference};
     
     BOOST_CHECK(!assembler.is_empty());
     BOOST_CHECK(assembler.is_all_reference());
@@ -32,7 +85,7 @@ BOOST_AUTO_TEST_CASE(reference_sequence_can_be_inserted_into_an_empty_assembler)
     
     constexpr unsigned kmerSize {5};
     
-    Assembler assembler {kmerSize};
+    Assembler assembler {{kmerSize}};
     
     BOOST_REQUIRE(assembler.is_empty());
     
@@ -48,7 +101,7 @@ BOOST_AUTO_TEST_CASE(assemblers_can_be_cleared_and_reused)
     
     constexpr unsigned kmerSize {5};
     
-    Assembler assembler {kmerSize, reference};
+    Assembler assembler {{kmerSize}, reference};
     
     BOOST_REQUIRE(!assembler.is_empty());
     
@@ -67,12 +120,66 @@ BOOST_AUTO_TEST_CASE(assembler_throws_if_reference_sequence_is_inserted_twice)
     
     constexpr unsigned kmerSize {5};
     
-    Assembler assembler {kmerSize, reference};
+    Assembler assembler {{kmerSize}, reference};
     
     BOOST_CHECK_THROW(assembler.insert_reference(reference), std::exception);
 }
 
+BOOST_AUTO_TEST_CASE(assembler_finds_variants_supported_by_reads)
+{
+    // 32 is the largest packed kmer and 33 uses the hashed representation
+    for (const unsigned kmer_size : {10u, 32u, 33u}) {
+        BOOST_TEST_CONTEXT("kmer size " << kmer_size) {
+            const auto snv_haplotype = with_snvs(test_reference, {{75, 'G'}});
+            const std::vector<Assembler::Variant> expected_snv {{75, "A", "G"}};
+            BOOST_CHECK(assemble(kmer_size, std::vector<Assembler::NucleotideSequence>(4, snv_haplotype)) == expected_snv);
+            
+            const auto snvs_haplotype = with_snvs(test_reference, {{40, 'T'}, {110, 'T'}});
+            const std::vector<Assembler::Variant> expected_snvs {{40, "A", "T"}, {110, "G", "T"}};
+            BOOST_CHECK(assemble(kmer_size, std::vector<Assembler::NucleotideSequence>(4, snvs_haplotype)) == expected_snvs);
+            
+            auto deletion_haplotype = test_reference;
+            deletion_haplotype.erase(70, 4);
+            const std::vector<Assembler::Variant> expected_deletion {{70, "ATAC", ""}};
+            BOOST_CHECK(assemble(kmer_size, std::vector<Assembler::NucleotideSequence>(4, deletion_haplotype)) == expected_deletion);
+            
+            auto insertion_haplotype = test_reference;
+            insertion_haplotype.insert(80, "TTTGA");
+            const std::vector<Assembler::Variant> expected_insertion {{80, "", "TTTGA"}};
+            BOOST_CHECK(assemble(kmer_size, std::vector<Assembler::NucleotideSequence>(4, insertion_haplotype)) == expected_insertion);
+        }
+    }
+}
 
+BOOST_AUTO_TEST_CASE(assembler_ignores_unsupported_variants)
+{
+    for (const unsigned kmer_size : {10u, 32u}) {
+        BOOST_TEST_CONTEXT("kmer size " << kmer_size) {
+            // A single read is pruned as an error
+            const std::vector<Assembler::NucleotideSequence> reads {with_snvs(test_reference, {{75, 'G'}})};
+            BOOST_CHECK(assemble(kmer_size, reads).empty());
+            BOOST_CHECK(assemble(kmer_size, std::vector<Assembler::NucleotideSequence>(4, test_reference)).empty());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(assembler_does_not_report_kmers_containing_n)
+{
+    for (const unsigned kmer_size : {10u, 32u, 33u}) {
+        BOOST_TEST_CONTEXT("kmer size " << kmer_size) {
+            const auto reference_reads = std::vector<Assembler::NucleotideSequence>(4, with_snvs(test_reference, {{20, 'N'}, {120, 'N'}}));
+            BOOST_CHECK(assemble(kmer_size, reference_reads).empty());
+            // Half the reads have an N next to the SNV, so the variant is only supported by the others
+            std::vector<Assembler::NucleotideSequence> snv_reads {};
+            for (int i {0}; i < 3; ++i) {
+                snv_reads.push_back(with_snvs(test_reference, {{75, 'G'}}));
+                snv_reads.push_back(with_snvs(test_reference, {{75, 'G'}, {78, 'N'}}));
+            }
+            const std::vector<Assembler::Variant> expected {{75, "A", "G"}};
+            BOOST_CHECK(assemble(kmer_size, snv_reads) == expected);
+        }
+    }
+}
 
 BOOST_AUTO_TEST_SUITE_END()
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,69 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <sstream>
+
+#include "io/variant/vcf_record.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(io)
+BOOST_AUTO_TEST_SUITE(vcf_record)
+
+namespace {
+
+std::string to_string(const VcfRecord& record)
+{
+    std::ostringstream ss {};
+    ss << record;
+    return ss.str();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(numeric_values_print_as_they_did_when_stored_as_strings)
+{
+    using ValueType = VcfRecord::ValueType;
+    VcfRecord::Builder builder {};
+    builder.set_chrom("1").set_pos(100).set_ref("A").set_alt("C").set_qual(60).set_passed();
+    builder.set_info("DP", 20u).set_info("MP", 0.99).set_info("PP", ValueType {12.346, 2});
+    builder.set_info("AC", {1u, 2u}).set_info_flag("SOMATIC").set_info_missing("RFQUAL");
+    builder.set_format({"GT", "GQ", "DP", "MAP_VAF"});
+    builder.set_genotype("sample", std::vector<std::string> {"A", "C"}, VcfRecord::Builder::Phasing::unphased);
+    builder.set_format("sample", "GQ", 99).set_format("sample", "DP", std::size_t {20});
+    builder.set_format("sample", "MAP_VAF", ".42");
+    const auto record = builder.build_once();
+    const std::string expected {"1\t100\t.\tA\tC\t60\tPASS\tAC=1,2;DP=20;MP=" + std::to_string(0.99)
+                                + ";PP=12.35;RFQUAL=.;SOMATIC\tGT:GQ:DP:MAP_VAF\t0/1:99:20:.42"};
+    BOOST_CHECK_EQUAL(to_string(record), expected);
+    BOOST_CHECK_EQUAL(record.info_value("DP").front().to_integer(), 20);
+    BOOST_CHECK_EQUAL(record.info_value("PP").front().to_real(), 12.346);
+    BOOST_CHECK(record.info_value("RFQUAL").front().is_missing());
+    BOOST_CHECK(record.info_value("SOMATIC").empty());
+    BOOST_CHECK_EQUAL(record.get_sample_value("sample", "GQ").front().to_integer(), 99);
+    BOOST_CHECK_EQUAL(record.get_sample_value("sample", "MAP_VAF").front().to_real(), 0.42);
+}
+
+BOOST_AUTO_TEST_CASE(string_values_are_parsed_when_a_number_is_requested)
+{
+    const VcfRecord::ValueType integer {"42"}, real {"0.5"}, missing {"."};
+    BOOST_CHECK_EQUAL(integer.to_integer(), 42);
+    BOOST_CHECK_EQUAL(integer.to_real(), 42.0);
+    BOOST_CHECK_EQUAL(real.to_real(), 0.5);
+    BOOST_CHECK(missing.is_missing());
+    BOOST_CHECK(!integer.is_missing());
+    BOOST_CHECK(integer == 42);
+    BOOST_CHECK(real != VcfRecord::ValueType {0.5});
+    BOOST_CHECK(real == VcfRecord::ValueType(0.5, 1));
+    BOOST_CHECK_THROW(VcfRecord::ValueType {"PASS"}.to_integer(), std::invalid_argument);
+    BOOST_CHECK_THROW(VcfRecord::ValueType {}.to_real(), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus
@@ -0,0 +1,152 @@
+// Copyright (c) 2017 Daniel Cooke
+// Use of this source code is governed by the MIT license that can be found in the LICENSE file.
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <random>
+#include <tuple>
+
+#include "tandem/tandem.hpp"
+
+#include "basics/genomic_region.hpp"
+#include "core/types/haplotype.hpp"
+#include "utils/tandem_repeat_index.hpp"
+#include "mock/mock_reference.hpp"
+
+namespace octopus { namespace test {
+
+BOOST_AUTO_TEST_SUITE(utils)
+BOOST_AUTO_TEST_SUITE(tandem_repeat_index)
+
+namespace {
+
+// Random sequence with plenty of short tandem repeats
+std::string random_repetitive_sequence(const std::size_t length, std::mt19937& generator)
+{
+    static const std::string bases {"ACGT"};
+    std::uniform_int_distribution<std::size_t> base_dist {0, bases.size() - 1}, period_dist {1, 3}, copies_dist {2, 8};
+    std::bernoulli_distribution repeat_dist {0.2};
+    std::string result {};
+    while (result.size() < length) {
+        if (repeat_dist(generator)) {
+            std::string unit(period_dist(generator), 'N');
+            for (auto& base : unit) base = bases[base_dist(generator)];
+            for (auto n = copies_dist(generator); n > 0; --n) result += unit;
+        } else {
+            result += bases[base_dist(generator)];
+        }
+    }
+    result.resize(length);
+    return result;
+}
+
+// Applies SNVs, short insertions and deletions, and expansions or contractions of the unit at a position
+std::string mutate(std::string sequence, std::mt19937& generator)
+{
+    static const std::string bases {"ACGT"};
+    std::uniform_int_distribution<std::size_t> base_dist {0, bases.size() - 1}, num_dist {0, 4}, size_dist {1, 6};
+    std::uniform_int_distribution<int> type_dist {0, 3};
+    for (auto n = num_dist(generator); n > 0 && !sequence.empty(); --n) {
+        const auto pos = std::uniform_int_distribution<std::size_t> {0, sequence.size() - 1}(generator);
+        switch (type_dist(generator)) {
+            case 0:
+                sequence[pos] = sequence[pos] == 'A' ? 'C' : 'A';
+                break;
+            case 1:
+            {
+                std::string insertion(size_dist(generator), 'N');
+                for (auto& base : insertion) base = bases[base_dist(generator)];
+                sequence.insert(pos, insertion);
+                break;
+            }
+            case 2:
+                sequence.erase(pos, size_dist(generator));
+                break;
+            default:
+            {
+                const auto period = std::min(size_dist(generator) % 3 + 1, sequence.size() - pos);
+                const auto unit = sequence.substr(pos, period);
+                if (std::bernoulli_distribution {0.5}(generator)) {
+                    for (auto copies = size_dist(generator); copies > 0; --copies) sequence.insert(pos, unit);
+                } else if (sequence.compare(pos + period, period, unit) == 0) {
+                    sequence.erase(pos, period);
+                }
+            }
+        }
+    }
+    return sequence;
+}
+
+auto to_tuples(const std::vector<tandem::Repeat>& repeats)
+{
+    std::vector<std::tuple<std::uint32_t, std::uint32_t, std::uint32_t>> result {};
+    result.reserve(repeats.size());
+    for (const auto& repeat : repeats) result.emplace_back(repeat.pos, repeat.length, repeat.period);
+    return result;
+}
+
+void check_find_matches_tandem(const TandemRepeatIndex& index, const Haplotype& haplotype)
+{
+    TandemRepeatIndex::RepeatVector repeats {};
+    index.find(haplotype, repeats);
+    const auto expected = tandem::extract_exact_tandem_repeats(haplotype.sequence(), 1, index.max_period());
+    BOOST_REQUIRE_EQUAL(repeats.size(), expected.size());
+    const auto actual_tuples = to_tuples(repeats), expected_tuples = to_tuples(expected);
+    BOOST_CHECK(actual_tuples == expected_tuples);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(find_gives_the_same_repeats_as_a_full_scan_for_mutated_haplotypes)
+{
+    const auto reference = mock::make_reference();
+    std::mt19937 generator {31};
+    for (unsigned max_period {1}; max_period <= 3; ++max_period) {
+        TandemRepeatIndex index {max_period};
+        for (const std::size_t length : {6, 20, 100, 400, 2000}) {
+            const GenomicRegion region {"1", 0, static_cast<GenomicRegion::Position>(length)};
+            for (int i {0}; i < 10; ++i) {
+                const Haplotype reference_haplotype {region, random_repetitive_sequence(length, generator), reference};
+                index.index(reference_haplotype);
+                BOOST_REQUIRE(index.is_indexed(region));
+                check_find_matches_tandem(index, reference_haplotype);
+                for (int j {0}; j < 20; ++j) {
+                    const Haplotype haplotype {region, mutate(reference_haplotype.sequence(), generator), reference};
+                    check_find_matches_tandem(index, haplotype);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(find_falls_back_to_a_full_scan_for_unindexed_regions_and_short_sequences)
+{
+    const auto reference = mock::make_reference();
+    std::mt19937 generator {13};
+    TandemRepeatIndex index {3};
+    const GenomicRegion region {"1", 0, 200}, other_region {"1", 50, 250};
+    const auto sequence = random_repetitive_sequence(200, generator);
+    index.index(Haplotype {region, sequence, reference});
+    // Region mismatch
+    check_find_matches_tandem(index, Haplotype {other_region, sequence, reference});
+    check_find_matches_tandem(index, Haplotype {other_region, mutate(sequence, generator), reference});
+    // Haplotypes shorter than two periods
+    for (const std::string short_sequence : {"", "A", "AA", "ACA", "AAAAA", "ACACA"}) {
+        check_find_matches_tandem(index, Haplotype {region, short_sequence, reference});
+    }
+    // A reference shorter than two periods is not indexed, so every haplotype is scanned in full
+    const GenomicRegion short_region {"1", 0, 5};
+    index.index(Haplotype {short_region, std::string {"AAAAA"}, reference});
+    BOOST_CHECK(!index.is_indexed(short_region));
+    check_find_matches_tandem(index, Haplotype {short_region, std::string {"AAAAAAAAAA"}, reference});
+    check_find_matches_tandem(index, Haplotype {short_region, std::string {"ACACAC"}, reference});
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace test
+} // namespace octopus